@@ -0,0 +1,634 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+/*
+ *	Microbenchmarks of the phases of a native Monte Carlo run: setting the
+ *	input distributions (sampling), the sensor calibration kernel (scalar and
+ *	block variants), the reduction of the samples, and the output writers.
+ *	Each benchmark runs for several numbers of samples, with warmup runs and
+ *	repetitions, and reports the median, median absolute deviation (MAD) and
+ *	a distribution-free 95% confidence interval of the median of the time
+ *	per sample. The repetitions of all benchmarks are interleaved, in a new
+ *	random order in every round, so that a slow phase of the machine spreads
+ *	over all of them instead of shifting the times of one. The JSON output
+ *	also holds the time per sample of every repetition and the peak resident
+ *	set size, for the regression gate. The parallel Monte Carlo and data.out
+ *	writer benchmarks sweep the number of threads.
+ */
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <uxhw.h>
+#include "utilities.h"
+#include "sensor-calibration.h"
+#include "timing.h"
+#include "parallel-monte-carlo.h"
+#include "run-arena.h"
+#include "json-output.h"
+
+typedef enum
+{
+	kMicrobenchmarkDefaultRepetitions				= 15,
+	kMicrobenchmarkDefaultWarmupRepetitions				= 3,
+	kMicrobenchmarkMaximumNumberOfSizes				= 32,
+} MicrobenchmarkConstant;
+
+static const char *	kMicrobenchmarkDefaultSizes = "1000,10000,100000,1000000";
+static const char *	kMicrobenchmarkDefaultThreadCounts = "1,2,4";
+
+/*
+ *	Buffers shared by all benchmarks, sized for the largest number of samples.
+ */
+typedef struct
+{
+	double	(*inputDistributionBlock)[kInputDistributionIndexMax];
+	double *	outputSamples[kOutputDistributionIndexMax];
+	size_t		numberOfThreads;
+} MicrobenchmarkBuffers;
+
+typedef void (*MicrobenchmarkFunction)(MicrobenchmarkBuffers *  buffers, size_t numberOfSamples);
+
+typedef struct
+{
+	const char *		name;
+	MicrobenchmarkFunction	function;
+} Microbenchmark;
+
+/*
+ *	One benchmark for one number of samples (and number of threads), with
+ *	the time per sample of each of its repetitions.
+ */
+typedef struct
+{
+	char			name[32];
+	MicrobenchmarkFunction	function;
+	size_t			numberOfThreads;
+	size_t			numberOfSamples;
+	double *		nanosecondsPerSample;
+} MicrobenchmarkCase;
+
+typedef struct
+{
+	double	median;
+	double	medianAbsoluteDeviation;
+	double	confidenceIntervalLow;
+	double	confidenceIntervalHigh;
+} MicrobenchmarkSummary;
+
+static void
+benchmarkSampling(MicrobenchmarkBuffers *  buffers, size_t numberOfSamples)
+{
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		setInputDistributionsViaUxHwCall(buffers->inputDistributionBlock[i]);
+	}
+
+	return;
+}
+
+static void
+benchmarkScalarKernel(MicrobenchmarkBuffers *  buffers, size_t numberOfSamples)
+{
+	SensorOutputKernel	kernel = getSensorOutputKernel(kOutputDistributionIndexMax);
+	double			outputDistributions[kOutputDistributionIndexMax];
+
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		kernel(buffers->inputDistributionBlock[i], outputDistributions);
+
+		for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+		{
+			buffers->outputSamples[j][i] = outputDistributions[j];
+		}
+	}
+
+	return;
+}
+
+static void
+benchmarkBlockKernel(MicrobenchmarkBuffers *  buffers, size_t numberOfSamples)
+{
+	SensorOutputBlockKernel	kernel = getSensorOutputBlockKernel(kOutputDistributionIndexMax);
+
+	for (size_t blockStart = 0; blockStart < numberOfSamples; blockStart += kMonteCarloBlockSize)
+	{
+		double *	blockOutputSamples[kOutputDistributionIndexMax];
+		size_t		blockLength = (numberOfSamples - blockStart < kMonteCarloBlockSize) ? numberOfSamples - blockStart : kMonteCarloBlockSize;
+
+		for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+		{
+			blockOutputSamples[j] = &buffers->outputSamples[j][blockStart];
+		}
+
+		kernel((const double (*)[kInputDistributionIndexMax])&buffers->inputDistributionBlock[blockStart], blockOutputSamples, blockLength);
+	}
+
+	return;
+}
+
+static void
+benchmarkReduction(MicrobenchmarkBuffers *  buffers, size_t numberOfSamples)
+{
+	volatile double	sink;
+
+	sink = calculateMeanAndVarianceOfDoubleSamples(
+			buffers->outputSamples[kOutputDistributionIndexCalibratedDifferentialPressureOutput],
+			numberOfSamples).mean;
+	(void)sink;
+
+	return;
+}
+
+static void
+benchmarkJointReduction(MicrobenchmarkBuffers *  buffers, size_t numberOfSamples)
+{
+	volatile double	sink;
+
+	sink = calculateJointOutputStatisticsOfDoubleSamples(buffers->outputSamples, numberOfSamples).correlation[0][1];
+	(void)sink;
+
+	return;
+}
+
+static void
+benchmarkDataDotOutWriter(MicrobenchmarkBuffers *  buffers, size_t numberOfSamples)
+{
+	saveJointMonteCarloDoubleDataToDataDotOutFile(
+		&buffers->outputSamples[kOutputDistributionIndexCalibratedDifferentialPressureOutput],
+		1,
+		0,
+		numberOfSamples,
+		buffers->numberOfThreads);
+
+	return;
+}
+
+static void
+benchmarkJSONWriter(MicrobenchmarkBuffers *  buffers, size_t numberOfSamples)
+{
+	CommandLineArguments	arguments = {0};
+	const char *		outputVariableNames[kOutputDistributionIndexMax] =
+				{
+					"Calibrated Mass Flow",
+					"Calibrated Differential Pressure",
+				};
+	int			standardOutput;
+	int			nullOutput;
+
+	arguments.common.isMonteCarloMode = true;
+	arguments.common.outputSelect = kOutputDistributionIndexMax;
+	arguments.common.numberOfMonteCarloIterations = numberOfSamples;
+
+	/*
+	 *	Discard the JSON text, so that the benchmark measures formatting
+	 *	rather than the terminal. The writer writes to the standard output
+	 *	file descriptor directly, so redirect that.
+	 */
+	fflush(stdout);
+	standardOutput = dup(STDOUT_FILENO);
+	nullOutput = open("/dev/null", O_WRONLY);
+
+	if ((standardOutput < 0) || (nullOutput < 0))
+	{
+		return;
+	}
+
+	dup2(nullOutput, STDOUT_FILENO);
+	close(nullOutput);
+
+	printMonteCarloOutputJSON(&arguments, buffers->outputSamples, NULL, outputVariableNames);
+
+	dup2(standardOutput, STDOUT_FILENO);
+	close(standardOutput);
+
+	return;
+}
+
+static void
+benchmarkParallelMonteCarlo(MicrobenchmarkBuffers *  buffers, size_t numberOfSamples)
+{
+	ParallelMonteCarloConfiguration	configuration =
+	{
+		.numberOfThreads	= buffers->numberOfThreads,
+		.isThreadPinningEnabled	= false,
+		.outputSelect		= kOutputDistributionIndexMax,
+		.seed			= kCounterBasedSamplerDefaultSeed,
+	};
+	ParallelMonteCarloReport	report;
+
+	runParallelMonteCarlo(&configuration, buffers->outputSamples, numberOfSamples, &report);
+
+	return;
+}
+
+static const Microbenchmark	kMicrobenchmarks[] =
+{
+	{ .name = "sampling",		.function = benchmarkSampling },
+	{ .name = "kernel-scalar",	.function = benchmarkScalarKernel },
+	{ .name = "kernel-block",	.function = benchmarkBlockKernel },
+	{ .name = "reduction",		.function = benchmarkReduction },
+	{ .name = "reduction-joint",	.function = benchmarkJointReduction },
+	{ .name = "writer-data-out",	.function = benchmarkDataDotOutWriter },
+	{ .name = "writer-json",	.function = benchmarkJSONWriter },
+};
+
+static int
+compareDoubles(const void *  a, const void *  b)
+{
+	double	x = *(const double *)a;
+	double	y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+/*
+ *	Median of sorted values.
+ */
+static double
+calculateMedianOfSortedDoubles(const double *  values, size_t numberOfValues)
+{
+	return (numberOfValues % 2 == 1) ?
+			values[numberOfValues / 2] :
+			(values[numberOfValues / 2 - 1] + values[numberOfValues / 2]) / 2;
+}
+
+/*
+ *	Summarizes the repetitions (sorts `values` in place). The confidence
+ *	interval of the median uses the order statistics at ranks
+ *	`n/2 -/+ 1.96 * sqrt(n)/2` (normal approximation of the binomial).
+ */
+static MicrobenchmarkSummary
+summarizeRepetitions(double *  values, size_t numberOfValues)
+{
+	MicrobenchmarkSummary	summary;
+	double			deviations[numberOfValues];
+	double			halfWidth = 1.96 * sqrt((double)numberOfValues) / 2;
+	long			lowRank = (long)floor((double)numberOfValues / 2 - halfWidth);
+	long			highRank = (long)ceil((double)numberOfValues / 2 + halfWidth);
+
+	qsort(values, numberOfValues, sizeof(double), compareDoubles);
+	summary.median = calculateMedianOfSortedDoubles(values, numberOfValues);
+
+	for (size_t i = 0; i < numberOfValues; i++)
+	{
+		deviations[i] = fabs(values[i] - summary.median);
+	}
+
+	qsort(deviations, numberOfValues, sizeof(double), compareDoubles);
+	summary.medianAbsoluteDeviation = calculateMedianOfSortedDoubles(deviations, numberOfValues);
+
+	lowRank = (lowRank < 0) ? 0 : lowRank;
+	highRank = (highRank > (long)numberOfValues - 1) ? (long)numberOfValues - 1 : highRank;
+	summary.confidenceIntervalLow = values[lowRank];
+	summary.confidenceIntervalHigh = values[highRank];
+
+	return summary;
+}
+
+/*
+ *	Runs one benchmark for one number of samples once, and returns the
+ *	wall-clock time per sample.
+ */
+static double
+runMicrobenchmarkCase(const MicrobenchmarkCase *  benchmarkCase, MicrobenchmarkBuffers *  buffers)
+{
+	uint64_t	start;
+
+	buffers->numberOfThreads = benchmarkCase->numberOfThreads;
+	start = getWallClockNanoseconds();
+	benchmarkCase->function(buffers, benchmarkCase->numberOfSamples);
+
+	return (double)(getWallClockNanoseconds() - start) / (double)benchmarkCase->numberOfSamples;
+}
+
+/*
+ *	Prints the results of one benchmark for one number of samples.
+ */
+static void
+printMicrobenchmarkCase(
+	MicrobenchmarkCase *	benchmarkCase,
+	int			repetitions,
+	bool			isOutputJSONMode,
+	bool *			isFirstResult)
+{
+	double			sortedNanosecondsPerSample[repetitions];
+	MicrobenchmarkSummary	summary;
+
+	memcpy(sortedNanosecondsPerSample, benchmarkCase->nanosecondsPerSample, (size_t)repetitions * sizeof(double));
+	summary = summarizeRepetitions(sortedNanosecondsPerSample, (size_t)repetitions);
+
+	if (isOutputJSONMode)
+	{
+		printf(
+			"%s{\"benchmark\": \"%s\", \"numberOfSamples\": %zu, \"medianNanosecondsPerSample\": %.3lf, "
+			"\"madNanosecondsPerSample\": %.3lf, \"ci95LowNanosecondsPerSample\": %.3lf, "
+			"\"ci95HighNanosecondsPerSample\": %.3lf, \"samplesPerSecond\": %.1lf, \"nanosecondsPerSample\": [",
+			*isFirstResult ? "" : ", ",
+			benchmarkCase->name,
+			benchmarkCase->numberOfSamples,
+			summary.median,
+			summary.medianAbsoluteDeviation,
+			summary.confidenceIntervalLow,
+			summary.confidenceIntervalHigh,
+			1e9 / summary.median);
+
+		/*
+		 *	In the order in which they ran.
+		 */
+		for (int r = 0; r < repetitions; r++)
+		{
+			printf("%s%.3lf", (r == 0) ? "" : ", ", benchmarkCase->nanosecondsPerSample[r]);
+		}
+
+		printf("]}");
+		*isFirstResult = false;
+	}
+	else
+	{
+		printf("%-20s %10zu %16.3lf %14.3lf %16.3lf %16.3lf %16.1lf\n",
+			benchmarkCase->name,
+			benchmarkCase->numberOfSamples,
+			summary.median,
+			summary.medianAbsoluteDeviation,
+			summary.confidenceIntervalLow,
+			summary.confidenceIntervalHigh,
+			1e9 / summary.median);
+	}
+
+	return;
+}
+
+static void
+printMicrobenchmarkUsage(void)
+{
+	fprintf(stderr, "Microbenchmarks of the FlussoFLS110 sensor conversion routines\n");
+	fprintf(stderr, "\n");
+	fprintf(
+		stderr,
+		"\t[-n, --sizes <Comma-separated numbers of samples : str (Default: %s)>]\n"
+		"\t[-r, --repetitions <Number of timed repetitions : int (Default: %d)>]\n"
+		"\t[-w, --warmup <Number of untimed warmup repetitions : int (Default: %d)>]\n"
+		"\t[-p, --threads <Comma-separated numbers of threads of the parallel Monte Carlo and data.out writer benchmarks : str (Default: %s)>]\n"
+		"\t[-j, --json] (Print results in JSON format.)\n"
+		"\t[-h, --help] (Display this help message.)\n",
+		kMicrobenchmarkDefaultSizes,
+		kMicrobenchmarkDefaultRepetitions,
+		kMicrobenchmarkDefaultWarmupRepetitions,
+		kMicrobenchmarkDefaultThreadCounts);
+	fprintf(stderr, "\n");
+
+	return;
+}
+
+/*
+ *	Parses a comma-separated list of positive integers into `sizes`.
+ */
+static size_t
+parseSizes(const char *  sizesArg, size_t *  sizes)
+{
+	char		buffer[1024];
+	size_t		numberOfSizes = 0;
+
+	snprintf(buffer, sizeof(buffer), "%s", sizesArg);
+
+	for (char *  token = strtok(buffer, ","); token != NULL; token = strtok(NULL, ","))
+	{
+		int	size;
+
+		if ((numberOfSizes == kMicrobenchmarkMaximumNumberOfSizes) ||
+			(parseIntChecked(token, &size) != kCommonConstantReturnTypeSuccess) ||
+			(size <= 0))
+		{
+			return 0;
+		}
+
+		sizes[numberOfSizes++] = (size_t)size;
+	}
+
+	return numberOfSizes;
+}
+
+int
+main(int argc, char *  argv[])
+{
+	CommonCommandLineArguments	arguments = {0};
+	char *				sizesArg = NULL;
+	char *				repetitionsArg = NULL;
+	char *				warmupArg = NULL;
+	char *				threadCountsArg = NULL;
+	DemoOption			options[] =
+					{
+						{ .opt = "n", .optAlternative = "sizes", .hasArg = true, .foundArg = &sizesArg, .foundOpt = NULL },
+						{ .opt = "r", .optAlternative = "repetitions", .hasArg = true, .foundArg = &repetitionsArg, .foundOpt = NULL },
+						{ .opt = "w", .optAlternative = "warmup", .hasArg = true, .foundArg = &warmupArg, .foundOpt = NULL },
+						{ .opt = "p", .optAlternative = "threads", .hasArg = true, .foundArg = &threadCountsArg, .foundOpt = NULL },
+						{0},
+					};
+	size_t				sizes[kMicrobenchmarkMaximumNumberOfSizes];
+	size_t				numberOfSizes;
+	size_t				threadCounts[kMicrobenchmarkMaximumNumberOfSizes];
+	size_t				numberOfThreadCounts;
+	size_t				maximumSize = 0;
+	int				repetitions = kMicrobenchmarkDefaultRepetitions;
+	int				warmupRepetitions = kMicrobenchmarkDefaultWarmupRepetitions;
+	MicrobenchmarkBuffers		buffers;
+	MicrobenchmarkCase *		cases;
+	size_t *			order;
+	size_t				numberOfCases = 0;
+	size_t				numberOfBenchmarks = sizeof(kMicrobenchmarks) / sizeof(kMicrobenchmarks[0]);
+	bool				isFirstResult = true;
+	bool				isOutOfMemory;
+	struct rusage			resourceUsage;
+
+	if (parseArgs(argc, argv, &arguments, options) != 0)
+	{
+		printMicrobenchmarkUsage();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (arguments.isHelpEnabled)
+	{
+		printMicrobenchmarkUsage();
+
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+	numberOfSizes = parseSizes((sizesArg != NULL) ? sizesArg : kMicrobenchmarkDefaultSizes, sizes);
+	numberOfThreadCounts = parseSizes((threadCountsArg != NULL) ? threadCountsArg : kMicrobenchmarkDefaultThreadCounts, threadCounts);
+
+	for (size_t t = 0; t < numberOfThreadCounts; t++)
+	{
+		numberOfThreadCounts = (threadCounts[t] > kParallelMonteCarloMaximumNumberOfThreads) ? 0 : numberOfThreadCounts;
+	}
+
+	if ((numberOfSizes == 0) || (numberOfThreadCounts == 0) ||
+		((repetitionsArg != NULL) && ((parseIntChecked(repetitionsArg, &repetitions) != kCommonConstantReturnTypeSuccess) || (repetitions < 1))) ||
+		((warmupArg != NULL) && ((parseIntChecked(warmupArg, &warmupRepetitions) != kCommonConstantReturnTypeSuccess) || (warmupRepetitions < 0))))
+	{
+		fprintf(stderr, "Error: Invalid sizes, repetitions, warmup or thread count arguments.\n");
+		printMicrobenchmarkUsage();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t s = 0; s < numberOfSizes; s++)
+	{
+		maximumSize = (sizes[s] > maximumSize) ? sizes[s] : maximumSize;
+	}
+
+	buffers.numberOfThreads = 1;
+	buffers.inputDistributionBlock = allocateFromRunArena(maximumSize * sizeof(*buffers.inputDistributionBlock), kRunArenaDefaultAlignment);
+	isOutOfMemory = (buffers.inputDistributionBlock == NULL);
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		buffers.outputSamples[j] = (double *) allocateFromRunArena(maximumSize * sizeof(double), kRunArenaDefaultAlignment);
+		isOutOfMemory = isOutOfMemory || (buffers.outputSamples[j] == NULL);
+	}
+
+	if (isOutOfMemory)
+	{
+		fprintf(stderr, "Error: Out of memory for %zu samples.\n", maximumSize);
+		destroyRunArena();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	Inputs and outputs for the benchmarks that do not generate their own.
+	 */
+	benchmarkSampling(&buffers, maximumSize);
+	benchmarkBlockKernel(&buffers, maximumSize);
+
+	if (arguments.isOutputJSONMode)
+	{
+		printf("{\"repetitions\": %d, \"warmupRepetitions\": %d, \"results\": [", repetitions, warmupRepetitions);
+	}
+	else
+	{
+		printf("%-20s %10s %16s %14s %16s %16s %16s\n",
+			"Benchmark", "Samples", "Median ns/sample", "MAD ns/sample", "95% CI low", "95% CI high", "Samples/s");
+	}
+
+	/*
+	 *	The benchmarks, then the thread-count sweep of parallel Monte Carlo
+	 *	(sampling and kernel) and of the data.out writer.
+	 */
+	cases = (MicrobenchmarkCase *) checkedMalloc((numberOfBenchmarks + 2 * numberOfThreadCounts) * numberOfSizes * sizeof(MicrobenchmarkCase), __FILE__, __LINE__);
+	order = (size_t *) checkedMalloc((numberOfBenchmarks + 2 * numberOfThreadCounts) * numberOfSizes * sizeof(size_t), __FILE__, __LINE__);
+
+	for (size_t b = 0; b < numberOfBenchmarks; b++)
+	{
+		for (size_t s = 0; s < numberOfSizes; s++)
+		{
+			cases[numberOfCases] = (MicrobenchmarkCase){.function = kMicrobenchmarks[b].function, .numberOfThreads = 1, .numberOfSamples = sizes[s]};
+			snprintf(cases[numberOfCases].name, sizeof(cases[numberOfCases].name), "%s", kMicrobenchmarks[b].name);
+			numberOfCases++;
+		}
+	}
+
+	for (size_t t = 0; t < numberOfThreadCounts; t++)
+	{
+		for (size_t s = 0; s < numberOfSizes; s++)
+		{
+			cases[numberOfCases] = (MicrobenchmarkCase){.function = benchmarkParallelMonteCarlo, .numberOfThreads = threadCounts[t], .numberOfSamples = sizes[s]};
+			snprintf(cases[numberOfCases].name, sizeof(cases[numberOfCases].name), "parallel-%zut", threadCounts[t]);
+			numberOfCases++;
+		}
+
+		for (size_t s = 0; s < numberOfSizes; s++)
+		{
+			cases[numberOfCases] = (MicrobenchmarkCase){.function = benchmarkDataDotOutWriter, .numberOfThreads = threadCounts[t], .numberOfSamples = sizes[s]};
+			snprintf(cases[numberOfCases].name, sizeof(cases[numberOfCases].name), "writer-data-out-%zut", threadCounts[t]);
+			numberOfCases++;
+		}
+	}
+
+	for (size_t c = 0; c < numberOfCases; c++)
+	{
+		cases[c].nanosecondsPerSample = (double *) checkedMalloc((size_t)repetitions * sizeof(double), __FILE__, __LINE__);
+		order[c] = c;
+
+		for (int r = 0; r < warmupRepetitions; r++)
+		{
+			runMicrobenchmarkCase(&cases[c], &buffers);
+		}
+	}
+
+	/*
+	 *	Every round runs every case once, in a new random order, so that
+	 *	drifts of the speed of the machine (frequency scaling, other tenants)
+	 *	do not line up with the consecutive repetitions of one case.
+	 */
+	srand((unsigned int)getWallClockNanoseconds());
+
+	for (int r = 0; r < repetitions; r++)
+	{
+		for (size_t c = numberOfCases - 1; c > 0; c--)
+		{
+			size_t	k = (size_t)rand() % (c + 1);
+			size_t	swap = order[c];
+
+			order[c] = order[k];
+			order[k] = swap;
+		}
+
+		for (size_t c = 0; c < numberOfCases; c++)
+		{
+			cases[order[c]].nanosecondsPerSample[r] = runMicrobenchmarkCase(&cases[order[c]], &buffers);
+		}
+	}
+
+	for (size_t c = 0; c < numberOfCases; c++)
+	{
+		printMicrobenchmarkCase(&cases[c], repetitions, arguments.isOutputJSONMode, &isFirstResult);
+		free(cases[c].nanosecondsPerSample);
+	}
+
+	free(order);
+	free(cases);
+
+	/*
+	 *	On Linux, `ru_maxrss` is in kilobytes.
+	 */
+	getrusage(RUSAGE_SELF, &resourceUsage);
+
+	if (arguments.isOutputJSONMode)
+	{
+		printf("], \"peakResidentSetSizeKilobytes\": %ld}\n", resourceUsage.ru_maxrss);
+	}
+	else
+	{
+		printf("\nPeak resident set size: %ld kB\n", resourceUsage.ru_maxrss);
+	}
+
+	destroyRunArena();
+
+	return kCommonConstantReturnTypeSuccess;
+}
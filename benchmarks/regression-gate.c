@@ -0,0 +1,831 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+/*
+ *	Performance regression gate: compares microbenchmark runs (JSON output
+ *	of `microbenchmark -j`, one file per process) against stored baseline
+ *	runs. The repetitions within one process share its warmup, memory layout
+ *	and frequency state, so they are not independent samples; the unit of
+ *	comparison is therefore the median time per sample of each process run.
+ *	For each benchmark and number of samples present in both sets of runs, a
+ *	one-sided Mann-Whitney U test on the run medians decides whether the new
+ *	runs are slower than the baseline beyond noise; it is flagged as a
+ *	regression if they are, and if the median time per sample (equivalently,
+ *	the median throughput) is also worse by more than a minimum relative
+ *	change that is set above the run-to-run noise. There must be enough runs
+ *	on each side for the test to reach its significance level at all (five
+ *	each, at the default level). The peak resident set size is compared against a relative tolerance. The
+ *	exit status is nonzero if there is any regression.
+ */
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+
+typedef enum
+{
+	kRegressionGateMaximumNumberOfResults				= 256,
+	kRegressionGateMaximumNumberOfRepetitions			= 1024,
+	kRegressionGateMaximumNameLength				= 64,
+	kRegressionGateMaximumNumberOfRuns				= 64,
+	kRegressionGateMaximumPathsLength				= 4096,
+} RegressionGateConstant;
+
+/*
+ *	Separate runs of the same build on the same machine differ by up to 13% in
+ *	the median time per sample of a benchmark, so the default minimum slowdown
+ *	is well above that.
+ */
+#define kRegressionGateDefaultSignificanceLevel				(0.01)
+#define kRegressionGateDefaultMinimumRelativeSlowdown			(0.25)
+#define kRegressionGateDefaultPeakResidentSetSizeTolerance		(0.10)
+
+typedef struct
+{
+	char	benchmark[kRegressionGateMaximumNameLength];
+	size_t	numberOfSamples;
+	size_t	numberOfRepetitions;
+	double	nanosecondsPerSample[kRegressionGateMaximumNumberOfRepetitions];
+} BenchmarkResult;
+
+typedef struct
+{
+	size_t			numberOfResults;
+	BenchmarkResult *	results;
+	double			peakResidentSetSizeKilobytes;
+} BenchmarkRun;
+
+/*
+ *	The median time per sample of one benchmark and number of samples in
+ *	each of a set of runs.
+ */
+typedef struct
+{
+	char	benchmark[kRegressionGateMaximumNameLength];
+	size_t	numberOfSamples;
+	size_t	numberOfRuns;
+	double	medianNanosecondsPerSample[kRegressionGateMaximumNumberOfRuns];
+} BenchmarkSeries;
+
+typedef struct
+{
+	size_t			numberOfRuns;
+	size_t			numberOfSeries;
+	BenchmarkSeries *	series;
+	double			peakResidentSetSizeKilobytes[kRegressionGateMaximumNumberOfRuns];
+} BenchmarkRunSet;
+
+/*
+ *	Minimal reader for the JSON that `microbenchmark -j` prints. Unknown
+ *	keys are skipped, so older and newer outputs can be compared.
+ */
+typedef struct
+{
+	const char *	text;
+	size_t		position;
+} JSONCursor;
+
+static void
+skipJSONWhitespace(JSONCursor *  cursor)
+{
+	while (isspace((unsigned char)cursor->text[cursor->position]))
+	{
+		cursor->position++;
+	}
+
+	return;
+}
+
+static bool
+consumeJSONCharacter(JSONCursor *  cursor, char character)
+{
+	skipJSONWhitespace(cursor);
+
+	if (cursor->text[cursor->position] != character)
+	{
+		return false;
+	}
+
+	cursor->position++;
+
+	return true;
+}
+
+static bool
+parseJSONString(JSONCursor *  cursor, char *  buffer, size_t bufferSize)
+{
+	size_t	length = 0;
+
+	if (!consumeJSONCharacter(cursor, '"'))
+	{
+		return false;
+	}
+
+	while ((cursor->text[cursor->position] != '"') && (cursor->text[cursor->position] != '\0'))
+	{
+		if (cursor->text[cursor->position] == '\\')
+		{
+			cursor->position++;
+		}
+
+		if ((buffer != NULL) && (length + 1 < bufferSize))
+		{
+			buffer[length++] = cursor->text[cursor->position];
+		}
+
+		cursor->position++;
+	}
+
+	if (buffer != NULL)
+	{
+		buffer[length] = '\0';
+	}
+
+	return consumeJSONCharacter(cursor, '"');
+}
+
+static bool
+parseJSONNumber(JSONCursor *  cursor, double *  value)
+{
+	char *	end;
+
+	skipJSONWhitespace(cursor);
+	*value = strtod(&cursor->text[cursor->position], &end);
+
+	if (end == &cursor->text[cursor->position])
+	{
+		return false;
+	}
+
+	cursor->position = (size_t)(end - cursor->text);
+
+	return true;
+}
+
+static bool
+skipJSONValue(JSONCursor *  cursor)
+{
+	double	number;
+
+	skipJSONWhitespace(cursor);
+
+	switch (cursor->text[cursor->position])
+	{
+		case '"':
+		{
+			return parseJSONString(cursor, NULL, 0);
+		}
+
+		case '{':
+		case '[':
+		{
+			char	closing = (cursor->text[cursor->position] == '{') ? '}' : ']';
+
+			cursor->position++;
+
+			if (consumeJSONCharacter(cursor, closing))
+			{
+				return true;
+			}
+
+			do
+			{
+				if ((closing == '}') && (!parseJSONString(cursor, NULL, 0) || !consumeJSONCharacter(cursor, ':')))
+				{
+					return false;
+				}
+
+				if (!skipJSONValue(cursor))
+				{
+					return false;
+				}
+			} while (consumeJSONCharacter(cursor, ','));
+
+			return consumeJSONCharacter(cursor, closing);
+		}
+
+		case 't':
+		case 'f':
+		case 'n':
+		{
+			while (isalpha((unsigned char)cursor->text[cursor->position]))
+			{
+				cursor->position++;
+			}
+
+			return true;
+		}
+
+		default:
+		{
+			return parseJSONNumber(cursor, &number);
+		}
+	}
+}
+
+static bool
+parseBenchmarkResult(JSONCursor *  cursor, BenchmarkResult *  result)
+{
+	char	key[kRegressionGateMaximumNameLength];
+	double	number;
+
+	result->numberOfRepetitions = 0;
+
+	if (!consumeJSONCharacter(cursor, '{'))
+	{
+		return false;
+	}
+
+	do
+	{
+		if (!parseJSONString(cursor, key, sizeof(key)) || !consumeJSONCharacter(cursor, ':'))
+		{
+			return false;
+		}
+
+		if (strcmp(key, "benchmark") == 0)
+		{
+			if (!parseJSONString(cursor, result->benchmark, sizeof(result->benchmark)))
+			{
+				return false;
+			}
+		}
+		else if (strcmp(key, "numberOfSamples") == 0)
+		{
+			if (!parseJSONNumber(cursor, &number))
+			{
+				return false;
+			}
+
+			result->numberOfSamples = (size_t)number;
+		}
+		else if (strcmp(key, "nanosecondsPerSample") == 0)
+		{
+			if (!consumeJSONCharacter(cursor, '['))
+			{
+				return false;
+			}
+
+			do
+			{
+				if ((result->numberOfRepetitions == kRegressionGateMaximumNumberOfRepetitions) ||
+					!parseJSONNumber(cursor, &result->nanosecondsPerSample[result->numberOfRepetitions]))
+				{
+					return false;
+				}
+
+				result->numberOfRepetitions++;
+			} while (consumeJSONCharacter(cursor, ','));
+
+			if (!consumeJSONCharacter(cursor, ']'))
+			{
+				return false;
+			}
+		}
+		else if (!skipJSONValue(cursor))
+		{
+			return false;
+		}
+	} while (consumeJSONCharacter(cursor, ','));
+
+	return consumeJSONCharacter(cursor, '}');
+}
+
+static bool
+parseBenchmarkRun(JSONCursor *  cursor, BenchmarkRun *  run)
+{
+	char	key[kRegressionGateMaximumNameLength];
+
+	run->numberOfResults = 0;
+	run->peakResidentSetSizeKilobytes = NAN;
+
+	if (!consumeJSONCharacter(cursor, '{'))
+	{
+		return false;
+	}
+
+	do
+	{
+		if (!parseJSONString(cursor, key, sizeof(key)) || !consumeJSONCharacter(cursor, ':'))
+		{
+			return false;
+		}
+
+		if (strcmp(key, "results") == 0)
+		{
+			if (!consumeJSONCharacter(cursor, '['))
+			{
+				return false;
+			}
+
+			if (consumeJSONCharacter(cursor, ']'))
+			{
+				continue;
+			}
+
+			do
+			{
+				if ((run->numberOfResults == kRegressionGateMaximumNumberOfResults) ||
+					!parseBenchmarkResult(cursor, &run->results[run->numberOfResults]))
+				{
+					return false;
+				}
+
+				run->numberOfResults++;
+			} while (consumeJSONCharacter(cursor, ','));
+
+			if (!consumeJSONCharacter(cursor, ']'))
+			{
+				return false;
+			}
+		}
+		else if (strcmp(key, "peakResidentSetSizeKilobytes") == 0)
+		{
+			if (!parseJSONNumber(cursor, &run->peakResidentSetSizeKilobytes))
+			{
+				return false;
+			}
+		}
+		else if (!skipJSONValue(cursor))
+		{
+			return false;
+		}
+	} while (consumeJSONCharacter(cursor, ','));
+
+	return consumeJSONCharacter(cursor, '}');
+}
+
+static CommonConstantReturnType
+loadBenchmarkRun(const char *  path, BenchmarkRun *  run)
+{
+	FILE *		fp = fopen(path, "r");
+	char *		text;
+	long		length;
+	JSONCursor	cursor;
+	bool		isParsed;
+
+	if (fp == NULL)
+	{
+		fprintf(stderr, "Error: Could not open \"%s\".\n", path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	length = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	text = (char *) checkedMalloc((size_t)length + 1, __FILE__, __LINE__);
+	text[fread(text, 1, (size_t)length, fp)] = '\0';
+	fclose(fp);
+
+	cursor = (JSONCursor) { .text = text, .position = 0 };
+	run->results = (BenchmarkResult *) checkedMalloc(kRegressionGateMaximumNumberOfResults * sizeof(BenchmarkResult), __FILE__, __LINE__);
+	isParsed = parseBenchmarkRun(&cursor, run);
+	free(text);
+
+	if (!isParsed)
+	{
+		fprintf(stderr, "Error: \"%s\" is not the JSON output of the microbenchmark (-j option), or is too large.\n", path);
+		free(run->results);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+static int
+compareDoubles(const void *  a, const void *  b)
+{
+	double	x = *(const double *)a;
+	double	y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+static double
+calculateMedian(const double *  values, size_t numberOfValues)
+{
+	double	sortedValues[numberOfValues];
+
+	memcpy(sortedValues, values, numberOfValues * sizeof(double));
+	qsort(sortedValues, numberOfValues, sizeof(double), compareDoubles);
+
+	return (numberOfValues % 2 == 1) ?
+			sortedValues[numberOfValues / 2] :
+			(sortedValues[numberOfValues / 2 - 1] + sortedValues[numberOfValues / 2]) / 2;
+}
+
+/*
+ *	Loads the runs of a comma-separated list of paths, reducing each
+ *	benchmark and number of samples of each run to its median.
+ */
+static CommonConstantReturnType
+loadBenchmarkRunSet(const char *  paths, BenchmarkRunSet *  runSet)
+{
+	char	buffer[kRegressionGateMaximumPathsLength];
+
+	runSet->numberOfRuns = 0;
+	runSet->numberOfSeries = 0;
+	runSet->series = (BenchmarkSeries *) checkedMalloc(kRegressionGateMaximumNumberOfResults * sizeof(BenchmarkSeries), __FILE__, __LINE__);
+	snprintf(buffer, sizeof(buffer), "%s", paths);
+
+	for (char *  path = strtok(buffer, ","); path != NULL; path = strtok(NULL, ","))
+	{
+		BenchmarkRun	run;
+
+		if (runSet->numberOfRuns == kRegressionGateMaximumNumberOfRuns)
+		{
+			fprintf(stderr, "Error: More than %d runs in \"%s\".\n", kRegressionGateMaximumNumberOfRuns, paths);
+			free(runSet->series);
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (loadBenchmarkRun(path, &run) != kCommonConstantReturnTypeSuccess)
+		{
+			free(runSet->series);
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		for (size_t i = 0; i < run.numberOfResults; i++)
+		{
+			BenchmarkSeries *	series = NULL;
+
+			if (run.results[i].numberOfRepetitions == 0)
+			{
+				continue;
+			}
+
+			for (size_t k = 0; k < runSet->numberOfSeries; k++)
+			{
+				if ((strcmp(runSet->series[k].benchmark, run.results[i].benchmark) == 0) &&
+					(runSet->series[k].numberOfSamples == run.results[i].numberOfSamples))
+				{
+					series = &runSet->series[k];
+				}
+			}
+
+			if ((series == NULL) && (runSet->numberOfSeries < kRegressionGateMaximumNumberOfResults))
+			{
+				series = &runSet->series[runSet->numberOfSeries++];
+				memcpy(series->benchmark, run.results[i].benchmark, sizeof(series->benchmark));
+				series->numberOfSamples = run.results[i].numberOfSamples;
+				series->numberOfRuns = 0;
+			}
+
+			if (series != NULL)
+			{
+				series->medianNanosecondsPerSample[series->numberOfRuns++] =
+					calculateMedian(run.results[i].nanosecondsPerSample, run.results[i].numberOfRepetitions);
+			}
+		}
+
+		runSet->peakResidentSetSizeKilobytes[runSet->numberOfRuns++] = run.peakResidentSetSizeKilobytes;
+		free(run.results);
+	}
+
+	if (runSet->numberOfRuns == 0)
+	{
+		fprintf(stderr, "Error: No runs in \"%s\".\n", paths);
+		free(runSet->series);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	One-sided p-value of the Mann-Whitney U test of the hypothesis that
+ *	`current` tends to be greater than `baseline`, using the normal
+ *	approximation with tie and continuity corrections.
+ */
+static double
+calculateMannWhitneyPValue(const BenchmarkSeries *  baseline, const BenchmarkSeries *  current)
+{
+	size_t	n1 = current->numberOfRuns;
+	size_t	n2 = baseline->numberOfRuns;
+	size_t	n = n1 + n2;
+	double	pooled[n];
+	double	u = 0.0;
+	double	tieCorrection = 0.0;
+	double	standardDeviation;
+
+	for (size_t i = 0; i < n1; i++)
+	{
+		for (size_t j = 0; j < n2; j++)
+		{
+			u += (current->medianNanosecondsPerSample[i] > baseline->medianNanosecondsPerSample[j]) ? 1.0 :
+				(current->medianNanosecondsPerSample[i] == baseline->medianNanosecondsPerSample[j]) ? 0.5 : 0.0;
+		}
+	}
+
+	memcpy(pooled, current->medianNanosecondsPerSample, n1 * sizeof(double));
+	memcpy(&pooled[n1], baseline->medianNanosecondsPerSample, n2 * sizeof(double));
+	qsort(pooled, n, sizeof(double), compareDoubles);
+
+	for (size_t i = 0; i < n; )
+	{
+		size_t	tieLength = 1;
+
+		while ((i + tieLength < n) && (pooled[i + tieLength] == pooled[i]))
+		{
+			tieLength++;
+		}
+
+		tieCorrection += (double)(tieLength * tieLength * tieLength - tieLength);
+		i += tieLength;
+	}
+
+	standardDeviation = sqrt((double)(n1 * n2) / 12.0 * ((double)(n + 1) - tieCorrection / (double)(n * (n - 1))));
+
+	if (standardDeviation == 0.0)
+	{
+		return (u > (double)(n1 * n2) / 2.0) ? 0.0 : 1.0;
+	}
+
+	return 0.5 * erfc((u - (double)(n1 * n2) / 2.0 - 0.5) / standardDeviation / sqrt(2.0));
+}
+
+/*
+ *	Smallest p-value of `calculateMannWhitneyPValue()` for the given numbers
+ *	of runs, when every current run is slower than every baseline run.
+ */
+static double
+calculateSmallestMannWhitneyPValue(size_t numberOfBaselineRuns, size_t numberOfCurrentRuns)
+{
+	double	n1n2 = (double)(numberOfBaselineRuns * numberOfCurrentRuns);
+	double	standardDeviation = sqrt(n1n2 / 12.0 * (double)(numberOfBaselineRuns + numberOfCurrentRuns + 1));
+
+	return 0.5 * erfc((n1n2 / 2.0 - 0.5) / standardDeviation / sqrt(2.0));
+}
+
+static void
+printRegressionGateUsage(void)
+{
+	fprintf(stderr, "Performance regression gate for the FlussoFLS110 sensor conversion routines microbenchmarks\n");
+	fprintf(stderr, "\n");
+	fprintf(
+		stderr,
+		"\t[-B, --baseline <Comma-separated paths to baseline microbenchmark JSON, one per run : str>] (Required.)\n"
+		"\t[-C, --current <Comma-separated paths to current microbenchmark JSON, one per run : str>] (Required.)\n"
+		"\t[-p, --significance <Significance level of the Mann-Whitney U test : double (Default: %.2lf)>]\n"
+		"\t[-d, --minimum-slowdown <Minimum relative increase of the median ns/sample : double (Default: %.2lf)>]\n"
+		"\t[-m, --rss-tolerance <Maximum relative increase of the peak resident set size : double (Default: %.2lf)>]\n"
+		"\t[-j, --json] (Print the comparison in JSON format.)\n"
+		"\t[-h, --help] (Display this help message.)\n",
+		kRegressionGateDefaultSignificanceLevel,
+		kRegressionGateDefaultMinimumRelativeSlowdown,
+		kRegressionGateDefaultPeakResidentSetSizeTolerance);
+	fprintf(stderr, "\n");
+
+	return;
+}
+
+int
+main(int argc, char *  argv[])
+{
+	CommonCommandLineArguments	arguments = {0};
+	char *				baselinePath = NULL;
+	char *				currentPath = NULL;
+	char *				significanceArg = NULL;
+	char *				minimumSlowdownArg = NULL;
+	char *				rssToleranceArg = NULL;
+	DemoOption			options[] =
+					{
+						{ .opt = "B", .optAlternative = "baseline", .hasArg = true, .foundArg = &baselinePath, .foundOpt = NULL },
+						{ .opt = "C", .optAlternative = "current", .hasArg = true, .foundArg = &currentPath, .foundOpt = NULL },
+						{ .opt = "p", .optAlternative = "significance", .hasArg = true, .foundArg = &significanceArg, .foundOpt = NULL },
+						{ .opt = "d", .optAlternative = "minimum-slowdown", .hasArg = true, .foundArg = &minimumSlowdownArg, .foundOpt = NULL },
+						{ .opt = "m", .optAlternative = "rss-tolerance", .hasArg = true, .foundArg = &rssToleranceArg, .foundOpt = NULL },
+						{0},
+					};
+	double				significanceLevel = kRegressionGateDefaultSignificanceLevel;
+	double				minimumRelativeSlowdown = kRegressionGateDefaultMinimumRelativeSlowdown;
+	double				rssTolerance = kRegressionGateDefaultPeakResidentSetSizeTolerance;
+	BenchmarkRunSet			baseline;
+	BenchmarkRunSet			current;
+	size_t				numberOfRegressions = 0;
+	bool				isFirstResult = true;
+	bool				isRSSRegression;
+	double				rssRelativeChange;
+	double				baselinePeakResidentSetSizeKilobytes;
+	double				currentPeakResidentSetSizeKilobytes;
+
+	if (parseArgs(argc, argv, &arguments, options) != 0)
+	{
+		printRegressionGateUsage();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (arguments.isHelpEnabled)
+	{
+		printRegressionGateUsage();
+
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+	if ((baselinePath == NULL) || (currentPath == NULL) ||
+		((significanceArg != NULL) && ((parseDoubleChecked(significanceArg, &significanceLevel) != kCommonConstantReturnTypeSuccess) || !(significanceLevel > 0.0) || !(significanceLevel < 1.0))) ||
+		((minimumSlowdownArg != NULL) && ((parseDoubleChecked(minimumSlowdownArg, &minimumRelativeSlowdown) != kCommonConstantReturnTypeSuccess) || !(minimumRelativeSlowdown >= 0.0))) ||
+		((rssToleranceArg != NULL) && ((parseDoubleChecked(rssToleranceArg, &rssTolerance) != kCommonConstantReturnTypeSuccess) || !(rssTolerance >= 0.0))))
+	{
+		fprintf(stderr, "Error: Invalid baseline, current, significance, minimum slowdown or RSS tolerance arguments.\n");
+		printRegressionGateUsage();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (loadBenchmarkRunSet(baselinePath, &baseline) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (loadBenchmarkRunSet(currentPath, &current) != kCommonConstantReturnTypeSuccess)
+	{
+		free(baseline.series);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (calculateSmallestMannWhitneyPValue(baseline.numberOfRuns, current.numberOfRuns) >= significanceLevel)
+	{
+		fprintf(
+			stderr,
+			"Error: With %zu baseline and %zu current runs, the rank test cannot reach a significance level of %.4lf. "
+			"Pass the microbenchmark JSON of more separate runs on each side.\n",
+			baseline.numberOfRuns,
+			current.numberOfRuns,
+			significanceLevel);
+		free(baseline.series);
+		free(current.series);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (arguments.isOutputJSONMode)
+	{
+		printf(
+			"{\"significanceLevel\": %.4lf, \"minimumRelativeSlowdown\": %.4lf, \"numberOfBaselineRuns\": %zu, \"numberOfCurrentRuns\": %zu, \"results\": [",
+			significanceLevel,
+			minimumRelativeSlowdown,
+			baseline.numberOfRuns,
+			current.numberOfRuns);
+	}
+	else
+	{
+		printf("%-16s %10s %16s %16s %12s %16s %16s %10s %s\n",
+			"Benchmark", "Samples", "Base ns/sample", "Curr ns/sample", "Change", "Base samples/s", "Curr samples/s", "p-value", "Verdict");
+	}
+
+	for (size_t i = 0; i < current.numberOfSeries; i++)
+	{
+		const BenchmarkSeries *	currentResult = &current.series[i];
+		const BenchmarkSeries *	baselineResult = NULL;
+		double			baselineMedian;
+		double			currentMedian;
+		double			relativeChange;
+		double			pValue;
+		const char *		verdict;
+
+		for (size_t j = 0; j < baseline.numberOfSeries; j++)
+		{
+			if ((strcmp(baseline.series[j].benchmark, currentResult->benchmark) == 0) &&
+				(baseline.series[j].numberOfSamples == currentResult->numberOfSamples))
+			{
+				baselineResult = &baseline.series[j];
+			}
+		}
+
+		if (baselineResult == NULL)
+		{
+			fprintf(
+				stderr,
+				"Warning: No baseline repetitions for benchmark \"%s\" with %zu samples. Skipping it.\n",
+				currentResult->benchmark,
+				currentResult->numberOfSamples);
+
+			continue;
+		}
+
+		/*
+		 *	Samples per second is the reciprocal of nanoseconds per sample, so
+		 *	the rank test on one is the rank test on the other. A benchmark
+		 *	that is missing from some runs may have too few runs for the test,
+		 *	and is then never a regression.
+		 */
+		baselineMedian = calculateMedian(baselineResult->medianNanosecondsPerSample, baselineResult->numberOfRuns);
+		currentMedian = calculateMedian(currentResult->medianNanosecondsPerSample, currentResult->numberOfRuns);
+		relativeChange = currentMedian / baselineMedian - 1.0;
+		pValue = calculateMannWhitneyPValue(baselineResult, currentResult);
+
+		if ((pValue < significanceLevel) && (relativeChange > minimumRelativeSlowdown))
+		{
+			verdict = "regression";
+			numberOfRegressions++;
+		}
+		else if ((1.0 - pValue < significanceLevel) && (-relativeChange > minimumRelativeSlowdown))
+		{
+			verdict = "improvement";
+		}
+		else
+		{
+			verdict = "unchanged";
+		}
+
+		if (arguments.isOutputJSONMode)
+		{
+			printf(
+				"%s{\"benchmark\": \"%s\", \"numberOfSamples\": %zu, \"baselineMedianNanosecondsPerSample\": %.3lf, "
+				"\"currentMedianNanosecondsPerSample\": %.3lf, \"relativeChange\": %.4lf, \"baselineSamplesPerSecond\": %.1lf, "
+				"\"currentSamplesPerSecond\": %.1lf, \"pValue\": %.4le, \"verdict\": \"%s\"}",
+				isFirstResult ? "" : ", ",
+				currentResult->benchmark,
+				currentResult->numberOfSamples,
+				baselineMedian,
+				currentMedian,
+				relativeChange,
+				1e9 / baselineMedian,
+				1e9 / currentMedian,
+				pValue,
+				verdict);
+			isFirstResult = false;
+		}
+		else
+		{
+			printf("%-16s %10zu %16.3lf %16.3lf %+11.1lf%% %16.1lf %16.1lf %10.2le %s\n",
+				currentResult->benchmark,
+				currentResult->numberOfSamples,
+				baselineMedian,
+				currentMedian,
+				100.0 * relativeChange,
+				1e9 / baselineMedian,
+				1e9 / currentMedian,
+				pValue,
+				verdict);
+		}
+	}
+
+	/*
+	 *	Peak resident set size: one number per run, so compare the median of
+	 *	the runs against a relative tolerance. A missing value (older
+	 *	baseline) never fails.
+	 */
+	baselinePeakResidentSetSizeKilobytes = calculateMedian(baseline.peakResidentSetSizeKilobytes, baseline.numberOfRuns);
+	currentPeakResidentSetSizeKilobytes = calculateMedian(current.peakResidentSetSizeKilobytes, current.numberOfRuns);
+	rssRelativeChange = currentPeakResidentSetSizeKilobytes / baselinePeakResidentSetSizeKilobytes - 1.0;
+	isRSSRegression = (rssRelativeChange > rssTolerance);
+	numberOfRegressions += isRSSRegression ? 1 : 0;
+
+	if (arguments.isOutputJSONMode)
+	{
+		printf(
+			"], \"baselinePeakResidentSetSizeKilobytes\": %.0lf, \"currentPeakResidentSetSizeKilobytes\": %.0lf, "
+			"\"peakResidentSetSizeVerdict\": \"%s\", \"numberOfRegressions\": %zu}\n",
+			isnan(baselinePeakResidentSetSizeKilobytes) ? -1.0 : baselinePeakResidentSetSizeKilobytes,
+			isnan(currentPeakResidentSetSizeKilobytes) ? -1.0 : currentPeakResidentSetSizeKilobytes,
+			isRSSRegression ? "regression" : "unchanged",
+			numberOfRegressions);
+	}
+	else
+	{
+		printf("\nPeak resident set size: baseline %.0lf kB, current %.0lf kB (%+.1lf%%): %s\n",
+			baselinePeakResidentSetSizeKilobytes,
+			currentPeakResidentSetSizeKilobytes,
+			100.0 * rssRelativeChange,
+			isRSSRegression ? "regression" : "unchanged");
+		printf("%zu regression(s).\n", numberOfRegressions);
+	}
+
+	free(baseline.series);
+	free(current.series);
+
+	return (numberOfRegressions == 0) ? kCommonConstantReturnTypeSuccess : kCommonConstantReturnTypeError;
+}
@@ -0,0 +1,292 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "common-random-numbers.h"
+#include "input-distributions.h"
+#include "mergeable-statistics.h"
+#include "run-arena.h"
+#include "samplers.h"
+#include "sensor-calibration.h"
+#include "timing.h"
+
+typedef struct
+{
+	size_t				numberOfScenarios;
+	char *				assignments[kCommonRandomNumbersSweepMaximumNumberOfScenarios];
+	InputDistributionSpecification	specifications[kCommonRandomNumbersSweepMaximumNumberOfScenarios][kInputDistributionIndexMax];
+} CommonRandomNumbersScenarios;
+
+/*
+ *	Reads the input distributions of every scenario of the file, each on top
+ *	of the current input distributions, which it leaves unchanged.
+ */
+static CommonConstantReturnType
+loadCommonRandomNumbersScenarios(const char *  path, CommonRandomNumbersScenarios *  scenarios)
+{
+	FILE *				fp = fopen(path, "r");
+	char				line[kInputDistributionAssignmentsMaximumLineBytes];
+	bool				isLineTooLong;
+	InputDistributionSpecification	baseSpecifications[kInputDistributionIndexMax];
+	CommonConstantReturnType	result = kCommonConstantReturnTypeSuccess;
+
+	if (fp == NULL)
+	{
+		fprintf(stderr, "Error: Could not open the scenario file \"%s\".\n", path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	getInputDistributionSpecifications(baseSpecifications);
+	scenarios->numberOfScenarios = 0;
+
+	while ((result == kCommonConstantReturnTypeSuccess) && readInputDistributionAssignmentsLine(fp, line, sizeof(line), &isLineTooLong))
+	{
+		size_t	s = scenarios->numberOfScenarios;
+
+		if (s == kCommonRandomNumbersSweepMaximumNumberOfScenarios)
+		{
+			fprintf(stderr, "Error: \"%s\" has more than %d scenarios.\n", path, kCommonRandomNumbersSweepMaximumNumberOfScenarios);
+			result = kCommonConstantReturnTypeError;
+
+			break;
+		}
+
+		scenarios->assignments[s] = (char *) allocateFromRunArena(strlen(line) + 1, 1);
+
+		if (scenarios->assignments[s] == NULL)
+		{
+			fprintf(stderr, "Error: Out of memory for the scenarios of \"%s\".\n", path);
+			result = kCommonConstantReturnTypeError;
+
+			break;
+		}
+
+		strcpy(scenarios->assignments[s], line);
+
+		setInputDistributionSpecifications(baseSpecifications);
+		result = parseInputDistributionAssignments(line);
+		getInputDistributionSpecifications(scenarios->specifications[s]);
+		scenarios->numberOfScenarios++;
+	}
+
+	if (isLineTooLong)
+	{
+		fprintf(stderr, "Error: A line of \"%s\" is longer than %d bytes.\n", path, kInputDistributionAssignmentsMaximumLineBytes);
+		result = kCommonConstantReturnTypeError;
+	}
+
+	if ((result == kCommonConstantReturnTypeSuccess) && (scenarios->numberOfScenarios == 0))
+	{
+		fprintf(stderr, "Error: \"%s\" has no scenarios.\n", path);
+		result = kCommonConstantReturnTypeError;
+	}
+
+	fclose(fp);
+	setInputDistributionSpecifications(baseSpecifications);
+
+	return result;
+}
+
+CommonConstantReturnType
+runCommonRandomNumbersSweep(
+	const CommandLineArguments *	arguments,
+	const char **			outputVariableDescriptions,
+	const char **			unitsOfMeasurement)
+{
+	RunArenaMark			arenaMark = getRunArenaMark();
+	CommonRandomNumbersScenarios *	scenarios;
+	size_t				outputSelect = arguments->common.outputSelect;
+	size_t				numberOfSamples = arguments->common.numberOfMonteCarloIterations;
+	size_t				blockCapacity = (numberOfSamples < kMonteCarloBlockSize) ? numberOfSamples : kMonteCarloBlockSize;
+	SensorOutputBlockKernel		sensorOutputBlockKernel = getSensorOutputBlockKernel(outputSelect);
+	double				(*uniformBlock)[kInputDistributionIndexMax];
+	double				(*inputDistributionBlock)[kInputDistributionIndexMax];
+	double *			scenarioOutputBlock;
+	MomentAccumulator *		outputMoments;
+	MomentAccumulator *		differenceMoments;
+	PhaseTimer			phaseTimer;
+	uint64_t			cpuTimeUsedInMicroSeconds;
+
+	scenarios = (CommonRandomNumbersScenarios *) allocateFromRunArena(sizeof(*scenarios), kRunArenaDefaultAlignment);
+
+	if (scenarios == NULL)
+	{
+		fprintf(stderr, "Error: Out of memory for the scenarios.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (loadCommonRandomNumbersScenarios(arguments->commonRandomNumbersScenarioPath, scenarios) != kCommonConstantReturnTypeSuccess)
+	{
+		releaseRunArenaToMark(arenaMark);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	uniformBlock = allocateFromRunArena(blockCapacity * sizeof(*uniformBlock), kRunArenaDefaultAlignment);
+	inputDistributionBlock = allocateFromRunArena(blockCapacity * sizeof(*inputDistributionBlock), kRunArenaDefaultAlignment);
+	scenarioOutputBlock = (double *) allocateFromRunArena(
+						scenarios->numberOfScenarios * blockCapacity * sizeof(double),
+						kRunArenaDefaultAlignment);
+	outputMoments = (MomentAccumulator *) allocateFromRunArena(
+						scenarios->numberOfScenarios * sizeof(MomentAccumulator),
+						kRunArenaDefaultAlignment);
+	differenceMoments = (MomentAccumulator *) allocateFromRunArena(
+						scenarios->numberOfScenarios * sizeof(MomentAccumulator),
+						kRunArenaDefaultAlignment);
+
+	if ((uniformBlock == NULL) || (inputDistributionBlock == NULL) || (scenarioOutputBlock == NULL) ||
+		(outputMoments == NULL) || (differenceMoments == NULL))
+	{
+		fprintf(stderr, "Error: Out of memory for the common random numbers sweep.\n");
+		releaseRunArenaToMark(arenaMark);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t s = 0; s < scenarios->numberOfScenarios; s++)
+	{
+		outputMoments[s] = (MomentAccumulator) {.minimum = INFINITY, .maximum = -INFINITY};
+		differenceMoments[s] = (MomentAccumulator) {.minimum = INFINITY, .maximum = -INFINITY};
+	}
+
+	startPhaseTimer(&phaseTimer);
+
+	for (size_t blockStart = 0; blockStart < numberOfSamples; blockStart += kMonteCarloBlockSize)
+	{
+		size_t	blockLength = ((numberOfSamples - blockStart) < kMonteCarloBlockSize) ? (numberOfSamples - blockStart) : kMonteCarloBlockSize;
+
+		sampleUnitUniformsCounterBased(kCounterBasedSamplerDefaultSeed, blockStart, uniformBlock, blockLength);
+		lapPhaseTimer(&phaseTimer, kTimingPhaseSampling);
+
+		/*
+		 *	Every scenario maps the same variates to its own distributions.
+		 */
+		for (size_t s = 0; s < scenarios->numberOfScenarios; s++)
+		{
+			double *	blockOutputSamples[kOutputDistributionIndexMax] = {NULL};
+
+			mapUnitUniformsToInputDistributions(
+				scenarios->specifications[s],
+				(const double (*)[kInputDistributionIndexMax])uniformBlock,
+				inputDistributionBlock,
+				blockLength);
+
+			lapPhaseTimer(&phaseTimer, kTimingPhaseSampling);
+
+			blockOutputSamples[outputSelect] = &scenarioOutputBlock[s * blockCapacity];
+			sensorOutputBlockKernel((const double (*)[kInputDistributionIndexMax])inputDistributionBlock, blockOutputSamples, blockLength);
+			lapPhaseTimer(&phaseTimer, kTimingPhaseKernel);
+		}
+
+		for (size_t s = 0; s < scenarios->numberOfScenarios; s++)
+		{
+			const double *	outputs = &scenarioOutputBlock[s * blockCapacity];
+
+			for (size_t i = 0; i < blockLength; i++)
+			{
+				updateMomentAccumulator(&outputMoments[s], outputs[i]);
+				updateMomentAccumulator(&differenceMoments[s], outputs[i] - scenarioOutputBlock[i]);
+			}
+		}
+
+		lapPhaseTimer(&phaseTimer, kTimingPhaseReduction);
+	}
+
+	cpuTimeUsedInMicroSeconds = getPhaseTimerComputationCpuNanoseconds(&phaseTimer) / 1000;
+
+	if (arguments->common.isBenchmarkingMode)
+	{
+		for (size_t s = 0; s < scenarios->numberOfScenarios; s++)
+		{
+			printf("%lf %" PRIu64 "\n", outputMoments[s].mean, cpuTimeUsedInMicroSeconds);
+		}
+	}
+	else
+	{
+		double	variance0;
+		double	unused;
+
+		getMomentAccumulatorStatistics(&outputMoments[0], &variance0, &unused, &unused);
+
+		printf(
+			"Common random numbers sweep of %s over %zu scenarios, with the same %zu samples of the inputs each:\n\n",
+			outputVariableDescriptions[outputSelect],
+			scenarios->numberOfScenarios,
+			numberOfSamples);
+
+		for (size_t s = 0; s < scenarios->numberOfScenarios; s++)
+		{
+			printf("\tScenario %zu: %s\n", s, scenarios->assignments[s]);
+		}
+
+		printf("\n\tScenario %20s %20s %20s %20s %20s\n", "Mean", "Standard deviation", "Difference from 0", "Standard error", "Variance reduction");
+
+		for (size_t s = 0; s < scenarios->numberOfScenarios; s++)
+		{
+			double	variance;
+			double	differenceVariance;
+
+			getMomentAccumulatorStatistics(&outputMoments[s], &variance, &unused, &unused);
+			getMomentAccumulatorStatistics(&differenceMoments[s], &differenceVariance, &unused, &unused);
+
+			if (s == 0)
+			{
+				printf("\t%8zu %20.6lf %20.6lf %20s %20s %20s\n", s, outputMoments[s].mean, sqrt(variance), "-", "-", "-");
+
+				continue;
+			}
+
+			/*
+			 *	The variance reduction is the variance of the difference of
+			 *	independent runs, (variance + variance0) / n, over that of the
+			 *	difference of the common random numbers runs.
+			 */
+			printf(
+				"\t%8zu %20.6lf %20.6lf %20.6lf %20.6le %20.1lf\n",
+				s,
+				outputMoments[s].mean,
+				sqrt(variance),
+				differenceMoments[s].mean,
+				sqrt(differenceVariance / (double)numberOfSamples),
+				(differenceVariance > 0.0) ? (variance + variance0) / differenceVariance : INFINITY);
+		}
+
+		printf("\n\tDifferences and their standard errors are in %s.\n", unitsOfMeasurement[outputSelect]);
+	}
+
+	lapPhaseTimer(&phaseTimer, kTimingPhaseOutput);
+
+	if (arguments->common.isTimingEnabled && !arguments->common.isBenchmarkingMode)
+	{
+		printPhaseTimings(&phaseTimer, numberOfSamples * scenarios->numberOfScenarios);
+	}
+
+	releaseRunArenaToMark(arenaMark);
+
+	return kCommonConstantReturnTypeSuccess;
+}
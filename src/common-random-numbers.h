@@ -0,0 +1,46 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "common.h"
+#include "utilities.h"
+#include "utilities-config.h"
+
+/**
+ *	@brief	Common random numbers sweep (-U option): evaluates the selected output for every
+ *		scenario of input distribution assignments of a file, on top of the current input
+ *		distributions, from one set of uniform variates per input that is mapped to the
+ *		distributions of each scenario. The scenarios are evaluated block by block in the same pass,
+ *		so the variates are drawn once, and the differences between scenarios are free of
+ *		the sampling noise that independent runs would add to them.
+ *
+ *	@param	arguments			: Pointer to the command-line arguments struct.
+ *	@param	outputVariableDescriptions	: The output variable descriptions.
+ *	@param	unitsOfMeasurement		: The units of measurement of the outputs.
+ *	@return					: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runCommonRandomNumbersSweep(
+					const CommandLineArguments *	arguments,
+					const char **			outputVariableDescriptions,
+					const char **			unitsOfMeasurement);
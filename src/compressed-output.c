@@ -0,0 +1,799 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <inttypes.h>
+#include <string.h>
+#include <sys/types.h>
+#include "compressed-output.h"
+#include "run-arena.h"
+#include "utilities.h"
+
+static const char	kCompressedOutputMagic[8] = "FLSCMP01";
+
+/*
+ *	Sizes of the serialized header, index entry and footer.
+ */
+enum
+{
+	kCompressedOutputHeaderBytes		= 8 + 2 * 4,
+	kCompressedOutputIndexEntryBytes	= 2 * 8 + 3 * 4,
+	kCompressedOutputFooterBytes		= 4 * 8 + 8,
+};
+
+static uint32_t
+loadCompressedOutputWord(const uint8_t *  bytes)
+{
+	uint32_t	word;
+
+	memcpy(&word, bytes, sizeof(word));
+
+	return word;
+}
+
+/*
+ *	64-bit FNV-1a over 8-byte words, to detect corrupt blocks.
+ */
+static uint64_t
+calculateCompressedOutputChecksum(const uint8_t *  bytes, size_t length)
+{
+	uint64_t	checksum = 0xCBF29CE484222325ULL;
+
+	for (size_t i = 0; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t))
+	{
+		uint64_t	word;
+
+		memcpy(&word, &bytes[i], sizeof(word));
+		checksum = (checksum ^ word) * 0x100000001B3ULL;
+	}
+
+	return checksum;
+}
+
+/*
+ *	Shuffles the bytes of a block of rows: byte `b` of row `i` of output `j`
+ *	goes to `shuffled[(j * 8 + b) * numberOfRows + i]`.
+ */
+static void
+shuffleCompressedOutputBlock(
+	uint8_t *		shuffled,
+	const double * const	columns[],
+	size_t			numberOfOutputs,
+	size_t			firstRow,
+	size_t			numberOfRows)
+{
+	for (size_t j = 0; j < numberOfOutputs; j++)
+	{
+		uint8_t *	planes = &shuffled[j * sizeof(double) * numberOfRows];
+
+		for (size_t i = 0; i < numberOfRows; i++)
+		{
+			uint64_t	bits;
+
+			memcpy(&bits, &columns[j][firstRow + i], sizeof(bits));
+
+			for (size_t b = 0; b < sizeof(double); b++)
+			{
+				planes[b * numberOfRows + i] = (uint8_t)(bits >> (8 * b));
+			}
+		}
+	}
+
+	return;
+}
+
+static void
+unshuffleCompressedOutputBlock(
+	double *		columns[],
+	const uint8_t *		shuffled,
+	size_t			numberOfOutputs,
+	size_t			numberOfRows)
+{
+	for (size_t j = 0; j < numberOfOutputs; j++)
+	{
+		const uint8_t *	planes = &shuffled[j * sizeof(double) * numberOfRows];
+
+		for (size_t i = 0; i < numberOfRows; i++)
+		{
+			uint64_t	bits = 0;
+
+			for (size_t b = 0; b < sizeof(double); b++)
+			{
+				bits |= (uint64_t)planes[b * numberOfRows + i] << (8 * b);
+			}
+
+			memcpy(&columns[j][i], &bits, sizeof(bits));
+		}
+	}
+
+	return;
+}
+
+/*
+ *	Appends a length beyond the 4 bits of a token: bytes of 255 and a final
+ *	byte less than 255, which add up to it.
+ */
+static void
+appendCompressedOutputLength(uint8_t *  compressed, size_t *  length, size_t value)
+{
+	while (value >= 255)
+	{
+		compressed[(*length)++] = 255;
+		value -= 255;
+	}
+
+	compressed[(*length)++] = (uint8_t)value;
+
+	return;
+}
+
+/*
+ *	Appends a sequence: a token with the literal length in its high 4 bits and
+ *	the match length minus `kCompressedOutputMinimumMatchBytes` in its low 4
+ *	bits (15 meaning that more length bytes follow), the literal length bytes,
+ *	the literals, and, unless this is the last sequence, the 2-byte match
+ *	offset and the match length bytes. Returns `false` if the sequence does not
+ *	fit in the capacity.
+ */
+static bool
+appendCompressedOutputSequence(
+	uint8_t *		compressed,
+	size_t *		length,
+	size_t			capacity,
+	const uint8_t *		literals,
+	size_t			numberOfLiterals,
+	size_t			matchLength,
+	size_t			matchOffset)
+{
+	size_t	matchCode = (matchLength > 0) ? matchLength - kCompressedOutputMinimumMatchBytes : 0;
+	size_t	worstCaseLength = 1 + (numberOfLiterals / 255 + 1) + numberOfLiterals + 2 + (matchCode / 255 + 1);
+
+	if (*length + worstCaseLength > capacity)
+	{
+		return false;
+	}
+
+	compressed[(*length)++] = (uint8_t)(((numberOfLiterals < 15) ? numberOfLiterals : 15) << 4 | ((matchCode < 15) ? matchCode : 15));
+
+	if (numberOfLiterals >= 15)
+	{
+		appendCompressedOutputLength(compressed, length, numberOfLiterals - 15);
+	}
+
+	memcpy(&compressed[*length], literals, numberOfLiterals);
+	*length += numberOfLiterals;
+
+	if (matchLength > 0)
+	{
+		compressed[(*length)++] = (uint8_t)matchOffset;
+		compressed[(*length)++] = (uint8_t)(matchOffset >> 8);
+
+		if (matchCode >= 15)
+		{
+			appendCompressedOutputLength(compressed, length, matchCode - 15);
+		}
+	}
+
+	return true;
+}
+
+/*
+ *	Greedy LZ77 compression, as in LZ4: each position is looked up in a hash
+ *	table of the last position of its first 4 bytes, and the search steps
+ *	faster the longer it goes without a match, so that incompressible bytes
+ *	(the low bytes of the mantissas) cost little. Returns the compressed
+ *	length, or 0 if it would not be less than `capacity`.
+ */
+static size_t
+compressCompressedOutputBlock(
+	uint8_t *		compressed,
+	size_t			capacity,
+	const uint8_t *		source,
+	size_t			sourceLength,
+	uint32_t *		hashTable)
+{
+	size_t	length = 0;
+	size_t	anchor = 0;
+	size_t	position = 0;
+
+	memset(hashTable, 0, sizeof(uint32_t) << kCompressedOutputHashBits);
+
+	while (position + kCompressedOutputMinimumMatchBytes <= sourceLength)
+	{
+		uint32_t	word = loadCompressedOutputWord(&source[position]);
+		uint32_t	hash = (word * 2654435761U) >> (32 - kCompressedOutputHashBits);
+		size_t		candidate = hashTable[hash];
+
+		hashTable[hash] = (uint32_t)position;
+
+		if ((candidate < position) &&
+			(position - candidate <= kCompressedOutputMaximumMatchOffset) &&
+			(loadCompressedOutputWord(&source[candidate]) == word))
+		{
+			size_t	matchLength = kCompressedOutputMinimumMatchBytes;
+
+			while ((position + matchLength < sourceLength) && (source[candidate + matchLength] == source[position + matchLength]))
+			{
+				matchLength++;
+			}
+
+			if (!appendCompressedOutputSequence(
+				compressed,
+				&length,
+				capacity,
+				&source[anchor],
+				position - anchor,
+				matchLength,
+				position - candidate))
+			{
+				return 0;
+			}
+
+			position += matchLength;
+			anchor = position;
+		}
+		else
+		{
+			position += 1 + ((position - anchor) >> 6);
+		}
+	}
+
+	if (!appendCompressedOutputSequence(compressed, &length, capacity, &source[anchor], sourceLength - anchor, 0, 0))
+	{
+		return 0;
+	}
+
+	return (length < capacity) ? length : 0;
+}
+
+static bool
+readCompressedOutputLength(const uint8_t *  compressed, size_t compressedLength, size_t *  position, size_t *  value)
+{
+	uint8_t	byte;
+
+	do
+	{
+		if (*position >= compressedLength)
+		{
+			return false;
+		}
+
+		byte = compressed[(*position)++];
+		*value += byte;
+	} while (byte == 255);
+
+	return true;
+}
+
+/*
+ *	Decompresses exactly `decompressedLength` bytes, checking every length and
+ *	offset against the buffers, so that a corrupt block fails rather than
+ *	reading or writing out of bounds.
+ */
+static bool
+decompressCompressedOutputBlock(
+	uint8_t *		decompressed,
+	size_t			decompressedLength,
+	const uint8_t *		compressed,
+	size_t			compressedLength)
+{
+	size_t	position = 0;
+	size_t	length = 0;
+
+	for (;;)
+	{
+		size_t	token;
+		size_t	numberOfLiterals;
+		size_t	matchLength;
+		size_t	matchOffset;
+
+		if (position >= compressedLength)
+		{
+			return false;
+		}
+
+		token = compressed[position++];
+		numberOfLiterals = token >> 4;
+
+		if ((numberOfLiterals == 15) && !readCompressedOutputLength(compressed, compressedLength, &position, &numberOfLiterals))
+		{
+			return false;
+		}
+
+		if ((numberOfLiterals > compressedLength - position) || (numberOfLiterals > decompressedLength - length))
+		{
+			return false;
+		}
+
+		memcpy(&decompressed[length], &compressed[position], numberOfLiterals);
+		position += numberOfLiterals;
+		length += numberOfLiterals;
+
+		if (length == decompressedLength)
+		{
+			return position == compressedLength;
+		}
+
+		if (compressedLength - position < 2)
+		{
+			return false;
+		}
+
+		matchOffset = compressed[position] | ((size_t)compressed[position + 1] << 8);
+		position += 2;
+		matchLength = token & 15;
+
+		if ((matchLength == 15) && !readCompressedOutputLength(compressed, compressedLength, &position, &matchLength))
+		{
+			return false;
+		}
+
+		matchLength += kCompressedOutputMinimumMatchBytes;
+
+		if ((matchOffset == 0) || (matchOffset > length) || (matchLength > decompressedLength - length))
+		{
+			return false;
+		}
+
+		/*
+		 *	The match may overlap the bytes it produces (e.g., a run), so copy
+		 *	it byte by byte.
+		 */
+		for (size_t i = 0; i < matchLength; i++)
+		{
+			decompressed[length + i] = decompressed[length - matchOffset + i];
+		}
+
+		length += matchLength;
+	}
+}
+
+static void
+writeCompressedOutputBlock(CompressedOutputWriter *  writer, size_t firstRow, size_t numberOfRows)
+{
+	CompressedOutputBlockIndexEntry *	entry = &writer->index[writer->numberOfBlocks];
+	size_t					shuffledLength = writer->numberOfOutputs * sizeof(double) * numberOfRows;
+	size_t					compressedLength;
+	const uint8_t *				block;
+
+	shuffleCompressedOutputBlock(writer->shuffledBlock, writer->columns, writer->numberOfOutputs, firstRow, numberOfRows);
+	compressedLength = compressCompressedOutputBlock(
+				writer->compressedBlock,
+				shuffledLength,
+				writer->shuffledBlock,
+				shuffledLength,
+				writer->hashTable);
+
+	entry->offset = writer->fileOffset;
+	entry->checksum = calculateCompressedOutputChecksum(writer->shuffledBlock, shuffledLength);
+	entry->numberOfRows = (uint32_t)numberOfRows;
+	entry->codec = (compressedLength > 0) ? kCompressedOutputCodecShuffledLZ : kCompressedOutputCodecShuffled;
+	entry->compressedBytes = (uint32_t)((compressedLength > 0) ? compressedLength : shuffledLength);
+	block = (compressedLength > 0) ? writer->compressedBlock : writer->shuffledBlock;
+
+	if (fwrite(block, 1, entry->compressedBytes, writer->fp) != entry->compressedBytes)
+	{
+		writer->hasWriteFailed = true;
+	}
+
+	writer->fileOffset += entry->compressedBytes;
+	writer->numberOfBlocks++;
+
+	return;
+}
+
+/*
+ *	Compressor thread: waits for a whole block of ready rows (or for the end
+ *	of the run, for the last partial block) and compresses it, until all rows
+ *	are compressed or the writer is aborted.
+ */
+static void *
+runCompressedOutputThread(void *  argument)
+{
+	CompressedOutputWriter *	writer = (CompressedOutputWriter *) argument;
+
+	pthread_mutex_lock(&writer->mutex);
+
+	for (;;)
+	{
+		size_t	numberOfRows;
+
+		while (!writer->isFinished && !writer->isAborted &&
+			(writer->numberOfReadyRows - writer->numberOfCompressedRows < kCompressedOutputBlockRows))
+		{
+			pthread_cond_wait(&writer->condition, &writer->mutex);
+		}
+
+		numberOfRows = writer->numberOfReadyRows - writer->numberOfCompressedRows;
+
+		if ((numberOfRows == 0) || writer->isAborted)
+		{
+			break;
+		}
+
+		numberOfRows = (numberOfRows < kCompressedOutputBlockRows) ? numberOfRows : kCompressedOutputBlockRows;
+
+		pthread_mutex_unlock(&writer->mutex);
+		writeCompressedOutputBlock(writer, writer->numberOfCompressedRows, numberOfRows);
+		pthread_mutex_lock(&writer->mutex);
+
+		writer->numberOfCompressedRows += numberOfRows;
+	}
+
+	pthread_mutex_unlock(&writer->mutex);
+
+	return NULL;
+}
+
+bool
+openCompressedOutputWriter(
+	CompressedOutputWriter *	writer,
+	const char *			path,
+	double * const			columns[],
+	size_t				numberOfOutputs,
+	size_t				maximumNumberOfRows)
+{
+	uint32_t	header[2] = {(uint32_t)numberOfOutputs, kCompressedOutputBlockRows};
+	size_t		blockBytes = numberOfOutputs * sizeof(double) * kCompressedOutputBlockRows;
+
+	memset(writer, 0, sizeof(*writer));
+	writer->path = path;
+	writer->numberOfOutputs = numberOfOutputs;
+	writer->fp = fopen(path, "wb");
+
+	if (writer->fp == NULL)
+	{
+		fprintf(stderr, "Error: Could not open %s for writing.\n", path);
+
+		return false;
+	}
+
+	for (size_t j = 0; j < numberOfOutputs; j++)
+	{
+		writer->columns[j] = columns[j];
+	}
+
+	writer->maximumNumberOfBlocks = (maximumNumberOfRows + kCompressedOutputBlockRows - 1) / kCompressedOutputBlockRows;
+	writer->index = (CompressedOutputBlockIndexEntry *) allocateFromRunArena(
+				(writer->maximumNumberOfBlocks + 1) * sizeof(CompressedOutputBlockIndexEntry),
+				kRunArenaDefaultAlignment);
+	writer->shuffledBlock = (uint8_t *) allocateFromRunArena(blockBytes, kRunArenaDefaultAlignment);
+	writer->compressedBlock = (uint8_t *) allocateFromRunArena(blockBytes, kRunArenaDefaultAlignment);
+	writer->hashTable = (uint32_t *) allocateFromRunArena(sizeof(uint32_t) << kCompressedOutputHashBits, kRunArenaDefaultAlignment);
+
+	if ((writer->index == NULL) || (writer->shuffledBlock == NULL) || (writer->compressedBlock == NULL) || (writer->hashTable == NULL))
+	{
+		fprintf(stderr, "Error: Out of memory for writing %s.\n", path);
+		fclose(writer->fp);
+		writer->fp = NULL;
+		remove(path);
+
+		return false;
+	}
+
+	writer->hasWriteFailed = (fwrite(kCompressedOutputMagic, sizeof(kCompressedOutputMagic), 1, writer->fp) != 1) ||
+					(fwrite(header, sizeof(header), 1, writer->fp) != 1);
+	writer->fileOffset = kCompressedOutputHeaderBytes;
+
+	pthread_mutex_init(&writer->mutex, NULL);
+	pthread_cond_init(&writer->condition, NULL);
+
+	/*
+	 *	Without a thread, `closeCompressedOutputWriter()` compresses all rows.
+	 */
+	writer->isThreadStarted = (pthread_create(&writer->thread, NULL, runCompressedOutputThread, writer) == 0);
+
+	return true;
+}
+
+void
+setCompressedOutputReadyRows(CompressedOutputWriter *  writer, size_t numberOfRows)
+{
+	pthread_mutex_lock(&writer->mutex);
+	writer->numberOfReadyRows = numberOfRows;
+	pthread_cond_signal(&writer->condition);
+	pthread_mutex_unlock(&writer->mutex);
+
+	return;
+}
+
+bool
+closeCompressedOutputWriter(CompressedOutputWriter *  writer, uint64_t cpuTimeUsedInMicroSeconds)
+{
+	uint64_t	footer[4];
+	bool		isWriteSuccessful;
+
+	pthread_mutex_lock(&writer->mutex);
+	writer->isFinished = true;
+	pthread_cond_signal(&writer->condition);
+	pthread_mutex_unlock(&writer->mutex);
+
+	if (writer->isThreadStarted)
+	{
+		pthread_join(writer->thread, NULL);
+	}
+	else
+	{
+		runCompressedOutputThread(writer);
+	}
+
+	pthread_cond_destroy(&writer->condition);
+	pthread_mutex_destroy(&writer->mutex);
+
+	footer[0] = writer->fileOffset;
+	footer[1] = writer->numberOfBlocks;
+	footer[2] = writer->numberOfCompressedRows;
+	footer[3] = cpuTimeUsedInMicroSeconds;
+
+	isWriteSuccessful = !writer->hasWriteFailed;
+
+	for (size_t b = 0; isWriteSuccessful && (b < writer->numberOfBlocks); b++)
+	{
+		const CompressedOutputBlockIndexEntry *	entry = &writer->index[b];
+		uint32_t				fields[3] = {entry->compressedBytes, entry->numberOfRows, entry->codec};
+
+		isWriteSuccessful = (fwrite(&entry->offset, sizeof(entry->offset), 1, writer->fp) == 1) &&
+					(fwrite(&entry->checksum, sizeof(entry->checksum), 1, writer->fp) == 1) &&
+					(fwrite(fields, sizeof(fields), 1, writer->fp) == 1);
+	}
+
+	isWriteSuccessful = isWriteSuccessful &&
+				(fwrite(footer, sizeof(footer), 1, writer->fp) == 1) &&
+				(fwrite(kCompressedOutputMagic, sizeof(kCompressedOutputMagic), 1, writer->fp) == 1);
+
+	isWriteSuccessful = (fclose(writer->fp) == 0) && isWriteSuccessful;
+	writer->fp = NULL;
+
+	if (!isWriteSuccessful)
+	{
+		fprintf(stderr, "Error: Could not write %s.\n", writer->path);
+
+		return false;
+	}
+
+	return true;
+}
+
+void
+abortCompressedOutputWriter(CompressedOutputWriter *  writer)
+{
+	if (writer->fp == NULL)
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&writer->mutex);
+	writer->isAborted = true;
+	pthread_cond_signal(&writer->condition);
+	pthread_mutex_unlock(&writer->mutex);
+
+	if (writer->isThreadStarted)
+	{
+		pthread_join(writer->thread, NULL);
+	}
+
+	pthread_cond_destroy(&writer->condition);
+	pthread_mutex_destroy(&writer->mutex);
+
+	fclose(writer->fp);
+	writer->fp = NULL;
+	remove(writer->path);
+
+	return;
+}
+
+bool
+openCompressedOutputReader(CompressedOutputReader *  reader, const char *  path)
+{
+	char		magic[sizeof(kCompressedOutputMagic)];
+	uint32_t	header[2];
+	uint64_t	footer[4];
+	size_t		blockBytes;
+	uint64_t	numberOfIndexedRows = 0;
+	off_t		indexEnd;
+
+	memset(reader, 0, sizeof(*reader));
+	reader->fp = fopen(path, "rb");
+
+	if ((reader->fp == NULL) ||
+		(fread(magic, sizeof(magic), 1, reader->fp) != 1) ||
+		(memcmp(magic, kCompressedOutputMagic, sizeof(magic)) != 0) ||
+		(fread(header, sizeof(header), 1, reader->fp) != 1) ||
+		(fseeko(reader->fp, -(off_t)kCompressedOutputFooterBytes, SEEK_END) != 0) ||
+		(fread(footer, sizeof(footer), 1, reader->fp) != 1) ||
+		(fread(magic, sizeof(magic), 1, reader->fp) != 1) ||
+		(memcmp(magic, kCompressedOutputMagic, sizeof(magic)) != 0))
+	{
+		return false;
+	}
+
+	/*
+	 *	The index must hold whole entries between the blocks and the footer.
+	 */
+	indexEnd = ftello(reader->fp) - kCompressedOutputFooterBytes;
+
+	if ((header[0] == 0) || (header[0] > kOutputDistributionIndexMax) ||
+		(header[1] == 0) || (header[1] > kCompressedOutputBlockRows) ||
+		(footer[0] < kCompressedOutputHeaderBytes) || (footer[0] > (uint64_t)indexEnd) ||
+		(footer[1] != ((uint64_t)indexEnd - footer[0]) / kCompressedOutputIndexEntryBytes) ||
+		(fseeko(reader->fp, (off_t)footer[0], SEEK_SET) != 0))
+	{
+		return false;
+	}
+
+	reader->numberOfOutputs = header[0];
+	reader->blockRows = header[1];
+	reader->numberOfBlocks = footer[1];
+	reader->numberOfRows = footer[2];
+	reader->cpuTimeUsedInMicroSeconds = footer[3];
+
+	blockBytes = reader->numberOfOutputs * sizeof(double) * reader->blockRows;
+	reader->index = (CompressedOutputBlockIndexEntry *) allocateFromRunArena(
+				(reader->numberOfBlocks + 1) * sizeof(CompressedOutputBlockIndexEntry),
+				kRunArenaDefaultAlignment);
+	reader->shuffledBlock = (uint8_t *) allocateFromRunArena(blockBytes, kRunArenaDefaultAlignment);
+	reader->compressedBlock = (uint8_t *) allocateFromRunArena(blockBytes, kRunArenaDefaultAlignment);
+
+	if ((reader->index == NULL) || (reader->shuffledBlock == NULL) || (reader->compressedBlock == NULL))
+	{
+		fprintf(stderr, "Error: Out of memory for reading the compressed output file.\n");
+
+		return false;
+	}
+
+	for (size_t b = 0; b < reader->numberOfBlocks; b++)
+	{
+		CompressedOutputBlockIndexEntry *	entry = &reader->index[b];
+		uint32_t				fields[3];
+
+		if ((fread(&entry->offset, sizeof(entry->offset), 1, reader->fp) != 1) ||
+			(fread(&entry->checksum, sizeof(entry->checksum), 1, reader->fp) != 1) ||
+			(fread(fields, sizeof(fields), 1, reader->fp) != 1))
+		{
+			return false;
+		}
+
+		entry->compressedBytes = fields[0];
+		entry->numberOfRows = fields[1];
+		entry->codec = fields[2];
+		numberOfIndexedRows += entry->numberOfRows;
+
+		if ((entry->offset < kCompressedOutputHeaderBytes) ||
+			(entry->offset + entry->compressedBytes > footer[0]) ||
+			(entry->numberOfRows == 0) || (entry->numberOfRows > reader->blockRows) ||
+			(entry->compressedBytes > reader->numberOfOutputs * sizeof(double) * entry->numberOfRows) ||
+			(entry->codec >= kCompressedOutputCodecMax))
+		{
+			return false;
+		}
+	}
+
+	return numberOfIndexedRows == reader->numberOfRows;
+}
+
+bool
+readCompressedOutputBlock(CompressedOutputReader *  reader, size_t blockIndex, double *  columns[])
+{
+	const CompressedOutputBlockIndexEntry *	entry = &reader->index[blockIndex];
+	size_t					shuffledLength = reader->numberOfOutputs * sizeof(double) * entry->numberOfRows;
+	uint8_t *				block = (entry->codec == kCompressedOutputCodecShuffledLZ) ? reader->compressedBlock : reader->shuffledBlock;
+
+	if ((fseeko(reader->fp, (off_t)entry->offset, SEEK_SET) != 0) ||
+		(fread(block, 1, entry->compressedBytes, reader->fp) != entry->compressedBytes))
+	{
+		return false;
+	}
+
+	if (entry->codec == kCompressedOutputCodecShuffledLZ)
+	{
+		if (!decompressCompressedOutputBlock(reader->shuffledBlock, shuffledLength, reader->compressedBlock, entry->compressedBytes))
+		{
+			return false;
+		}
+	}
+	else if (entry->compressedBytes != shuffledLength)
+	{
+		return false;
+	}
+
+	if (calculateCompressedOutputChecksum(reader->shuffledBlock, shuffledLength) != entry->checksum)
+	{
+		return false;
+	}
+
+	unshuffleCompressedOutputBlock(columns, reader->shuffledBlock, reader->numberOfOutputs, entry->numberOfRows);
+
+	return true;
+}
+
+void
+closeCompressedOutputReader(CompressedOutputReader *  reader)
+{
+	if (reader->fp != NULL)
+	{
+		fclose(reader->fp);
+		reader->fp = NULL;
+	}
+
+	return;
+}
+
+CommonConstantReturnType
+decompressCompressedOutputFile(const char *  path)
+{
+	CompressedOutputReader		reader;
+	double *			columns[kOutputDistributionIndexMax];
+	double *			blockColumns[kOutputDistributionIndexMax];
+	size_t				firstRow = 0;
+	RunArenaMark			arenaMark = getRunArenaMark();
+	CommonConstantReturnType	result = kCommonConstantReturnTypeSuccess;
+
+	if (!openCompressedOutputReader(&reader, path))
+	{
+		fprintf(stderr, "Error: \"%s\" is not a readable compressed output file.\n", path);
+		closeCompressedOutputReader(&reader);
+		releaseRunArenaToMark(arenaMark);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t j = 0; j < reader.numberOfOutputs; j++)
+	{
+		columns[j] = (double *) allocateFromRunArena(reader.numberOfRows * sizeof(double), kRunArenaDefaultAlignment);
+
+		if (columns[j] == NULL)
+		{
+			fprintf(stderr, "Error: Out of memory for the samples of \"%s\".\n", path);
+			closeCompressedOutputReader(&reader);
+			releaseRunArenaToMark(arenaMark);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	for (size_t b = 0; b < reader.numberOfBlocks; b++)
+	{
+		for (size_t j = 0; j < reader.numberOfOutputs; j++)
+		{
+			blockColumns[j] = &columns[j][firstRow];
+		}
+
+		if (!readCompressedOutputBlock(&reader, b, blockColumns))
+		{
+			fprintf(stderr, "Error: Block %zu of \"%s\" is corrupt.\n", b, path);
+			result = kCommonConstantReturnTypeError;
+			break;
+		}
+
+		firstRow += reader.index[b].numberOfRows;
+	}
+
+	if (result == kCommonConstantReturnTypeSuccess)
+	{
+		saveJointMonteCarloDoubleDataToDataDotOutFile(columns, reader.numberOfOutputs, reader.cpuTimeUsedInMicroSeconds, reader.numberOfRows, 1);
+	}
+
+	closeCompressedOutputReader(&reader);
+	releaseRunArenaToMark(arenaMark);
+
+	return result;
+}
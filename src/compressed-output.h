@@ -0,0 +1,200 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "common.h"
+#include "utilities-config.h"
+
+/*
+ *	Compressed binary output of Monte Carlo samples, for archiving. The rows
+ *	of samples are split into blocks of `kCompressedOutputBlockRows` rows.
+ *	The bytes of the doubles of each block are shuffled (byte 0 of every
+ *	sample, then byte 1, and so on, per output), so that the sign and
+ *	exponent bytes, which vary little between samples, end up next to each
+ *	other, and are then compressed with a byte-oriented LZ77 codec. A block
+ *	that does not get smaller is stored shuffled but uncompressed.
+ *
+ *	The file layout, in native byte order, is:
+ *		header	: the 8-byte magic `FLSCMP01`, the number of outputs and
+ *			  the number of rows per block (`uint32_t` each);
+ *		blocks	: the compressed blocks, one after the other;
+ *		index	: per block, its file offset and the checksum of its
+ *			  shuffled bytes (`uint64_t` each), and its compressed size,
+ *			  number of rows and codec (`uint32_t` each);
+ *		footer	: the file offset of the index, the number of blocks, the
+ *			  number of rows and the CPU time of the run in microseconds
+ *			  (`uint64_t` each), and the magic again.
+ *
+ *	The writer compresses on a background thread: the Monte Carlo loop only
+ *	publishes how many rows of the sample arrays are complete, and the thread
+ *	compresses every complete block straight from the sample arrays.
+ */
+typedef enum
+{
+	kCompressedOutputCodecShuffled		= 0,
+	kCompressedOutputCodecShuffledLZ	= 1,
+	kCompressedOutputCodecMax,
+} CompressedOutputCodec;
+
+typedef struct
+{
+	uint64_t	offset;
+	uint64_t	checksum;
+	uint32_t	compressedBytes;
+	uint32_t	numberOfRows;
+	uint32_t	codec;
+} CompressedOutputBlockIndexEntry;
+
+typedef struct
+{
+	FILE *				fp;
+	const char *			path;
+	const double *			columns[kOutputDistributionIndexMax];
+	size_t				numberOfOutputs;
+	pthread_t			thread;
+	bool				isThreadStarted;
+	pthread_mutex_t			mutex;
+	pthread_cond_t			condition;
+
+	/*
+	 *	Guarded by `mutex`.
+	 */
+	size_t				numberOfReadyRows;
+	bool				isFinished;
+	bool				isAborted;
+
+	/*
+	 *	Owned by the compressor thread until it is joined.
+	 */
+	size_t				numberOfCompressedRows;
+	uint8_t *			shuffledBlock;
+	uint8_t *			compressedBlock;
+	uint32_t *			hashTable;
+	CompressedOutputBlockIndexEntry *	index;
+	size_t				maximumNumberOfBlocks;
+	size_t				numberOfBlocks;
+	uint64_t			fileOffset;
+	bool				hasWriteFailed;
+} CompressedOutputWriter;
+
+typedef struct
+{
+	FILE *				fp;
+	size_t				numberOfOutputs;
+	size_t				blockRows;
+	size_t				numberOfBlocks;
+	uint64_t			numberOfRows;
+	uint64_t			cpuTimeUsedInMicroSeconds;
+	CompressedOutputBlockIndexEntry *	index;
+	uint8_t *			shuffledBlock;
+	uint8_t *			compressedBlock;
+} CompressedOutputReader;
+
+/**
+ *	@brief	Opens a compressed output file and starts its compressor thread. The buffers of the
+ *		writer are allocated from the run arena, which the caller must not release until the
+ *		writer is closed.
+ *
+ *	@param	writer			: Output. The writer.
+ *	@param	path			: The path of the file.
+ *	@param	columns			: The per-output arrays of samples, which the writer reads as rows become ready.
+ *	@param	numberOfOutputs		: The number of outputs.
+ *	@param	maximumNumberOfRows	: The maximum number of rows that will be written.
+ *	@return				: `true` if successful, else `false`.
+ */
+bool	openCompressedOutputWriter(
+		CompressedOutputWriter *	writer,
+		const char *			path,
+		double * const			columns[],
+		size_t				numberOfOutputs,
+		size_t				maximumNumberOfRows);
+
+/**
+ *	@brief	Tells the compressor thread that the first rows of the sample arrays are complete and
+ *		will not change. Does not wait for the compression.
+ *
+ *	@param	writer		: The writer.
+ *	@param	numberOfRows	: The number of complete rows, at least that of any earlier call.
+ */
+void	setCompressedOutputReadyRows(CompressedOutputWriter *  writer, size_t numberOfRows);
+
+/**
+ *	@brief	Compresses the remaining ready rows, waits for the compressor thread, and writes the
+ *		index and footer.
+ *
+ *	@param	writer				: The writer.
+ *	@param	cpuTimeUsedInMicroSeconds	: The CPU time of the run, as in the first line of data.out.
+ *	@return					: `true` if the whole file was written, else `false`.
+ */
+bool	closeCompressedOutputWriter(CompressedOutputWriter *  writer, uint64_t cpuTimeUsedInMicroSeconds);
+
+/**
+ *	@brief	Stops the compressor thread of a writer that is still open, without compressing the
+ *		remaining rows, waits for it, and removes the incomplete file. Does nothing if the
+ *		writer is closed or could not be opened, so that it can follow any error path.
+ *
+ *	@param	writer	: The writer, zero-initialized if it was never opened.
+ */
+void	abortCompressedOutputWriter(CompressedOutputWriter *  writer);
+
+/**
+ *	@brief	Opens a compressed output file and reads its index. The buffers of the reader are
+ *		allocated from the run arena.
+ *
+ *	@param	reader	: Output. The reader.
+ *	@param	path	: The path of the file.
+ *	@return		: `true` if successful, `false` if the file is not a readable compressed output file.
+ */
+bool	openCompressedOutputReader(CompressedOutputReader *  reader, const char *  path);
+
+/**
+ *	@brief	Reads one block of a compressed output file, independently of the other blocks.
+ *
+ *	@param	reader		: The reader.
+ *	@param	blockIndex	: The block, less than `reader->numberOfBlocks`.
+ *	@param	columns		: Output. The per-output arrays that receive `reader->index[blockIndex].numberOfRows` samples each.
+ *	@return			: `true` if successful, `false` if the block is corrupt (including if it does not match its checksum).
+ */
+bool	readCompressedOutputBlock(CompressedOutputReader *  reader, size_t blockIndex, double *  columns[]);
+
+/**
+ *	@brief	Closes a compressed output file.
+ *
+ *	@param	reader	: The reader.
+ */
+void	closeCompressedOutputReader(CompressedOutputReader *  reader);
+
+/**
+ *	@brief	Decompresses a compressed output file into data.out, as the run that wrote it would
+ *		have written data.out (-X option).
+ *
+ *	@param	path	: The path of the compressed output file.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	decompressCompressedOutputFile(const char *  path);
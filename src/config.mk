@@ -1,4 +1,27 @@
 SOURCES =\
 	main.c\
 	common.c\
-	utilities.c
+	utilities.c\
+	convergence.c\
+	importance-sampling.c\
+	timing.c\
+	perf-counters.c\
+	sensor-calibration.c\
+	samplers.c\
+	wasserstein.c\
+	mergeable-statistics.c\
+	sharding.c\
+	parallel-monte-carlo.c\
+	run-arena.c\
+	double-formatting.c\
+	json-output.c\
+	text-output.c\
+	distribution-table.c\
+	compressed-output.c\
+	particle-distribution.c\
+	product-distribution.c\
+	input-distributions.c\
+	common-random-numbers.c\
+	sample-reweighting.c\
+	normal-distribution.c\
+	input-correlations.c
@@ -0,0 +1,143 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "convergence.h"
+
+/*
+ *	Quantile levels whose standard error is tracked.
+ */
+static const double	kConvergenceMonitorQuantileLevels[kConvergenceMonitorNumberOfQuantiles] =
+{
+	0.05,
+	0.50,
+	0.95,
+};
+
+static int
+compareDoubles(const void *  a, const void *  b)
+{
+	double	x = *(const double *)a;
+	double	y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+void
+initializeConvergenceMonitor(ConvergenceMonitor *  monitor, double tolerance)
+{
+	memset(monitor, 0, sizeof(*monitor));
+	monitor->tolerance = tolerance;
+
+	return;
+}
+
+void
+updateConvergenceMonitor(ConvergenceMonitor *  monitor, const double *  samples, size_t numberOfSamples)
+{
+	if (numberOfSamples == 0)
+	{
+		return;
+	}
+
+	/*
+	 *	Running mean and variance over all samples.
+	 */
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		double	delta = samples[i] - monitor->mean;
+
+		monitor->numberOfSamples++;
+		monitor->mean += delta / (double)monitor->numberOfSamples;
+		monitor->sumOfSquaredDeviations += delta * (samples[i] - monitor->mean);
+	}
+
+	/*
+	 *	Quantiles of this block, folded into the batch-means statistics.
+	 */
+	memcpy(monitor->blockScratch, samples, numberOfSamples * sizeof(double));
+	qsort(monitor->blockScratch, numberOfSamples, sizeof(double), compareDoubles);
+
+	monitor->numberOfBlocks++;
+
+	for (size_t q = 0; q < kConvergenceMonitorNumberOfQuantiles; q++)
+	{
+		size_t	index = (size_t)(kConvergenceMonitorQuantileLevels[q] * (double)(numberOfSamples - 1));
+		double	delta = monitor->blockScratch[index] - monitor->blockQuantileMean[q];
+
+		monitor->blockQuantileMean[q] += delta / (double)monitor->numberOfBlocks;
+		monitor->blockQuantileSumOfSquaredDeviations[q] += delta * (monitor->blockScratch[index] - monitor->blockQuantileMean[q]);
+	}
+
+	return;
+}
+
+double
+getConvergenceMonitorStandardErrorOfMean(const ConvergenceMonitor *  monitor)
+{
+	if (monitor->numberOfSamples < 2)
+	{
+		return INFINITY;
+	}
+
+	return sqrt(monitor->sumOfSquaredDeviations / (double)(monitor->numberOfSamples - 1) / (double)monitor->numberOfSamples);
+}
+
+double
+getConvergenceMonitorMaximumStandardErrorOfQuantiles(const ConvergenceMonitor *  monitor)
+{
+	double	maximumStandardError = 0.0;
+
+	if (monitor->numberOfBlocks < 2)
+	{
+		return INFINITY;
+	}
+
+	for (size_t q = 0; q < kConvergenceMonitorNumberOfQuantiles; q++)
+	{
+		double	standardError = sqrt(
+					monitor->blockQuantileSumOfSquaredDeviations[q] /
+					(double)(monitor->numberOfBlocks - 1) /
+					(double)monitor->numberOfBlocks);
+
+		maximumStandardError = fmax(maximumStandardError, standardError);
+	}
+
+	return maximumStandardError;
+}
+
+bool
+hasConvergenceMonitorConverged(const ConvergenceMonitor *  monitor)
+{
+	double	threshold = monitor->tolerance * fabs(monitor->mean);
+
+	if (monitor->numberOfBlocks < kAdaptiveMonteCarloMinimumNumberOfBlocks)
+	{
+		return false;
+	}
+
+	return (getConvergenceMonitorStandardErrorOfMean(monitor) <= threshold) &&
+		(getConvergenceMonitorMaximumStandardErrorOfQuantiles(monitor) <= threshold);
+}
@@ -0,0 +1,100 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "utilities-config.h"
+
+/*
+ *	Number of quantiles whose standard error the convergence monitor tracks.
+ *	The quantile levels are defined in `convergence.c`.
+ */
+typedef enum
+{
+	kConvergenceMonitorNumberOfQuantiles				= 3,
+} ConvergenceMonitorConstant;
+
+/*
+ *	Running statistics used to decide when the Monte Carlo estimate of one
+ *	output has converged:
+ *		(1) the mean and variance over all samples so far (Welford's algorithm),
+ *		    giving the standard error of the mean, and
+ *		(2) the mean and variance of the per-block quantile estimates (batch
+ *		    means), giving the standard error of each tracked quantile.
+ */
+typedef struct
+{
+	double	tolerance;
+	size_t	numberOfSamples;
+	double	mean;
+	double	sumOfSquaredDeviations;
+	size_t	numberOfBlocks;
+	double	blockQuantileMean[kConvergenceMonitorNumberOfQuantiles];
+	double	blockQuantileSumOfSquaredDeviations[kConvergenceMonitorNumberOfQuantiles];
+	double	blockScratch[kMonteCarloBlockSize];
+} ConvergenceMonitor;
+
+/**
+ *	@brief	Initializes a convergence monitor.
+ *
+ *	@param	monitor		: Pointer to the monitor to initialize.
+ *	@param	tolerance	: Relative tolerance. The estimate has converged when the standard
+ *				  errors of the mean and of every tracked quantile are at most
+ *				  `tolerance * |mean|`.
+ */
+void	initializeConvergenceMonitor(ConvergenceMonitor *  monitor, double tolerance);
+
+/**
+ *	@brief	Updates a convergence monitor with one block of samples.
+ *
+ *	@param	monitor		: Pointer to the monitor to update.
+ *	@param	samples		: The samples of the block.
+ *	@param	numberOfSamples	: The number of samples in the block, at most `kMonteCarloBlockSize`.
+ */
+void	updateConvergenceMonitor(ConvergenceMonitor *  monitor, const double *  samples, size_t numberOfSamples);
+
+/**
+ *	@brief	Checks whether the estimate tracked by a convergence monitor has converged.
+ *
+ *	@param	monitor		: Pointer to the monitor.
+ *	@return			: `true` if the standard errors are within tolerance, else `false`.
+ */
+bool	hasConvergenceMonitorConverged(const ConvergenceMonitor *  monitor);
+
+/**
+ *	@brief	Standard error of the mean tracked by a convergence monitor.
+ *
+ *	@param	monitor		: Pointer to the monitor.
+ *	@return			: The standard error of the mean.
+ */
+double	getConvergenceMonitorStandardErrorOfMean(const ConvergenceMonitor *  monitor);
+
+/**
+ *	@brief	Largest standard error of the quantiles tracked by a convergence monitor.
+ *
+ *	@param	monitor		: Pointer to the monitor.
+ *	@return			: The largest batch-means standard error among the tracked quantiles.
+ */
+double	getConvergenceMonitorMaximumStandardErrorOfQuantiles(const ConvergenceMonitor *  monitor);
@@ -0,0 +1,390 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "distribution-table.h"
+#include "json-output.h"
+#include "run-arena.h"
+#include "sensor-calibration.h"
+#include "text-output.h"
+
+static const char *	kDistributionTableBoundsNames[kDistributionTableBoundsMax] =
+{
+	[kDistributionTableBoundsFirstBlock]	= "first-block",
+	[kDistributionTableBoundsAnalytic]	= "analytic",
+};
+
+static const char *	kDistributionTableFormatNames[kDistributionTableFormatMax] =
+{
+	[kDistributionTableFormatText]		= "text",
+	[kDistributionTableFormatJSON]		= "json",
+	[kDistributionTableFormatBinary]	= "binary",
+};
+
+static const char *	kDistributionTableFilePaths[kDistributionTableFormatMax] =
+{
+	[kDistributionTableFormatText]		= "distribution-table.out",
+	[kDistributionTableFormatJSON]		= "distribution-table.json",
+	[kDistributionTableFormatBinary]	= "distribution-table.bin",
+};
+
+static const char	kDistributionTableBinaryMagic[8] = "FLSDTAB1";
+
+const char *
+getDistributionTableBoundsName(DistributionTableBounds bounds)
+{
+	return kDistributionTableBoundsNames[bounds];
+}
+
+const char *
+getDistributionTableFormatName(DistributionTableFormat format)
+{
+	return kDistributionTableFormatNames[format];
+}
+
+CommonConstantReturnType
+buildDistributionTable(
+	DistributionTable *		table,
+	double * const			outputSamples[kOutputDistributionIndexMax],
+	size_t				numberOfSamples,
+	DistributionTableBounds		bounds)
+{
+	double	binLows[kOutputDistributionIndexMax];
+	double	binHighs[kOutputDistributionIndexMax];
+
+	memset(table, 0, sizeof(*table));
+	table->numberOfSamples = numberOfSamples;
+
+	if (bounds == kDistributionTableBoundsFirstBlock)
+	{
+		/*
+		 *	Same range as the histograms of the mergeable summaries.
+		 */
+		MergeableOutputSummaries *	summaries;
+		RunArenaMark			arenaMark = getRunArenaMark();
+
+		summaries = (MergeableOutputSummaries *) allocateFromRunArena(sizeof(MergeableOutputSummaries), kRunArenaDefaultAlignment);
+
+		if (summaries == NULL)
+		{
+			fprintf(stderr, "Error: Out of memory for the bounds of the distribution table.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		initializeMergeableOutputSummaries(
+			summaries,
+			outputSamples,
+			(numberOfSamples < kMonteCarloBlockSize) ? numberOfSamples : kMonteCarloBlockSize);
+
+		for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+		{
+			binLows[j] = summaries->outputs[j].histogram.low;
+			binHighs[j] = summaries->outputs[j].histogram.high;
+		}
+
+		releaseRunArenaToMark(arenaMark);
+	}
+	else
+	{
+		calculateSensorOutputBounds(binLows, binHighs);
+
+		for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+		{
+			double	margin = kDistributionTableAnalyticBoundsMargin * (binHighs[j] - binLows[j]);
+
+			binLows[j] -= margin;
+			binHighs[j] += margin;
+		}
+	}
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		if (outputSamples[j] == NULL)
+		{
+			continue;
+		}
+
+		table->isOutputCalculated[j] = true;
+		table->histograms[j].low = binLows[j];
+		table->histograms[j].high = binHighs[j];
+
+		for (size_t i = 0; i < numberOfSamples; i++)
+		{
+			updateOutputHistogram(&table->histograms[j], outputSamples[j][i]);
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+double
+getDistributionTableWassersteinBound(const DistributionTable *  table, size_t outputIndex)
+{
+	const OutputHistogram *	histogram = &table->histograms[outputIndex];
+
+	if ((histogram->underflowCount > 0) || (histogram->overflowCount > 0))
+	{
+		return INFINITY;
+	}
+
+	return (histogram->high - histogram->low) / kOutputHistogramNumberOfBins / 2.0;
+}
+
+/*
+ *	Probability density and cumulative distribution at the upper edge of each
+ *	bin. The cumulative distribution includes the samples below the bins.
+ */
+static void
+getDistributionTableColumns(
+	const DistributionTable *	table,
+	size_t				outputIndex,
+	double				pdf[kOutputHistogramNumberOfBins],
+	double				cdf[kOutputHistogramNumberOfBins])
+{
+	const OutputHistogram *	histogram = &table->histograms[outputIndex];
+	double			binWidth = (histogram->high - histogram->low) / kOutputHistogramNumberOfBins;
+	double			numberOfSamples = (double)table->numberOfSamples;
+	uint64_t		cumulativeCount = histogram->underflowCount;
+
+	for (size_t b = 0; b < kOutputHistogramNumberOfBins; b++)
+	{
+		cumulativeCount += histogram->counts[b];
+		pdf[b] = histogram->counts[b] / (numberOfSamples * binWidth);
+		cdf[b] = cumulativeCount / numberOfSamples;
+	}
+
+	return;
+}
+
+/*
+ *	One header line per output, followed by one line per bin with the bin
+ *	edges, probability density and cumulative distribution.
+ */
+static void
+appendDistributionTableText(TextOutputStream *  stream, const DistributionTable *  table, const char **  outputVariableDescriptions)
+{
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		const OutputHistogram *	histogram = &table->histograms[j];
+		double			binWidth = (histogram->high - histogram->low) / kOutputHistogramNumberOfBins;
+		double			pdf[kOutputHistogramNumberOfBins];
+		double			cdf[kOutputHistogramNumberOfBins];
+
+		if (!table->isOutputCalculated[j])
+		{
+			continue;
+		}
+
+		getDistributionTableColumns(table, j, pdf, cdf);
+
+		appendTextOutputText(stream, "# outputDistributions[");
+		appendTextOutputUnsigned(stream, j);
+		appendTextOutputText(stream, "] ");
+		appendTextOutputText(stream, outputVariableDescriptions[j]);
+		appendTextOutputText(stream, ": samples ");
+		appendTextOutputUnsigned(stream, table->numberOfSamples);
+		appendTextOutputText(stream, ", underflow ");
+		appendTextOutputUnsigned(stream, histogram->underflowCount);
+		appendTextOutputText(stream, ", overflow ");
+		appendTextOutputUnsigned(stream, histogram->overflowCount);
+		appendTextOutputText(stream, ", Wasserstein bound ");
+		appendTextOutputDouble(stream, getDistributionTableWassersteinBound(table, j));
+		appendTextOutputText(stream, "\n# binLow binHigh pdf cdf\n");
+
+		for (size_t b = 0; b < kOutputHistogramNumberOfBins; b++)
+		{
+			appendTextOutputDouble(stream, histogram->low + b * binWidth);
+			appendTextOutputText(stream, " ");
+			appendTextOutputDouble(stream, (b + 1 == kOutputHistogramNumberOfBins) ? histogram->high : histogram->low + (b + 1) * binWidth);
+			appendTextOutputText(stream, " ");
+			appendTextOutputDouble(stream, pdf[b]);
+			appendTextOutputText(stream, " ");
+			appendTextOutputDouble(stream, cdf[b]);
+			appendTextOutputText(stream, "\n");
+		}
+	}
+
+	return;
+}
+
+/*
+ *	Same layout as the output of `printMonteCarloOutputJSON()`, with a
+ *	"distributionTable" entry per output in place of its values.
+ */
+static void
+appendDistributionTableJSON(TextOutputStream *  stream, const DistributionTable *  table, const char **  outputVariableDescriptions)
+{
+	bool	isFirstResult = true;
+
+	appendTextOutputText(stream, "{\"description\": \"Output variables\", \"results\": [");
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		const OutputHistogram *	histogram = &table->histograms[j];
+		char			variableID[kCommonConstantMaxCharsPerJSONVariableSymbol];
+		double			pdf[kOutputHistogramNumberOfBins];
+		double			cdf[kOutputHistogramNumberOfBins];
+
+		if (!table->isOutputCalculated[j])
+		{
+			continue;
+		}
+
+		getDistributionTableColumns(table, j, pdf, cdf);
+
+		snprintf(variableID, sizeof(variableID), "outputDistributions[%zu]", j);
+		appendTextOutputText(stream, isFirstResult ? "{\"variableID\": " : ", {\"variableID\": ");
+		appendJSONOutputString(stream, variableID);
+		appendTextOutputText(stream, ", \"variableDescription\": ");
+		appendJSONOutputString(stream, outputVariableDescriptions[j]);
+		appendTextOutputText(stream, ", \"numberOfSamples\": ");
+		appendTextOutputUnsigned(stream, table->numberOfSamples);
+		appendTextOutputText(stream, ", \"distributionTable\": {\"low\": ");
+		appendJSONOutputDouble(stream, histogram->low);
+		appendTextOutputText(stream, ", \"high\": ");
+		appendJSONOutputDouble(stream, histogram->high);
+		appendTextOutputText(stream, ", \"underflowCount\": ");
+		appendTextOutputUnsigned(stream, histogram->underflowCount);
+		appendTextOutputText(stream, ", \"overflowCount\": ");
+		appendTextOutputUnsigned(stream, histogram->overflowCount);
+		appendTextOutputText(stream, ", \"wassersteinBound\": ");
+		appendJSONOutputDouble(stream, getDistributionTableWassersteinBound(table, j));
+		appendTextOutputText(stream, ", \"pdf\": ");
+		appendJSONOutputDoubleArray(stream, pdf, kOutputHistogramNumberOfBins, 1);
+		appendTextOutputText(stream, ", \"cdf\": ");
+		appendJSONOutputDoubleArray(stream, cdf, kOutputHistogramNumberOfBins, 1);
+		appendTextOutputText(stream, "}}");
+		isFirstResult = false;
+	}
+
+	appendTextOutputText(stream, "]}\n");
+
+	return;
+}
+
+/*
+ *	Native-endian binary layout: the magic, the number of outputs (`uint32_t`),
+ *	the number of bins (`uint32_t`) and the number of samples (`uint64_t`),
+ *	then per output its index (`uint32_t`), the range and Wasserstein bound
+ *	(`double`), the underflow and overflow counts (`uint64_t`), and the
+ *	probability density and cumulative distribution of each bin (`double`).
+ */
+static CommonConstantReturnType
+writeDistributionTableBinary(const char *  path, const DistributionTable *  table)
+{
+	FILE *		fp = fopen(path, "wb");
+	uint32_t	numberOfOutputs = 0;
+	uint32_t	numberOfBins = kOutputHistogramNumberOfBins;
+	bool		isWriteSuccessful;
+
+	if (fp == NULL)
+	{
+		fprintf(stderr, "Error: Could not open %s for writing.\n", path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		numberOfOutputs += table->isOutputCalculated[j] ? 1 : 0;
+	}
+
+	isWriteSuccessful = (fwrite(kDistributionTableBinaryMagic, sizeof(kDistributionTableBinaryMagic), 1, fp) == 1) &&
+				(fwrite(&numberOfOutputs, sizeof(numberOfOutputs), 1, fp) == 1) &&
+				(fwrite(&numberOfBins, sizeof(numberOfBins), 1, fp) == 1) &&
+				(fwrite(&table->numberOfSamples, sizeof(table->numberOfSamples), 1, fp) == 1);
+
+	for (size_t j = 0; isWriteSuccessful && (j < kOutputDistributionIndexMax); j++)
+	{
+		const OutputHistogram *	histogram = &table->histograms[j];
+		uint32_t		outputIndex = (uint32_t)j;
+		double			wassersteinBound = getDistributionTableWassersteinBound(table, j);
+		double			pdf[kOutputHistogramNumberOfBins];
+		double			cdf[kOutputHistogramNumberOfBins];
+
+		if (!table->isOutputCalculated[j])
+		{
+			continue;
+		}
+
+		getDistributionTableColumns(table, j, pdf, cdf);
+
+		isWriteSuccessful = (fwrite(&outputIndex, sizeof(outputIndex), 1, fp) == 1) &&
+					(fwrite(&histogram->low, sizeof(histogram->low), 1, fp) == 1) &&
+					(fwrite(&histogram->high, sizeof(histogram->high), 1, fp) == 1) &&
+					(fwrite(&wassersteinBound, sizeof(wassersteinBound), 1, fp) == 1) &&
+					(fwrite(&histogram->underflowCount, sizeof(histogram->underflowCount), 1, fp) == 1) &&
+					(fwrite(&histogram->overflowCount, sizeof(histogram->overflowCount), 1, fp) == 1) &&
+					(fwrite(pdf, sizeof(pdf), 1, fp) == 1) &&
+					(fwrite(cdf, sizeof(cdf), 1, fp) == 1);
+	}
+
+	if ((fclose(fp) != 0) || !isWriteSuccessful)
+	{
+		fprintf(stderr, "Error: Could not write %s.\n", path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+writeDistributionTable(
+	const DistributionTable *	table,
+	DistributionTableFormat		format,
+	const char **			outputVariableDescriptions)
+{
+	RunArenaMark		arenaMark;
+	TextOutputStream	stream;
+	bool			isWriteSuccessful;
+
+	if (format == kDistributionTableFormatBinary)
+	{
+		return writeDistributionTableBinary(kDistributionTableFilePaths[format], table);
+	}
+
+	arenaMark = getRunArenaMark();
+
+	if (!openTextOutputFile(&stream, kDistributionTableFilePaths[format]))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (format == kDistributionTableFormatJSON)
+	{
+		appendDistributionTableJSON(&stream, table, outputVariableDescriptions);
+	}
+	else
+	{
+		appendDistributionTableText(&stream, table, outputVariableDescriptions);
+	}
+
+	isWriteSuccessful = closeTextOutputStream(&stream);
+	releaseRunArenaToMark(arenaMark);
+
+	return isWriteSuccessful ? kCommonConstantReturnTypeSuccess : kCommonConstantReturnTypeError;
+}
@@ -0,0 +1,105 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "common.h"
+#include "mergeable-statistics.h"
+#include "utilities-config.h"
+
+/*
+ *	Distribution table output of Monte Carlo runs: instead of every sample,
+ *	a fixed-size table of the probability density and cumulative distribution
+ *	of each calculated output over `kOutputHistogramNumberOfBins` equal-width
+ *	bins, so that the size of the output does not depend on the number of
+ *	samples.
+ *
+ *	Spreading the samples of each bin uniformly over it moves each of them by
+ *	at most half the bin width on average, so the 1-Wasserstein distance from
+ *	the distribution of the samples to that of the table is at most half the
+ *	bin width, as long as no sample falls outside the bins.
+ */
+typedef struct
+{
+	bool		isOutputCalculated[kOutputDistributionIndexMax];
+	uint64_t	numberOfSamples;
+	OutputHistogram	histograms[kOutputDistributionIndexMax];
+} DistributionTable;
+
+/**
+ *	@brief	Name of a distribution table bounds option, as given to the -D option.
+ *
+ *	@param	bounds	: The bounds option.
+ *	@return		: The name.
+ */
+const char *	getDistributionTableBoundsName(DistributionTableBounds bounds);
+
+/**
+ *	@brief	Name of a distribution table format, as given to the -F option.
+ *
+ *	@param	format	: The format.
+ *	@return		: The name.
+ */
+const char *	getDistributionTableFormatName(DistributionTableFormat format);
+
+/**
+ *	@brief	Bins the samples of the calculated outputs into a distribution table.
+ *
+ *	@param	table			: Output. The table.
+ *	@param	outputSamples		: The per-output arrays of samples. `NULL` for outputs that are not calculated.
+ *	@param	numberOfSamples		: The number of samples.
+ *	@param	bounds			: Where the range of the bins comes from.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	buildDistributionTable(
+					DistributionTable *		table,
+					double * const			outputSamples[kOutputDistributionIndexMax],
+					size_t				numberOfSamples,
+					DistributionTableBounds		bounds);
+
+/**
+ *	@brief	Bound on the 1-Wasserstein distance from the distribution of the samples of an output
+ *		to the distribution described by its table.
+ *
+ *	@param	table		: The table.
+ *	@param	outputIndex	: The output.
+ *	@return			: Half the bin width, or `INFINITY` if any sample fell outside the bins.
+ */
+double		getDistributionTableWassersteinBound(const DistributionTable *  table, size_t outputIndex);
+
+/**
+ *	@brief	Writes a distribution table to `distribution-table.out`, `distribution-table.json` or
+ *		`distribution-table.bin`, depending on the format.
+ *
+ *	@param	table				: The table.
+ *	@param	format				: The format.
+ *	@param	outputVariableDescriptions	: The output variable descriptions.
+ *	@return					: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	writeDistributionTable(
+					const DistributionTable *	table,
+					DistributionTableFormat		format,
+					const char **			outputVariableDescriptions);
@@ -0,0 +1,567 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "double-formatting.h"
+
+/*
+ *	Grisu3, after F. Loitsch, "Printing Floating-Point Numbers Quickly and
+ *	Accurately with Integers", PLDI 2010. The value and the boundaries of its
+ *	rounding interval are scaled by a cached power of ten into a range where
+ *	their integral and fractional parts fit in 64-bit integers, and digits are
+ *	generated until the remaining part is within the rounding interval, widened
+ *	by the error of the scaling. A final check then tells whether the digits
+ *	are certainly the shortest (and closest) text within the exact interval.
+ *	For the about 0.5% of doubles for which it cannot tell, the digits come
+ *	from the C library instead, at the smallest precision that reads back.
+ */
+
+typedef struct
+{
+	uint64_t	significand;
+	int		exponent;
+} DiyFloat;
+
+typedef struct
+{
+	uint64_t	significand;
+	int		exponent;
+} CachedPowerOfTen;
+
+enum
+{
+	kDiyFloatSignificandBits					= 64,
+	kDoubleSignificandBits						= 52,
+	kDoubleExponentBias						= 0x3FF + kDoubleSignificandBits,
+	kCachedPowerOfTenFirstDecimalExponent				= -348,
+	kCachedPowerOfTenDecimalExponentStep				= 8,
+};
+
+static const uint64_t	kDoubleHiddenBit = 0x0010000000000000ULL;
+static const uint64_t	kDoubleSignificandMask = 0x000FFFFFFFFFFFFFULL;
+static const uint64_t	kDoubleExponentMask = 0x7FF0000000000000ULL;
+
+/*
+ *	Normalized 64-bit significands and binary exponents of 10^-348, 10^-340,
+ *	..., 10^340, rounded to nearest.
+ */
+static const CachedPowerOfTen	kCachedPowersOfTen[] =
+{
+	{ 0xFA8FD5A0081C0288ULL, -1220 },	/* 1e-348 */
+	{ 0xBAAEE17FA23EBF76ULL, -1193 },	/* 1e-340 */
+	{ 0x8B16FB203055AC76ULL, -1166 },	/* 1e-332 */
+	{ 0xCF42894A5DCE35EAULL, -1140 },	/* 1e-324 */
+	{ 0x9A6BB0AA55653B2DULL, -1113 },	/* 1e-316 */
+	{ 0xE61ACF033D1A45DFULL, -1087 },	/* 1e-308 */
+	{ 0xAB70FE17C79AC6CAULL, -1060 },	/* 1e-300 */
+	{ 0xFF77B1FCBEBCDC4FULL, -1034 },	/* 1e-292 */
+	{ 0xBE5691EF416BD60CULL, -1007 },	/* 1e-284 */
+	{ 0x8DD01FAD907FFC3CULL,  -980 },	/* 1e-276 */
+	{ 0xD3515C2831559A83ULL,  -954 },	/* 1e-268 */
+	{ 0x9D71AC8FADA6C9B5ULL,  -927 },	/* 1e-260 */
+	{ 0xEA9C227723EE8BCBULL,  -901 },	/* 1e-252 */
+	{ 0xAECC49914078536DULL,  -874 },	/* 1e-244 */
+	{ 0x823C12795DB6CE57ULL,  -847 },	/* 1e-236 */
+	{ 0xC21094364DFB5637ULL,  -821 },	/* 1e-228 */
+	{ 0x9096EA6F3848984FULL,  -794 },	/* 1e-220 */
+	{ 0xD77485CB25823AC7ULL,  -768 },	/* 1e-212 */
+	{ 0xA086CFCD97BF97F4ULL,  -741 },	/* 1e-204 */
+	{ 0xEF340A98172AACE5ULL,  -715 },	/* 1e-196 */
+	{ 0xB23867FB2A35B28EULL,  -688 },	/* 1e-188 */
+	{ 0x84C8D4DFD2C63F3BULL,  -661 },	/* 1e-180 */
+	{ 0xC5DD44271AD3CDBAULL,  -635 },	/* 1e-172 */
+	{ 0x936B9FCEBB25C996ULL,  -608 },	/* 1e-164 */
+	{ 0xDBAC6C247D62A584ULL,  -582 },	/* 1e-156 */
+	{ 0xA3AB66580D5FDAF6ULL,  -555 },	/* 1e-148 */
+	{ 0xF3E2F893DEC3F126ULL,  -529 },	/* 1e-140 */
+	{ 0xB5B5ADA8AAFF80B8ULL,  -502 },	/* 1e-132 */
+	{ 0x87625F056C7C4A8BULL,  -475 },	/* 1e-124 */
+	{ 0xC9BCFF6034C13053ULL,  -449 },	/* 1e-116 */
+	{ 0x964E858C91BA2655ULL,  -422 },	/* 1e-108 */
+	{ 0xDFF9772470297EBDULL,  -396 },	/* 1e-100 */
+	{ 0xA6DFBD9FB8E5B88FULL,  -369 },	/* 1e-92 */
+	{ 0xF8A95FCF88747D94ULL,  -343 },	/* 1e-84 */
+	{ 0xB94470938FA89BCFULL,  -316 },	/* 1e-76 */
+	{ 0x8A08F0F8BF0F156BULL,  -289 },	/* 1e-68 */
+	{ 0xCDB02555653131B6ULL,  -263 },	/* 1e-60 */
+	{ 0x993FE2C6D07B7FACULL,  -236 },	/* 1e-52 */
+	{ 0xE45C10C42A2B3B06ULL,  -210 },	/* 1e-44 */
+	{ 0xAA242499697392D3ULL,  -183 },	/* 1e-36 */
+	{ 0xFD87B5F28300CA0EULL,  -157 },	/* 1e-28 */
+	{ 0xBCE5086492111AEBULL,  -130 },	/* 1e-20 */
+	{ 0x8CBCCC096F5088CCULL,  -103 },	/* 1e-12 */
+	{ 0xD1B71758E219652CULL,   -77 },	/* 1e-4 */
+	{ 0x9C40000000000000ULL,   -50 },	/* 1e4 */
+	{ 0xE8D4A51000000000ULL,   -24 },	/* 1e12 */
+	{ 0xAD78EBC5AC620000ULL,     3 },	/* 1e20 */
+	{ 0x813F3978F8940984ULL,    30 },	/* 1e28 */
+	{ 0xC097CE7BC90715B3ULL,    56 },	/* 1e36 */
+	{ 0x8F7E32CE7BEA5C70ULL,    83 },	/* 1e44 */
+	{ 0xD5D238A4ABE98068ULL,   109 },	/* 1e52 */
+	{ 0x9F4F2726179A2245ULL,   136 },	/* 1e60 */
+	{ 0xED63A231D4C4FB27ULL,   162 },	/* 1e68 */
+	{ 0xB0DE65388CC8ADA8ULL,   189 },	/* 1e76 */
+	{ 0x83C7088E1AAB65DBULL,   216 },	/* 1e84 */
+	{ 0xC45D1DF942711D9AULL,   242 },	/* 1e92 */
+	{ 0x924D692CA61BE758ULL,   269 },	/* 1e100 */
+	{ 0xDA01EE641A708DEAULL,   295 },	/* 1e108 */
+	{ 0xA26DA3999AEF774AULL,   322 },	/* 1e116 */
+	{ 0xF209787BB47D6B85ULL,   348 },	/* 1e124 */
+	{ 0xB454E4A179DD1877ULL,   375 },	/* 1e132 */
+	{ 0x865B86925B9BC5C2ULL,   402 },	/* 1e140 */
+	{ 0xC83553C5C8965D3DULL,   428 },	/* 1e148 */
+	{ 0x952AB45CFA97A0B3ULL,   455 },	/* 1e156 */
+	{ 0xDE469FBD99A05FE3ULL,   481 },	/* 1e164 */
+	{ 0xA59BC234DB398C25ULL,   508 },	/* 1e172 */
+	{ 0xF6C69A72A3989F5CULL,   534 },	/* 1e180 */
+	{ 0xB7DCBF5354E9BECEULL,   561 },	/* 1e188 */
+	{ 0x88FCF317F22241E2ULL,   588 },	/* 1e196 */
+	{ 0xCC20CE9BD35C78A5ULL,   614 },	/* 1e204 */
+	{ 0x98165AF37B2153DFULL,   641 },	/* 1e212 */
+	{ 0xE2A0B5DC971F303AULL,   667 },	/* 1e220 */
+	{ 0xA8D9D1535CE3B396ULL,   694 },	/* 1e228 */
+	{ 0xFB9B7CD9A4A7443CULL,   720 },	/* 1e236 */
+	{ 0xBB764C4CA7A44410ULL,   747 },	/* 1e244 */
+	{ 0x8BAB8EEFB6409C1AULL,   774 },	/* 1e252 */
+	{ 0xD01FEF10A657842CULL,   800 },	/* 1e260 */
+	{ 0x9B10A4E5E9913129ULL,   827 },	/* 1e268 */
+	{ 0xE7109BFBA19C0C9DULL,   853 },	/* 1e276 */
+	{ 0xAC2820D9623BF429ULL,   880 },	/* 1e284 */
+	{ 0x80444B5E7AA7CF85ULL,   907 },	/* 1e292 */
+	{ 0xBF21E44003ACDD2DULL,   933 },	/* 1e300 */
+	{ 0x8E679C2F5E44FF8FULL,   960 },	/* 1e308 */
+	{ 0xD433179D9C8CB841ULL,   986 },	/* 1e316 */
+	{ 0x9E19DB92B4E31BA9ULL,  1013 },	/* 1e324 */
+	{ 0xEB96BF6EBADF77D9ULL,  1039 },	/* 1e332 */
+	{ 0xAF87023B9BF0EE6BULL,  1066 },	/* 1e340 */
+};
+
+static const uint32_t	kPowersOfTen[] =
+{
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+static DiyFloat
+getDiyFloatOfDouble(double value)
+{
+	uint64_t	bits;
+	uint64_t	significand;
+	int		biasedExponent;
+
+	memcpy(&bits, &value, sizeof(bits));
+	significand = bits & kDoubleSignificandMask;
+	biasedExponent = (int)((bits & kDoubleExponentMask) >> kDoubleSignificandBits);
+
+	if (biasedExponent != 0)
+	{
+		return (DiyFloat) { .significand = significand + kDoubleHiddenBit, .exponent = biasedExponent - kDoubleExponentBias };
+	}
+
+	return (DiyFloat) { .significand = significand, .exponent = 1 - kDoubleExponentBias };
+}
+
+static DiyFloat
+normalizeDiyFloat(DiyFloat x)
+{
+	int	shift = __builtin_clzll(x.significand);
+
+	x.significand <<= shift;
+	x.exponent -= shift;
+
+	return x;
+}
+
+/*
+ *	Upper 64 bits of the 128-bit product, rounded.
+ */
+static DiyFloat
+multiplyDiyFloats(DiyFloat x, DiyFloat y)
+{
+	unsigned __int128	product = (unsigned __int128)x.significand * y.significand;
+	uint64_t		high = (uint64_t)(product >> 64);
+	uint64_t		low = (uint64_t)product;
+
+	return (DiyFloat) { .significand = high + (low >> 63), .exponent = x.exponent + y.exponent + kDiyFloatSignificandBits };
+}
+
+/*
+ *	Boundaries of the rounding interval of a double, normalized to the same
+ *	exponent. The lower boundary is closer when the significand is a power of
+ *	two (except for the smallest normal exponent).
+ */
+static void
+getNormalizedBoundaries(DiyFloat value, DiyFloat *  lower, DiyFloat *  upper)
+{
+	*upper = normalizeDiyFloat((DiyFloat) { .significand = (value.significand << 1) + 1, .exponent = value.exponent - 1 });
+
+	if (value.significand == kDoubleHiddenBit)
+	{
+		*lower = (DiyFloat) { .significand = (value.significand << 2) - 1, .exponent = value.exponent - 2 };
+	}
+	else
+	{
+		*lower = (DiyFloat) { .significand = (value.significand << 1) - 1, .exponent = value.exponent - 1 };
+	}
+
+	lower->significand <<= lower->exponent - upper->exponent;
+	lower->exponent = upper->exponent;
+
+	return;
+}
+
+/*
+ *	Cached power of ten `c` such that the binary exponent of a value with
+ *	binary exponent `exponent` scaled by `c` is in [-60, -32], and its
+ *	decimal exponent, negated, in `decimalExponent`.
+ */
+static DiyFloat
+getCachedPowerOfTen(int exponent, int *  decimalExponent)
+{
+	double	approximateDecimalExponent = (-61 - exponent) * 0.30102999566398114 + 347;
+	int	k = (int)approximateDecimalExponent;
+	size_t	index;
+
+	k += (approximateDecimalExponent - k > 0.0);
+	index = (size_t)((k >> 3) + 1);
+	*decimalExponent = -(kCachedPowerOfTenFirstDecimalExponent + (int)index * kCachedPowerOfTenDecimalExponentStep);
+
+	return (DiyFloat) { .significand = kCachedPowersOfTen[index].significand, .exponent = kCachedPowersOfTen[index].exponent };
+}
+
+static int
+countDecimalDigits(uint32_t n)
+{
+	int	digits = 1;
+
+	while ((digits < 10) && (n >= kPowersOfTen[digits]))
+	{
+		digits++;
+	}
+
+	return digits;
+}
+
+/*
+ *	Moves the last digit towards the scaled value while the text stays in the
+ *	widened rounding interval and gets closer to the value, and tells whether
+ *	the result is certainly the closest shortest text within the exact
+ *	interval, given that each scaled quantity may be off by `unit`.
+ */
+static bool
+roundAndWeedLastDigit(
+	char *		digits,
+	int		length,
+	uint64_t	distanceToTooHigh,
+	uint64_t	unsafeInterval,
+	uint64_t	rest,
+	uint64_t	tenToKappa,
+	uint64_t	unit)
+{
+	uint64_t	smallDistance = distanceToTooHigh - unit;
+	uint64_t	bigDistance = distanceToTooHigh + unit;
+
+	while ((rest < smallDistance) && (unsafeInterval - rest >= tenToKappa) &&
+		((rest + tenToKappa < smallDistance) || (smallDistance - rest >= rest + tenToKappa - smallDistance)))
+	{
+		digits[length - 1]--;
+		rest += tenToKappa;
+	}
+
+	/*
+	 *	If the next lower last digit might still be closer, it is unknown
+	 *	which one is.
+	 */
+	if ((rest < bigDistance) && (unsafeInterval - rest >= tenToKappa) &&
+		((rest + tenToKappa < bigDistance) || (bigDistance - rest > rest + tenToKappa - bigDistance)))
+	{
+		return false;
+	}
+
+	/*
+	 *	The text is certainly inside the exact interval only if it is far
+	 *	enough from the ends of the widened one.
+	 */
+	return (2 * unit <= rest) && (rest <= unsafeInterval - 4 * unit);
+}
+
+/*
+ *	Generates the digits of the scaled value from the top of its widened
+ *	rounding interval `[tooLow, tooHigh]`. Returns the number of digits, or
+ *	its negation if they are not certainly the shortest text. No shorter text
+ *	is in the widened interval, so the shortest text has at least as many.
+ */
+static int
+generateDigits(DiyFloat value, DiyFloat tooLow, DiyFloat tooHigh, char *  digits, int *  decimalExponent)
+{
+	DiyFloat	one = { .significand = 1ULL << -value.exponent, .exponent = value.exponent };
+	uint64_t	unsafeInterval = tooHigh.significand - tooLow.significand;
+	uint64_t	unit = 1;
+	uint32_t	integral = (uint32_t)(tooHigh.significand >> -one.exponent);
+	uint64_t	fractional = tooHigh.significand & (one.significand - 1);
+	int		kappa = countDecimalDigits(integral);
+	int		length = 0;
+
+	while (kappa > 0)
+	{
+		uint32_t	digit = integral / kPowersOfTen[kappa - 1];
+		uint64_t	rest;
+
+		digits[length++] = (char)('0' + digit);
+		integral %= kPowersOfTen[kappa - 1];
+		kappa--;
+		rest = ((uint64_t)integral << -one.exponent) + fractional;
+
+		if (rest < unsafeInterval)
+		{
+			*decimalExponent += kappa;
+
+			return roundAndWeedLastDigit(
+					digits,
+					length,
+					tooHigh.significand - value.significand,
+					unsafeInterval,
+					rest,
+					(uint64_t)kPowersOfTen[kappa] << -one.exponent,
+					unit) ? length : -length;
+		}
+	}
+
+	for (;;)
+	{
+		fractional *= 10;
+		unit *= 10;
+		unsafeInterval *= 10;
+		digits[length++] = (char)('0' + (fractional >> -one.exponent));
+		fractional &= one.significand - 1;
+		kappa--;
+
+		if (fractional < unsafeInterval)
+		{
+			*decimalExponent += kappa;
+
+			return roundAndWeedLastDigit(
+					digits,
+					length,
+					(tooHigh.significand - value.significand) * unit,
+					unsafeInterval,
+					fractional,
+					one.significand,
+					unit) ? length : -length;
+		}
+	}
+}
+
+/*
+ *	Digits and decimal exponent of the shortest text of a positive, finite
+ *	double from the C library: the digits of `printf("%.*e")` at the smallest
+ *	precision from `minimumNumberOfDigits` that `strtod()` reads back as the
+ *	same double. Both round correctly, so the digits are the closest shortest
+ *	text.
+ */
+static int
+getShortestDigitsOfPrintf(double value, int minimumNumberOfDigits, char *  digits, int *  decimalExponent)
+{
+	char	text[kDoubleFormattingMaximumLength];
+	int	numberOfDigits = minimumNumberOfDigits;
+
+	snprintf(text, sizeof(text), "%.*e", numberOfDigits - 1, value);
+
+	while ((strtod(text, NULL) != value) && (numberOfDigits < 17))
+	{
+		numberOfDigits++;
+		snprintf(text, sizeof(text), "%.*e", numberOfDigits - 1, value);
+	}
+
+	/*
+	 *	The text is "d.ddde+XX", or "de+XX" for a single digit.
+	 */
+	digits[0] = text[0];
+	memcpy(&digits[1], &text[2], (size_t)(numberOfDigits - 1));
+	*decimalExponent = atoi(&text[(numberOfDigits == 1) ? 2 : numberOfDigits + 2]) - (numberOfDigits - 1);
+
+	return numberOfDigits;
+}
+
+/*
+ *	Digits and decimal exponent of the shortest text of a positive, finite
+ *	double: the value is `digits` times 10 to the `decimalExponent`.
+ */
+static int
+getShortestDigits(double value, char *  digits, int *  decimalExponent)
+{
+	DiyFloat	diyValue = getDiyFloatOfDouble(value);
+	DiyFloat	lower;
+	DiyFloat	upper;
+	DiyFloat	cachedPower;
+	DiyFloat	scaledValue;
+	DiyFloat	scaledLower;
+	DiyFloat	scaledUpper;
+	int		numberOfDigits;
+
+	getNormalizedBoundaries(diyValue, &lower, &upper);
+	cachedPower = getCachedPowerOfTen(upper.exponent, decimalExponent);
+	scaledValue = multiplyDiyFloats(normalizeDiyFloat(diyValue), cachedPower);
+	scaledLower = multiplyDiyFloats(lower, cachedPower);
+	scaledUpper = multiplyDiyFloats(upper, cachedPower);
+
+	/*
+	 *	Widen the interval by one unit on each side, to account for the
+	 *	rounding of the scaling.
+	 */
+	scaledLower.significand--;
+	scaledUpper.significand++;
+	numberOfDigits = generateDigits(scaledValue, scaledLower, scaledUpper, digits, decimalExponent);
+
+	return (numberOfDigits > 0) ? numberOfDigits : getShortestDigitsOfPrintf(value, -numberOfDigits, digits, decimalExponent);
+}
+
+static size_t
+formatDecimalExponent(int exponent, char *  buffer)
+{
+	size_t	length = 0;
+
+	buffer[length++] = 'e';
+	buffer[length++] = (exponent < 0) ? '-' : '+';
+	length += formatUnsignedDecimal((unsigned long long)((exponent < 0) ? -exponent : exponent), &buffer[length]);
+
+	return length;
+}
+
+size_t
+formatDoubleShortest(double value, char *  buffer)
+{
+	char	digits[18];
+	int	numberOfDigits;
+	int	decimalExponent;
+	int	pointPosition;
+	size_t	length = 0;
+
+	if (isnan(value))
+	{
+		memcpy(buffer, "nan", 3);
+
+		return 3;
+	}
+
+	if (signbit(value))
+	{
+		buffer[length++] = '-';
+		value = -value;
+	}
+
+	if (isinf(value))
+	{
+		memcpy(&buffer[length], "inf", 3);
+
+		return length + 3;
+	}
+
+	if (value == 0.0)
+	{
+		buffer[length++] = '0';
+
+		return length;
+	}
+
+	numberOfDigits = getShortestDigits(value, digits, &decimalExponent);
+
+	/*
+	 *	The decimal point goes after `pointPosition` digits of the text.
+	 */
+	pointPosition = numberOfDigits + decimalExponent;
+
+	if ((numberOfDigits <= pointPosition) && (pointPosition <= 21))
+	{
+		/*
+		 *	Integer, e.g., "1234000".
+		 */
+		memcpy(&buffer[length], digits, (size_t)numberOfDigits);
+		memset(&buffer[length + (size_t)numberOfDigits], '0', (size_t)(pointPosition - numberOfDigits));
+		length += (size_t)pointPosition;
+	}
+	else if ((0 < pointPosition) && (pointPosition <= 21))
+	{
+		/*
+		 *	Decimal point inside the digits, e.g., "1234.5678".
+		 */
+		memcpy(&buffer[length], digits, (size_t)pointPosition);
+		buffer[length + (size_t)pointPosition] = '.';
+		memcpy(&buffer[length + (size_t)pointPosition + 1], &digits[pointPosition], (size_t)(numberOfDigits - pointPosition));
+		length += (size_t)numberOfDigits + 1;
+	}
+	else if ((-6 < pointPosition) && (pointPosition <= 0))
+	{
+		/*
+		 *	Leading zeros, e.g., "0.001234".
+		 */
+		buffer[length++] = '0';
+		buffer[length++] = '.';
+		memset(&buffer[length], '0', (size_t)-pointPosition);
+		length += (size_t)-pointPosition;
+		memcpy(&buffer[length], digits, (size_t)numberOfDigits);
+		length += (size_t)numberOfDigits;
+	}
+	else
+	{
+		/*
+		 *	Exponential notation, e.g., "1.234e+25".
+		 */
+		buffer[length++] = digits[0];
+
+		if (numberOfDigits > 1)
+		{
+			buffer[length++] = '.';
+			memcpy(&buffer[length], &digits[1], (size_t)(numberOfDigits - 1));
+			length += (size_t)(numberOfDigits - 1);
+		}
+
+		length += formatDecimalExponent(pointPosition - 1, &buffer[length]);
+	}
+
+	return length;
+}
+
+size_t
+formatUnsignedDecimal(unsigned long long value, char *  buffer)
+{
+	char	reversed[20];
+	size_t	length = 0;
+
+	do
+	{
+		reversed[length++] = (char)('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+
+	for (size_t i = 0; i < length; i++)
+	{
+		buffer[i] = reversed[length - 1 - i];
+	}
+
+	return length;
+}
@@ -0,0 +1,57 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stddef.h>
+
+/*
+ *	Longest text that `formatDoubleShortest()` writes, without terminator:
+ *	sign, 17 digits, decimal point and a zero (e.g., "-0.00000123...") or an
+ *	exponent of up to "e-324".
+ */
+#define kDoubleFormattingMaximumLength					(32)
+
+/**
+ *	@brief	Formats a double as the shortest decimal text that reads back (with `strtod()`) as the
+ *		same double, using the Grisu3 algorithm with 64-bit integer arithmetic, or the C library
+ *		for the few doubles for which Grisu3 cannot tell that its digits are the shortest. The
+ *		format is that of JavaScript `Number.prototype.toString()`: fixed notation for decimal
+ *		exponents from -7 to 20 (e.g., "2608.6231", "0.000125") and exponential notation
+ *		otherwise (e.g., "1.5e+21", "5e-324"). Non-finite values are formatted as "nan", "inf"
+ *		and "-inf". The text is not terminated.
+ *
+ *	@param	value	: The value.
+ *	@param	buffer	: Output. At least `kDoubleFormattingMaximumLength` characters.
+ *	@return		: The number of characters written.
+ */
+size_t	formatDoubleShortest(double value, char *  buffer);
+
+/**
+ *	@brief	Formats an unsigned integer in decimal. The text is not terminated.
+ *
+ *	@param	value	: The value.
+ *	@param	buffer	: Output. At least 20 characters.
+ *	@return		: The number of characters written.
+ */
+size_t	formatUnsignedDecimal(unsigned long long value, char *  buffer);
@@ -0,0 +1,176 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <string.h>
+#include "importance-sampling.h"
+
+/*
+ *	Bound on `|tilt * (high - low)|`, which keeps `expm1()` of it finite.
+ */
+static const double	kExponentialTiltMaximumNormalizedTilt = 500.0;
+
+/*
+ *	Mean of the tilted distribution on `[0, width]`.
+ */
+static double
+calculateExponentialTiltOffsetMean(double width, double tilt)
+{
+	double	normalizedTilt = tilt * width;
+
+	if (fabs(normalizedTilt) < 1e-8)
+	{
+		return width / 2;
+	}
+
+	return -width / expm1(-normalizedTilt) - 1 / tilt;
+}
+
+double
+calculateExponentialTiltForMean(double low, double high, double targetMean)
+{
+	double	width = high - low;
+	double	lowerTilt = -kExponentialTiltMaximumNormalizedTilt / width;
+	double	upperTilt = kExponentialTiltMaximumNormalizedTilt / width;
+	double	targetOffsetMean;
+
+	/*
+	 *	Keep the target mean away from the bounds, where the tilt diverges.
+	 */
+	targetOffsetMean = fmin(fmax(targetMean - low, 0.001 * width), 0.999 * width);
+
+	/*
+	 *	The mean of the tilted distribution increases monotonically with the tilt.
+	 */
+	for (int i = 0; i < 200; i++)
+	{
+		double	tilt = (lowerTilt + upperTilt) / 2;
+
+		if (calculateExponentialTiltOffsetMean(width, tilt) < targetOffsetMean)
+		{
+			lowerTilt = tilt;
+		}
+		else
+		{
+			upperTilt = tilt;
+		}
+	}
+
+	return (lowerTilt + upperTilt) / 2;
+}
+
+double
+sampleExponentialTilt(const ExponentialTilt *  tilt, double uniformVariate, double *  weight)
+{
+	double	width = tilt->high - tilt->low;
+	double	normalizedTilt = tilt->tilt * width;
+	double	offset;
+
+	if (fabs(normalizedTilt) < 1e-8)
+	{
+		*weight = 1.0;
+
+		return tilt->low + uniformVariate * width;
+	}
+
+	/*
+	 *	Inverse of the CDF `expm1(tilt * x) / expm1(tilt * width)` of the offset `x`.
+	 */
+	offset = log1p(uniformVariate * expm1(normalizedTilt)) / tilt->tilt;
+	offset = fmin(fmax(offset, 0.0), width);
+
+	*weight = expm1(normalizedTilt) / normalizedTilt * exp(-tilt->tilt * offset);
+
+	return tilt->low + offset;
+}
+
+void
+initializeTailProbabilityEstimator(TailProbabilityEstimator *  estimator, double threshold)
+{
+	memset(estimator, 0, sizeof(*estimator));
+	estimator->threshold = threshold;
+
+	return;
+}
+
+void
+updateTailProbabilityEstimator(TailProbabilityEstimator *  estimator, double value, double weight)
+{
+	double	weightedIndicator = (value > estimator->threshold) ? weight : 0.0;
+	double	delta = weightedIndicator - estimator->meanOfWeightedIndicator;
+
+	estimator->numberOfSamples++;
+	estimator->numberOfExceedances += (value > estimator->threshold);
+	estimator->meanOfWeightedIndicator += delta / (double)estimator->numberOfSamples;
+	estimator->sumOfSquaredDeviations += delta * (weightedIndicator - estimator->meanOfWeightedIndicator);
+	estimator->sumOfExceedanceWeights += weightedIndicator;
+	estimator->sumOfSquaredExceedanceWeights += weightedIndicator * weightedIndicator;
+
+	return;
+}
+
+double
+getTailProbabilityEstimate(const TailProbabilityEstimator *  estimator)
+{
+	return estimator->meanOfWeightedIndicator;
+}
+
+double
+getTailProbabilityStandardError(const TailProbabilityEstimator *  estimator)
+{
+	if (estimator->numberOfSamples < 2)
+	{
+		return INFINITY;
+	}
+
+	return sqrt(estimator->sumOfSquaredDeviations / (double)(estimator->numberOfSamples - 1) / (double)estimator->numberOfSamples);
+}
+
+bool
+hasTailProbabilityEstimatorConverged(
+	const TailProbabilityEstimator *	estimator,
+	size_t					minimumNumberOfSamples,
+	double					relativeTolerance)
+{
+	/*
+	 *	Without any exceedances, the estimate and its standard error are both
+	 *	zero, which says nothing about the tail.
+	 */
+	if ((estimator->numberOfSamples < minimumNumberOfSamples) || (estimator->numberOfExceedances == 0))
+	{
+		return false;
+	}
+
+	return getTailProbabilityStandardError(estimator) <= relativeTolerance * getTailProbabilityEstimate(estimator);
+}
+
+double
+getTailProbabilityEffectiveSampleSize(const TailProbabilityEstimator *  estimator)
+{
+	if (estimator->sumOfSquaredExceedanceWeights == 0.0)
+	{
+		return 0.0;
+	}
+
+	return estimator->sumOfExceedanceWeights * estimator->sumOfExceedanceWeights / estimator->sumOfSquaredExceedanceWeights;
+}
@@ -0,0 +1,125 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ *	Exponential tilting of a uniform distribution on `[low, high]`: samples are
+ *	drawn from the density proportional to `exp(tilt * x)` on `[low, high]` and
+ *	carry the likelihood ratio (weight) of the uniform density to the tilted one.
+ *	A positive tilt moves samples towards `high`, a negative one towards `low`,
+ *	and a zero tilt is the uniform distribution itself.
+ */
+typedef struct
+{
+	double	low;
+	double	high;
+	double	tilt;
+} ExponentialTilt;
+
+/*
+ *	Running estimate of a tail probability `P(X > threshold)` from weighted
+ *	(importance) samples of `X`.
+ */
+typedef struct
+{
+	double	threshold;
+	size_t	numberOfSamples;
+	size_t	numberOfExceedances;
+	double	meanOfWeightedIndicator;
+	double	sumOfSquaredDeviations;
+	double	sumOfExceedanceWeights;
+	double	sumOfSquaredExceedanceWeights;
+} TailProbabilityEstimator;
+
+/**
+ *	@brief	Finds the tilt under which the mean of the tilted uniform distribution on
+ *		`[low, high]` equals `targetMean`.
+ *
+ *	@param	low		: Lower bound of the uniform distribution.
+ *	@param	high		: Upper bound of the uniform distribution.
+ *	@param	targetMean	: The desired mean, clamped to the interior of `[low, high]`.
+ *	@return			: The tilt.
+ */
+double	calculateExponentialTiltForMean(double low, double high, double targetMean);
+
+/**
+ *	@brief	Maps a uniform variate on `[0, 1)` to a sample of the tilted distribution.
+ *
+ *	@param	tilt		: The tilted distribution.
+ *	@param	uniformVariate	: A sample of the uniform distribution on `[0, 1)`.
+ *	@param	weight		: Output. The likelihood ratio of the untilted to the tilted density at the sample.
+ *	@return			: The sample.
+ */
+double	sampleExponentialTilt(const ExponentialTilt *  tilt, double uniformVariate, double *  weight);
+
+/**
+ *	@brief	Initializes a tail probability estimator.
+ *
+ *	@param	estimator	: Pointer to the estimator to initialize.
+ *	@param	threshold	: The threshold of the tail probability `P(X > threshold)`.
+ */
+void	initializeTailProbabilityEstimator(TailProbabilityEstimator *  estimator, double threshold);
+
+/**
+ *	@brief	Updates a tail probability estimator with one weighted sample.
+ *
+ *	@param	estimator	: Pointer to the estimator to update.
+ *	@param	value		: The sample.
+ *	@param	weight		: The importance weight of the sample.
+ */
+void	updateTailProbabilityEstimator(TailProbabilityEstimator *  estimator, double value, double weight);
+
+/**
+ *	@brief	The importance sampling estimate of the tail probability.
+ */
+double	getTailProbabilityEstimate(const TailProbabilityEstimator *  estimator);
+
+/**
+ *	@brief	The standard error of the importance sampling estimate of the tail probability.
+ */
+double	getTailProbabilityStandardError(const TailProbabilityEstimator *  estimator);
+
+/**
+ *	@brief	Checks whether the relative standard error of the tail probability estimate is within tolerance.
+ *
+ *	@param	estimator		: Pointer to the estimator.
+ *	@param	minimumNumberOfSamples	: The number of samples below which the estimate is never considered converged.
+ *	@param	relativeTolerance	: The largest acceptable ratio of standard error to estimate.
+ *	@return				: `true` if converged, else `false`.
+ */
+bool	hasTailProbabilityEstimatorConverged(
+		const TailProbabilityEstimator *	estimator,
+		size_t					minimumNumberOfSamples,
+		double					relativeTolerance);
+
+/**
+ *	@brief	The effective sample size of the estimate: `(sum of weights)^2 / (sum of squared weights)`
+ *		over the exceedances so far, the only samples whose weights enter the estimate. The
+ *		samples below the threshold only have their weights, which mostly shrink with the tilt,
+ *		multiplied by zero.
+ */
+double	getTailProbabilityEffectiveSampleSize(const TailProbabilityEstimator *  estimator);
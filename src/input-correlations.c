@@ -0,0 +1,322 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "input-correlations.h"
+#include "input-distributions.h"
+
+static InputCorrelationSpecification	inputCorrelationSpecification =
+{
+	.correlations =
+	{
+		[kInputDistributionIndexHxfer]	= {[kInputDistributionIndexHxfer]	= 1.0},
+		[kInputDistributionIndexTflow]	= {[kInputDistributionIndexTflow]	= 1.0},
+		[kInputDistributionIndexT0]	= {[kInputDistributionIndexT0]		= 1.0},
+		[kInputDistributionIndexPflow]	= {[kInputDistributionIndexPflow]	= 1.0},
+		[kInputDistributionIndexP0]	= {[kInputDistributionIndexP0]		= 1.0},
+	},
+	.choleskyFactor =
+	{
+		[kInputDistributionIndexHxfer]	= {[kInputDistributionIndexHxfer]	= 1.0},
+		[kInputDistributionIndexTflow]	= {[kInputDistributionIndexTflow]	= 1.0},
+		[kInputDistributionIndexT0]	= {[kInputDistributionIndexT0]		= 1.0},
+		[kInputDistributionIndexPflow]	= {[kInputDistributionIndexPflow]	= 1.0},
+		[kInputDistributionIndexP0]	= {[kInputDistributionIndexP0]		= 1.0},
+	},
+	.numberOfCorrelatedInputs = 0,
+};
+
+const InputCorrelationSpecification *
+getInputCorrelationSpecification(void)
+{
+	return &inputCorrelationSpecification;
+}
+
+bool
+areInputsCorrelated(void)
+{
+	return (inputCorrelationSpecification.numberOfCorrelatedInputs > 0);
+}
+
+/*
+ *	Index of the input with the name `name`, or `kInputDistributionIndexMax`.
+ */
+static size_t
+getInputIndexOfName(const char *  name)
+{
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		if (strcmp(name, getInputDistributionName(k)) == 0)
+		{
+			return k;
+		}
+	}
+
+	return kInputDistributionIndexMax;
+}
+
+/*
+ *	Parses one `<input>:<input>=<correlation>` assignment into the
+ *	correlation matrix, or describes why it is invalid.
+ */
+static CommonConstantReturnType
+parseInputCorrelationAssignment(
+	char *	assignment,
+	double	correlations[kInputDistributionIndexMax][kInputDistributionIndexMax],
+	char *	errorMessage,
+	size_t	errorMessageBytes)
+{
+	char *	value = strchr(assignment, '=');
+	char *	secondInput = strchr(assignment, ':');
+	size_t	firstInputIndex;
+	size_t	secondInputIndex;
+	double	correlation;
+
+	if ((value == NULL) || (secondInput == NULL) || (secondInput > value))
+	{
+		snprintf(errorMessage, errorMessageBytes, "The input correlation \"%s\" must be of the form <input>:<input>=<correlation>.", assignment);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	*value++ = '\0';
+	*secondInput++ = '\0';
+	firstInputIndex = getInputIndexOfName(assignment);
+	secondInputIndex = getInputIndexOfName(secondInput);
+
+	if ((firstInputIndex == kInputDistributionIndexMax) || (secondInputIndex == kInputDistributionIndexMax))
+	{
+		snprintf(errorMessage, errorMessageBytes, "Unknown input \"%s\". The inputs are Hxfer, Tflow, T0, Pflow and P0.",
+			(firstInputIndex == kInputDistributionIndexMax) ? assignment : secondInput);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (firstInputIndex == secondInputIndex)
+	{
+		snprintf(errorMessage, errorMessageBytes, "The correlation of input %s with itself is always 1.", assignment);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((parseDoubleChecked(value, &correlation) != kCommonConstantReturnTypeSuccess) || !(fabs(correlation) < 1.0))
+	{
+		snprintf(errorMessage, errorMessageBytes, "The correlation of inputs %s and %s must be a real number in (-1, 1).", assignment, secondInput);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	correlations[firstInputIndex][secondInputIndex] = correlation;
+	correlations[secondInputIndex][firstInputIndex] = correlation;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Cholesky factorization of a correlation matrix (the Cholesky-Banachiewicz
+ *	order, row by row). Fails if the matrix is not positive definite.
+ */
+static CommonConstantReturnType
+calculateCholeskyFactor(
+	const double	correlations[kInputDistributionIndexMax][kInputDistributionIndexMax],
+	double		choleskyFactor[kInputDistributionIndexMax][kInputDistributionIndexMax])
+{
+	for (size_t row = 0; row < kInputDistributionIndexMax; row++)
+	{
+		for (size_t column = 0; column <= row; column++)
+		{
+			double	sum = correlations[row][column];
+
+			for (size_t m = 0; m < column; m++)
+			{
+				sum -= choleskyFactor[row][m] * choleskyFactor[column][m];
+			}
+
+			if (column < row)
+			{
+				choleskyFactor[row][column] = sum / choleskyFactor[column][column];
+			}
+			else if (sum < kInputCorrelationMinimumCholeskyPivot)
+			{
+				return kCommonConstantReturnTypeError;
+			}
+			else
+			{
+				choleskyFactor[row][row] = sqrt(sum);
+			}
+		}
+
+		for (size_t column = row + 1; column < kInputDistributionIndexMax; column++)
+		{
+			choleskyFactor[row][column] = 0.0;
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+prepareInputCorrelationSpecification(InputCorrelationSpecification *  specification)
+{
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		if (specification->correlations[k][k] != 1.0)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		for (size_t m = 0; m < k; m++)
+		{
+			if ((specification->correlations[k][m] != specification->correlations[m][k]) || !(fabs(specification->correlations[k][m]) < 1.0))
+			{
+				return kCommonConstantReturnTypeError;
+			}
+		}
+	}
+
+	if (calculateCholeskyFactor(specification->correlations, specification->choleskyFactor) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	An input without correlations has a unit row and column in the
+	 *	Cholesky factor, so it can be sampled on its own.
+	 */
+	specification->numberOfCorrelatedInputs = 0;
+
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		specification->isCorrelated[k] = false;
+
+		for (size_t m = 0; m < kInputDistributionIndexMax; m++)
+		{
+			specification->isCorrelated[k] = specification->isCorrelated[k] || ((m != k) && (specification->correlations[k][m] != 0.0));
+		}
+
+		if (specification->isCorrelated[k])
+		{
+			specification->correlatedInputs[specification->numberOfCorrelatedInputs++] = k;
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+parseInputCorrelationSpecification(
+	char *				assignments,
+	InputCorrelationSpecification *	specification,
+	char *				errorMessage,
+	size_t				errorMessageBytes)
+{
+	InputCorrelationSpecification	parsedSpecification = {0};
+	char *				savePointer = NULL;
+
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		parsedSpecification.correlations[k][k] = 1.0;
+	}
+
+	for (char *  assignment = strtok_r(assignments, ", \t", &savePointer); assignment != NULL; assignment = strtok_r(NULL, ", \t", &savePointer))
+	{
+		if (parseInputCorrelationAssignment(assignment, parsedSpecification.correlations, errorMessage, errorMessageBytes) != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (prepareInputCorrelationSpecification(&parsedSpecification) != kCommonConstantReturnTypeSuccess)
+	{
+		snprintf(errorMessage, errorMessageBytes, "The input correlations do not form a positive definite correlation matrix.");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	*specification = parsedSpecification;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+parseInputCorrelationAssignments(char *  assignments)
+{
+	char	errorMessage[kInputAssignmentErrorMessageBytes];
+
+	if (parseInputCorrelationSpecification(assignments, &inputCorrelationSpecification, errorMessage, sizeof(errorMessage)) != kCommonConstantReturnTypeSuccess)
+	{
+		fprintf(stderr, "Error: %s\n", errorMessage);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+correlateStandardGaussians(
+	double *	variates[kInputDistributionIndexMax],
+	size_t		stride,
+	size_t		numberOfSamples)
+{
+	const InputCorrelationSpecification *	specification = &inputCorrelationSpecification;
+
+	/*
+	 *	Row `a` of the factor combines the variates of the inputs up to `a`,
+	 *	so going from the last correlated input to the first leaves the
+	 *	variates that later rows read untouched until their own turn.
+	 */
+	for (size_t a = specification->numberOfCorrelatedInputs; a-- > 0;)
+	{
+		size_t		row = specification->correlatedInputs[a];
+		double *	rowVariates = variates[row];
+		double		diagonal = specification->choleskyFactor[row][row];
+
+		for (size_t i = 0; i < numberOfSamples; i++)
+		{
+			rowVariates[i * stride] *= diagonal;
+		}
+
+		for (size_t b = 0; b < a; b++)
+		{
+			size_t		column = specification->correlatedInputs[b];
+			const double *	columnVariates = variates[column];
+			double		coefficient = specification->choleskyFactor[row][column];
+
+			if (coefficient == 0.0)
+			{
+				continue;
+			}
+
+			for (size_t i = 0; i < numberOfSamples; i++)
+			{
+				rowVariates[i * stride] += coefficient * columnVariates[i * stride];
+			}
+		}
+	}
+
+	return;
+}
@@ -0,0 +1,113 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "common.h"
+#include "utilities-config.h"
+
+/*
+ *	Correlations of the inputs, as the correlation matrix of the Gaussian
+ *	copula from which they are sampled, with its Cholesky factor and the
+ *	inputs that are correlated with at least one other.
+ */
+typedef struct
+{
+	double	correlations[kInputDistributionIndexMax][kInputDistributionIndexMax];
+	double	choleskyFactor[kInputDistributionIndexMax][kInputDistributionIndexMax];
+	bool	isCorrelated[kInputDistributionIndexMax];
+	size_t	correlatedInputs[kInputDistributionIndexMax];
+	size_t	numberOfCorrelatedInputs;
+} InputCorrelationSpecification;
+
+/**
+ *	@brief	The current correlations of the inputs. Until they are set, the inputs are
+ *		independent.
+ *
+ *	@return	: The correlations.
+ */
+const InputCorrelationSpecification *	getInputCorrelationSpecification(void);
+
+/**
+ *	@brief	Whether any input is correlated with another.
+ *
+ *	@return	: `true` if the correlation matrix is not the identity.
+ */
+bool		areInputsCorrelated(void);
+
+/**
+ *	@brief	Checks the correlation matrix of a specification (unit diagonal, symmetric, with
+ *		correlations in (-1, 1) and positive definite) and sets its Cholesky factor and
+ *		correlated inputs. Every specification must be prepared before it is used.
+ *
+ *	@param	specification	: The correlations.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if the matrix is valid, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	prepareInputCorrelationSpecification(InputCorrelationSpecification *  specification);
+
+/**
+ *	@brief	Sets a prepared correlation specification from a list of pairwise correlations, in
+ *		the syntax of `parseInputCorrelationAssignments()`. The specification is changed only
+ *		if all of them are valid and the matrix is positive definite. Errors are described
+ *		in a buffer of the caller instead of on the standard error.
+ *
+ *	@param	assignments		: The correlations. Modified by parsing.
+ *	@param	specification		: Output. The correlations.
+ *	@param	errorMessage		: Output. On error, the description of the invalid correlations.
+ *	@param	errorMessageBytes	: The size of `errorMessage`, for example `kInputAssignmentErrorMessageBytes`.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	parseInputCorrelationSpecification(
+					char *				assignments,
+					InputCorrelationSpecification *	specification,
+					char *				errorMessage,
+					size_t				errorMessageBytes);
+
+/**
+ *	@brief	Sets the correlation matrix of the inputs from a list of pairwise correlations,
+ *		separated by commas or whitespace, each of the form `<input>:<input>=<correlation>`,
+ *		for example `Tflow:T0=0.8,Pflow:P0=0.6`. Pairs without a correlation are
+ *		uncorrelated. The correlations are applied only if all of them are valid and the
+ *		matrix is positive definite.
+ *
+ *	@param	assignments	: The correlations. Modified by parsing.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	parseInputCorrelationAssignments(char *  assignments);
+
+/**
+ *	@brief	Correlates independent standard Gaussian variates of the correlated inputs, in
+ *		place, by the Cholesky factor of the correlation matrix, one input at a time over
+ *		all the samples. The variates of the other inputs are neither read nor written.
+ *
+ *	@param	variates	: Pointers to the variate of the first sample of every input.
+ *	@param	stride		: Distance, in doubles, between the variates of consecutive samples.
+ *	@param	numberOfSamples	: The number of samples.
+ */
+void		correlateStandardGaussians(
+			double *	variates[kInputDistributionIndexMax],
+			size_t		stride,
+			size_t		numberOfSamples);
@@ -0,0 +1,785 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "input-distributions.h"
+#include "normal-distribution.h"
+
+static const char *	kInputDistributionNames[kInputDistributionIndexMax] =
+{
+	[kInputDistributionIndexHxfer]	= "Hxfer",
+	[kInputDistributionIndexTflow]	= "Tflow",
+	[kInputDistributionIndexT0]	= "T0",
+	[kInputDistributionIndexPflow]	= "Pflow",
+	[kInputDistributionIndexP0]	= "P0",
+};
+
+static const char *	kInputDistributionFamilyNames[kInputDistributionFamilyMax] =
+{
+	[kInputDistributionFamilyUniform]		= "uniform",
+	[kInputDistributionFamilyGaussian]		= "gaussian",
+	[kInputDistributionFamilyTruncatedGaussian]	= "truncated-gaussian",
+	[kInputDistributionFamilyTriangular]		= "triangular",
+	[kInputDistributionFamilyHistogram]		= "histogram",
+};
+
+/*
+ *	Number of parameters of every family in an assignment, and their description
+ *	for error messages.
+ */
+static const size_t	kInputDistributionFamilyNumberOfParameters[kInputDistributionFamilyMax] =
+{
+	[kInputDistributionFamilyUniform]		= 2,
+	[kInputDistributionFamilyGaussian]		= 2,
+	[kInputDistributionFamilyTruncatedGaussian]	= 4,
+	[kInputDistributionFamilyTriangular]		= 3,
+	[kInputDistributionFamilyHistogram]		= 3,
+};
+
+static const char *	kInputDistributionFamilyParameterDescriptions[kInputDistributionFamilyMax] =
+{
+	[kInputDistributionFamilyUniform]		= "<low>:<high>, finite with low < high",
+	[kInputDistributionFamilyGaussian]		= "<mean>:<standard deviation>, finite with a positive standard deviation",
+	[kInputDistributionFamilyTruncatedGaussian]	= "<mean>:<standard deviation>:<low>:<high>, finite with a positive standard deviation, "
+							  "low < high and a non-zero probability between them",
+	[kInputDistributionFamilyTriangular]		= "<low>:<mode>:<high>, finite with low <= mode <= high and low < high",
+	[kInputDistributionFamilyHistogram]		= "<low>:<high>:<weight>/<weight>/..., finite with low < high and at most 64 "
+							  "non-negative weights of positive sum",
+};
+
+/*
+ *	The current input distributions, indexed by `InputDistributionIndex`.
+ */
+static InputDistributionSpecification	inputDistributionSpecifications[kInputDistributionIndexMax] =
+{
+	[kInputDistributionIndexHxfer]	= { kInputDistributionFamilyUniform,	kDefaultInputDistributionHxferUniformDistLow,	kDefaultInputDistributionHxferUniformDistHigh },
+	[kInputDistributionIndexTflow]	= { kInputDistributionFamilyUniform,	kDefaultInputDistributionTflowUniformDistLow,	kDefaultInputDistributionTflowUniformDistHigh },
+	[kInputDistributionIndexT0]	= { kInputDistributionFamilyUniform,	kDefaultInputDistributionT0UniformDistLow,	kDefaultInputDistributionT0UniformDistHigh },
+	[kInputDistributionIndexPflow]	= { kInputDistributionFamilyUniform,	kDefaultInputDistributionPflowUniformDistLow,	kDefaultInputDistributionPflowUniformDistHigh },
+	[kInputDistributionIndexP0]	= { kInputDistributionFamilyUniform,	kDefaultInputDistributionP0UniformDistLow,	kDefaultInputDistributionP0UniformDistHigh },
+};
+
+const char *
+getInputDistributionName(size_t inputIndex)
+{
+	return kInputDistributionNames[inputIndex];
+}
+
+const char *
+getInputDistributionFamilyName(InputDistributionFamily family)
+{
+	return kInputDistributionFamilyNames[family];
+}
+
+const InputDistributionSpecification *
+getInputDistributionSpecification(size_t inputIndex)
+{
+	return &inputDistributionSpecifications[inputIndex];
+}
+
+void
+getInputDistributionBounds(size_t inputIndex, double *  low, double *  high)
+{
+	*low = inputDistributionSpecifications[inputIndex].low;
+	*high = inputDistributionSpecifications[inputIndex].high;
+
+	return;
+}
+
+void
+getInputDistributionRange(size_t inputIndex, double *  low, double *  high)
+{
+	const InputDistributionSpecification *	specification = &inputDistributionSpecifications[inputIndex];
+
+	if (specification->family == kInputDistributionFamilyGaussian)
+	{
+		*low = specification->mean - kInputDistributionGaussianRangeStandardDeviations * specification->standardDeviation;
+		*high = specification->mean + kInputDistributionGaussianRangeStandardDeviations * specification->standardDeviation;
+	}
+	else
+	{
+		*low = specification->low;
+		*high = specification->high;
+	}
+
+	return;
+}
+
+CommonConstantReturnType
+prepareInputDistributionSpecification(InputDistributionSpecification *  specification)
+{
+	bool	isGaussianValid = isfinite(specification->mean) && isfinite(specification->standardDeviation) &&
+					(specification->standardDeviation > 0.0);
+	bool	areBoundsValid = isfinite(specification->low) && isfinite(specification->high) &&
+					(specification->low < specification->high);
+
+	switch (specification->family)
+	{
+		case kInputDistributionFamilyUniform:
+		{
+			return areBoundsValid ? kCommonConstantReturnTypeSuccess : kCommonConstantReturnTypeError;
+		}
+
+		case kInputDistributionFamilyGaussian:
+		{
+			specification->low = -INFINITY;
+			specification->high = INFINITY;
+
+			return isGaussianValid ? kCommonConstantReturnTypeSuccess : kCommonConstantReturnTypeError;
+		}
+
+		case kInputDistributionFamilyTruncatedGaussian:
+		{
+			double	standardLow = (specification->low - specification->mean) / specification->standardDeviation;
+			double	standardHigh = (specification->high - specification->mean) / specification->standardDeviation;
+
+			if (!isGaussianValid || !areBoundsValid)
+			{
+				return kCommonConstantReturnTypeError;
+			}
+
+			/*
+			 *	The lower tail of the standard Gaussian cumulative distribution
+			 *	function keeps its relative precision, so a support mostly above
+			 *	the mean is handled as its mirror image below it.
+			 */
+			specification->isTruncationMirrored = (standardLow + standardHigh > 0.0);
+
+			if (specification->isTruncationMirrored)
+			{
+				double	mirroredLow = -standardHigh;
+
+				standardHigh = -standardLow;
+				standardLow = mirroredLow;
+			}
+
+			specification->truncatedLowCumulativeProbability = getStandardGaussianCumulativeProbability(standardLow);
+			specification->truncatedProbabilityMass = getStandardGaussianCumulativeProbability(standardHigh) -
+									specification->truncatedLowCumulativeProbability;
+
+			return (specification->truncatedProbabilityMass > 0.0) ? kCommonConstantReturnTypeSuccess : kCommonConstantReturnTypeError;
+		}
+
+		case kInputDistributionFamilyTriangular:
+		{
+			return (areBoundsValid && (specification->mode >= specification->low) && (specification->mode <= specification->high)) ?
+					kCommonConstantReturnTypeSuccess :
+					kCommonConstantReturnTypeError;
+		}
+
+		case kInputDistributionFamilyHistogram:
+		{
+			double	totalWeight = 0.0;
+			double	cumulativeWeight = 0.0;
+
+			if (!areBoundsValid || (specification->numberOfHistogramBins == 0) ||
+				(specification->numberOfHistogramBins > kInputDistributionHistogramMaximumNumberOfBins))
+			{
+				return kCommonConstantReturnTypeError;
+			}
+
+			for (size_t b = 0; b < specification->numberOfHistogramBins; b++)
+			{
+				if (!isfinite(specification->histogramWeights[b]) || (specification->histogramWeights[b] < 0.0))
+				{
+					return kCommonConstantReturnTypeError;
+				}
+
+				totalWeight += specification->histogramWeights[b];
+			}
+
+			if (!(totalWeight > 0.0) || !isfinite(totalWeight))
+			{
+				return kCommonConstantReturnTypeError;
+			}
+
+			specification->histogramCumulativeProbabilities[0] = 0.0;
+
+			for (size_t b = 0; b < specification->numberOfHistogramBins; b++)
+			{
+				cumulativeWeight += specification->histogramWeights[b];
+				specification->histogramCumulativeProbabilities[b + 1] = cumulativeWeight / totalWeight;
+			}
+
+			specification->histogramCumulativeProbabilities[specification->numberOfHistogramBins] = 1.0;
+
+			return kCommonConstantReturnTypeSuccess;
+		}
+
+		default:
+		{
+			return kCommonConstantReturnTypeError;
+		}
+	}
+}
+
+double
+getInputDistributionQuantile(const InputDistributionSpecification *  specification, double p)
+{
+	switch (specification->family)
+	{
+		case kInputDistributionFamilyGaussian:
+		{
+			/*
+			 *	A variate of exactly zero stands for the smallest positive one.
+			 */
+			return specification->mean + specification->standardDeviation * getStandardGaussianQuantile(fmax(p, 0x1.0p-54));
+		}
+
+		case kInputDistributionFamilyTruncatedGaussian:
+		{
+			double	standardQuantile = getStandardGaussianQuantile(
+							specification->truncatedLowCumulativeProbability + p * specification->truncatedProbabilityMass);
+			double	quantile = specification->isTruncationMirrored ?
+						specification->mean - specification->standardDeviation * standardQuantile :
+						specification->mean + specification->standardDeviation * standardQuantile;
+
+			return fmin(fmax(quantile, specification->low), specification->high);
+		}
+
+		case kInputDistributionFamilyTriangular:
+		{
+			double	width = specification->high - specification->low;
+			double	lowerWidth = specification->mode - specification->low;
+			double	upperWidth = specification->high - specification->mode;
+
+			if (p * width < lowerWidth)
+			{
+				return specification->low + sqrt(p * width * lowerWidth);
+			}
+
+			return specification->high - sqrt((1.0 - p) * width * upperWidth);
+		}
+
+		case kInputDistributionFamilyHistogram:
+		{
+			const double *	cumulativeProbabilities = specification->histogramCumulativeProbabilities;
+			size_t		lowBin = 0;
+			size_t		highBin = specification->numberOfHistogramBins;
+			double		binWidth = (specification->high - specification->low) / (double)specification->numberOfHistogramBins;
+
+			/*
+			 *	Binary search for the bin whose cumulative probabilities bracket
+			 *	`p`. Bins of zero weight are never selected.
+			 */
+			while (highBin - lowBin > 1)
+			{
+				size_t	middleBin = lowBin + (highBin - lowBin) / 2;
+
+				if (cumulativeProbabilities[middleBin] <= p)
+				{
+					lowBin = middleBin;
+				}
+				else
+				{
+					highBin = middleBin;
+				}
+			}
+
+			return specification->low + binWidth * ((double)lowBin +
+					(p - cumulativeProbabilities[lowBin]) / (cumulativeProbabilities[lowBin + 1] - cumulativeProbabilities[lowBin]));
+		}
+
+		case kInputDistributionFamilyUniform:
+		default:
+		{
+			return specification->low + p * (specification->high - specification->low);
+		}
+	}
+}
+
+double
+getInputDistributionQuantileOfStandardGaussian(const InputDistributionSpecification *  specification, double variate)
+{
+	if (specification->family == kInputDistributionFamilyGaussian)
+	{
+		return specification->mean + specification->standardDeviation * variate;
+	}
+
+	return getInputDistributionQuantile(specification, getStandardGaussianCumulativeProbability(variate));
+}
+
+double
+getInputDistributionDensity(const InputDistributionSpecification *  specification, double value)
+{
+	if ((value < specification->low) || (value > specification->high))
+	{
+		return 0.0;
+	}
+
+	switch (specification->family)
+	{
+		case kInputDistributionFamilyGaussian:
+		{
+			return getStandardGaussianDensity((value - specification->mean) / specification->standardDeviation) /
+					specification->standardDeviation;
+		}
+
+		case kInputDistributionFamilyTruncatedGaussian:
+		{
+			return getStandardGaussianDensity((value - specification->mean) / specification->standardDeviation) /
+					(specification->standardDeviation * specification->truncatedProbabilityMass);
+		}
+
+		case kInputDistributionFamilyTriangular:
+		{
+			double	width = specification->high - specification->low;
+
+			if (value < specification->mode)
+			{
+				return 2.0 * (value - specification->low) / (width * (specification->mode - specification->low));
+			}
+
+			if (value > specification->mode)
+			{
+				return 2.0 * (specification->high - value) / (width * (specification->high - specification->mode));
+			}
+
+			return 2.0 / width;
+		}
+
+		case kInputDistributionFamilyHistogram:
+		{
+			double	binWidth = (specification->high - specification->low) / (double)specification->numberOfHistogramBins;
+			size_t	bin = (size_t)((value - specification->low) / binWidth);
+
+			bin = (bin < specification->numberOfHistogramBins) ? bin : specification->numberOfHistogramBins - 1;
+
+			return (specification->histogramCumulativeProbabilities[bin + 1] - specification->histogramCumulativeProbabilities[bin]) / binWidth;
+		}
+
+		case kInputDistributionFamilyUniform:
+		default:
+		{
+			return 1.0 / (specification->high - specification->low);
+		}
+	}
+}
+
+void
+getInputDistributionSpecifications(InputDistributionSpecification specifications[kInputDistributionIndexMax])
+{
+	memcpy(specifications, inputDistributionSpecifications, sizeof(inputDistributionSpecifications));
+
+	return;
+}
+
+void
+setInputDistributionSpecifications(const InputDistributionSpecification specifications[kInputDistributionIndexMax])
+{
+	memcpy(inputDistributionSpecifications, specifications, sizeof(inputDistributionSpecifications));
+
+	return;
+}
+
+CommonConstantReturnType
+setInputDistributionSpecificationOfParameters(
+	InputDistributionSpecification *	specification,
+	InputDistributionFamily			family,
+	const double *				parameters,
+	size_t					numberOfParameters)
+{
+	InputDistributionSpecification	parametrizedSpecification = {.family = family};
+	size_t				numberOfHistogramBins = numberOfParameters - 2;
+
+	if ((family >= kInputDistributionFamilyMax) || (parameters == NULL))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	switch (family)
+	{
+		case kInputDistributionFamilyGaussian:
+		case kInputDistributionFamilyTruncatedGaussian:
+		{
+			if (numberOfParameters != kInputDistributionFamilyNumberOfParameters[family])
+			{
+				return kCommonConstantReturnTypeError;
+			}
+
+			parametrizedSpecification.mean = parameters[0];
+			parametrizedSpecification.standardDeviation = parameters[1];
+
+			if (family == kInputDistributionFamilyTruncatedGaussian)
+			{
+				parametrizedSpecification.low = parameters[2];
+				parametrizedSpecification.high = parameters[3];
+			}
+			break;
+		}
+
+		case kInputDistributionFamilyTriangular:
+		{
+			if (numberOfParameters != kInputDistributionFamilyNumberOfParameters[family])
+			{
+				return kCommonConstantReturnTypeError;
+			}
+
+			parametrizedSpecification.low = parameters[0];
+			parametrizedSpecification.mode = parameters[1];
+			parametrizedSpecification.high = parameters[2];
+			break;
+		}
+
+		case kInputDistributionFamilyHistogram:
+		{
+			/*
+			 *	The bounds, then one weight per bin.
+			 */
+			if ((numberOfParameters < 3) || (numberOfHistogramBins > kInputDistributionHistogramMaximumNumberOfBins))
+			{
+				return kCommonConstantReturnTypeError;
+			}
+
+			parametrizedSpecification.low = parameters[0];
+			parametrizedSpecification.high = parameters[1];
+			parametrizedSpecification.numberOfHistogramBins = numberOfHistogramBins;
+			memcpy(parametrizedSpecification.histogramWeights, &parameters[2], numberOfHistogramBins * sizeof(double));
+			break;
+		}
+
+		case kInputDistributionFamilyUniform:
+		default:
+		{
+			if (numberOfParameters != kInputDistributionFamilyNumberOfParameters[family])
+			{
+				return kCommonConstantReturnTypeError;
+			}
+
+			parametrizedSpecification.low = parameters[0];
+			parametrizedSpecification.high = parameters[1];
+			break;
+		}
+	}
+
+	if (prepareInputDistributionSpecification(&parametrizedSpecification) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	*specification = parametrizedSpecification;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Parses the `/`-separated bin weights of a histogram assignment.
+ */
+static CommonConstantReturnType
+parseInputDistributionHistogramWeights(char *  weights, InputDistributionSpecification *  specification)
+{
+	char *	savePointer = NULL;
+
+	specification->numberOfHistogramBins = 0;
+
+	for (char *  weight = strtok_r(weights, "/", &savePointer); weight != NULL; weight = strtok_r(NULL, "/", &savePointer))
+	{
+		if ((specification->numberOfHistogramBins == kInputDistributionHistogramMaximumNumberOfBins) ||
+			(parseDoubleChecked(weight, &specification->histogramWeights[specification->numberOfHistogramBins]) != kCommonConstantReturnTypeSuccess))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		specification->numberOfHistogramBins++;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Parses one `<input>=[<family>:]<parameters>` assignment into the
+ *	distributions, or describes why it is invalid.
+ */
+static CommonConstantReturnType
+parseInputDistributionAssignment(
+	char *				assignment,
+	InputDistributionSpecification	specifications[kInputDistributionIndexMax],
+	char *				errorMessage,
+	size_t				errorMessageBytes)
+{
+	char *				value = strchr(assignment, '=');
+	char *				fields[kInputDistributionAssignmentMaximumNumberOfFields];
+	char **				parameters = fields;
+	double				numericParameters[kInputDistributionAssignmentMaximumNumberOfFields];
+	size_t				numberOfFields = 0;
+	size_t				numberOfParameters;
+	size_t				inputIndex = kInputDistributionIndexMax;
+	bool				areParametersValid;
+	InputDistributionSpecification	specification = {.family = kInputDistributionFamilyUniform};
+
+	if (value == NULL)
+	{
+		snprintf(errorMessage, errorMessageBytes, "The input distribution assignment \"%s\" must be of the form <input>=[<family>:]<parameters>.", assignment);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	*value++ = '\0';
+
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		if (strcmp(assignment, kInputDistributionNames[k]) == 0)
+		{
+			inputIndex = k;
+		}
+	}
+
+	if (inputIndex == kInputDistributionIndexMax)
+	{
+		snprintf(errorMessage, errorMessageBytes, "Unknown input \"%s\". The inputs are Hxfer, Tflow, T0, Pflow and P0.", assignment);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	Split the value into its `:`-separated fields, keeping empty ones.
+	 */
+	for (char *  field = value; field != NULL; numberOfFields++)
+	{
+		char *	separator = strchr(field, ':');
+
+		if (numberOfFields == kInputDistributionAssignmentMaximumNumberOfFields)
+		{
+			snprintf(errorMessage, errorMessageBytes, "The distribution of input %s has too many parameters.", assignment);
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		fields[numberOfFields] = field;
+
+		if (separator != NULL)
+		{
+			*separator = '\0';
+			separator++;
+		}
+
+		field = separator;
+	}
+
+	/*
+	 *	An optional family name comes before the parameters.
+	 */
+	numberOfParameters = numberOfFields;
+
+	if (parseDoubleChecked(fields[0], &numericParameters[0]) != kCommonConstantReturnTypeSuccess)
+	{
+		specification.family = kInputDistributionFamilyMax;
+
+		for (InputDistributionFamily family = 0; family < kInputDistributionFamilyMax; family++)
+		{
+			if (strcmp(fields[0], kInputDistributionFamilyNames[family]) == 0)
+			{
+				specification.family = family;
+			}
+		}
+
+		if (specification.family == kInputDistributionFamilyMax)
+		{
+			snprintf(errorMessage, errorMessageBytes,
+				"Unknown distribution family \"%s\" of input %s. The families are uniform, gaussian, "
+				"truncated-gaussian, triangular and histogram.",
+				fields[0],
+				assignment);
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		parameters = &fields[1];
+		numberOfParameters = numberOfFields - 1;
+	}
+
+	/*
+	 *	All parameters are numbers, except for the weights of a histogram.
+	 */
+	areParametersValid = (numberOfParameters == kInputDistributionFamilyNumberOfParameters[specification.family]);
+
+	for (size_t i = 0; areParametersValid && (i < numberOfParameters); i++)
+	{
+		if ((specification.family == kInputDistributionFamilyHistogram) && (i == 2))
+		{
+			areParametersValid = (parseInputDistributionHistogramWeights(parameters[i], &specification) == kCommonConstantReturnTypeSuccess);
+		}
+		else
+		{
+			areParametersValid = (parseDoubleChecked(parameters[i], &numericParameters[i]) == kCommonConstantReturnTypeSuccess);
+		}
+	}
+
+	if (areParametersValid)
+	{
+		switch (specification.family)
+		{
+			case kInputDistributionFamilyGaussian:
+			{
+				specification.mean = numericParameters[0];
+				specification.standardDeviation = numericParameters[1];
+				break;
+			}
+
+			case kInputDistributionFamilyTruncatedGaussian:
+			{
+				specification.mean = numericParameters[0];
+				specification.standardDeviation = numericParameters[1];
+				specification.low = numericParameters[2];
+				specification.high = numericParameters[3];
+				break;
+			}
+
+			case kInputDistributionFamilyTriangular:
+			{
+				specification.low = numericParameters[0];
+				specification.mode = numericParameters[1];
+				specification.high = numericParameters[2];
+				break;
+			}
+
+			case kInputDistributionFamilyUniform:
+			case kInputDistributionFamilyHistogram:
+			default:
+			{
+				specification.low = numericParameters[0];
+				specification.high = numericParameters[1];
+				break;
+			}
+		}
+
+		areParametersValid = (prepareInputDistributionSpecification(&specification) == kCommonConstantReturnTypeSuccess);
+	}
+
+	if (!areParametersValid)
+	{
+		snprintf(errorMessage, errorMessageBytes,
+			"The %s distribution of input %s takes the parameters %s.",
+			kInputDistributionFamilyNames[specification.family],
+			assignment,
+			kInputDistributionFamilyParameterDescriptions[specification.family]);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	specifications[inputIndex] = specification;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+applyInputDistributionAssignments(
+	char *				assignments,
+	InputDistributionSpecification	specifications[kInputDistributionIndexMax],
+	char *				errorMessage,
+	size_t				errorMessageBytes)
+{
+	InputDistributionSpecification	assignedSpecifications[kInputDistributionIndexMax];
+	char *				savePointer = NULL;
+
+	memcpy(assignedSpecifications, specifications, sizeof(assignedSpecifications));
+
+	for (char *  assignment = strtok_r(assignments, ", \t", &savePointer); assignment != NULL; assignment = strtok_r(NULL, ", \t", &savePointer))
+	{
+		if (parseInputDistributionAssignment(assignment, assignedSpecifications, errorMessage, errorMessageBytes) != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	memcpy(specifications, assignedSpecifications, sizeof(assignedSpecifications));
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+parseInputDistributionAssignments(char *  assignments)
+{
+	char	errorMessage[kInputAssignmentErrorMessageBytes];
+
+	if (applyInputDistributionAssignments(assignments, inputDistributionSpecifications, errorMessage, sizeof(errorMessage)) != kCommonConstantReturnTypeSuccess)
+	{
+		fprintf(stderr, "Error: %s\n", errorMessage);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+bool
+readInputDistributionAssignmentsLine(FILE *  fp, char *  line, size_t lineBytes, bool *  isLineTooLong)
+{
+	*isLineTooLong = false;
+
+	while (fgets(line, (int)lineBytes, fp) != NULL)
+	{
+		size_t	length = strcspn(line, "\r\n");
+		size_t	start = strspn(line, " \t");
+
+		if ((line[length] == '\0') && !feof(fp))
+		{
+			*isLineTooLong = true;
+
+			return false;
+		}
+
+		line[length] = '\0';
+
+		if ((line[start] != '\0') && (line[start] != '#'))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+CommonConstantReturnType
+loadInputDistributionConfigurationFile(const char *  path)
+{
+	FILE *				fp = fopen(path, "r");
+	char				line[kInputDistributionAssignmentsMaximumLineBytes];
+	bool				isLineTooLong;
+	CommonConstantReturnType	result = kCommonConstantReturnTypeSuccess;
+
+	if (fp == NULL)
+	{
+		fprintf(stderr, "Error: Could not open the input distribution configuration file \"%s\".\n", path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	while ((result == kCommonConstantReturnTypeSuccess) && readInputDistributionAssignmentsLine(fp, line, sizeof(line), &isLineTooLong))
+	{
+		result = parseInputDistributionAssignments(line);
+	}
+
+	if (isLineTooLong)
+	{
+		fprintf(stderr, "Error: A line of \"%s\" is longer than %d bytes.\n", path, kInputDistributionAssignmentsMaximumLineBytes);
+		result = kCommonConstantReturnTypeError;
+	}
+
+	fclose(fp);
+
+	return result;
+}
@@ -0,0 +1,224 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "common.h"
+#include "utilities-config.h"
+
+/*
+ *	Distribution of an input: its family, the bounds of its support (infinite
+ *	for a Gaussian) and the parameters of the family. The derived values are
+ *	set by `prepareInputDistributionSpecification()`.
+ */
+typedef struct
+{
+	InputDistributionFamily	family;
+	double			low;
+	double			high;
+	double			mean;
+	double			standardDeviation;
+	double			mode;
+	size_t			numberOfHistogramBins;
+	double			histogramWeights[kInputDistributionHistogramMaximumNumberOfBins];
+
+	/*
+	 *	Derived values: the cumulative probabilities of the histogram bin edges,
+	 *	and for a truncated Gaussian, the standard Gaussian cumulative probability
+	 *	of its lower bound and its probability mass, mirrored about the mean if the
+	 *	support lies mostly above it so that they keep their relative precision.
+	 */
+	double			histogramCumulativeProbabilities[kInputDistributionHistogramMaximumNumberOfBins + 1];
+	double			truncatedLowCumulativeProbability;
+	double			truncatedProbabilityMass;
+	bool			isTruncationMirrored;
+} InputDistributionSpecification;
+
+/**
+ *	@brief	Name of an input, as used in input distribution assignments.
+ *
+ *	@param	inputIndex	: The input, an `InputDistributionIndex`.
+ *	@return			: The name.
+ */
+const char *	getInputDistributionName(size_t inputIndex);
+
+/**
+ *	@brief	Name of an input distribution family, as used in input distribution assignments.
+ *
+ *	@param	family	: The family.
+ *	@return		: The name.
+ */
+const char *	getInputDistributionFamilyName(InputDistributionFamily family);
+
+/**
+ *	@brief	The current distribution of an input. Until it is changed, this is the
+ *		`kDefaultInputDistribution` distribution of `utilities-config.h`.
+ *
+ *	@param	inputIndex	: The input, an `InputDistributionIndex`.
+ *	@return			: The distribution.
+ */
+const InputDistributionSpecification *	getInputDistributionSpecification(size_t inputIndex);
+
+/**
+ *	@brief	Bounds of the current distribution of an input.
+ *
+ *	@param	inputIndex	: The input, an `InputDistributionIndex`.
+ *	@param	low		: Output. The lower bound.
+ *	@param	high		: Output. The upper bound.
+ */
+void		getInputDistributionBounds(size_t inputIndex, double *  low, double *  high);
+
+/**
+ *	@brief	Finite range of the current distribution of an input: its bounds, or for a
+ *		Gaussian, `kInputDistributionGaussianRangeStandardDeviations` standard deviations
+ *		either side of its mean.
+ *
+ *	@param	inputIndex	: The input, an `InputDistributionIndex`.
+ *	@param	low		: Output. The lower end of the range.
+ *	@param	high		: Output. The upper end of the range.
+ */
+void		getInputDistributionRange(size_t inputIndex, double *  low, double *  high);
+
+/**
+ *	@brief	Checks the parameters of a distribution and sets its bounds (for a Gaussian)
+ *		and derived values. Every distribution must be prepared before it is used.
+ *
+ *	@param	specification	: The distribution.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if the parameters are valid, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	prepareInputDistributionSpecification(InputDistributionSpecification *  specification);
+
+/**
+ *	@brief	Quantile function (inverse cumulative distribution function) of a distribution.
+ *
+ *	@param	specification	: The distribution.
+ *	@param	p		: The probability, in [0, 1).
+ *	@return			: The quantile of `p`.
+ */
+double		getInputDistributionQuantile(const InputDistributionSpecification *  specification, double p);
+
+/**
+ *	@brief	Maps a standard Gaussian variate to a distribution, as the quantile of its standard
+ *		Gaussian cumulative probability: the Gaussian copula of correlated inputs. A
+ *		Gaussian distribution maps it directly, without the round trip through a probability.
+ *
+ *	@param	specification	: The distribution.
+ *	@param	variate		: The standard Gaussian variate.
+ *	@return			: The value of the distribution.
+ */
+double		getInputDistributionQuantileOfStandardGaussian(const InputDistributionSpecification *  specification, double variate);
+
+/**
+ *	@brief	Probability density of a distribution at a value.
+ *
+ *	@param	specification	: The distribution.
+ *	@param	value		: The value.
+ *	@return			: The density, zero outside the bounds.
+ */
+double		getInputDistributionDensity(const InputDistributionSpecification *  specification, double value);
+
+/**
+ *	@brief	Copies out the current distributions of all inputs.
+ *
+ *	@param	specifications	: Output. The distributions, indexed by `InputDistributionIndex`.
+ */
+void		getInputDistributionSpecifications(InputDistributionSpecification specifications[kInputDistributionIndexMax]);
+
+/**
+ *	@brief	Replaces the current distributions of all inputs.
+ *
+ *	@param	specifications	: The distributions, indexed by `InputDistributionIndex`.
+ */
+void		setInputDistributionSpecifications(const InputDistributionSpecification specifications[kInputDistributionIndexMax]);
+
+/**
+ *	@brief	Sets and prepares a distribution from its family and its parameters, in the order
+ *		of the parameters of an assignment. The parameters of a histogram are its bounds
+ *		followed by the weight of every bin. The distribution is changed only if the
+ *		parameters are valid.
+ *
+ *	@param	specification		: Output. The distribution.
+ *	@param	family			: The family.
+ *	@param	parameters		: The parameters.
+ *	@param	numberOfParameters	: The number of parameters.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if the parameters are valid, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	setInputDistributionSpecificationOfParameters(
+					InputDistributionSpecification *	specification,
+					InputDistributionFamily			family,
+					const double *				parameters,
+					size_t					numberOfParameters);
+
+/**
+ *	@brief	Applies a list of input distribution assignments, in the syntax of
+ *		`parseInputDistributionAssignments()`, to given distributions instead of the
+ *		current ones. The distributions are changed only if all of them are valid. Errors
+ *		are described in a buffer of the caller instead of on the standard error.
+ *
+ *	@param	assignments		: The assignments. Modified by parsing.
+ *	@param	specifications		: The distributions, indexed by `InputDistributionIndex`.
+ *	@param	errorMessage		: Output. On error, the description of the invalid assignment.
+ *	@param	errorMessageBytes	: The size of `errorMessage`, for example `kInputAssignmentErrorMessageBytes`.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	applyInputDistributionAssignments(
+					char *				assignments,
+					InputDistributionSpecification	specifications[kInputDistributionIndexMax],
+					char *				errorMessage,
+					size_t				errorMessageBytes);
+
+/**
+ *	@brief	Applies a list of input distribution assignments, separated by commas or
+ *		whitespace, each of the form `<input>=[<family>:]<parameters>`, for example
+ *		`Tflow=gaussian:293.5:0.2,P0=400000:410000`. The family defaults to uniform, and
+ *		the parameters of every family are those of `InputDistributionFamily`. The
+ *		assignments are applied only if all of them are valid.
+ *
+ *	@param	assignments	: The assignments. Modified by parsing.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	parseInputDistributionAssignments(char *  assignments);
+
+/**
+ *	@brief	Applies the input distribution assignments of every line of a configuration
+ *		file. Empty lines and lines that start with `#` are skipped.
+ *
+ *	@param	path	: The path of the configuration file.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	loadInputDistributionConfigurationFile(const char *  path);
+
+/**
+ *	@brief	Reads the next line of input distribution assignments of a configuration or
+ *		scenario batch file, skipping empty lines and lines that start with `#`.
+ *
+ *	@param	fp		: The file.
+ *	@param	line		: Output. The line, without its line break.
+ *	@param	lineBytes	: The size of `line`.
+ *	@param	isLineTooLong	: Output. Whether the line did not fit in `line`.
+ *	@return			: `true` if a line was read, `false` at the end of the file or on error.
+ */
+bool		readInputDistributionAssignmentsLine(FILE *  fp, char *  line, size_t lineBytes, bool *  isLineTooLong);
@@ -0,0 +1,421 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "json-output.h"
+#include "double-formatting.h"
+#include "mergeable-statistics.h"
+#include "run-arena.h"
+
+static const char *	kJSONOutputContentNames[kJSONOutputContentMax] =
+{
+	[kJSONOutputContentSamples]	= "samples",
+	[kJSONOutputContentSummary]	= "summary",
+	[kJSONOutputContentHistogram]	= "histogram",
+};
+
+static const double	kJSONOutputSummaryQuantileLevels[] = {0.01, 0.05, 0.25, 0.50, 0.75, 0.95, 0.99};
+static const size_t	kJSONOutputSummaryInsertionSortLength = 16;
+
+const char *
+getJSONOutputContentName(JSONOutputContent content)
+{
+	return kJSONOutputContentNames[content];
+}
+
+void
+appendJSONOutputString(TextOutputStream *  stream, const char *  string)
+{
+	reserveTextOutput(stream, 1);
+	stream->buffer[stream->length++] = '"';
+
+	for (const unsigned char *  c = (const unsigned char *)string; *c != '\0'; c++)
+	{
+		/*
+		 *	Longest escape is "\u00XX".
+		 */
+		reserveTextOutput(stream, 6);
+
+		if ((*c == '"') || (*c == '\\'))
+		{
+			stream->buffer[stream->length++] = '\\';
+			stream->buffer[stream->length++] = (char)*c;
+		}
+		else if (*c < 0x20)
+		{
+			stream->length += (size_t)snprintf(&stream->buffer[stream->length], 7, "\\u%04x", *c);
+		}
+		else
+		{
+			stream->buffer[stream->length++] = (char)*c;
+		}
+	}
+
+	reserveTextOutput(stream, 1);
+	stream->buffer[stream->length++] = '"';
+
+	return;
+}
+
+void
+appendJSONOutputDouble(TextOutputStream *  stream, double value)
+{
+	if (!isfinite(value))
+	{
+		appendTextOutputText(stream, "null");
+
+		return;
+	}
+
+	reserveTextOutput(stream, kDoubleFormattingMaximumLength);
+	stream->length += formatDoubleShortest(value, &stream->buffer[stream->length]);
+
+	return;
+}
+
+void
+appendJSONOutputDoubleArray(TextOutputStream *  stream, const double *  values, size_t numberOfValues, size_t numberOfThreads)
+{
+	appendTextOutputText(stream, "[");
+
+	/*
+	 *	Every value but the last is followed by a separator.
+	 */
+	if (numberOfValues > 0)
+	{
+		appendTextOutputDoubleRows(stream, &values, 1, numberOfValues - 1, "", ", ", "null", numberOfThreads);
+		appendJSONOutputDouble(stream, values[numberOfValues - 1]);
+	}
+
+	appendTextOutputText(stream, "]");
+
+	return;
+}
+
+/*
+ *	Moves the order statistic of rank `rank` of `values[low, high)` to
+ *	`values[rank]`, with no larger value before it and no smaller value
+ *	after it (quickselect with Hoare partitioning on the median of three,
+ *	down to ranges short enough to sort by insertion).
+ */
+static void
+selectOrderStatistic(double *  values, size_t low, size_t high, size_t rank)
+{
+	while (high - low > kJSONOutputSummaryInsertionSortLength)
+	{
+		size_t	middle = low + (high - low) / 2;
+		double	a = values[low];
+		double	b = values[middle];
+		double	c = values[high - 1];
+		double	pivot = (a < b) ? ((b < c) ? b : ((a < c) ? c : a)) : ((a < c) ? a : ((b < c) ? c : b));
+		size_t	i = low;
+		size_t	j = high - 1;
+
+		for (;;)
+		{
+			while (values[i] < pivot)
+			{
+				i++;
+			}
+
+			while (values[j] > pivot)
+			{
+				j--;
+			}
+
+			if (i >= j)
+			{
+				break;
+			}
+
+			double	swap = values[i];
+
+			values[i++] = values[j];
+			values[j--] = swap;
+		}
+
+		/*
+		 *	Now `values[low, j]` are at most the pivot and `values(j, high)` at least.
+		 */
+		if (rank <= j)
+		{
+			high = j + 1;
+		}
+		else
+		{
+			low = j + 1;
+		}
+	}
+
+	for (size_t i = low + 1; i < high; i++)
+	{
+		double	value = values[i];
+		size_t	k = i;
+
+		for (; (k > low) && (values[k - 1] > value); k--)
+		{
+			values[k] = values[k - 1];
+		}
+
+		values[k] = value;
+	}
+
+	return;
+}
+
+/*
+ *	The summary of an output: moments and extremes from the mergeable
+ *	summary, and quantiles as exact order statistics of the samples (of rank
+ *	`floor(level * (n - 1))`, as for the convergence monitor), selected in a
+ *	copy of the samples in scratch space of `numberOfSamples` doubles.
+ */
+static void
+appendOutputSummaryJSON(
+	TextOutputStream *	stream,
+	const OutputSummary *	summary,
+	const double *		samples,
+	size_t			numberOfSamples,
+	double *		sortedSamples)
+{
+	size_t		lowestRank = 0;
+	double		variance;
+	double		skewness;
+	double		excessKurtosis;
+
+	memcpy(sortedSamples, samples, numberOfSamples * sizeof(double));
+
+	getMomentAccumulatorStatistics(&summary->moments, &variance, &skewness, &excessKurtosis);
+
+	appendTextOutputText(stream, "\"summary\": {\"mean\": ");
+	appendJSONOutputDouble(stream, summary->moments.mean);
+	appendTextOutputText(stream, ", \"variance\": ");
+	appendJSONOutputDouble(stream, variance);
+	appendTextOutputText(stream, ", \"skewness\": ");
+	appendJSONOutputDouble(stream, skewness);
+	appendTextOutputText(stream, ", \"excessKurtosis\": ");
+	appendJSONOutputDouble(stream, excessKurtosis);
+	appendTextOutputText(stream, ", \"minimum\": ");
+	appendJSONOutputDouble(stream, summary->moments.minimum);
+	appendTextOutputText(stream, ", \"maximum\": ");
+	appendJSONOutputDouble(stream, summary->moments.maximum);
+	appendTextOutputText(stream, ", \"quantiles\": {");
+
+	for (size_t q = 0; q < sizeof(kJSONOutputSummaryQuantileLevels) / sizeof(kJSONOutputSummaryQuantileLevels[0]); q++)
+	{
+		char	level[kDoubleFormattingMaximumLength + 1];
+
+		size_t	rank = (size_t)(kJSONOutputSummaryQuantileLevels[q] * (double)(numberOfSamples - 1));
+
+		/*
+		 *	The levels increase, so every rank is in the part of the samples
+		 *	at or after the previous one.
+		 */
+		selectOrderStatistic(sortedSamples, lowestRank, numberOfSamples, rank);
+		lowestRank = rank;
+
+		level[formatDoubleShortest(kJSONOutputSummaryQuantileLevels[q], level)] = '\0';
+		appendTextOutputText(stream, (q == 0) ? "" : ", ");
+		appendJSONOutputString(stream, level);
+		appendTextOutputText(stream, ": ");
+		appendJSONOutputDouble(stream, sortedSamples[rank]);
+	}
+
+	appendTextOutputText(stream, "}}");
+
+	return;
+}
+
+static void
+appendOutputHistogramJSON(TextOutputStream *  stream, const OutputHistogram *  histogram)
+{
+	appendTextOutputText(stream, "\"histogram\": {\"low\": ");
+	appendJSONOutputDouble(stream, histogram->low);
+	appendTextOutputText(stream, ", \"high\": ");
+	appendJSONOutputDouble(stream, histogram->high);
+	appendTextOutputText(stream, ", \"underflowCount\": ");
+	appendTextOutputUnsigned(stream, histogram->underflowCount);
+	appendTextOutputText(stream, ", \"overflowCount\": ");
+	appendTextOutputUnsigned(stream, histogram->overflowCount);
+	appendTextOutputText(stream, ", \"counts\": [");
+
+	for (size_t b = 0; b < kOutputHistogramNumberOfBins; b++)
+	{
+		appendTextOutputText(stream, (b == 0) ? "" : ", ");
+		appendTextOutputUnsigned(stream, histogram->counts[b]);
+	}
+
+	appendTextOutputText(stream, "]}");
+
+	return;
+}
+
+/*
+ *	Appends a flattened square matrix of the outputs as a result entry.
+ */
+static void
+appendOutputMatrixJSON(
+	TextOutputStream *	stream,
+	const char *		variableID,
+	const char *		variableDescription,
+	const double		matrix[kOutputDistributionIndexMax][kOutputDistributionIndexMax])
+{
+	appendTextOutputText(stream, ", {\"variableID\": ");
+	appendJSONOutputString(stream, variableID);
+	appendTextOutputText(stream, ", \"variableDescription\": ");
+	appendJSONOutputString(stream, variableDescription);
+	appendTextOutputText(stream, ", \"values\": ");
+	appendJSONOutputDoubleArray(stream, &matrix[0][0], kOutputDistributionIndexMax * kOutputDistributionIndexMax, 1);
+	appendTextOutputText(stream, "}");
+
+	return;
+}
+
+void
+printOutputJSONEnd(void)
+{
+	printf("}\n");
+	fflush(stdout);
+
+	return;
+}
+
+CommonConstantReturnType
+printMonteCarloOutputJSON(
+	const CommandLineArguments *	arguments,
+	double * const			monteCarloOutputSamples[kOutputDistributionIndexMax],
+	const JointOutputStatistics *	jointOutputStatistics,
+	const char **			outputVariableDescriptions)
+{
+	RunArenaMark			arenaMark = getRunArenaMark();
+	size_t				numberOfSamples = arguments->common.numberOfMonteCarloIterations;
+	MergeableOutputSummaries *	summaries = NULL;
+	double *			sortedSamples = NULL;
+	TextOutputStream		stream;
+	bool				isFirstResult = true;
+
+	if (!initializeTextOutputStream(&stream, STDOUT_FILENO))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	The moments and histogram are those of the mergeable summaries, with
+	 *	the histogram range taken from the first block of samples. Only the
+	 *	part that is printed is accumulated; the quantile sketches are only
+	 *	for sharded runs, since all samples are at hand here.
+	 */
+	if (arguments->jsonOutputContent != kJSONOutputContentSamples)
+	{
+		summaries = (MergeableOutputSummaries *) allocateFromRunArena(sizeof(MergeableOutputSummaries), kRunArenaDefaultAlignment);
+		sortedSamples = (arguments->jsonOutputContent == kJSONOutputContentSummary) ?
+					(double *) allocateFromRunArena(numberOfSamples * sizeof(double), kRunArenaDefaultAlignment) :
+					NULL;
+
+		if ((summaries == NULL) || ((arguments->jsonOutputContent == kJSONOutputContentSummary) && (sortedSamples == NULL)))
+		{
+			fprintf(stderr, "Error: Out of memory for the summaries of the JSON output.\n");
+			releaseRunArenaToMark(arenaMark);
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		initializeMergeableOutputSummaries(
+			summaries,
+			monteCarloOutputSamples,
+			(numberOfSamples < kMonteCarloBlockSize) ? numberOfSamples : kMonteCarloBlockSize);
+
+		for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+		{
+			for (size_t i = 0; (monteCarloOutputSamples[j] != NULL) && (i < numberOfSamples); i++)
+			{
+				if (arguments->jsonOutputContent == kJSONOutputContentSummary)
+				{
+					updateMomentAccumulator(&summaries->outputs[j].moments, monteCarloOutputSamples[j][i]);
+				}
+				else
+				{
+					updateOutputHistogram(&summaries->outputs[j].histogram, monteCarloOutputSamples[j][i]);
+				}
+			}
+		}
+	}
+
+	appendTextOutputText(&stream, "{\"description\": \"Output variables\", \"results\": [");
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		char	variableID[kCommonConstantMaxCharsPerJSONVariableSymbol];
+
+		if (monteCarloOutputSamples[j] == NULL)
+		{
+			continue;
+		}
+
+		snprintf(variableID, sizeof(variableID), "outputDistributions[%zu]", j);
+		appendTextOutputText(&stream, isFirstResult ? "{\"variableID\": " : ", {\"variableID\": ");
+		appendJSONOutputString(&stream, variableID);
+		appendTextOutputText(&stream, ", \"variableDescription\": ");
+		appendJSONOutputString(&stream, outputVariableDescriptions[j]);
+		appendTextOutputText(&stream, ", \"numberOfSamples\": ");
+		appendTextOutputUnsigned(&stream, numberOfSamples);
+		appendTextOutputText(&stream, ", ");
+
+		switch (arguments->jsonOutputContent)
+		{
+			case kJSONOutputContentSummary:
+				appendOutputSummaryJSON(&stream, &summaries->outputs[j], monteCarloOutputSamples[j], numberOfSamples, sortedSamples);
+				break;
+
+			case kJSONOutputContentHistogram:
+				appendOutputHistogramJSON(&stream, &summaries->outputs[j].histogram);
+				break;
+
+			default:
+				appendTextOutputText(&stream, "\"values\": ");
+				appendJSONOutputDoubleArray(
+					&stream,
+					monteCarloOutputSamples[j],
+					numberOfSamples,
+					arguments->isParallelMonteCarloMode ? arguments->numberOfThreads : 1);
+				break;
+		}
+
+		appendTextOutputText(&stream, "}");
+		isFirstResult = false;
+	}
+
+	if (jointOutputStatistics != NULL)
+	{
+		appendOutputMatrixJSON(&stream, "outputCovariance", "Output covariance matrix (row-major)", jointOutputStatistics->covariance);
+		appendOutputMatrixJSON(&stream, "outputCorrelation", "Output correlation matrix (row-major)", jointOutputStatistics->correlation);
+	}
+
+	appendTextOutputText(&stream, "]");
+	closeTextOutputStream(&stream);
+	releaseRunArenaToMark(arenaMark);
+
+	return stream.hasWriteFailed ? kCommonConstantReturnTypeError : kCommonConstantReturnTypeSuccess;
+}
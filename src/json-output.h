@@ -0,0 +1,95 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "text-output.h"
+#include "utilities.h"
+
+/*
+ *	JSON output of Monte Carlo runs, written through a text output stream
+ *	(see text-output.h) rather than stdio.
+ */
+
+/**
+ *	@brief	Name of a JSON output content, as given to the -J option.
+ *
+ *	@param	content	: The content.
+ *	@return		: The name.
+ */
+const char *	getJSONOutputContentName(JSONOutputContent content);
+
+/**
+ *	@brief	Appends a string as a quoted JSON string, escaping quotes, backslashes and control characters.
+ *
+ *	@param	stream	: The stream.
+ *	@param	string	: The string.
+ */
+void		appendJSONOutputString(TextOutputStream *  stream, const char *  string);
+
+/**
+ *	@brief	Appends a double in its shortest round-trip form, or `null` (JSON has no NaN or
+ *		infinity) if it is not finite.
+ *
+ *	@param	stream	: The stream.
+ *	@param	value	: The value.
+ */
+void		appendJSONOutputDouble(TextOutputStream *  stream, double value);
+
+/**
+ *	@brief	Appends an array of doubles, formatted by several threads if it is large.
+ *
+ *	@param	stream		: The stream.
+ *	@param	values		: The values.
+ *	@param	numberOfValues	: The number of values.
+ *	@param	numberOfThreads	: The number of threads to format with.
+ */
+void		appendJSONOutputDoubleArray(TextOutputStream *  stream, const double *  values, size_t numberOfValues, size_t numberOfThreads);
+
+/**
+ *	@brief	Closes the JSON object opened by `printMonteCarloOutputJSON()`.
+ */
+void		printOutputJSONEnd(void);
+
+/**
+ *	@brief	Prints the output variables of a Monte Carlo run to standard output as JSON, streaming
+ *		the samples (or, with the -J option, a summary or histogram of them instead). The
+ *		layout follows that of `printJSONFormattedOutput()`. In parallel Monte Carlo mode,
+ *		the samples are formatted by the same number of threads. The object is left open,
+ *		so that the timing and other reports can follow as members of it, and is closed by
+ *		`printOutputJSONEnd()`.
+ *
+ *	@param	arguments			: Pointer to the command-line arguments struct.
+ *	@param	monteCarloOutputSamples		: The per-output arrays of samples. `NULL` for outputs that are not calculated.
+ *	@param	jointOutputStatistics		: The covariance and correlation of the outputs, or `NULL` if not all are calculated.
+ *	@param	outputVariableDescriptions	: The output variable descriptions.
+ *	@return					: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	printMonteCarloOutputJSON(
+					const CommandLineArguments *	arguments,
+					double * const			monteCarloOutputSamples[kOutputDistributionIndexMax],
+					const JointOutputStatistics *	jointOutputStatistics,
+					const char **			outputVariableDescriptions);
@@ -0,0 +1,123 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "libfls110.h"
+
+/*
+ *	Example caller of the libfls110 library, which also checks it (`make -f
+ *	libfls110.mk check`): it sets input distributions and correlations, runs a
+ *	batch of samples of the mass flow, and estimates the probability that the
+ *	mass flow is greater than its mean. Only `libfls110.h` is included.
+ */
+
+enum
+{
+	kExampleNumberOfSamples	= 100000,
+};
+
+static int
+fail(const char *  message, Fls110Context *  context)
+{
+	fprintf(stderr, "Error: %s\n", message);
+	fls110DestroyContext(context);
+
+	return EXIT_FAILURE;
+}
+
+int
+main(void)
+{
+	Fls110Context *		context = NULL;
+	static double		massFlowSamples[kExampleNumberOfSamples];
+	double * const		outputSamples[kFls110OutputMax] = {[kFls110OutputMassFlow] = massFlowSamples};
+	Fls110OutputSummary	summaries[kFls110OutputMax];
+	double			probability;
+
+	if (fls110GetApiVersion() != kFls110ApiVersion)
+	{
+		return fail("The library does not match libfls110.h.", NULL);
+	}
+
+	if (fls110CreateContext(0x5EEDF1511000ULL, &context) != kFls110StatusSuccess)
+	{
+		return fail("Could not create a context.", NULL);
+	}
+
+	if ((fls110SetInputDistributions(context, "Tflow=gaussian:293.5:0.2,P0=400000:410000") != kFls110StatusSuccess) ||
+		(fls110SetInputCorrelations(context, "Tflow:T0=0.8") != kFls110StatusSuccess))
+	{
+		return fail(fls110GetErrorMessage(context), context);
+	}
+
+	/*
+	 *	Invalid assignments fail without changing the context, and are described.
+	 */
+	if ((fls110SetInputDistributions(context, "P0=lognormal:1:2") != kFls110StatusInvalidArgument) ||
+		(fls110GetErrorMessage(context)[0] == '\0'))
+	{
+		return fail("An invalid input distribution assignment was accepted.", context);
+	}
+
+	printf("Invalid assignment: %s\n", fls110GetErrorMessage(context));
+
+	if (fls110RunBatch(context, 0, kExampleNumberOfSamples, outputSamples, summaries) != kFls110StatusSuccess)
+	{
+		return fail("Could not run a batch.", context);
+	}
+
+	if ((summaries[kFls110OutputMassFlow].count != kExampleNumberOfSamples) ||
+		!isfinite(summaries[kFls110OutputMassFlow].mean) ||
+		(summaries[kFls110OutputDifferentialPressure].count != 0) ||
+		(summaries[kFls110OutputDifferentialPressure].minimum != 0.0))
+	{
+		return fail("The summaries of the batch are wrong.", context);
+	}
+
+	printf(
+		"Mass flow: mean %.6f sccm, standard deviation %.6f sccm, range [%.6f, %.6f] sccm\n",
+		summaries[kFls110OutputMassFlow].mean,
+		sqrt(summaries[kFls110OutputMassFlow].variance),
+		summaries[kFls110OutputMassFlow].minimum,
+		summaries[kFls110OutputMassFlow].maximum);
+
+	if ((fls110QueryProbability(
+			context,
+			kFls110OutputMassFlow,
+			summaries[kFls110OutputMassFlow].mean,
+			0,
+			kExampleNumberOfSamples,
+			&probability) != kFls110StatusSuccess) ||
+		!(probability > 0.0) || !(probability < 1.0))
+	{
+		return fail("Could not estimate a probability.", context);
+	}
+
+	printf("P(mass flow > mean) = %.5f\n", probability);
+	fls110DestroyContext(context);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,374 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "input-correlations.h"
+#include "input-distributions.h"
+#include "libfls110.h"
+#include "mergeable-statistics.h"
+#include "samplers.h"
+#include "sensor-calibration.h"
+
+/*
+ *	The public enumerations are those of the tree, so that they convert by value.
+ */
+_Static_assert((int)kFls110InputMax == (int)kInputDistributionIndexMax, "Fls110Input must match InputDistributionIndex");
+_Static_assert((int)kFls110OutputMax == (int)kOutputDistributionIndexMax, "Fls110Output must match OutputDistributionIndex");
+_Static_assert((int)kFls110FamilyMax == (int)kInputDistributionFamilyMax, "Fls110Family must match InputDistributionFamily");
+
+/*
+ *	The distributions, correlations and seed of a context, the description of
+ *	its last invalid assignments, and its block of inputs and block of outputs
+ *	for the samples that are not kept.
+ */
+struct Fls110Context
+{
+	uint64_t			seed;
+	InputDistributionSpecification	inputDistributions[kInputDistributionIndexMax];
+	InputCorrelationSpecification	inputCorrelations;
+	char				errorMessage[kInputAssignmentErrorMessageBytes];
+	double				inputDistributionBlock[kMonteCarloBlockSize][kInputDistributionIndexMax];
+	double				outputBlock[kMonteCarloBlockSize];
+};
+
+/*
+ *	Samples the inputs of a block of at most `kMonteCarloBlockSize` samples
+ *	into the block of inputs of a context.
+ */
+static void
+sampleContextInputDistributions(Fls110Context *  context, uint64_t firstSampleIndex, size_t numberOfSamples)
+{
+	const InputDistributionSpecification *	specifications[kInputDistributionIndexMax];
+
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		specifications[k] = &context->inputDistributions[k];
+	}
+
+	sampleGivenInputDistributionsCounterBased(
+		specifications,
+		&context->inputCorrelations,
+		context->seed,
+		firstSampleIndex,
+		context->inputDistributionBlock,
+		numberOfSamples);
+
+	return;
+}
+
+uint32_t
+fls110GetApiVersion(void)
+{
+	return kFls110ApiVersion;
+}
+
+Fls110Status
+fls110CreateContext(uint64_t seed, Fls110Context **  context)
+{
+	Fls110Context *	newContext;
+
+	if (context == NULL)
+	{
+		return kFls110StatusInvalidArgument;
+	}
+
+	newContext = calloc(1, sizeof(*newContext));
+
+	if (newContext == NULL)
+	{
+		return kFls110StatusOutOfMemory;
+	}
+
+	newContext->seed = seed;
+	getInputDistributionSpecifications(newContext->inputDistributions);
+
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		newContext->inputCorrelations.correlations[k][k] = 1.0;
+	}
+
+	prepareInputCorrelationSpecification(&newContext->inputCorrelations);
+	*context = newContext;
+
+	return kFls110StatusSuccess;
+}
+
+void
+fls110DestroyContext(Fls110Context *  context)
+{
+	free(context);
+
+	return;
+}
+
+Fls110Status
+fls110SetInputDistribution(
+	Fls110Context *	context,
+	Fls110Input	input,
+	Fls110Family	family,
+	const double *	parameters,
+	size_t		numberOfParameters)
+{
+	if ((context == NULL) || (input >= kFls110InputMax) ||
+		(setInputDistributionSpecificationOfParameters(
+			&context->inputDistributions[input],
+			(InputDistributionFamily)family,
+			parameters,
+			numberOfParameters) != kCommonConstantReturnTypeSuccess))
+	{
+		return kFls110StatusInvalidArgument;
+	}
+
+	return kFls110StatusSuccess;
+}
+
+Fls110Status
+fls110SetInputDistributions(Fls110Context *  context, const char *  assignments)
+{
+	char *				assignmentsCopy;
+	CommonConstantReturnType	result;
+
+	if ((context == NULL) || (assignments == NULL))
+	{
+		return kFls110StatusInvalidArgument;
+	}
+
+	context->errorMessage[0] = '\0';
+
+	/*
+	 *	The parser modifies its argument.
+	 */
+	assignmentsCopy = strdup(assignments);
+
+	if (assignmentsCopy == NULL)
+	{
+		return kFls110StatusOutOfMemory;
+	}
+
+	result = applyInputDistributionAssignments(assignmentsCopy, context->inputDistributions, context->errorMessage, sizeof(context->errorMessage));
+	free(assignmentsCopy);
+
+	return (result == kCommonConstantReturnTypeSuccess) ? kFls110StatusSuccess : kFls110StatusInvalidArgument;
+}
+
+Fls110Status
+fls110SetInputCorrelationMatrix(Fls110Context *  context, const double correlations[kFls110InputMax * kFls110InputMax])
+{
+	InputCorrelationSpecification	specification = {0};
+
+	if (context == NULL)
+	{
+		return kFls110StatusInvalidArgument;
+	}
+
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		for (size_t m = 0; m < kInputDistributionIndexMax; m++)
+		{
+			specification.correlations[k][m] = (correlations != NULL) ? correlations[k * kInputDistributionIndexMax + m] : (double)(k == m);
+		}
+	}
+
+	if (prepareInputCorrelationSpecification(&specification) != kCommonConstantReturnTypeSuccess)
+	{
+		return kFls110StatusInvalidArgument;
+	}
+
+	context->inputCorrelations = specification;
+
+	return kFls110StatusSuccess;
+}
+
+Fls110Status
+fls110SetInputCorrelations(Fls110Context *  context, const char *  assignments)
+{
+	char *				assignmentsCopy;
+	CommonConstantReturnType	result;
+
+	if ((context == NULL) || (assignments == NULL))
+	{
+		return kFls110StatusInvalidArgument;
+	}
+
+	context->errorMessage[0] = '\0';
+	assignmentsCopy = strdup(assignments);
+
+	if (assignmentsCopy == NULL)
+	{
+		return kFls110StatusOutOfMemory;
+	}
+
+	result = parseInputCorrelationSpecification(assignmentsCopy, &context->inputCorrelations, context->errorMessage, sizeof(context->errorMessage));
+	free(assignmentsCopy);
+
+	return (result == kCommonConstantReturnTypeSuccess) ? kFls110StatusSuccess : kFls110StatusInvalidArgument;
+}
+
+const char *
+fls110GetErrorMessage(const Fls110Context *  context)
+{
+	return (context != NULL) ? context->errorMessage : "";
+}
+
+Fls110Status
+fls110RunBatch(
+	Fls110Context *		context,
+	uint64_t		firstSampleIndex,
+	size_t			numberOfSamples,
+	double * const		outputSamples[kFls110OutputMax],
+	Fls110OutputSummary	summaries[kFls110OutputMax])
+{
+	MomentAccumulator	moments[kOutputDistributionIndexMax];
+	size_t			outputSelect;
+	SensorOutputBlockKernel	kernel;
+
+	if ((context == NULL) || (outputSamples == NULL) ||
+		((outputSamples[kOutputDistributionIndexCalibratedMassFlowOutput] == NULL) &&
+		 (outputSamples[kOutputDistributionIndexCalibratedDifferentialPressureOutput] == NULL)))
+	{
+		return kFls110StatusInvalidArgument;
+	}
+
+	if (outputSamples[kOutputDistributionIndexCalibratedMassFlowOutput] == NULL)
+	{
+		outputSelect = kOutputDistributionIndexCalibratedDifferentialPressureOutput;
+	}
+	else if (outputSamples[kOutputDistributionIndexCalibratedDifferentialPressureOutput] == NULL)
+	{
+		outputSelect = kOutputDistributionIndexCalibratedMassFlowOutput;
+	}
+	else
+	{
+		outputSelect = kOutputDistributionIndexMax;
+	}
+
+	kernel = getSensorOutputBlockKernel(outputSelect);
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		moments[j] = (MomentAccumulator){.minimum = INFINITY, .maximum = -INFINITY};
+	}
+
+	for (size_t blockStart = 0; blockStart < numberOfSamples; blockStart += kMonteCarloBlockSize)
+	{
+		size_t		blockLength = ((numberOfSamples - blockStart) < kMonteCarloBlockSize) ? (numberOfSamples - blockStart) : kMonteCarloBlockSize;
+		double *	blockOutputSamples[kOutputDistributionIndexMax];
+
+		sampleContextInputDistributions(context, firstSampleIndex + blockStart, blockLength);
+
+		for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+		{
+			blockOutputSamples[j] = (outputSamples[j] != NULL) ? &outputSamples[j][blockStart] : NULL;
+		}
+
+		kernel((const double (*)[kInputDistributionIndexMax])context->inputDistributionBlock, blockOutputSamples, blockLength);
+
+		if (summaries == NULL)
+		{
+			continue;
+		}
+
+		for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+		{
+			if (blockOutputSamples[j] == NULL)
+			{
+				continue;
+			}
+
+			for (size_t i = 0; i < blockLength; i++)
+			{
+				updateMomentAccumulator(&moments[j], blockOutputSamples[j][i]);
+			}
+		}
+	}
+
+	if (summaries == NULL)
+	{
+		return kFls110StatusSuccess;
+	}
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		double	skewness;
+		double	excessKurtosis;
+
+		if (moments[j].count == 0)
+		{
+			summaries[j] = (Fls110OutputSummary){0};
+
+			continue;
+		}
+
+		summaries[j] = (Fls110OutputSummary){
+					.count = moments[j].count,
+					.mean = moments[j].mean,
+					.minimum = moments[j].minimum,
+					.maximum = moments[j].maximum,
+				};
+		getMomentAccumulatorStatistics(&moments[j], &summaries[j].variance, &skewness, &excessKurtosis);
+	}
+
+	return kFls110StatusSuccess;
+}
+
+Fls110Status
+fls110QueryProbability(
+	Fls110Context *	context,
+	Fls110Output	output,
+	double		threshold,
+	uint64_t	firstSampleIndex,
+	size_t		numberOfSamples,
+	double *	probability)
+{
+	double *		blockOutputSamples[kOutputDistributionIndexMax] = {NULL};
+	SensorOutputBlockKernel	kernel;
+	uint64_t		count = 0;
+
+	if ((context == NULL) || (output >= kFls110OutputMax) || (numberOfSamples == 0) || (probability == NULL))
+	{
+		return kFls110StatusInvalidArgument;
+	}
+
+	kernel = getSensorOutputBlockKernel(output);
+	blockOutputSamples[output] = context->outputBlock;
+
+	for (size_t blockStart = 0; blockStart < numberOfSamples; blockStart += kMonteCarloBlockSize)
+	{
+		size_t	blockLength = ((numberOfSamples - blockStart) < kMonteCarloBlockSize) ? (numberOfSamples - blockStart) : kMonteCarloBlockSize;
+
+		sampleContextInputDistributions(context, firstSampleIndex + blockStart, blockLength);
+		kernel((const double (*)[kInputDistributionIndexMax])context->inputDistributionBlock, blockOutputSamples, blockLength);
+
+		for (size_t i = 0; i < blockLength; i++)
+		{
+			count += (context->outputBlock[i] > threshold);
+		}
+	}
+
+	*probability = (double)count / (double)numberOfSamples;
+
+	return kFls110StatusSuccess;
+}
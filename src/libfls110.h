@@ -0,0 +1,261 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#pragma once
+
+/*
+ *	libfls110: the FLS110 sensor calibration as a library, for callers that
+ *	calibrate in-process instead of running the command line tool for every
+ *	query. This header is the whole public interface. It depends on no other
+ *	header of the tree, and its types and values only ever gain new members,
+ *	so that code built against one version keeps working with later ones.
+ *
+ *	Every context owns its own input distributions, correlations and seed, so
+ *	different contexts may be used from different threads at the same time.
+ *	A single context must not be used from two threads at the same time.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ *	Version of the interface, returned by `fls110GetApiVersion()`.
+ */
+#define kFls110ApiVersion	(2)
+
+/*
+ *	The functions of the interface are the only symbols that the library
+ *	exports: it is built with hidden visibility by default (libfls110.mk).
+ */
+#if defined(__GNUC__)
+#define FLS110_EXPORT	__attribute__((visibility("default")))
+#else
+#define FLS110_EXPORT
+#endif
+
+/*
+ *	Opaque calibration context.
+ */
+typedef struct Fls110Context	Fls110Context;
+
+typedef enum
+{
+	kFls110StatusSuccess		= 0,
+	kFls110StatusInvalidArgument	= 1,
+	kFls110StatusOutOfMemory	= 2,
+} Fls110Status;
+
+/*
+ *	Inputs of the calibration, as in the input distribution assignments of
+ *	the command line tool (-I option).
+ */
+typedef enum
+{
+	kFls110InputHxfer		= 0,
+	kFls110InputTflow		= 1,
+	kFls110InputT0			= 2,
+	kFls110InputPflow		= 3,
+	kFls110InputP0			= 4,
+	kFls110InputMax,
+} Fls110Input;
+
+/*
+ *	Outputs of the calibration: mass flow (in sccm) and differential pressure
+ *	(in Pascal).
+ */
+typedef enum
+{
+	kFls110OutputMassFlow			= 0,
+	kFls110OutputDifferentialPressure	= 1,
+	kFls110OutputMax,
+} Fls110Output;
+
+/*
+ *	Families of input distributions, with their parameters in order:
+ *		kFls110FamilyUniform		: low, high.
+ *		kFls110FamilyGaussian		: mean, standard deviation.
+ *		kFls110FamilyTruncatedGaussian	: mean, standard deviation, low, high.
+ *		kFls110FamilyTriangular		: low, mode, high.
+ *		kFls110FamilyHistogram		: low, high, then the weight of every equal-width bin (at most 64).
+ */
+typedef enum
+{
+	kFls110FamilyUniform		= 0,
+	kFls110FamilyGaussian		= 1,
+	kFls110FamilyTruncatedGaussian	= 2,
+	kFls110FamilyTriangular		= 3,
+	kFls110FamilyHistogram		= 4,
+	kFls110FamilyMax,
+} Fls110Family;
+
+/*
+ *	Summary of the samples of an output of a batch.
+ */
+typedef struct
+{
+	uint64_t	count;
+	double		mean;
+	double		variance;
+	double		minimum;
+	double		maximum;
+} Fls110OutputSummary;
+
+/**
+ *	@brief	Version of the interface of the library.
+ *
+ *	@return	: `kFls110ApiVersion` of the library.
+ */
+FLS110_EXPORT uint32_t		fls110GetApiVersion(void);
+
+/**
+ *	@brief	Creates a context, with the default input distributions of the command line tool
+ *		and independent inputs.
+ *
+ *	@param	seed	: The seed of the random stream of the context.
+ *	@param	context	: Output. The context.
+ *	@return		: `kFls110StatusSuccess`, or `kFls110StatusOutOfMemory`.
+ */
+FLS110_EXPORT Fls110Status	fls110CreateContext(uint64_t seed, Fls110Context **  context);
+
+/**
+ *	@brief	Destroys a context.
+ *
+ *	@param	context	: The context, or `NULL`.
+ */
+FLS110_EXPORT void		fls110DestroyContext(Fls110Context *  context);
+
+/**
+ *	@brief	Sets the distribution of an input of a context.
+ *
+ *	@param	context			: The context.
+ *	@param	input			: The input.
+ *	@param	family			: The family of the distribution.
+ *	@param	parameters		: The parameters of the family, in the order of `Fls110Family`.
+ *	@param	numberOfParameters	: The number of parameters.
+ *	@return				: `kFls110StatusSuccess`, or `kFls110StatusInvalidArgument` if the
+ *					  parameters are invalid, in which case the context is unchanged.
+ */
+FLS110_EXPORT Fls110Status	fls110SetInputDistribution(
+			Fls110Context *	context,
+			Fls110Input	input,
+			Fls110Family	family,
+			const double *	parameters,
+			size_t		numberOfParameters);
+
+/**
+ *	@brief	Sets input distributions of a context from assignments in the syntax of the -I
+ *		option of the command line tool, for example `Tflow=gaussian:293.5:0.2,P0=400000:410000`.
+ *		On error, `fls110GetErrorMessage()` describes the invalid assignment.
+ *
+ *	@param	context		: The context.
+ *	@param	assignments	: The assignments.
+ *	@return			: `kFls110StatusSuccess`, or `kFls110StatusInvalidArgument` if an assignment
+ *				  is invalid, in which case the context is unchanged.
+ */
+FLS110_EXPORT Fls110Status	fls110SetInputDistributions(Fls110Context *  context, const char *  assignments);
+
+/**
+ *	@brief	Sets the correlation matrix of the Gaussian copula of the inputs of a context.
+ *
+ *	@param	context		: The context.
+ *	@param	correlations	: The symmetric, positive definite matrix, in row-major order indexed by
+ *				  `Fls110Input`, with a unit diagonal. `NULL` for independent inputs.
+ *	@return			: `kFls110StatusSuccess`, or `kFls110StatusInvalidArgument` if the matrix
+ *				  is invalid, in which case the context is unchanged.
+ */
+FLS110_EXPORT Fls110Status	fls110SetInputCorrelationMatrix(Fls110Context *  context, const double correlations[kFls110InputMax * kFls110InputMax]);
+
+/**
+ *	@brief	Sets the correlations of the inputs of a context from pairwise correlations in the
+ *		syntax of the -K option of the command line tool, for example `Tflow:T0=0.8`. Pairs
+ *		without a correlation are uncorrelated. On error, `fls110GetErrorMessage()` describes
+ *		the invalid correlations.
+ *
+ *	@param	context		: The context.
+ *	@param	assignments	: The correlations.
+ *	@return			: `kFls110StatusSuccess`, or `kFls110StatusInvalidArgument` if a correlation
+ *				  is invalid, in which case the context is unchanged.
+ */
+FLS110_EXPORT Fls110Status	fls110SetInputCorrelations(Fls110Context *  context, const char *  assignments);
+
+/**
+ *	@brief	Describes why the last call of `fls110SetInputDistributions()` or
+ *		`fls110SetInputCorrelations()` on a context failed.
+ *
+ *	@param	context	: The context.
+ *	@return		: The description, owned by the context and valid until its next call, or an empty
+ *			  string if that call succeeded or there was none.
+ */
+FLS110_EXPORT const char *	fls110GetErrorMessage(const Fls110Context *  context);
+
+/**
+ *	@brief	Runs a batch of Monte Carlo samples of the calibration into caller-provided arrays.
+ *		The inputs of every sample are a function of the seed of the context and of the
+ *		index of the sample only, so a batch can be repeated, or split across calls and
+ *		contexts with the same seed and distributions, with the same results.
+ *
+ *	@param	context			: The context.
+ *	@param	firstSampleIndex	: The index of the first sample of the batch.
+ *	@param	numberOfSamples		: The number of samples.
+ *	@param	outputSamples		: Per-output arrays of at least `numberOfSamples` entries, indexed by
+ *					  `Fls110Output`. Only the outputs with a non-`NULL` array are calculated.
+ *	@param	summaries		: Output. The summaries of the samples of every output, all zero
+ *					  for outputs that are not calculated. `NULL` to skip them.
+ *	@return				: `kFls110StatusSuccess`, or `kFls110StatusInvalidArgument` if no output
+ *					  is calculated.
+ */
+FLS110_EXPORT Fls110Status	fls110RunBatch(
+			Fls110Context *		context,
+			uint64_t		firstSampleIndex,
+			size_t			numberOfSamples,
+			double * const		outputSamples[kFls110OutputMax],
+			Fls110OutputSummary	summaries[kFls110OutputMax]);
+
+/**
+ *	@brief	Estimates the probability that an output is greater than a threshold, from a batch of
+ *		Monte Carlo samples that are drawn as by `fls110RunBatch()` but not kept.
+ *
+ *	@param	context			: The context.
+ *	@param	output			: The output.
+ *	@param	threshold		: The threshold.
+ *	@param	firstSampleIndex	: The index of the first sample of the batch.
+ *	@param	numberOfSamples		: The number of samples, at least one.
+ *	@param	probability		: Output. The fraction of the samples greater than `threshold`.
+ *	@return				: `kFls110StatusSuccess`, or `kFls110StatusInvalidArgument`.
+ */
+FLS110_EXPORT Fls110Status	fls110QueryProbability(
+			Fls110Context *	context,
+			Fls110Output	output,
+			double		threshold,
+			uint64_t	firstSampleIndex,
+			size_t		numberOfSamples,
+			double *	probability);
+
+#ifdef __cplusplus
+}
+#endif
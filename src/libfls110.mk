@@ -0,0 +1,71 @@
+#
+#	Builds the libfls110 library (libfls110.so and libfls110.a) from the
+#	modules that its interface needs, and checks it with an example caller.
+#	Only the functions of libfls110.h are global symbols of either library:
+#	everything is compiled with hidden visibility, and the objects of the
+#	static library are first linked into one object whose hidden symbols are
+#	then made local. Unused sections (such as the runners of the command line
+#	modes in the linked modules) are dropped, so the library does not use the
+#	run arena of the command line tool.
+#
+#	Usage, from src/:
+#		make -f libfls110.mk
+#		make -f libfls110.mk check
+#		make -f libfls110.mk clean
+#
+
+CC		?= gcc
+LD		?= ld
+OBJCOPY		?= objcopy
+CFLAGS		?= -O3
+LIBFLS110_CFLAGS	= -std=gnu11 -fPIC -fvisibility=hidden -ffunction-sections -fdata-sections -I.
+LIBFLS110_LDFLAGS	= -shared -Wl,--gc-sections -Wl,--no-undefined
+LIBFLS110_LDLIBS	= -lm -lpthread
+
+LIBFLS110_SOURCES	=\
+	libfls110.c\
+	sensor-calibration.c\
+	samplers.c\
+	input-distributions.c\
+	input-correlations.c\
+	normal-distribution.c\
+	importance-sampling.c\
+	particle-distribution.c\
+	mergeable-statistics.c\
+	common.c\
+
+LIBFLS110_OBJECTS	= $(LIBFLS110_SOURCES:%.c=libfls110-objects/%.o)
+
+#
+#	The roots of the unused-section removal of the static library.
+#
+LIBFLS110_API_SYMBOLS	= $(shell sed -n 's/^FLS110_EXPORT.*[[:space:]]\(fls110[A-Za-z]*\).*/\1/p' libfls110.h)
+
+all: libfls110.so libfls110.a
+
+libfls110.so: $(LIBFLS110_OBJECTS)
+	$(CC) $(LIBFLS110_LDFLAGS) -o $@ $^ $(LIBFLS110_LDLIBS)
+
+libfls110.a: $(LIBFLS110_OBJECTS)
+	$(LD) -r --gc-sections $(LIBFLS110_API_SYMBOLS:%=-u %) -o libfls110-objects/libfls110-combined.o $^
+	$(OBJCOPY) --localize-hidden libfls110-objects/libfls110-combined.o
+	rm -f $@
+	$(AR) rcs $@ libfls110-objects/libfls110-combined.o
+
+libfls110-objects/%.o: %.c
+	@mkdir -p libfls110-objects
+	$(CC) $(CFLAGS) $(LIBFLS110_CFLAGS) -c -o $@ $<
+
+#
+#	Runs the example caller against both libraries.
+#
+check: libfls110.so libfls110.a
+	$(CC) $(CFLAGS) -std=gnu11 -o libfls110-objects/libfls110-example-shared libfls110-example.c -L. -lfls110 -Wl,-rpath,'$$ORIGIN/..' $(LIBFLS110_LDLIBS)
+	$(CC) $(CFLAGS) -std=gnu11 -o libfls110-objects/libfls110-example-static libfls110-example.c libfls110.a $(LIBFLS110_LDLIBS)
+	./libfls110-objects/libfls110-example-shared
+	./libfls110-objects/libfls110-example-static
+
+clean:
+	rm -rf libfls110-objects libfls110.so libfls110.a
+
+.PHONY: all check clean
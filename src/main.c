@@ -20,249 +20,555 @@
  *	SOFTWARE.
  */
 
-#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
 #include <stddef.h>
 #include <stdbool.h>
 #include <inttypes.h>
 #include <uxhw.h>
 #include "utilities.h"
+#include "convergence.h"
+#include "timing.h"
+#include "perf-counters.h"
+#include "input-distributions.h"
+#include "samplers.h"
+#include "sensor-calibration.h"
+#include "wasserstein.h"
+#include "sharding.h"
+#include "parallel-monte-carlo.h"
+#include "run-arena.h"
+#include "distribution-table.h"
+#include "compressed-output.h"
+#include "particle-distribution.h"
+#include "product-distribution.h"
+#include "common-random-numbers.h"
+#include "sample-reweighting.h"
+#include "json-output.h"
 
 /**
- *	@brief  Sensor calibration routines taken from the screenshot on page 6 of
- *		FL-000986-TN-7, 2022-01-30.
+ *	@brief  Updates the convergence monitors of the calculated outputs with one block of
+ *		Monte Carlo samples.
  *
- *	@param  arguments		: Pointer to command line arguments struct.
- *	@param  inputDistributions	: The array of input distributions used in the calculation.
- * 	@param  outputDistributions	: An array of of output distributions. Writes the result to `outputDistributions[outputSelectValue]`.
+ *	@param  convergenceMonitors		: The per-output convergence monitors.
+ *	@param  monteCarloOutputSamples		: The per-output arrays of data samples of Monte Carlo.
+ *	@param  outputSelect			: The output select value (`-S` option).
+ *	@param  blockStart			: Index of the first sample of the block.
+ *	@param  blockLength			: Number of samples in the block.
  *
- *	@return	double			: Returns the distributional value calculated.
+ *	@return	bool				: `true` if the estimates of all calculated outputs have converged.
  */
-static double
-calculateSensorOutput(CommandLineArguments *  arguments, double *  inputDistributions, double *  outputDistributions)
+static bool
+updateConvergenceMonitors(
+	ConvergenceMonitor *	convergenceMonitors,
+	double *		monteCarloOutputSamples[kOutputDistributionIndexMax],
+	size_t			outputSelect,
+	size_t			blockStart,
+	size_t			blockLength)
 {
-	double	calibratedValue;
-	double	m;
-	double	h;
+	bool	haveAllConverged = true;
 
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		if ((outputSelect == kOutputDistributionIndexMax) || (j == outputSelect))
+		{
+			updateConvergenceMonitor(&convergenceMonitors[j], &monteCarloOutputSamples[j][blockStart], blockLength);
+			haveAllConverged = haveAllConverged && hasConvergenceMonitorConverged(&convergenceMonitors[j]);
+		}
+	}
+
+	return haveAllConverged;
+}
+
+/*
+ *	Buffers of a Monte Carlo run. A scenario batch allocates them once and
+ *	reuses them for all its scenarios.
+ */
+typedef struct
+{
+	double *	monteCarloOutputSamples[kOutputDistributionIndexMax];
+	double		(*inputDistributionBlock)[kInputDistributionIndexMax];
+	double *	importanceWeightBlock;
+} MonteCarloBuffers;
+
+/**
+ *	@brief  Allocates the buffers of a Monte Carlo run from the run arena.
+ *
+ *	@param  arguments	: The command line arguments.
+ *	@param  buffers		: Output. The buffers.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+allocateMonteCarloBuffers(const CommandLineArguments *  arguments, MonteCarloBuffers *  buffers)
+{
 	bool	calculateAllOutputs = (arguments->common.outputSelect == kOutputDistributionIndexMax);
+	size_t	blockCapacity;
 
-	h = inputDistributions[kInputDistributionIndexHxfer];
+	*buffers = (MonteCarloBuffers) {0};
 
 	/*
-	 *	The calculation of mass flow is common in the two output calculations.
+	 *	Monte Carlo samples are stored in structure-of-arrays layout, one
+	 *	array per output. When all outputs are selected, both arrays are
+	 *	filled in the same pass, since they share the mass flow calculation.
 	 */
-	m = kSensorCalibrationConstant3 * pow(h, 3) + kSensorCalibrationConstant2 * pow(h, 2) + kSensorCalibrationConstant1;
+	if (arguments->common.isMonteCarloMode)
+	{
+		for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+		{
+			if ((calculateAllOutputs || (j == arguments->common.outputSelect)) && arguments->isParallelMonteCarloMode)
+			{
+				buffers->monteCarloOutputSamples[j] = allocateParallelMonteCarloSampleArray(arguments->common.numberOfMonteCarloIterations);
+			}
+			else if (calculateAllOutputs || (j == arguments->common.outputSelect))
+			{
+				buffers->monteCarloOutputSamples[j] = (double *) allocateFromRunArena(
+										arguments->common.numberOfMonteCarloIterations * sizeof(double),
+										kRunArenaDefaultAlignment);
+			}
 
-	if (calculateAllOutputs ||
-		(arguments->common.outputSelect == kOutputDistributionIndexCalibratedMassFlowOutput))
-	{		
-		calibratedValue = m;
+			if ((calculateAllOutputs || (j == arguments->common.outputSelect)) && (buffers->monteCarloOutputSamples[j] == NULL))
+			{
+				fprintf(stderr, "Error: Out of memory for %zu Monte Carlo samples.\n", arguments->common.numberOfMonteCarloIterations);
 
-		outputDistributions[kOutputDistributionIndexCalibratedMassFlowOutput] = calibratedValue;
+				return kCommonConstantReturnTypeError;
+			}
+		}
 	}
-		
-	if (calculateAllOutputs ||
-		arguments->common.outputSelect == kOutputDistributionIndexCalibratedDifferentialPressureOutput)
+
+	/*
+	 *	Each block of iterations first sets the input distributions of all its
+	 *	iterations and then runs the kernel on them, so that the timer can
+	 *	account the sampling and kernel phases separately.
+	 */
+	blockCapacity = (arguments->common.numberOfMonteCarloIterations < kMonteCarloBlockSize) ?
+				arguments->common.numberOfMonteCarloIterations :
+				kMonteCarloBlockSize;
+	buffers->inputDistributionBlock = allocateFromRunArena(
+						blockCapacity * sizeof(*buffers->inputDistributionBlock),
+						kRunArenaDefaultAlignment);
+
+	if (arguments->isImportanceSamplingMode)
 	{
-		double	Tflow;
-		double	T0;
-		double	Pflow;
-		double	P0;
-		
-		Tflow = inputDistributions[kInputDistributionIndexTflow];
-		T0 = inputDistributions[kInputDistributionIndexT0];
-		Pflow = inputDistributions[kInputDistributionIndexPflow];
-		P0 = inputDistributions[kInputDistributionIndexP0];
+		buffers->importanceWeightBlock = (double *) allocateFromRunArena(blockCapacity * sizeof(double), kRunArenaDefaultAlignment);
+	}
+
+	if ((buffers->inputDistributionBlock == NULL) || (arguments->isImportanceSamplingMode && (buffers->importanceWeightBlock == NULL)))
+	{
+		fprintf(stderr, "Error: Out of memory for the input buffers.\n");
 
-		calibratedValue = m * (Tflow/T0) * (P0/Pflow);
-		outputDistributions[kOutputDistributionIndexCalibratedDifferentialPressureOutput] = calibratedValue;
+		return kCommonConstantReturnTypeError;
 	}
 
-	return	calibratedValue;
+	return kCommonConstantReturnTypeSuccess;
 }
 
 /**
- *	@brief  Sets the Input Distributions via call to UxHw Parametric function.
+ *	@brief  Runs the kernel on the -M iterations (or once, with distributions on Signaloid
+ *		platforms) with the current input distributions, and prints and writes the outputs.
+ *		In compressed output mode, opens and closes the compressed output writer, which it
+ *		leaves open if it fails in between.
  *
- *	@param  inputDistributions	: An array of double values, where the function writes the distributional data.
+ *	@param  arguments			: The command line arguments. Adaptive Monte Carlo sets the
+ *						  number of iterations to the number it used.
+ *	@param  buffers				: The buffers, from `allocateMonteCarloBuffers()`.
+ *	@param  compressedOutputWriter		: The compressed output writer, zero-initialized.
+ *	@param  outputVariableNames		: The output variable descriptions.
+ *	@param  unitsOfMeasurement		: The units of measurement of the outputs.
+ *	@return					: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
  */
-static void
-setInputDistributionsViaUxHwCall(double *  inputDistributions)
-{
-	inputDistributions[kInputDistributionIndexHxfer] = UxHwDoubleUniformDist(
-								kDefaultInputDistributionHxferUniformDistLow,
-								kDefaultInputDistributionHxferUniformDistHigh);
-
-	inputDistributions[kInputDistributionIndexTflow] = UxHwDoubleUniformDist(
-								kDefaultInputDistributionTflowUniformDistLow,
-								kDefaultInputDistributionTflowUniformDistHigh);
-
-	inputDistributions[kInputDistributionIndexT0] = UxHwDoubleUniformDist(
-								kDefaultInputDistributionT0UniformDistLow,
-								kDefaultInputDistributionT0UniformDistHigh);
-
-	inputDistributions[kInputDistributionIndexPflow] = UxHwDoubleUniformDist(
-								kDefaultInputDistributionPflowUniformDistLow,
-								kDefaultInputDistributionPflowUniformDistHigh);
-
-	inputDistributions[kInputDistributionIndexP0] = UxHwDoubleUniformDist(
-								kDefaultInputDistributionP0UniformDistLow,
-								kDefaultInputDistributionP0UniformDistHigh);
-	return;
-}
-
-int
-main(int argc, char *  argv[])
+static CommonConstantReturnType
+runMonteCarloWithCompressedOutputWriter(
+	CommandLineArguments *		arguments,
+	MonteCarloBuffers *		buffers,
+	CompressedOutputWriter *	compressedOutputWriter,
+	const char **			outputVariableNames,
+	const char **			unitsOfMeasurement)
 {
-	CommandLineArguments	arguments = {0};
-
-	double			calibratedSensorOutput;
-	double *		monteCarloOutputSamples = NULL;
-	clock_t			start;
-	clock_t			end;
-	double			cpuTimeUsedSeconds;
-	double			inputDistributions[kInputDistributionIndexMax];
+	SensorOutputKernel	sensorOutputKernel;
+	SensorOutputBlockKernel	sensorOutputBlockKernel;
+	double			calibratedSensorOutput = 0.0;
+	bool			calculateAllOutputs;
+	double **		monteCarloOutputSamples = buffers->monteCarloOutputSamples;
+	PhaseTimer		phaseTimer;
+	PerfCounters		perfCounters = {0};
+	uint64_t		cpuTimeUsedInMicroSeconds;
+	double			(*inputDistributionBlock)[kInputDistributionIndexMax] = buffers->inputDistributionBlock;
+	double *		importanceWeightBlock = buffers->importanceWeightBlock;
 	double			outputDistributions[kOutputDistributionIndexMax];
-	const char *		outputVariableNames[kOutputDistributionIndexMax] =
-				{
-					"Calibrated Mass Flow",
-					"Calibrated Differential Pressure",
-				};
-	const char *		unitsOfMeasurement[] =
-				{
-					[kOutputDistributionIndexCalibratedMassFlowOutput]		= "sccm",
-					[kOutputDistributionIndexCalibratedDifferentialPressureOutput]	= "Pa",
-				};
 	MeanAndVariance		meanAndVariance;
+	JointOutputStatistics	jointOutputStatistics;
+	ConvergenceMonitor	convergenceMonitors[kOutputDistributionIndexMax];
+	bool			hasConverged = false;
+	ExponentialTilt		importanceSamplingTilt;
+	TailProbabilityEstimator	tailProbabilityEstimator;
+	ParallelMonteCarloReport	parallelMonteCarloReport;
+	bool				isJSONResultsObjectOpen;
+	bool				isJSONReportsObjectNeeded;
+	FILE *				jsonReportsFile;
 
 	/*
-	 *	Get command line arguments.
+	 *	A tail probability is exactly 0 or 1 when the interval of the output
+	 *	over the input bounds is entirely on one side of the threshold. Only
+	 *	thresholds inside the interval are sampled.
 	 */
-	if (getCommandLineArguments(argc, argv, &arguments))
+	if (arguments->isImportanceSamplingMode)
 	{
-		return kCommonConstantReturnTypeError;
+		double				inputLows[kInputDistributionIndexMax];
+		double				inputHighs[kInputDistributionIndexMax];
+		double				outputLow;
+		double				outputHigh;
+		ThresholdIntervalDecision	decision;
+
+		/*
+		 *	The exponential tilt replaces a uniform heat power transfer.
+		 */
+		if (getInputDistributionSpecification(kInputDistributionIndexHxfer)->family != kInputDistributionFamilyUniform)
+		{
+			fprintf(stderr, "Error: Importance sampling (-t option) requires a uniform distribution of Hxfer.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+		{
+			getInputDistributionBounds(k, &inputLows[k], &inputHighs[k]);
+		}
+
+		decision = decideSensorOutputThresholdByInterval(
+				inputLows,
+				inputHighs,
+				arguments->common.outputSelect,
+				arguments->tailThreshold,
+				&outputLow,
+				&outputHigh);
+
+		if (decision != kThresholdIntervalDecisionAmbiguous)
+		{
+			printThresholdIntervalDecision(
+				decision,
+				arguments->tailThreshold,
+				outputLow,
+				outputHigh,
+				outputVariableNames[arguments->common.outputSelect],
+				unitsOfMeasurement[arguments->common.outputSelect]);
+
+			return kCommonConstantReturnTypeSuccess;
+		}
 	}
 
-	if (arguments.common.isMonteCarloMode)
+	/*
+	 *	Select the output-specialized kernel once, outside the main computation loop.
+	 */
+	sensorOutputKernel = getSensorOutputKernel(arguments->common.outputSelect);
+	sensorOutputBlockKernel = getSensorOutputBlockKernel(arguments->common.outputSelect);
+	calculateAllOutputs = (arguments->common.outputSelect == kOutputDistributionIndexMax);
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		initializeConvergenceMonitor(&convergenceMonitors[j], arguments->adaptiveTolerance);
+	}
+
+	/*
+	 *	Set up importance sampling of the tail probability.
+	 */
+	if (arguments->isImportanceSamplingMode)
 	{
-		monteCarloOutputSamples = (double *) checkedMalloc(
-							arguments.common.numberOfMonteCarloIterations * sizeof(double),
-							__FILE__,
-							__LINE__);
+		importanceSamplingTilt = (ExponentialTilt)
+		{
+			.low	= getInputDistributionSpecification(kInputDistributionIndexHxfer)->low,
+			.high	= getInputDistributionSpecification(kInputDistributionIndexHxfer)->high,
+			.tilt	= arguments->isTiltSpecified ?
+					arguments->importanceSamplingTilt :
+					calculateDefaultImportanceSamplingTilt(arguments->common.outputSelect, arguments->tailThreshold),
+		};
+
+		initializeTailProbabilityEstimator(&tailProbabilityEstimator, arguments->tailThreshold);
+	}
+
+	/*
+	 *	The compressor thread compresses the samples as the blocks of
+	 *	iterations complete them.
+	 */
+	if (arguments->isCompressedOutputMode &&
+		!openCompressedOutputWriter(
+			compressedOutputWriter,
+			"data.cmp",
+			calculateAllOutputs ? monteCarloOutputSamples : &monteCarloOutputSamples[arguments->common.outputSelect],
+			calculateAllOutputs ? kOutputDistributionIndexMax : 1,
+			arguments->common.numberOfMonteCarloIterations))
+	{
+		return kCommonConstantReturnTypeError;
 	}
 
 	/*
 	 *	Start timing.
 	 */
-	if (arguments.common.isTimingEnabled || arguments.common.isBenchmarkingMode)
+	if (arguments->isPerfCountersEnabled)
 	{
-		start = clock();
+		openPerfCounters(&perfCounters);
 	}
 
-	for (size_t i = 0; i < arguments.common.numberOfMonteCarloIterations; i++)
+	startPhaseTimer(&phaseTimer);
+
+	/*
+	 *	In parallel Monte Carlo mode, the threads interleave sampling and
+	 *	running the kernel, so the timer accounts both to the kernel phase.
+	 */
+	if (arguments->isParallelMonteCarloMode)
 	{
-		/*
-		 *	Set input distribution values, inside the main computation
-		 *	loop, so that it generates samples in the native
-		 *	Monte Carlo Execution Mode.
-		 */
-		setInputDistributionsViaUxHwCall(inputDistributions);
+		ParallelMonteCarloConfiguration	parallelMonteCarloConfiguration =
+		{
+			.numberOfThreads	= arguments->numberOfThreads,
+			.isThreadPinningEnabled	= arguments->isThreadPinningEnabled,
+			.outputSelect		= arguments->common.outputSelect,
+			.seed			= kCounterBasedSamplerDefaultSeed,
+		};
 
-		calibratedSensorOutput = calculateSensorOutput(&arguments, inputDistributions, outputDistributions);
+		if (runParallelMonteCarlo(
+			&parallelMonteCarloConfiguration,
+			monteCarloOutputSamples,
+			arguments->common.numberOfMonteCarloIterations,
+			&parallelMonteCarloReport) != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
 
-		/*
-		 *	For this application, calibratedSensorOutput is the item we track.
-		 */
-		if (arguments.common.isMonteCarloMode)
+		if (arguments->isCompressedOutputMode)
 		{
-			monteCarloOutputSamples[i] = calibratedSensorOutput;
+			setCompressedOutputReadyRows(compressedOutputWriter, arguments->common.numberOfMonteCarloIterations);
+		}
+
+		lapPhaseTimer(&phaseTimer, kTimingPhaseKernel);
+	}
+	else
+	{
+		for (size_t blockStart = 0; blockStart < arguments->common.numberOfMonteCarloIterations; blockStart += kMonteCarloBlockSize)
+		{
+			size_t	blockEnd = blockStart + kMonteCarloBlockSize;
+
+			if (blockEnd > arguments->common.numberOfMonteCarloIterations)
+			{
+				blockEnd = arguments->common.numberOfMonteCarloIterations;
+			}
+
+			/*
+			 *	Set input distribution values, inside the main computation
+			 *	loop, so that it generates samples in the native
+			 *	Monte Carlo Execution Mode.
+			 */
+			for (size_t i = blockStart; i < blockEnd; i++)
+			{
+				if (arguments->isImportanceSamplingMode)
+				{
+					importanceWeightBlock[i - blockStart] = setInputDistributionsForImportanceSampling(
+											inputDistributionBlock[i - blockStart],
+											&importanceSamplingTilt);
+				}
+				else
+				{
+					setInputDistributionsViaUxHwCall(inputDistributionBlock[i - blockStart]);
+				}
+			}
+
+			lapPhaseTimer(&phaseTimer, kTimingPhaseSampling);
+			lapPerfCounters(&perfCounters, kTimingPhaseSampling);
+
+			/*
+			 *	In Monte Carlo mode, the block kernel writes the samples of the
+			 *	selected output(s) straight into their sample arrays.
+			 */
+			if (arguments->common.isMonteCarloMode)
+			{
+				double *	blockOutputSamples[kOutputDistributionIndexMax];
+
+				for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+				{
+					blockOutputSamples[j] = (monteCarloOutputSamples[j] != NULL) ? &monteCarloOutputSamples[j][blockStart] : NULL;
+				}
+
+				sensorOutputBlockKernel((const double (*)[kInputDistributionIndexMax])inputDistributionBlock, blockOutputSamples, blockEnd - blockStart);
+
+				if (arguments->isImportanceSamplingMode)
+				{
+					for (size_t i = blockStart; i < blockEnd; i++)
+					{
+						updateTailProbabilityEstimator(
+							&tailProbabilityEstimator,
+							monteCarloOutputSamples[arguments->common.outputSelect][i],
+							importanceWeightBlock[i - blockStart]);
+					}
+				}
+
+				if (arguments->isCompressedOutputMode)
+				{
+					setCompressedOutputReadyRows(compressedOutputWriter, blockEnd);
+				}
+			}
+			else
+			{
+				for (size_t i = blockStart; i < blockEnd; i++)
+				{
+					calibratedSensorOutput = sensorOutputKernel(inputDistributionBlock[i - blockStart], outputDistributions);
+				}
+			}
+
+			lapPhaseTimer(&phaseTimer, kTimingPhaseKernel);
+			lapPerfCounters(&perfCounters, kTimingPhaseKernel);
+
+			/*
+			 *	In adaptive Monte Carlo mode, stop at the end of the first block after
+			 *	which the estimates have converged. The rest of the program then only
+			 *	sees the iterations actually used. With importance sampling, the
+			 *	estimate is the tail probability and the tolerance is on its relative
+			 *	standard error.
+			 */
+			if (arguments->isAdaptiveMonteCarloMode &&
+				(arguments->isImportanceSamplingMode ?
+					hasTailProbabilityEstimatorConverged(
+						&tailProbabilityEstimator,
+						kAdaptiveMonteCarloMinimumNumberOfBlocks * kMonteCarloBlockSize,
+						arguments->adaptiveTolerance) :
+					updateConvergenceMonitors(
+						convergenceMonitors,
+						monteCarloOutputSamples,
+						arguments->common.outputSelect,
+						blockStart,
+						blockEnd - blockStart)))
+			{
+				hasConverged = true;
+				arguments->common.numberOfMonteCarloIterations = blockEnd;
+				lapPhaseTimer(&phaseTimer, kTimingPhaseReduction);
+				lapPerfCounters(&perfCounters, kTimingPhaseReduction);
+
+				break;
+			}
+
+			lapPhaseTimer(&phaseTimer, kTimingPhaseReduction);
+			lapPerfCounters(&perfCounters, kTimingPhaseReduction);
 		}
 	}
 
+	closePerfCounters(&perfCounters);
+
+	restartPhaseTimerLap(&phaseTimer);
+
 	/*
 	 *	If not doing Laplace version, then approximate the cost of the third phase of
 	 *	Monte Carlo (post-processing), by calculating the mean and variance.
 	 */
-	if (arguments.common.isMonteCarloMode)
+	if (arguments->common.isMonteCarloMode)
 	{
-		meanAndVariance = calculateMeanAndVarianceOfDoubleSamples(
-					monteCarloOutputSamples,
-					arguments.common.numberOfMonteCarloIterations);
-		calibratedSensorOutput = meanAndVariance.mean;
-	}
+		if (calculateAllOutputs)
+		{
+			jointOutputStatistics = calculateJointOutputStatisticsOfDoubleSamples(
+							monteCarloOutputSamples,
+							arguments->common.numberOfMonteCarloIterations);
 
-	/*
-	 *	Stop timing.
-	 */
-	if (arguments.common.isTimingEnabled || arguments.common.isBenchmarkingMode)
-	{
-		end = clock();
-		cpuTimeUsedSeconds = ((double)(end - start)) / CLOCKS_PER_SEC;
+			for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+			{
+				outputDistributions[j] = jointOutputStatistics.meanAndVariance[j].mean;
+			}
+		}
+		else
+		{
+			meanAndVariance = calculateMeanAndVarianceOfDoubleSamples(
+						monteCarloOutputSamples[arguments->common.outputSelect],
+						arguments->common.numberOfMonteCarloIterations);
+			calibratedSensorOutput = meanAndVariance.mean;
+		}
 	}
 
-	if (arguments.common.isBenchmarkingMode)
+	lapPhaseTimer(&phaseTimer, kTimingPhaseReduction);
+	cpuTimeUsedInMicroSeconds = getPhaseTimerComputationCpuNanoseconds(&phaseTimer) / 1000;
+
+	if (arguments->common.isBenchmarkingMode)
 	{
 		/*
 		 *	In benchmarking mode, we print:
 		 *		(1) single result (for calculating Wasserstein distance to reference)
 		 *		(2) time in microseconds (benchmarking setup expects cpu time in microseconds)
 		 */
-		printf("%lf %" PRIu64 "\n", calibratedSensorOutput, (uint64_t)(cpuTimeUsedSeconds*1000000));
+		printf("%lf %" PRIu64 "\n", calibratedSensorOutput, cpuTimeUsedInMicroSeconds);
 	}
 	else
 	{
 		/*
 		 *	Print the results (either in JSON or standard output format).
 		 */
-		if (!arguments.common.isOutputJSONMode)
+		if (arguments->isImportanceSamplingMode)
+		{
+			printTailProbabilityEstimate(
+				&tailProbabilityEstimator,
+				&importanceSamplingTilt,
+				outputVariableNames[arguments->common.outputSelect],
+				unitsOfMeasurement[arguments->common.outputSelect]);
+		}
+		else if (!arguments->common.isOutputJSONMode)
 		{
-			if (arguments.common.outputSelect == kOutputDistributionIndexMax)
+			if (arguments->common.outputSelect == kOutputDistributionIndexMax)
 			{
 				for (size_t i = 0; i < kOutputDistributionIndexMax; i++)
 				{
 					printCalibratedValueAndProbabilities(
-						&arguments,
+						arguments,
 						outputDistributions[i],
 						outputVariableNames[i],
 						unitsOfMeasurement[i]);
 				}
+
+				if (arguments->common.isMonteCarloMode)
+				{
+					printJointOutputStatistics(&jointOutputStatistics, outputVariableNames);
+				}
 			}
 			else
 			{
 				printCalibratedValueAndProbabilities(
-					&arguments,
+					arguments,
 					calibratedSensorOutput,
-					outputVariableNames[arguments.common.outputSelect],
-					unitsOfMeasurement[arguments.common.outputSelect]);
+					outputVariableNames[arguments->common.outputSelect],
+					unitsOfMeasurement[arguments->common.outputSelect]);
+			}
+		}
+		else if (arguments->common.isMonteCarloMode)
+		{
+			if (printMonteCarloOutputJSON(
+				arguments,
+				monteCarloOutputSamples,
+				calculateAllOutputs ? &jointOutputStatistics : NULL,
+				outputVariableNames) != kCommonConstantReturnTypeSuccess)
+			{
+				return kCommonConstantReturnTypeError;
 			}
 		}
 		else
 		{
 			printJSONFormattedOutput(
-				&arguments,
+				arguments,
 				monteCarloOutputSamples,
+				NULL,
 				outputDistributions,
 				outputVariableNames);
 		}
 
 		/*
-		 *	Print timing result.
+		 *	Print the number of iterations used by adaptive Monte Carlo.
 		 */
-		if (arguments.common.isTimingEnabled)
+		if (arguments->isAdaptiveMonteCarloMode && !arguments->common.isOutputJSONMode)
 		{
-			printf("\nCPU time used: %lf seconds\n", cpuTimeUsedSeconds);
+			printf(
+				"\nAdaptive Monte Carlo %s after %zu iterations (relative tolerance %lg).\n",
+				hasConverged ? "converged" : "reached the iteration cap",
+				arguments->common.numberOfMonteCarloIterations,
+				arguments->adaptiveTolerance);
 		}
 
 		/*
 		 *	Write output data.
 		 */
-		if (arguments.common.isWriteToFileEnabled)
+		if (arguments->common.isWriteToFileEnabled)
 		{
 			if (writeOutputDoubleDistributionsToCSV(
-				arguments.common.outputFilePath,
+				arguments->common.outputFilePath,
 				outputDistributions,
 				outputVariableNames,
 				kOutputDistributionIndexMax))
@@ -273,18 +579,325 @@ main(int argc, char *  argv[])
 	}
 
 	/*
-	 *	Save Monte carlo outputs in an output file.
-	 *	Free dynamically-allocated memory.
+	 *	Save Monte carlo outputs in an output file, compressed, or only a table
+	 *	of their distributions. The scenarios of a batch do not save them.
 	 */
-	if (arguments.common.isMonteCarloMode)
+	if (arguments->isDistributionTableMode)
 	{
-		saveMonteCarloDoubleDataToDataDotOutFile(
+		DistributionTable	distributionTable;
+
+		if ((buildDistributionTable(
+			&distributionTable,
 			monteCarloOutputSamples,
-			(uint64_t)(cpuTimeUsedSeconds*1000000),
-			arguments.common.numberOfMonteCarloIterations);
+			arguments->common.numberOfMonteCarloIterations,
+			arguments->distributionTableBounds) != kCommonConstantReturnTypeSuccess) ||
+			(writeDistributionTable(
+			&distributionTable,
+			arguments->distributionTableFormat,
+			outputVariableNames) != kCommonConstantReturnTypeSuccess))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+	}
+	else if (arguments->isCompressedOutputMode)
+	{
+		if (!closeCompressedOutputWriter(compressedOutputWriter, cpuTimeUsedInMicroSeconds))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+	}
+	else if (arguments->common.isMonteCarloMode && (arguments->scenarioBatchPath == NULL))
+	{
+		saveJointMonteCarloDoubleDataToDataDotOutFile(
+			calculateAllOutputs ? monteCarloOutputSamples : &monteCarloOutputSamples[arguments->common.outputSelect],
+			calculateAllOutputs ? kOutputDistributionIndexMax : 1,
+			cpuTimeUsedInMicroSeconds,
+			arguments->common.numberOfMonteCarloIterations,
+			arguments->isParallelMonteCarloMode ? arguments->numberOfThreads : 1);
+	}
+
+	lapPhaseTimer(&phaseTimer, kTimingPhaseOutput);
+
+	/*
+	 *	Print timing result, including the time spent writing the outputs above.
+	 *	In JSON output, the reports are members of the object of the results of
+	 *	a Monte Carlo run, which is still open. Outside Monte Carlo mode the
+	 *	results object is already closed, so they go to an object of their own
+	 *	on the standard error, to keep the standard output a single document.
+	 */
+	isJSONResultsObjectOpen = arguments->common.isOutputJSONMode && arguments->common.isMonteCarloMode && !arguments->common.isBenchmarkingMode;
+	isJSONReportsObjectNeeded = arguments->common.isOutputJSONMode && !isJSONResultsObjectOpen && !arguments->common.isBenchmarkingMode &&
+					(arguments->common.isTimingEnabled || arguments->isPerfCountersEnabled);
+	jsonReportsFile = isJSONResultsObjectOpen ? stdout : stderr;
+
+	if (isJSONReportsObjectNeeded)
+	{
+		fprintf(jsonReportsFile, "{\"description\": \"Run reports\"");
+	}
+
+	if (arguments->common.isTimingEnabled && !arguments->common.isBenchmarkingMode)
+	{
+		if (arguments->common.isOutputJSONMode)
+		{
+			printPhaseTimingsJSON(jsonReportsFile, &phaseTimer, arguments->common.numberOfMonteCarloIterations);
+		}
+		else
+		{
+			printPhaseTimings(&phaseTimer, arguments->common.numberOfMonteCarloIterations);
+		}
+
+		if (arguments->isParallelMonteCarloMode)
+		{
+			if (arguments->common.isOutputJSONMode)
+			{
+				printParallelMonteCarloReportJSON(jsonReportsFile, &parallelMonteCarloReport);
+			}
+			else
+			{
+				printParallelMonteCarloReport(&parallelMonteCarloReport);
+			}
+		}
+
+		if (arguments->common.isOutputJSONMode)
+		{
+			printMemoryUsageJSON(jsonReportsFile);
+		}
+		else
+		{
+			printMemoryUsage();
+		}
+	}
+
+	/*
+	 *	Print hardware performance counters of the main computation loop.
+	 */
+	if (arguments->isPerfCountersEnabled && !arguments->common.isBenchmarkingMode)
+	{
+		if (arguments->common.isOutputJSONMode)
+		{
+			printPerfCountersJSON(jsonReportsFile, &perfCounters, arguments->common.numberOfMonteCarloIterations);
+		}
+		else
+		{
+			printPerfCounters(&perfCounters, arguments->common.numberOfMonteCarloIterations);
+		}
+	}
+
+	if (isJSONResultsObjectOpen)
+	{
+		printOutputJSONEnd();
+	}
+	else if (isJSONReportsObjectNeeded)
+	{
+		fprintf(jsonReportsFile, "}\n");
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief  Runs `runMonteCarloWithCompressedOutputWriter()`. After an error, stops the
+ *		compressor thread and removes the incomplete compressed output file, if any.
+ *
+ *	@param  arguments			: The command line arguments.
+ *	@param  buffers				: The buffers, from `allocateMonteCarloBuffers()`.
+ *	@param  outputVariableNames		: The output variable descriptions.
+ *	@param  unitsOfMeasurement		: The units of measurement of the outputs.
+ *	@return					: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+runMonteCarlo(
+	CommandLineArguments *		arguments,
+	MonteCarloBuffers *		buffers,
+	const char **			outputVariableNames,
+	const char **			unitsOfMeasurement)
+{
+	CompressedOutputWriter		compressedOutputWriter = {0};
+	CommonConstantReturnType	result;
+
+	result = runMonteCarloWithCompressedOutputWriter(arguments, buffers, &compressedOutputWriter, outputVariableNames, unitsOfMeasurement);
+	abortCompressedOutputWriter(&compressedOutputWriter);
+
+	return result;
+}
+
+/**
+ *	@brief  Runs `runMonteCarlo()` once for every line of input distribution assignments of the
+ *		scenario batch file, each applied on top of the input distributions of the command
+ *		line. All scenarios share the buffers and the state of the random number generator.
+ *
+ *	@param  arguments			: The command line arguments.
+ *	@param  buffers				: The buffers, from `allocateMonteCarloBuffers()`.
+ *	@param  outputVariableNames		: The output variable descriptions.
+ *	@param  unitsOfMeasurement		: The units of measurement of the outputs.
+ *	@return					: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+runScenarioBatch(
+	const CommandLineArguments *	arguments,
+	MonteCarloBuffers *		buffers,
+	const char **			outputVariableNames,
+	const char **			unitsOfMeasurement)
+{
+	FILE *				fp = fopen(arguments->scenarioBatchPath, "r");
+	char				line[kInputDistributionAssignmentsMaximumLineBytes];
+	bool				isLineTooLong;
+	InputDistributionSpecification	baseSpecifications[kInputDistributionIndexMax];
+	size_t				numberOfScenarios = 0;
+	CommonConstantReturnType	result = kCommonConstantReturnTypeSuccess;
 
-		free(monteCarloOutputSamples);
+	if (fp == NULL)
+	{
+		fprintf(stderr, "Error: Could not open the scenario batch file \"%s\".\n", arguments->scenarioBatchPath);
+
+		return kCommonConstantReturnTypeError;
 	}
 
-	return 0;
+	getInputDistributionSpecifications(baseSpecifications);
+
+	while ((result == kCommonConstantReturnTypeSuccess) && readInputDistributionAssignmentsLine(fp, line, sizeof(line), &isLineTooLong))
+	{
+		CommandLineArguments	scenarioArguments = *arguments;
+
+		if (!arguments->common.isBenchmarkingMode)
+		{
+			printf("%sScenario %zu: %s\n\n", (numberOfScenarios > 0) ? "\n" : "", numberOfScenarios, line);
+		}
+
+		setInputDistributionSpecifications(baseSpecifications);
+		result = parseInputDistributionAssignments(line);
+
+		if (result == kCommonConstantReturnTypeSuccess)
+		{
+			result = runMonteCarlo(&scenarioArguments, buffers, outputVariableNames, unitsOfMeasurement);
+		}
+
+		numberOfScenarios++;
+	}
+
+	if (isLineTooLong)
+	{
+		fprintf(stderr, "Error: A line of \"%s\" is longer than %d bytes.\n", arguments->scenarioBatchPath, kInputDistributionAssignmentsMaximumLineBytes);
+		result = kCommonConstantReturnTypeError;
+	}
+
+	fclose(fp);
+	setInputDistributionSpecifications(baseSpecifications);
+
+	return result;
+}
+
+int
+main(int argc, char *  argv[])
+{
+	CommandLineArguments		arguments = {0};
+	MonteCarloBuffers		monteCarloBuffers;
+	const char *			outputVariableNames[kOutputDistributionIndexMax] =
+					{
+						"Calibrated Mass Flow",
+						"Calibrated Differential Pressure",
+					};
+	const char *			unitsOfMeasurement[] =
+					{
+						[kOutputDistributionIndexCalibratedMassFlowOutput]		= "sccm",
+						[kOutputDistributionIndexCalibratedDifferentialPressureOutput]	= "Pa",
+					};
+	CommonConstantReturnType	result;
+
+	/*
+	 *	Get command line arguments.
+	 */
+	if (getCommandLineArguments(argc, argv, &arguments))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	The Wasserstein accuracy-versus-cost sweep replaces the normal run.
+	 */
+	if (arguments.isWassersteinSweepMode)
+	{
+		return runWassersteinSweep(&arguments, outputVariableNames);
+	}
+
+	/*
+	 *	Sharded Monte Carlo runs one shard, or merges the partial results of all shards.
+	 */
+	if (arguments.isShardMode)
+	{
+		return runMonteCarloShard(&arguments);
+	}
+
+	if (arguments.mergePartialResultPaths != NULL)
+	{
+		return mergeMonteCarloShards(&arguments, outputVariableNames, unitsOfMeasurement);
+	}
+
+	if (arguments.decompressInputPath != NULL)
+	{
+		return decompressCompressedOutputFile(arguments.decompressInputPath);
+	}
+
+	/*
+	 *	Particle mode runs the kernel once on particle distributions instead.
+	 */
+	if (arguments.isParticleMode)
+	{
+		return runParticlePropagation(&arguments, outputVariableNames, unitsOfMeasurement);
+	}
+
+	/*
+	 *	The product engine samples the two independent factors of the
+	 *	differential pressure separately instead.
+	 */
+	if (arguments.isProductEngineMode)
+	{
+		return runProductDistributionEngine(&arguments, outputVariableNames, unitsOfMeasurement);
+	}
+
+	/*
+	 *	The common random numbers sweep evaluates all its scenarios in one pass instead.
+	 */
+	if (arguments.commonRandomNumbersScenarioPath != NULL)
+	{
+		result = runCommonRandomNumbersSweep(&arguments, outputVariableNames, unitsOfMeasurement);
+		destroyRunArena();
+
+		return result;
+	}
+
+	/*
+	 *	Sample reweighting answers from a stored sample set where it can.
+	 */
+	if (arguments.sampleReweightingStorePath != NULL)
+	{
+		result = runSampleReweighting(&arguments, outputVariableNames, unitsOfMeasurement);
+		destroyRunArena();
+
+		return result;
+	}
+
+	/*
+	 *	A scenario batch runs the iterations once for each of its sets of input
+	 *	distributions, reusing the buffers.
+	 */
+	if (allocateMonteCarloBuffers(&arguments, &monteCarloBuffers) != kCommonConstantReturnTypeSuccess)
+	{
+		result = kCommonConstantReturnTypeError;
+	}
+	else if (arguments.scenarioBatchPath != NULL)
+	{
+		result = runScenarioBatch(&arguments, &monteCarloBuffers, outputVariableNames, unitsOfMeasurement);
+	}
+	else
+	{
+		result = runMonteCarlo(&arguments, &monteCarloBuffers, outputVariableNames, unitsOfMeasurement);
+	}
+
+	/*
+	 *	Release all buffers of the run at once.
+	 */
+	destroyRunArena();
+
+	return result;
 }
@@ -0,0 +1,679 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "mergeable-statistics.h"
+#include "run-arena.h"
+
+static double
+getQuantileSketchGamma(void)
+{
+	return (1.0 + kQuantileSketchRelativeAccuracy) / (1.0 - kQuantileSketchRelativeAccuracy);
+}
+
+/*
+ *	Bucket key of a finite magnitude of at least `kQuantileSketchMinimumIndexableValue`.
+ */
+static int64_t
+getQuantileSketchBucketKey(double magnitude)
+{
+	return (int64_t)ceil(log(magnitude) / log(getQuantileSketchGamma()));
+}
+
+/*
+ *	Representative magnitude of a bucket, within the relative accuracy of
+ *	every magnitude in it.
+ */
+static double
+getQuantileSketchBucketValue(int64_t key)
+{
+	double	gamma = getQuantileSketchGamma();
+
+	return 2.0 * pow(gamma, (double)key) / (gamma + 1.0);
+}
+
+/*
+ *	Slot of a key in a table: the slot of the bucket with the key, or the
+ *	empty slot where it would go. The capacity is a power of two, and the
+ *	table is never more than half full.
+ */
+static QuantileSketchBucket *
+findQuantileSketchBucket(const QuantileSketchBucketTable *  table, int64_t key)
+{
+	size_t	slot = (size_t)(((uint64_t)key * 0x9E3779B97F4A7C15ULL) >> 32) & (table->capacity - 1);
+
+	while ((table->buckets[slot].count != 0) && (table->buckets[slot].key != key))
+	{
+		slot = (slot + 1) & (table->capacity - 1);
+	}
+
+	return &table->buckets[slot];
+}
+
+static bool
+growQuantileSketchBucketTable(QuantileSketchBucketTable *  table)
+{
+	QuantileSketchBucketTable	grown =
+					{
+						.numberOfBuckets	= table->numberOfBuckets,
+						.capacity		= (table->capacity == 0) ? kQuantileSketchInitialCapacity : 2 * table->capacity,
+					};
+
+	grown.buckets = (QuantileSketchBucket *) allocateFromRunArena(grown.capacity * sizeof(QuantileSketchBucket), kRunArenaDefaultAlignment);
+
+	if (grown.buckets == NULL)
+	{
+		return false;
+	}
+
+	memset(grown.buckets, 0, grown.capacity * sizeof(QuantileSketchBucket));
+
+	for (size_t slot = 0; slot < table->capacity; slot++)
+	{
+		if (table->buckets[slot].count != 0)
+		{
+			*findQuantileSketchBucket(&grown, table->buckets[slot].key) = table->buckets[slot];
+		}
+	}
+
+	*table = grown;
+
+	return true;
+}
+
+static bool
+addToQuantileSketchBucket(QuantileSketchBucketTable *  table, int64_t key, uint64_t count)
+{
+	QuantileSketchBucket *	bucket;
+
+	if ((2 * (table->numberOfBuckets + 1) > table->capacity) && !growQuantileSketchBucketTable(table))
+	{
+		return false;
+	}
+
+	bucket = findQuantileSketchBucket(table, key);
+
+	if (bucket->count == 0)
+	{
+		bucket->key = key;
+		table->numberOfBuckets++;
+	}
+
+	bucket->count += count;
+
+	return true;
+}
+
+static int
+compareQuantileSketchBuckets(const void *  a, const void *  b)
+{
+	int64_t	x = ((const QuantileSketchBucket *)a)->key;
+	int64_t	y = ((const QuantileSketchBucket *)b)->key;
+
+	return (x > y) - (x < y);
+}
+
+/*
+ *	The nonempty buckets of a table in increasing order of key, in scratch
+ *	space of the run arena (`NULL` if it has no memory left).
+ */
+static QuantileSketchBucket *
+getSortedQuantileSketchBuckets(const QuantileSketchBucketTable *  table)
+{
+	QuantileSketchBucket *	sortedBuckets;
+	size_t			numberOfSortedBuckets = 0;
+
+	sortedBuckets = (QuantileSketchBucket *) allocateFromRunArena(
+							(table->numberOfBuckets + 1) * sizeof(QuantileSketchBucket),
+							kRunArenaDefaultAlignment);
+
+	if (sortedBuckets == NULL)
+	{
+		return NULL;
+	}
+
+	for (size_t slot = 0; slot < table->capacity; slot++)
+	{
+		if (table->buckets[slot].count != 0)
+		{
+			sortedBuckets[numberOfSortedBuckets++] = table->buckets[slot];
+		}
+	}
+
+	qsort(sortedBuckets, numberOfSortedBuckets, sizeof(QuantileSketchBucket), compareQuantileSketchBuckets);
+
+	return sortedBuckets;
+}
+
+void
+updateMomentAccumulator(MomentAccumulator *  moments, double value)
+{
+	double	n = (double)(moments->count + 1);
+	double	delta = value - moments->mean;
+	double	deltaOverN = delta / n;
+	double	deltaOverNSquared = deltaOverN * deltaOverN;
+	double	term = delta * deltaOverN * (double)moments->count;
+
+	moments->count++;
+	moments->mean += deltaOverN;
+	moments->m4 += term * deltaOverNSquared * (n * n - 3.0 * n + 3.0) + 6.0 * deltaOverNSquared * moments->m2 - 4.0 * deltaOverN * moments->m3;
+	moments->m3 += term * deltaOverN * (n - 2.0) - 3.0 * deltaOverN * moments->m2;
+	moments->m2 += term;
+	moments->minimum = fmin(moments->minimum, value);
+	moments->maximum = fmax(moments->maximum, value);
+
+	return;
+}
+
+/*
+ *	Pairwise merge of central moment sums (Pébay, 2008).
+ */
+static void
+mergeMomentAccumulators(MomentAccumulator *  moments, const MomentAccumulator *  other)
+{
+	double	nA = (double)moments->count;
+	double	nB = (double)other->count;
+	double	n = nA + nB;
+	double	delta;
+	double	deltaOverN;
+	double	m2;
+	double	m3;
+
+	if (other->count == 0)
+	{
+		return;
+	}
+
+	if (moments->count == 0)
+	{
+		*moments = *other;
+
+		return;
+	}
+
+	delta = other->mean - moments->mean;
+	deltaOverN = delta / n;
+	m2 = moments->m2 + other->m2 + delta * deltaOverN * nA * nB;
+	m3 = moments->m3 + other->m3 + delta * deltaOverN * deltaOverN * nA * nB * (nA - nB) +
+		3.0 * deltaOverN * (nA * other->m2 - nB * moments->m2);
+	moments->m4 = moments->m4 + other->m4 +
+		delta * deltaOverN * deltaOverN * deltaOverN * nA * nB * (nA * nA - nA * nB + nB * nB) +
+		6.0 * deltaOverN * deltaOverN * (nA * nA * other->m2 + nB * nB * moments->m2) +
+		4.0 * deltaOverN * (nA * other->m3 - nB * moments->m3);
+	moments->m3 = m3;
+	moments->m2 = m2;
+	moments->mean += deltaOverN * nB;
+	moments->count += other->count;
+	moments->minimum = fmin(moments->minimum, other->minimum);
+	moments->maximum = fmax(moments->maximum, other->maximum);
+
+	return;
+}
+
+void
+updateOutputHistogram(OutputHistogram *  histogram, double value)
+{
+	if (value < histogram->low)
+	{
+		histogram->underflowCount++;
+	}
+	else if (value >= histogram->high)
+	{
+		histogram->overflowCount++;
+	}
+	else
+	{
+		size_t	bin = (size_t)((value - histogram->low) / (histogram->high - histogram->low) * kOutputHistogramNumberOfBins);
+
+		histogram->counts[(bin < kOutputHistogramNumberOfBins) ? bin : kOutputHistogramNumberOfBins - 1]++;
+	}
+
+	return;
+}
+
+static bool
+updateQuantileSketch(QuantileSketch *  sketch, double value)
+{
+	sketch->count++;
+
+	if (value >= kQuantileSketchMinimumIndexableValue)
+	{
+		return addToQuantileSketchBucket(&sketch->positiveBuckets, getQuantileSketchBucketKey(value), 1);
+	}
+	else if (value <= -kQuantileSketchMinimumIndexableValue)
+	{
+		return addToQuantileSketchBucket(&sketch->negativeBuckets, getQuantileSketchBucketKey(-value), 1);
+	}
+
+	sketch->zeroCount++;
+
+	return true;
+}
+
+void
+initializeMergeableOutputSummaries(
+	MergeableOutputSummaries *	summaries,
+	double * const			pilotOutputSamples[kOutputDistributionIndexMax],
+	size_t				numberOfPilotSamples)
+{
+	memset(summaries, 0, sizeof(*summaries));
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		double	minimum = INFINITY;
+		double	maximum = -INFINITY;
+		double	width;
+
+		if (pilotOutputSamples[j] == NULL)
+		{
+			continue;
+		}
+
+		for (size_t i = 0; i < numberOfPilotSamples; i++)
+		{
+			minimum = fmin(minimum, pilotOutputSamples[j][i]);
+			maximum = fmax(maximum, pilotOutputSamples[j][i]);
+		}
+
+		width = maximum - minimum;
+		width = (width > 0.0) ? width : fmax(fabs(maximum), 1.0);
+
+		summaries->isOutputCalculated[j] = true;
+		summaries->outputs[j].moments.minimum = INFINITY;
+		summaries->outputs[j].moments.maximum = -INFINITY;
+		summaries->outputs[j].histogram.low = minimum - kOutputHistogramPilotRangeMargin * width;
+		summaries->outputs[j].histogram.high = maximum + kOutputHistogramPilotRangeMargin * width;
+	}
+
+	return;
+}
+
+bool
+updateMergeableOutputSummaries(
+	MergeableOutputSummaries *	summaries,
+	double * const			outputSamples[kOutputDistributionIndexMax],
+	size_t				numberOfSamples)
+{
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		double	deltaFromPreviousMean[kOutputDistributionIndexMax] = {0};
+
+		for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+		{
+			if (summaries->isOutputCalculated[j])
+			{
+				OutputSummary *	summary = &summaries->outputs[j];
+
+				deltaFromPreviousMean[j] = outputSamples[j][i] - summary->moments.mean;
+				updateMomentAccumulator(&summary->moments, outputSamples[j][i]);
+				updateOutputHistogram(&summary->histogram, outputSamples[j][i]);
+
+				if (!updateQuantileSketch(&summary->sketch, outputSamples[j][i]))
+				{
+					return false;
+				}
+			}
+		}
+
+		for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+		{
+			for (size_t k = j + 1; k < kOutputDistributionIndexMax; k++)
+			{
+				if (summaries->isOutputCalculated[j] && summaries->isOutputCalculated[k])
+				{
+					summaries->comoment[j][k] += deltaFromPreviousMean[j] * (outputSamples[k][i] - summaries->outputs[k].moments.mean);
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+bool
+mergeMergeableOutputSummaries(MergeableOutputSummaries *  summaries, const MergeableOutputSummaries *  other)
+{
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		if ((summaries->isOutputCalculated[j] != other->isOutputCalculated[j]) ||
+			(summaries->isOutputCalculated[j] &&
+				((summaries->outputs[j].histogram.low != other->outputs[j].histogram.low) ||
+				(summaries->outputs[j].histogram.high != other->outputs[j].histogram.high))))
+		{
+			return false;
+		}
+	}
+
+	/*
+	 *	The co-moments need the means before merging.
+	 */
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		for (size_t k = j + 1; k < kOutputDistributionIndexMax; k++)
+		{
+			const MomentAccumulator *	a = &summaries->outputs[j].moments;
+			const MomentAccumulator *	b = &other->outputs[j].moments;
+
+			if (summaries->isOutputCalculated[j] && summaries->isOutputCalculated[k] && (a->count + b->count > 0))
+			{
+				summaries->comoment[j][k] += other->comoment[j][k] +
+					(b->mean - a->mean) *
+					(other->outputs[k].moments.mean - summaries->outputs[k].moments.mean) *
+					(double)a->count * (double)b->count / (double)(a->count + b->count);
+			}
+		}
+	}
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		OutputSummary *		summary = &summaries->outputs[j];
+		const OutputSummary *	otherSummary = &other->outputs[j];
+
+		if (!summaries->isOutputCalculated[j])
+		{
+			continue;
+		}
+
+		mergeMomentAccumulators(&summary->moments, &otherSummary->moments);
+
+		for (size_t b = 0; b < kOutputHistogramNumberOfBins; b++)
+		{
+			summary->histogram.counts[b] += otherSummary->histogram.counts[b];
+		}
+
+		summary->histogram.underflowCount += otherSummary->histogram.underflowCount;
+		summary->histogram.overflowCount += otherSummary->histogram.overflowCount;
+
+		summary->sketch.count += otherSummary->sketch.count;
+		summary->sketch.zeroCount += otherSummary->sketch.zeroCount;
+
+		for (size_t slot = 0; slot < otherSummary->sketch.positiveBuckets.capacity; slot++)
+		{
+			const QuantileSketchBucket *	bucket = &otherSummary->sketch.positiveBuckets.buckets[slot];
+
+			if ((bucket->count != 0) && !addToQuantileSketchBucket(&summary->sketch.positiveBuckets, bucket->key, bucket->count))
+			{
+				return false;
+			}
+		}
+
+		for (size_t slot = 0; slot < otherSummary->sketch.negativeBuckets.capacity; slot++)
+		{
+			const QuantileSketchBucket *	bucket = &otherSummary->sketch.negativeBuckets.buckets[slot];
+
+			if ((bucket->count != 0) && !addToQuantileSketchBucket(&summary->sketch.negativeBuckets, bucket->key, bucket->count))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+double
+getQuantileSketchQuantile(const QuantileSketch *  sketch, double level)
+{
+	RunArenaMark		arenaMark = getRunArenaMark();
+	QuantileSketchBucket *	sortedNegativeBuckets;
+	QuantileSketchBucket *	sortedPositiveBuckets;
+	uint64_t		rank;
+	uint64_t		cumulativeCount = 0;
+	double			quantile = NAN;
+
+	if (sketch->count == 0)
+	{
+		return NAN;
+	}
+
+	rank = (uint64_t)(fmin(fmax(level, 0.0), 1.0) * (double)(sketch->count - 1));
+	sortedNegativeBuckets = getSortedQuantileSketchBuckets(&sketch->negativeBuckets);
+	sortedPositiveBuckets = getSortedQuantileSketchBuckets(&sketch->positiveBuckets);
+
+	if ((sortedNegativeBuckets == NULL) || (sortedPositiveBuckets == NULL))
+	{
+		releaseRunArenaToMark(arenaMark);
+
+		return NAN;
+	}
+
+	/*
+	 *	In increasing order: negative values from the largest magnitude down,
+	 *	then zeros, then positive values from the smallest magnitude up.
+	 */
+	for (size_t b = sketch->negativeBuckets.numberOfBuckets; (b-- > 0) && isnan(quantile); )
+	{
+		cumulativeCount += sortedNegativeBuckets[b].count;
+		quantile = (cumulativeCount > rank) ? -getQuantileSketchBucketValue(sortedNegativeBuckets[b].key) : NAN;
+	}
+
+	cumulativeCount += sketch->zeroCount;
+	quantile = (isnan(quantile) && (cumulativeCount > rank)) ? 0.0 : quantile;
+
+	for (size_t b = 0; (b < sketch->positiveBuckets.numberOfBuckets) && isnan(quantile); b++)
+	{
+		cumulativeCount += sortedPositiveBuckets[b].count;
+		quantile = (cumulativeCount > rank) ? getQuantileSketchBucketValue(sortedPositiveBuckets[b].key) : NAN;
+	}
+
+	releaseRunArenaToMark(arenaMark);
+
+	return quantile;
+}
+
+void
+getMomentAccumulatorStatistics(
+	const MomentAccumulator *	moments,
+	double *			variance,
+	double *			skewness,
+	double *			excessKurtosis)
+{
+	double	n = (double)moments->count;
+
+	*variance = (moments->count > 1) ? moments->m2 / (n - 1.0) : 0.0;
+	*skewness = (moments->m2 > 0.0) ? sqrt(n) * moments->m3 / pow(moments->m2, 1.5) : 0.0;
+	*excessKurtosis = (moments->m2 > 0.0) ? n * moments->m4 / (moments->m2 * moments->m2) - 3.0 : 0.0;
+
+	return;
+}
+
+void
+writeMergeableOutputSummaries(FILE *  fp, const MergeableOutputSummaries *  summaries)
+{
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		RunArenaMark		arenaMark = getRunArenaMark();
+		const OutputSummary *	summary = &summaries->outputs[j];
+		QuantileSketchBucket *	sortedPositiveBuckets;
+		QuantileSketchBucket *	sortedNegativeBuckets;
+
+		if (!summaries->isOutputCalculated[j])
+		{
+			continue;
+		}
+
+		fprintf(fp, "output %zu\n", j);
+		fprintf(
+			fp,
+			"moments %" PRIu64 " %a %a %a %a %a %a\n",
+			summary->moments.count,
+			summary->moments.mean,
+			summary->moments.m2,
+			summary->moments.m3,
+			summary->moments.m4,
+			summary->moments.minimum,
+			summary->moments.maximum);
+		fprintf(
+			fp,
+			"histogram %a %a %" PRIu64 " %" PRIu64 "\n",
+			summary->histogram.low,
+			summary->histogram.high,
+			summary->histogram.underflowCount,
+			summary->histogram.overflowCount);
+
+		for (size_t b = 0; b < kOutputHistogramNumberOfBins; b++)
+		{
+			fprintf(fp, "%s%" PRIu64, (b == 0) ? "" : " ", summary->histogram.counts[b]);
+		}
+
+		/*
+		 *	The buckets in order of key, so that the file does not depend on
+		 *	the layout of the hash tables.
+		 */
+		fprintf(
+			fp,
+			"\nsketch %" PRIu64 " %" PRIu64 " %zu\n",
+			summary->sketch.count,
+			summary->sketch.zeroCount,
+			summary->sketch.positiveBuckets.numberOfBuckets + summary->sketch.negativeBuckets.numberOfBuckets);
+		sortedPositiveBuckets = getSortedQuantileSketchBuckets(&summary->sketch.positiveBuckets);
+		sortedNegativeBuckets = getSortedQuantileSketchBuckets(&summary->sketch.negativeBuckets);
+
+		for (size_t b = 0; b < summary->sketch.positiveBuckets.numberOfBuckets; b++)
+		{
+			fprintf(fp, "+ %" PRId64 " %" PRIu64 "\n", sortedPositiveBuckets[b].key, sortedPositiveBuckets[b].count);
+		}
+
+		for (size_t b = 0; b < summary->sketch.negativeBuckets.numberOfBuckets; b++)
+		{
+			fprintf(fp, "- %" PRId64 " %" PRIu64 "\n", sortedNegativeBuckets[b].key, sortedNegativeBuckets[b].count);
+		}
+
+		releaseRunArenaToMark(arenaMark);
+	}
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		for (size_t k = j + 1; k < kOutputDistributionIndexMax; k++)
+		{
+			if (summaries->isOutputCalculated[j] && summaries->isOutputCalculated[k])
+			{
+				fprintf(fp, "comoment %zu %zu %a\n", j, k, summaries->comoment[j][k]);
+			}
+		}
+	}
+
+	fprintf(fp, "end\n");
+
+	return;
+}
+
+bool
+readMergeableOutputSummaries(FILE *  fp, MergeableOutputSummaries *  summaries)
+{
+	char	keyword[16];
+
+	memset(summaries, 0, sizeof(*summaries));
+
+	while (fscanf(fp, "%15s", keyword) == 1)
+	{
+		if (strcmp(keyword, "end") == 0)
+		{
+			return true;
+		}
+		else if (strcmp(keyword, "output") == 0)
+		{
+			size_t		j;
+			size_t		numberOfNonemptyBuckets;
+			OutputSummary *	summary;
+
+			if ((fscanf(fp, "%zu", &j) != 1) || (j >= kOutputDistributionIndexMax))
+			{
+				return false;
+			}
+
+			summaries->isOutputCalculated[j] = true;
+			summary = &summaries->outputs[j];
+
+			if ((fscanf(
+				fp,
+				" moments %" SCNu64 " %lf %lf %lf %lf %lf %lf",
+				&summary->moments.count,
+				&summary->moments.mean,
+				&summary->moments.m2,
+				&summary->moments.m3,
+				&summary->moments.m4,
+				&summary->moments.minimum,
+				&summary->moments.maximum) != 7) ||
+				(fscanf(
+				fp,
+				" histogram %lf %lf %" SCNu64 " %" SCNu64,
+				&summary->histogram.low,
+				&summary->histogram.high,
+				&summary->histogram.underflowCount,
+				&summary->histogram.overflowCount) != 4))
+			{
+				return false;
+			}
+
+			for (size_t b = 0; b < kOutputHistogramNumberOfBins; b++)
+			{
+				if (fscanf(fp, "%" SCNu64, &summary->histogram.counts[b]) != 1)
+				{
+					return false;
+				}
+			}
+
+			if (fscanf(fp, " sketch %" SCNu64 " %" SCNu64 " %zu", &summary->sketch.count, &summary->sketch.zeroCount, &numberOfNonemptyBuckets) != 3)
+			{
+				return false;
+			}
+
+			for (size_t i = 0; i < numberOfNonemptyBuckets; i++)
+			{
+				char		sign;
+				int64_t		key;
+				uint64_t	count;
+
+				if ((fscanf(fp, " %c %" SCNd64 " %" SCNu64, &sign, &key, &count) != 3) || (count == 0) ||
+					((sign != '+') && (sign != '-')) ||
+					!addToQuantileSketchBucket((sign == '+') ? &summary->sketch.positiveBuckets : &summary->sketch.negativeBuckets, key, count))
+				{
+					return false;
+				}
+			}
+		}
+		else if (strcmp(keyword, "comoment") == 0)
+		{
+			size_t	j;
+			size_t	k;
+			double	comoment;
+
+			if ((fscanf(fp, "%zu %zu %lf", &j, &k, &comoment) != 3) || (j >= kOutputDistributionIndexMax) || (k >= kOutputDistributionIndexMax))
+			{
+				return false;
+			}
+
+			summaries->comoment[j][k] = comoment;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,212 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "utilities-config.h"
+
+/*
+ *	Summaries of the samples of an output that can be computed on disjoint
+ *	sets of samples (e.g., by different processes) and then merged without
+ *	the samples themselves.
+ */
+
+/*
+ *	Count, mean, central moment sums of orders 2 to 4, minimum and maximum.
+ */
+typedef struct
+{
+	uint64_t	count;
+	double		mean;
+	double		m2;
+	double		m3;
+	double		m4;
+	double		minimum;
+	double		maximum;
+} MomentAccumulator;
+
+/*
+ *	Histogram with `kOutputHistogramNumberOfBins` equal-width bins in `[low, high)`
+ *	and separate counts of the samples below and above that range. Histograms
+ *	can only be merged if they have the same range.
+ */
+typedef struct
+{
+	double		low;
+	double		high;
+	uint64_t	counts[kOutputHistogramNumberOfBins];
+	uint64_t	underflowCount;
+	uint64_t	overflowCount;
+} OutputHistogram;
+
+/*
+ *	Quantile sketch with logarithmically-spaced buckets (as in DDSketch): the
+ *	bucket of a value `x` is `ceil(log(|x|) / log(gamma))`, with
+ *	`gamma = (1 + a) / (1 - a)` for relative accuracy `a`, separately for
+ *	positive and negative values. Merging adds the bucket counts, so it
+ *	gives the same sketch as a single pass over all samples, and every
+ *	quantile is within relative error `a` of the same order statistic of
+ *	the samples. The nonempty buckets are kept in open-addressing hash
+ *	tables (a bucket with zero count is an empty slot) in the run arena, so
+ *	that the fine accuracy only costs memory for the range that the samples
+ *	span. A table grows by moving to a new one twice its size, leaving the
+ *	old one to be released with the rest of the arena.
+ */
+typedef struct
+{
+	int64_t		key;
+	uint64_t	count;
+} QuantileSketchBucket;
+
+typedef struct
+{
+	size_t			numberOfBuckets;
+	size_t			capacity;
+	QuantileSketchBucket *	buckets;
+} QuantileSketchBucketTable;
+
+typedef struct
+{
+	uint64_t			count;
+	uint64_t			zeroCount;
+	QuantileSketchBucketTable	positiveBuckets;
+	QuantileSketchBucketTable	negativeBuckets;
+} QuantileSketch;
+
+typedef struct
+{
+	MomentAccumulator	moments;
+	OutputHistogram		histogram;
+	QuantileSketch		sketch;
+} OutputSummary;
+
+/*
+ *	Summaries of the calculated outputs of a Monte Carlo run, and the sums of
+ *	products of deviations from the means of every pair of them.
+ */
+typedef struct
+{
+	bool		isOutputCalculated[kOutputDistributionIndexMax];
+	OutputSummary	outputs[kOutputDistributionIndexMax];
+	double		comoment[kOutputDistributionIndexMax][kOutputDistributionIndexMax];
+} MergeableOutputSummaries;
+
+/**
+ *	@brief	Adds a sample to accumulated moments, with the updates of Pébay (2008).
+ *
+ *	@param	moments	: The moments. Start from zero, with `minimum` `INFINITY` and `maximum` `-INFINITY`.
+ *	@param	value	: The sample.
+ */
+void	updateMomentAccumulator(MomentAccumulator *  moments, double value);
+
+/**
+ *	@brief	Adds a sample to a histogram: to the count of its bin, or to the underflow or overflow count.
+ *
+ *	@param	histogram	: The histogram.
+ *	@param	value		: The sample.
+ */
+void	updateOutputHistogram(OutputHistogram *  histogram, double value);
+
+/**
+ *	@brief	Initializes the summaries of the calculated outputs, with the histogram range of each
+ *		taken from a pilot set of its samples.
+ *
+ *	@param	summaries		: The summaries.
+ *	@param	pilotOutputSamples	: The per-output arrays of pilot samples. `NULL` for outputs that are not calculated.
+ *	@param	numberOfPilotSamples	: The number of pilot samples.
+ */
+void	initializeMergeableOutputSummaries(
+		MergeableOutputSummaries *	summaries,
+		double * const			pilotOutputSamples[kOutputDistributionIndexMax],
+		size_t				numberOfPilotSamples);
+
+/**
+ *	@brief	Adds a block of samples of the calculated outputs to their summaries.
+ *
+ *	@param	summaries		: The summaries.
+ *	@param	outputSamples		: The per-output arrays of samples.
+ *	@param	numberOfSamples		: The number of samples.
+ *	@return				: `true` if successful, `false` if the run arena has no memory left for the quantile sketches.
+ */
+bool	updateMergeableOutputSummaries(
+		MergeableOutputSummaries *	summaries,
+		double * const			outputSamples[kOutputDistributionIndexMax],
+		size_t				numberOfSamples);
+
+/**
+ *	@brief	Merges summaries of a disjoint set of samples into summaries. Both must summarize
+ *		the same outputs, with the same histogram ranges.
+ *
+ *	@param	summaries	: The summaries to merge into.
+ *	@param	other		: The summaries to merge.
+ *	@return			: `true` if successful, `false` if the summaries are incompatible or the run arena
+ *				  has no memory left for the quantile sketches.
+ */
+bool	mergeMergeableOutputSummaries(MergeableOutputSummaries *  summaries, const MergeableOutputSummaries *  other);
+
+/**
+ *	@brief	Quantile of the samples summarized by a quantile sketch.
+ *
+ *	@param	sketch	: The sketch.
+ *	@param	level	: The quantile level, in `[0, 1]`.
+ *	@return		: The quantile, within relative error `kQuantileSketchRelativeAccuracy`. `NAN` if the sketch is empty
+ *			  or the run arena has no memory left for sorting its buckets.
+ */
+double	getQuantileSketchQuantile(const QuantileSketch *  sketch, double level);
+
+/**
+ *	@brief	Sample variance, skewness and excess kurtosis from accumulated moments.
+ *
+ *	@param	moments		: The moments.
+ *	@param	variance	: Output. The sample variance.
+ *	@param	skewness	: Output. The sample skewness.
+ *	@param	excessKurtosis	: Output. The sample excess kurtosis.
+ */
+void	getMomentAccumulatorStatistics(
+		const MomentAccumulator *	moments,
+		double *			variance,
+		double *			skewness,
+		double *			excessKurtosis);
+
+/**
+ *	@brief	Writes summaries to a text file. Floating-point values are written in hexadecimal
+ *		notation, so that reading them back is exact.
+ *
+ *	@param	fp		: The file.
+ *	@param	summaries	: The summaries.
+ */
+void	writeMergeableOutputSummaries(FILE *  fp, const MergeableOutputSummaries *  summaries);
+
+/**
+ *	@brief	Reads summaries written by `writeMergeableOutputSummaries()`.
+ *
+ *	@param	fp		: The file.
+ *	@param	summaries	: Output. The summaries.
+ *	@return			: `true` if successful, `false` if the file is malformed or the run arena has no
+ *				  memory left for the quantile sketches.
+ */
+bool	readMergeableOutputSummaries(FILE *  fp, MergeableOutputSummaries *  summaries);
@@ -0,0 +1,51 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#pragma once
+
+/**
+ *	@brief	Probability density of the standard Gaussian distribution.
+ *
+ *	@param	x	: The value.
+ *	@return		: The density at `x`.
+ */
+double	getStandardGaussianDensity(double x);
+
+/**
+ *	@brief	Cumulative distribution function of the standard Gaussian distribution,
+ *		accurate to relative rounding in both tails.
+ *
+ *	@param	x	: The value.
+ *	@return		: The probability of a value at most `x`.
+ */
+double	getStandardGaussianCumulativeProbability(double x);
+
+/**
+ *	@brief	Quantile function of the standard Gaussian distribution (Wichura's algorithm
+ *		AS 241, accurate to about 1e-16 relative).
+ *
+ *	@param	p	: The probability, in [0, 1].
+ *	@return		: The quantile of `p`, infinite for `p` of 0 or 1.
+ */
+double	getStandardGaussianQuantile(double p);
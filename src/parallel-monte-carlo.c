@@ -0,0 +1,421 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "parallel-monte-carlo.h"
+#include "run-arena.h"
+#include "samplers.h"
+#include "sensor-calibration.h"
+#include "timing.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+typedef struct
+{
+	const ParallelMonteCarloConfiguration *	configuration;
+	double **				outputSamples;
+	double					(*inputDistributionBlock)[kInputDistributionIndexMax];
+	int					pinnedCpu;
+	ParallelMonteCarloThreadStatistics *	statistics;
+} ParallelMonteCarloThreadArguments;
+
+/*
+ *	The CPU and NUMA node that the calling thread runs on.
+ */
+static void
+getCurrentCpuAndNumaNode(int *  cpu, int *  numaNode)
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+	unsigned int	currentCpu;
+	unsigned int	currentNode;
+
+	if (syscall(SYS_getcpu, &currentCpu, &currentNode, NULL) == 0)
+	{
+		*cpu = (int)currentCpu;
+		*numaNode = (int)currentNode;
+
+		return;
+	}
+#endif
+
+	*cpu = -1;
+	*numaNode = -1;
+
+	return;
+}
+
+static void *
+runParallelMonteCarloThread(void *  threadArguments)
+{
+	ParallelMonteCarloThreadArguments *	arguments = (ParallelMonteCarloThreadArguments *)threadArguments;
+	ParallelMonteCarloThreadStatistics *	statistics = arguments->statistics;
+	SensorOutputBlockKernel			kernel = getSensorOutputBlockKernel(arguments->configuration->outputSelect);
+	double					(*inputDistributionBlock)[kInputDistributionIndexMax] = arguments->inputDistributionBlock;
+	uint64_t				threadStart = getWallClockNanoseconds();
+	size_t					endSampleIndex = statistics->firstSampleIndex + statistics->numberOfSamples;
+	uint64_t				writeStart;
+
+#if defined(__linux__)
+	if (arguments->pinnedCpu >= 0)
+	{
+		cpu_set_t	cpuSet;
+
+		CPU_ZERO(&cpuSet);
+		CPU_SET(arguments->pinnedCpu, &cpuSet);
+
+		if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0)
+		{
+			fprintf(stderr, "Warning: Could not pin a thread to CPU %d. Continuing without pinning it.\n", arguments->pinnedCpu);
+		}
+	}
+#endif
+
+	getCurrentCpuAndNumaNode(&statistics->cpu, &statistics->numaNode);
+
+	/*
+	 *	Write the thread's range of the sample arrays on its own, so that the
+	 *	write bandwidth is that of the stores (and of the page faults that
+	 *	place the pages), without the sampling and the kernel.
+	 */
+	writeStart = getWallClockNanoseconds();
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		if (arguments->outputSamples[j] != NULL)
+		{
+			memset(&arguments->outputSamples[j][statistics->firstSampleIndex], 0, statistics->numberOfSamples * sizeof(double));
+		}
+	}
+
+	statistics->writeNanoseconds = getWallClockNanoseconds() - writeStart;
+
+	for (size_t blockStart = statistics->firstSampleIndex; blockStart < endSampleIndex; blockStart += kMonteCarloBlockSize)
+	{
+		size_t		blockLength = (endSampleIndex - blockStart < kMonteCarloBlockSize) ? endSampleIndex - blockStart : kMonteCarloBlockSize;
+		double *	blockOutputSamples[kOutputDistributionIndexMax];
+		uint64_t	samplingStart = getWallClockNanoseconds();
+		uint64_t	kernelStart;
+
+		sampleInputDistributionsCounterBased(arguments->configuration->seed, blockStart, inputDistributionBlock, blockLength);
+		kernelStart = getWallClockNanoseconds();
+
+		for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+		{
+			blockOutputSamples[j] = (arguments->outputSamples[j] != NULL) ? &arguments->outputSamples[j][blockStart] : NULL;
+		}
+
+		kernel((const double (*)[kInputDistributionIndexMax])inputDistributionBlock, blockOutputSamples, blockLength);
+		statistics->samplingNanoseconds += kernelStart - samplingStart;
+		statistics->kernelNanoseconds += getWallClockNanoseconds() - kernelStart;
+	}
+
+	statistics->wallNanoseconds = getWallClockNanoseconds() - threadStart;
+
+	return NULL;
+}
+
+/*
+ *	The base page size, to give each thread's buffers pages of their own.
+ */
+static size_t
+getPageSize(void)
+{
+	long	pageSize = sysconf(_SC_PAGESIZE);
+
+	return (pageSize > 0) ? (size_t)pageSize : 4096;
+}
+
+double *
+allocateParallelMonteCarloSampleArray(size_t numberOfSamples)
+{
+	return (double *) allocateFromRunArenaWithBasePages(numberOfSamples * sizeof(double));
+}
+
+CommonConstantReturnType
+runParallelMonteCarlo(
+	const ParallelMonteCarloConfiguration *	configuration,
+	double *				outputSamples[kOutputDistributionIndexMax],
+	size_t					numberOfSamples,
+	ParallelMonteCarloReport *		report)
+{
+	pthread_t				threads[kParallelMonteCarloMaximumNumberOfThreads];
+	ParallelMonteCarloThreadArguments	threadArguments[kParallelMonteCarloMaximumNumberOfThreads];
+	size_t					numberOfBlocks = (numberOfSamples + kMonteCarloBlockSize - 1) / kMonteCarloBlockSize;
+	size_t					numberOfStartedThreads = 0;
+	int					allowedCpus[kParallelMonteCarloMaximumNumberOfThreads];
+	size_t					numberOfAllowedCpus = 0;
+	RunArenaMark				arenaMark = getRunArenaMark();
+	size_t					inputDistributionBlockBytes;
+	char *					inputDistributionBlocks;
+	uint64_t				start;
+
+	memset(report, 0, sizeof(*report));
+	report->numberOfThreads = configuration->numberOfThreads;
+	report->isThreadPinningEnabled = configuration->isThreadPinningEnabled;
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		report->bytesPerSample += (outputSamples[j] != NULL) ? sizeof(double) : 0;
+	}
+
+	/*
+	 *	With pinning, thread `t` runs on the `t`-th CPU that the process may
+	 *	run on (wrapping around if there are more threads than CPUs).
+	 */
+	if (configuration->isThreadPinningEnabled)
+	{
+#if defined(__linux__)
+		cpu_set_t	cpuSet;
+
+		if (sched_getaffinity(0, sizeof(cpuSet), &cpuSet) == 0)
+		{
+			for (int cpu = 0; (cpu < CPU_SETSIZE) && (numberOfAllowedCpus < kParallelMonteCarloMaximumNumberOfThreads); cpu++)
+			{
+				if (CPU_ISSET(cpu, &cpuSet))
+				{
+					allowedCpus[numberOfAllowedCpus++] = cpu;
+				}
+			}
+		}
+#endif
+
+		if (numberOfAllowedCpus == 0)
+		{
+			fprintf(stderr, "Warning: Thread pinning is not supported on this platform. Continuing without pinning.\n");
+			report->isThreadPinningEnabled = false;
+		}
+	}
+
+	/*
+	 *	The input buffers of all threads, each rounded up to whole base pages.
+	 */
+	inputDistributionBlockBytes = (kMonteCarloBlockSize * kInputDistributionIndexMax * sizeof(double) + getPageSize() - 1) / getPageSize() * getPageSize();
+	inputDistributionBlocks = (char *) allocateFromRunArenaWithBasePages(configuration->numberOfThreads * inputDistributionBlockBytes);
+
+	if (inputDistributionBlocks == NULL)
+	{
+		fprintf(stderr, "Error: Out of memory for the input buffers of the threads.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	start = getWallClockNanoseconds();
+
+	for (size_t t = 0; t < configuration->numberOfThreads; t++)
+	{
+		size_t	firstBlock = t * numberOfBlocks / configuration->numberOfThreads;
+		size_t	endBlock = (t + 1) * numberOfBlocks / configuration->numberOfThreads;
+		size_t	endSampleIndex = (endBlock * kMonteCarloBlockSize < numberOfSamples) ? endBlock * kMonteCarloBlockSize : numberOfSamples;
+
+		report->threads[t].firstSampleIndex = firstBlock * kMonteCarloBlockSize;
+		report->threads[t].numberOfSamples = (endSampleIndex > report->threads[t].firstSampleIndex) ? endSampleIndex - report->threads[t].firstSampleIndex : 0;
+
+		/*
+		 *	Each thread's input buffer starts on its own base page and is
+		 *	not touched here, so it is placed on the NUMA node of the thread
+		 *	that first writes it.
+		 */
+		threadArguments[t] = (ParallelMonteCarloThreadArguments)
+		{
+			.configuration		= configuration,
+			.outputSamples		= outputSamples,
+			.inputDistributionBlock	= (double (*)[kInputDistributionIndexMax])(inputDistributionBlocks + t * inputDistributionBlockBytes),
+			.pinnedCpu		= (numberOfAllowedCpus > 0) ? allowedCpus[t % numberOfAllowedCpus] : -1,
+			.statistics		= &report->threads[t],
+		};
+
+		if (pthread_create(&threads[t], NULL, runParallelMonteCarloThread, &threadArguments[t]) != 0)
+		{
+			fprintf(stderr, "Error: Could not start thread %zu of the parallel Monte Carlo run.\n", t);
+			break;
+		}
+
+		numberOfStartedThreads++;
+	}
+
+	for (size_t t = 0; t < numberOfStartedThreads; t++)
+	{
+		pthread_join(threads[t], NULL);
+	}
+
+	report->wallNanoseconds = getWallClockNanoseconds() - start;
+	releaseRunArenaToMark(arenaMark);
+
+	return (numberOfStartedThreads == configuration->numberOfThreads) ? kCommonConstantReturnTypeSuccess : kCommonConstantReturnTypeError;
+}
+
+/*
+ *	Highest NUMA node of any thread in the report, or `-1` if none is known.
+ */
+static int
+getMaximumNumaNode(const ParallelMonteCarloReport *  report)
+{
+	int	maximumNumaNode = -1;
+
+	for (size_t t = 0; t < report->numberOfThreads; t++)
+	{
+		maximumNumaNode = (report->threads[t].numaNode > maximumNumaNode) ? report->threads[t].numaNode : maximumNumaNode;
+	}
+
+	return maximumNumaNode;
+}
+
+/*
+ *	Bytes of output samples that the threads of a NUMA node wrote, and the
+ *	longest time any of them took to write them (the threads write at the
+ *	same time).
+ */
+static void
+getNumaNodeWrites(const ParallelMonteCarloReport *  report, int numaNode, uint64_t *  bytes, uint64_t *  writeNanoseconds, size_t *  numberOfThreads)
+{
+	*bytes = 0;
+	*writeNanoseconds = 0;
+	*numberOfThreads = 0;
+
+	for (size_t t = 0; t < report->numberOfThreads; t++)
+	{
+		if (report->threads[t].numaNode == numaNode)
+		{
+			*bytes += report->threads[t].numberOfSamples * report->bytesPerSample;
+			*writeNanoseconds = (report->threads[t].writeNanoseconds > *writeNanoseconds) ? report->threads[t].writeNanoseconds : *writeNanoseconds;
+			(*numberOfThreads)++;
+		}
+	}
+
+	return;
+}
+
+void
+printParallelMonteCarloReport(const ParallelMonteCarloReport *  report)
+{
+	printf("\nParallel Monte Carlo: %zu threads%s, %.3lf ms wall-clock time:\n",
+		report->numberOfThreads,
+		report->isThreadPinningEnabled ? " (pinned)" : "",
+		(double)report->wallNanoseconds / 1e6);
+	printf("\t%6s %5s %5s %12s %12s %14s %14s %14s\n", "Thread", "CPU", "Node", "First", "Samples", "Sampling ms", "Kernel ms", "Write MB/s");
+
+	for (size_t t = 0; t < report->numberOfThreads; t++)
+	{
+		const ParallelMonteCarloThreadStatistics *	thread = &report->threads[t];
+
+		printf("\t%6zu %5d %5d %12zu %12zu %14.3lf %14.3lf %14.1lf\n",
+			t,
+			thread->cpu,
+			thread->numaNode,
+			thread->firstSampleIndex,
+			thread->numberOfSamples,
+			(double)thread->samplingNanoseconds / 1e6,
+			(double)thread->kernelNanoseconds / 1e6,
+			(thread->writeNanoseconds > 0) ? (double)(thread->numberOfSamples * report->bytesPerSample) / (double)thread->writeNanoseconds * 1e3 : 0.0);
+	}
+
+	for (int node = 0; node <= getMaximumNumaNode(report); node++)
+	{
+		uint64_t	bytes;
+		uint64_t	writeNanoseconds;
+		size_t		numberOfThreads;
+
+		getNumaNodeWrites(report, node, &bytes, &writeNanoseconds, &numberOfThreads);
+
+		if (numberOfThreads > 0)
+		{
+			printf("\tNUMA node %d: %zu threads wrote %.1lf MB of samples at %.1lf MB/s.\n",
+				node,
+				numberOfThreads,
+				(double)bytes / 1e6,
+				(writeNanoseconds > 0) ? (double)bytes / (double)writeNanoseconds * 1e3 : 0.0);
+		}
+	}
+
+	return;
+}
+
+void
+printParallelMonteCarloReportJSON(FILE *  fp, const ParallelMonteCarloReport *  report)
+{
+	bool	isFirstNode = true;
+
+	fprintf(fp, ", \"parallel\": {\"numberOfThreads\": %zu, \"isThreadPinningEnabled\": %s, \"wallNanoseconds\": %" PRIu64 ", \"threads\": [",
+		report->numberOfThreads,
+		report->isThreadPinningEnabled ? "true" : "false",
+		report->wallNanoseconds);
+
+	for (size_t t = 0; t < report->numberOfThreads; t++)
+	{
+		const ParallelMonteCarloThreadStatistics *	thread = &report->threads[t];
+
+		fprintf(
+			fp,
+			"%s{\"cpu\": %d, \"numaNode\": %d, \"firstSampleIndex\": %zu, \"numberOfSamples\": %zu, "
+			"\"writeNanoseconds\": %" PRIu64 ", \"samplingNanoseconds\": %" PRIu64 ", \"kernelNanoseconds\": %" PRIu64 ", \"wallNanoseconds\": %" PRIu64 "}",
+			(t == 0) ? "" : ", ",
+			thread->cpu,
+			thread->numaNode,
+			thread->firstSampleIndex,
+			thread->numberOfSamples,
+			thread->writeNanoseconds,
+			thread->samplingNanoseconds,
+			thread->kernelNanoseconds,
+			thread->wallNanoseconds);
+	}
+
+	fprintf(fp, "], \"numaNodes\": [");
+
+	for (int node = 0; node <= getMaximumNumaNode(report); node++)
+	{
+		uint64_t	bytes;
+		uint64_t	writeNanoseconds;
+		size_t		numberOfThreads;
+
+		getNumaNodeWrites(report, node, &bytes, &writeNanoseconds, &numberOfThreads);
+
+		if (numberOfThreads > 0)
+		{
+			fprintf(
+				fp,
+				"%s{\"numaNode\": %d, \"numberOfThreads\": %zu, \"bytesWritten\": %" PRIu64 ", \"writeBytesPerSecond\": %.1lf}",
+				isFirstNode ? "" : ", ",
+				node,
+				numberOfThreads,
+				bytes,
+				(writeNanoseconds > 0) ? (double)bytes / (double)writeNanoseconds * 1e9 : 0.0);
+			isFirstNode = false;
+		}
+	}
+
+	fprintf(fp, "]}");
+
+	return;
+}
@@ -0,0 +1,117 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "common.h"
+#include "utilities-config.h"
+
+typedef struct
+{
+	size_t		numberOfThreads;
+	bool		isThreadPinningEnabled;
+	size_t		outputSelect;
+	uint64_t	seed;
+} ParallelMonteCarloConfiguration;
+
+/*
+ *	Where a thread ran and how long it took. The CPU and NUMA node are those
+ *	at the start of the thread (`-1` if unknown); without pinning, the
+ *	thread may later migrate. The write time is that of the first write of
+ *	the thread's range of the sample arrays, before the kernel runs, which
+ *	includes the page faults that place the pages.
+ */
+typedef struct
+{
+	int		cpu;
+	int		numaNode;
+	size_t		firstSampleIndex;
+	size_t		numberOfSamples;
+	uint64_t	writeNanoseconds;
+	uint64_t	samplingNanoseconds;
+	uint64_t	kernelNanoseconds;
+	uint64_t	wallNanoseconds;
+} ParallelMonteCarloThreadStatistics;
+
+typedef struct
+{
+	size_t					numberOfThreads;
+	bool					isThreadPinningEnabled;
+	size_t					bytesPerSample;
+	uint64_t				wallNanoseconds;
+	ParallelMonteCarloThreadStatistics	threads[kParallelMonteCarloMaximumNumberOfThreads];
+} ParallelMonteCarloReport;
+
+/**
+ *	@brief	Allocates an array of Monte Carlo samples for a parallel run, on pages of the base
+ *		size (not huge pages), aligned to a page and not touched. The pages of the array are
+ *		therefore placed on the NUMA node of the thread that first writes them (Linux
+ *		first-touch policy), which in a parallel run is the thread that computes the samples
+ *		in them, since each thread's range is whole blocks and so whole base pages. The array
+ *		is allocated from the run arena.
+ *
+ *	@param	numberOfSamples	: The number of samples.
+ *	@return			: The array, or `NULL` if the run arena has no memory left.
+ */
+double *	allocateParallelMonteCarloSampleArray(size_t numberOfSamples);
+
+/**
+ *	@brief	Runs the Monte Carlo iterations on several threads. Each thread first writes its own
+ *		contiguous range of the sample arrays, timing only these stores, and then samples the
+ *		inputs with the counter-based sampler (so the samples do not depend on the number of
+ *		threads), runs the block kernel and writes the outputs into that range, from its own
+ *		input buffer.
+ *
+ *	@param	configuration	: The number of threads, pinning, selected output and seed.
+ *	@param	outputSamples	: Output. The per-output sample arrays. `NULL` for outputs that are not calculated.
+ *	@param	numberOfSamples	: The number of iterations.
+ *	@param	report		: Output. Per-thread placement and timing.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runParallelMonteCarlo(
+					const ParallelMonteCarloConfiguration *	configuration,
+					double *				outputSamples[kOutputDistributionIndexMax],
+					size_t					numberOfSamples,
+					ParallelMonteCarloReport *		report);
+
+/**
+ *	@brief	Prints the per-thread placement, time and write bandwidth of a parallel run, and the
+ *		write bandwidth of the threads of each NUMA node. The write bandwidth is that of the
+ *		first write of the ranges of the sample arrays, not of the sampling and the kernel.
+ *
+ *	@param	report	: The report.
+ */
+void		printParallelMonteCarloReport(const ParallelMonteCarloReport *  report);
+
+/**
+ *	@brief	Prints the same information as `printParallelMonteCarloReport()` as a `"parallel"`
+ *		member of an open JSON object, after its other members (that is, preceded by a comma).
+ *
+ *	@param	fp	: The file.
+ *	@param	report	: The report.
+ */
+void		printParallelMonteCarloReportJSON(FILE *  fp, const ParallelMonteCarloReport *  report);
@@ -0,0 +1,340 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include "particle-distribution.h"
+#include "json-output.h"
+#include "run-arena.h"
+#include "samplers.h"
+#include "sensor-calibration.h"
+#include "timing.h"
+
+void
+setParticleDistributionConstant(ParticleDistribution *  result, double value)
+{
+	for (size_t v = 0; v < kParticleDistributionNumberOfVectors; v++)
+	{
+		result->vectors[v] = (ParticleVector){0} + value;
+	}
+
+	return;
+}
+
+void
+addParticleDistributions(ParticleDistribution *  result, const ParticleDistribution *  a, const ParticleDistribution *  b)
+{
+	for (size_t v = 0; v < kParticleDistributionNumberOfVectors; v++)
+	{
+		result->vectors[v] = a->vectors[v] + b->vectors[v];
+	}
+
+	return;
+}
+
+void
+subtractParticleDistributions(ParticleDistribution *  result, const ParticleDistribution *  a, const ParticleDistribution *  b)
+{
+	for (size_t v = 0; v < kParticleDistributionNumberOfVectors; v++)
+	{
+		result->vectors[v] = a->vectors[v] - b->vectors[v];
+	}
+
+	return;
+}
+
+void
+multiplyParticleDistributions(ParticleDistribution *  result, const ParticleDistribution *  a, const ParticleDistribution *  b)
+{
+	for (size_t v = 0; v < kParticleDistributionNumberOfVectors; v++)
+	{
+		result->vectors[v] = a->vectors[v] * b->vectors[v];
+	}
+
+	return;
+}
+
+void
+divideParticleDistributions(ParticleDistribution *  result, const ParticleDistribution *  a, const ParticleDistribution *  b)
+{
+	for (size_t v = 0; v < kParticleDistributionNumberOfVectors; v++)
+	{
+		result->vectors[v] = a->vectors[v] / b->vectors[v];
+	}
+
+	return;
+}
+
+void
+addParticleDistributionScalar(ParticleDistribution *  result, const ParticleDistribution *  a, double b)
+{
+	for (size_t v = 0; v < kParticleDistributionNumberOfVectors; v++)
+	{
+		result->vectors[v] = a->vectors[v] + b;
+	}
+
+	return;
+}
+
+void
+multiplyParticleDistributionScalar(ParticleDistribution *  result, const ParticleDistribution *  a, double b)
+{
+	for (size_t v = 0; v < kParticleDistributionNumberOfVectors; v++)
+	{
+		result->vectors[v] = a->vectors[v] * b;
+	}
+
+	return;
+}
+
+void
+powParticleDistribution(ParticleDistribution *  result, const ParticleDistribution *  a, double exponent)
+{
+	if ((exponent >= 0) && (exponent <= kParticleDistributionMaximumIntegerExponent) && (exponent == floor(exponent)))
+	{
+		/*
+		 *	Exponentiation by squaring, a vector at a time.
+		 */
+		for (size_t v = 0; v < kParticleDistributionNumberOfVectors; v++)
+		{
+			ParticleVector	base = a->vectors[v];
+			ParticleVector	power = (ParticleVector){0} + 1.0;
+
+			for (unsigned remaining = (unsigned)exponent; remaining > 0; remaining >>= 1)
+			{
+				if (remaining & 1)
+				{
+					power *= base;
+				}
+
+				base *= base;
+			}
+
+			result->vectors[v] = power;
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < kParticleDistributionNumberOfParticles; i++)
+		{
+			result->values[i] = pow(a->values[i], exponent);
+		}
+	}
+
+	return;
+}
+
+double
+getParticleDistributionMean(const ParticleDistribution *  a)
+{
+	ParticleVector	sum = {0};
+	double		total = 0.0;
+
+	for (size_t v = 0; v < kParticleDistributionNumberOfVectors; v++)
+	{
+		sum += a->vectors[v];
+	}
+
+	for (size_t l = 0; l < kParticleDistributionParticlesPerVector; l++)
+	{
+		total += sum[l];
+	}
+
+	return total / kParticleDistributionNumberOfParticles;
+}
+
+double
+getParticleDistributionProbabilityGT(const ParticleDistribution *  a, double threshold)
+{
+	/*
+	 *	Vector comparisons give -1 in the lanes where they hold.
+	 */
+	typedef long long	ParticleMask __attribute__((vector_size(kParticleDistributionVectorBytes)));
+	ParticleMask		count = {0};
+	long long		total = 0;
+
+	for (size_t v = 0; v < kParticleDistributionNumberOfVectors; v++)
+	{
+		count -= (a->vectors[v] > threshold);
+	}
+
+	for (size_t l = 0; l < kParticleDistributionParticlesPerVector; l++)
+	{
+		total += count[l];
+	}
+
+	return (double)total / kParticleDistributionNumberOfParticles;
+}
+
+/*
+ *	`getParticleDistributionProbabilityGT()` as a `DistributionProbabilityGTFunction`.
+ */
+static double
+getParticleDistributionProbabilityGTOfPointer(const void *  distribution, double threshold)
+{
+	return getParticleDistributionProbabilityGT((const ParticleDistribution *) distribution, threshold);
+}
+
+CommonConstantReturnType
+runParticlePropagation(
+	const CommandLineArguments *	arguments,
+	const char **			outputVariableDescriptions,
+	const char **			unitsOfMeasurement)
+{
+	RunArenaMark			arenaMark = getRunArenaMark();
+	ParticleDistribution *		inputDistributions;
+	ParticleDistribution *		outputDistributions;
+	double *			inputParticles[kInputDistributionIndexMax];
+	double *			outputParticles[kOutputDistributionIndexMax] = {NULL};
+	size_t				outputSelect = arguments->common.outputSelect;
+	bool				calculateAllOutputs = (outputSelect == kOutputDistributionIndexMax);
+	JointOutputStatistics		jointOutputStatistics;
+	PhaseTimer			phaseTimer;
+	uint64_t			cpuTimeUsedInMicroSeconds;
+	CommonConstantReturnType	result = kCommonConstantReturnTypeSuccess;
+
+	inputDistributions = (ParticleDistribution *) allocateFromRunArena(
+				kInputDistributionIndexMax * sizeof(ParticleDistribution),
+				kRunArenaDefaultAlignment);
+	outputDistributions = (ParticleDistribution *) allocateFromRunArena(
+				kOutputDistributionIndexMax * sizeof(ParticleDistribution),
+				kRunArenaDefaultAlignment);
+
+	if ((inputDistributions == NULL) || (outputDistributions == NULL))
+	{
+		fprintf(stderr, "Error: Out of memory for the particle distributions.\n");
+		releaseRunArenaToMark(arenaMark);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		inputParticles[k] = inputDistributions[k].values;
+	}
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		outputParticles[j] = (calculateAllOutputs || (j == outputSelect)) ? outputDistributions[j].values : NULL;
+	}
+
+	startPhaseTimer(&phaseTimer);
+
+	sampleInputDistributionsStratified(kCounterBasedSamplerDefaultSeed, inputParticles, kParticleDistributionNumberOfParticles);
+	lapPhaseTimer(&phaseTimer, kTimingPhaseSampling);
+
+	if (!calculateSensorOutputParticleDistributions(inputDistributions, outputDistributions, outputSelect))
+	{
+		fprintf(stderr, "Error: Out of memory for the particle distributions.\n");
+		releaseRunArenaToMark(arenaMark);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	lapPhaseTimer(&phaseTimer, kTimingPhaseKernel);
+
+	if (calculateAllOutputs)
+	{
+		jointOutputStatistics = calculateJointOutputStatisticsOfDoubleSamples(outputParticles, kParticleDistributionNumberOfParticles);
+	}
+
+	lapPhaseTimer(&phaseTimer, kTimingPhaseReduction);
+	cpuTimeUsedInMicroSeconds = getPhaseTimerComputationCpuNanoseconds(&phaseTimer) / 1000;
+
+	if (arguments->common.isBenchmarkingMode)
+	{
+		printf(
+			"%lf %" PRIu64 "\n",
+			getParticleDistributionMean(&outputDistributions[calculateAllOutputs ? kOutputDistributionIndexMax - 1 : outputSelect]),
+			cpuTimeUsedInMicroSeconds);
+	}
+	else if (arguments->common.isOutputJSONMode)
+	{
+		/*
+		 *	The particles are printed as the samples of a Monte Carlo run.
+		 */
+		CommandLineArguments	particleArguments = *arguments;
+
+		particleArguments.common.numberOfMonteCarloIterations = kParticleDistributionNumberOfParticles;
+		particleArguments.isParallelMonteCarloMode = false;
+		result = printMonteCarloOutputJSON(
+				&particleArguments,
+				outputParticles,
+				calculateAllOutputs ? &jointOutputStatistics : NULL,
+				outputVariableDescriptions);
+	}
+	else
+	{
+		for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+		{
+			if (outputParticles[j] != NULL)
+			{
+				printDistributionValueAndProbabilities(
+					&outputDistributions[j],
+					getParticleDistributionProbabilityGTOfPointer,
+					getParticleDistributionMean(&outputDistributions[j]),
+					outputVariableDescriptions[j],
+					unitsOfMeasurement[j]);
+			}
+		}
+
+		if (calculateAllOutputs)
+		{
+			printJointOutputStatistics(&jointOutputStatistics, outputVariableDescriptions);
+		}
+	}
+
+	saveJointMonteCarloDoubleDataToDataDotOutFile(
+		calculateAllOutputs ? outputParticles : &outputParticles[outputSelect],
+		calculateAllOutputs ? kOutputDistributionIndexMax : 1,
+		cpuTimeUsedInMicroSeconds,
+		kParticleDistributionNumberOfParticles,
+		1);
+
+	lapPhaseTimer(&phaseTimer, kTimingPhaseOutput);
+
+	/*
+	 *	In JSON output, the timings are a member of the still open results object.
+	 */
+	if (arguments->common.isTimingEnabled && !arguments->common.isBenchmarkingMode)
+	{
+		if (arguments->common.isOutputJSONMode)
+		{
+			printPhaseTimingsJSON(stdout, &phaseTimer, kParticleDistributionNumberOfParticles);
+		}
+		else
+		{
+			printPhaseTimings(&phaseTimer, kParticleDistributionNumberOfParticles);
+		}
+	}
+
+	if (arguments->common.isOutputJSONMode && !arguments->common.isBenchmarkingMode)
+	{
+		printOutputJSONEnd();
+	}
+
+	releaseRunArenaToMark(arenaMark);
+
+	return result;
+}
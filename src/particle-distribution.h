@@ -0,0 +1,156 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stddef.h>
+#include "common.h"
+#include "utilities.h"
+#include "utilities-config.h"
+
+/*
+ *	Distributional double for native execution: a distribution represented by
+ *	`kParticleDistributionNumberOfParticles` equally-weighted particles.
+ *	Particles with the same index belong together, so arithmetic works
+ *	particle by particle, a vector of particles at a time: a value computed
+ *	from the same distribution twice (as the mass flow is from the heat power
+ *	transfer) keeps its dependence on it, and the particles of independent
+ *	inputs are paired at random. The result of every operation may be one of
+ *	its operands.
+ */
+#define kParticleDistributionParticlesPerVector		(kParticleDistributionVectorBytes / sizeof(double))
+#define kParticleDistributionNumberOfVectors		(kParticleDistributionNumberOfParticles / kParticleDistributionParticlesPerVector)
+
+typedef double	ParticleVector __attribute__((vector_size(kParticleDistributionVectorBytes)));
+
+typedef union
+{
+	ParticleVector	vectors[kParticleDistributionNumberOfVectors];
+	double		values[kParticleDistributionNumberOfParticles];
+} ParticleDistribution;
+
+/**
+ *	@brief	Sets all particles of a distribution to the same value.
+ *
+ *	@param	result	: Output. The distribution.
+ *	@param	value	: The value.
+ */
+void	setParticleDistributionConstant(ParticleDistribution *  result, double value);
+
+/**
+ *	@brief	Adds two distributions.
+ *
+ *	@param	result	: Output. `a + b`.
+ *	@param	a	: The first operand.
+ *	@param	b	: The second operand.
+ */
+void	addParticleDistributions(ParticleDistribution *  result, const ParticleDistribution *  a, const ParticleDistribution *  b);
+
+/**
+ *	@brief	Subtracts two distributions.
+ *
+ *	@param	result	: Output. `a - b`.
+ *	@param	a	: The first operand.
+ *	@param	b	: The second operand.
+ */
+void	subtractParticleDistributions(ParticleDistribution *  result, const ParticleDistribution *  a, const ParticleDistribution *  b);
+
+/**
+ *	@brief	Multiplies two distributions.
+ *
+ *	@param	result	: Output. `a * b`.
+ *	@param	a	: The first operand.
+ *	@param	b	: The second operand.
+ */
+void	multiplyParticleDistributions(ParticleDistribution *  result, const ParticleDistribution *  a, const ParticleDistribution *  b);
+
+/**
+ *	@brief	Divides two distributions.
+ *
+ *	@param	result	: Output. `a / b`.
+ *	@param	a	: The first operand.
+ *	@param	b	: The second operand.
+ */
+void	divideParticleDistributions(ParticleDistribution *  result, const ParticleDistribution *  a, const ParticleDistribution *  b);
+
+/**
+ *	@brief	Adds a constant to a distribution.
+ *
+ *	@param	result	: Output. `a + b`.
+ *	@param	a	: The distribution.
+ *	@param	b	: The constant.
+ */
+void	addParticleDistributionScalar(ParticleDistribution *  result, const ParticleDistribution *  a, double b);
+
+/**
+ *	@brief	Multiplies a distribution by a constant.
+ *
+ *	@param	result	: Output. `a * b`.
+ *	@param	a	: The distribution.
+ *	@param	b	: The constant.
+ */
+void	multiplyParticleDistributionScalar(ParticleDistribution *  result, const ParticleDistribution *  a, double b);
+
+/**
+ *	@brief	Raises a distribution to a constant power, by repeated multiplication if the exponent
+ *		is a small non-negative integer, and with `pow()` on every particle otherwise.
+ *
+ *	@param	result		: Output. `pow(a, exponent)`.
+ *	@param	a		: The distribution.
+ *	@param	exponent	: The exponent.
+ */
+void	powParticleDistribution(ParticleDistribution *  result, const ParticleDistribution *  a, double exponent);
+
+/**
+ *	@brief	Mean of a distribution.
+ *
+ *	@param	a	: The distribution.
+ *	@return		: The mean of its particles.
+ */
+double	getParticleDistributionMean(const ParticleDistribution *  a);
+
+/**
+ *	@brief	Probability that a distribution is greater than a threshold, as
+ *		`UxHwDoubleProbabilityGT()` gives for a distributional double.
+ *
+ *	@param	a		: The distribution.
+ *	@param	threshold	: The threshold.
+ *	@return			: The fraction of its particles that are greater than the threshold.
+ */
+double	getParticleDistributionProbabilityGT(const ParticleDistribution *  a, double threshold);
+
+/**
+ *	@brief	Particle mode (-Q option): sets the input distributions as particle distributions of
+ *		their deterministic Latin hypercube samples, runs the kernel once on them, and prints
+ *		and saves the output distributions as a Monte Carlo run would, with the particles as
+ *		the samples.
+ *
+ *	@param	arguments			: Pointer to the command-line arguments struct.
+ *	@param	outputVariableDescriptions	: The output variable descriptions.
+ *	@param	unitsOfMeasurement		: The units of measurement of the outputs.
+ *	@return					: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runParticlePropagation(
+					const CommandLineArguments *	arguments,
+					const char **			outputVariableDescriptions,
+					const char **			unitsOfMeasurement);
@@ -0,0 +1,298 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include "perf-counters.h"
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+static const char *	kPerfCounterNames[kPerfCounterMax] =
+{
+	[kPerfCounterCycles]		= "cycles",
+	[kPerfCounterInstructions]	= "instructions",
+	[kPerfCounterCacheMisses]	= "cacheMisses",
+	[kPerfCounterBranchMisses]	= "branchMisses",
+};
+
+/*
+ *	Phases for which the counts are reported.
+ */
+static const TimingPhase	kPerfCountersReportedPhases[] =
+{
+	kTimingPhaseSampling,
+	kTimingPhaseKernel,
+};
+
+#if defined(__linux__)
+static const uint64_t	kPerfCounterEventConfigs[kPerfCounterMax] =
+{
+	[kPerfCounterCycles]		= PERF_COUNT_HW_CPU_CYCLES,
+	[kPerfCounterInstructions]	= PERF_COUNT_HW_INSTRUCTIONS,
+	[kPerfCounterCacheMisses]	= PERF_COUNT_HW_CACHE_MISSES,
+	[kPerfCounterBranchMisses]	= PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+static int
+openPerfEvent(uint64_t config, int groupFileDescriptor)
+{
+	struct perf_event_attr	attributes;
+
+	memset(&attributes, 0, sizeof(attributes));
+	attributes.size = sizeof(attributes);
+	attributes.type = PERF_TYPE_HARDWARE;
+	attributes.config = config;
+	attributes.disabled = (groupFileDescriptor == -1);
+	attributes.exclude_kernel = 1;
+	attributes.exclude_hv = 1;
+
+	return (int)syscall(__NR_perf_event_open, &attributes, 0, -1, groupFileDescriptor, 0);
+}
+
+/*
+ *	Reads the current values of the available counters into `values`.
+ */
+static void
+readPerfCounters(const PerfCounters *  counters, uint64_t *  values)
+{
+	for (size_t i = 0; i < kPerfCounterMax; i++)
+	{
+		values[i] = 0;
+
+		if (counters->isCounterAvailable[i] &&
+			(read(counters->fileDescriptors[i], &values[i], sizeof(values[i])) != (ssize_t)sizeof(values[i])))
+		{
+			values[i] = 0;
+		}
+	}
+
+	return;
+}
+#endif
+
+bool
+openPerfCounters(PerfCounters *  counters)
+{
+	memset(counters, 0, sizeof(*counters));
+
+	for (size_t i = 0; i < kPerfCounterMax; i++)
+	{
+		counters->fileDescriptors[i] = -1;
+	}
+
+#if defined(__linux__)
+	/*
+	 *	The cycle counter leads the group, so that all counters are scheduled
+	 *	together. Other counters that the CPU does not support are skipped.
+	 */
+	counters->fileDescriptors[kPerfCounterCycles] = openPerfEvent(kPerfCounterEventConfigs[kPerfCounterCycles], -1);
+
+	if (counters->fileDescriptors[kPerfCounterCycles] < 0)
+	{
+		fprintf(
+			stderr,
+			"Warning: Hardware performance counters are unavailable (perf_event_open: %s). Continuing without them.\n",
+			strerror(errno));
+
+		return false;
+	}
+
+	counters->isCounterAvailable[kPerfCounterCycles] = true;
+
+	for (size_t i = 0; i < kPerfCounterMax; i++)
+	{
+		if (i != kPerfCounterCycles)
+		{
+			counters->fileDescriptors[i] = openPerfEvent(kPerfCounterEventConfigs[i], counters->fileDescriptors[kPerfCounterCycles]);
+			counters->isCounterAvailable[i] = (counters->fileDescriptors[i] >= 0);
+		}
+	}
+
+	counters->isAvailable = true;
+	ioctl(counters->fileDescriptors[kPerfCounterCycles], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(counters->fileDescriptors[kPerfCounterCycles], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	restartPerfCountersLap(counters);
+
+	return true;
+#else
+	fprintf(stderr, "Warning: Hardware performance counters are only supported on Linux. Continuing without them.\n");
+
+	return false;
+#endif
+}
+
+void
+restartPerfCountersLap(PerfCounters *  counters)
+{
+#if defined(__linux__)
+	if (counters->isAvailable)
+	{
+		readPerfCounters(counters, counters->lapCounts);
+	}
+#endif
+
+	return;
+}
+
+void
+lapPerfCounters(PerfCounters *  counters, TimingPhase phase)
+{
+#if defined(__linux__)
+	uint64_t	values[kPerfCounterMax];
+
+	if (!counters->isAvailable)
+	{
+		return;
+	}
+
+	readPerfCounters(counters, values);
+
+	for (size_t i = 0; i < kPerfCounterMax; i++)
+	{
+		counters->counts[phase][i] += values[i] - counters->lapCounts[i];
+		counters->lapCounts[i] = values[i];
+	}
+#endif
+
+	return;
+}
+
+void
+closePerfCounters(PerfCounters *  counters)
+{
+#if defined(__linux__)
+	if (counters->isAvailable)
+	{
+		ioctl(counters->fileDescriptors[kPerfCounterCycles], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+	}
+
+	for (size_t i = 0; i < kPerfCounterMax; i++)
+	{
+		if (counters->fileDescriptors[i] >= 0)
+		{
+			close(counters->fileDescriptors[i]);
+			counters->fileDescriptors[i] = -1;
+		}
+	}
+#endif
+
+	return;
+}
+
+static double
+calculateInstructionsPerCycle(const PerfCounters *  counters, TimingPhase phase)
+{
+	uint64_t	cycles = counters->counts[phase][kPerfCounterCycles];
+
+	if (!counters->isCounterAvailable[kPerfCounterInstructions] || (cycles == 0))
+	{
+		return 0.0;
+	}
+
+	return (double)counters->counts[phase][kPerfCounterInstructions] / (double)cycles;
+}
+
+void
+printPerfCounters(const PerfCounters *  counters, size_t numberOfSamples)
+{
+	if (!counters->isAvailable)
+	{
+		return;
+	}
+
+	printf("\nHardware performance counters per iteration:\n");
+	printf("\n");
+	printf("\t%-10s", "Phase");
+
+	for (size_t i = 0; i < kPerfCounterMax; i++)
+	{
+		printf(" %14s", kPerfCounterNames[i]);
+	}
+
+	printf(" %8s\n", "IPC");
+
+	for (size_t p = 0; p < sizeof(kPerfCountersReportedPhases) / sizeof(kPerfCountersReportedPhases[0]); p++)
+	{
+		TimingPhase	phase = kPerfCountersReportedPhases[p];
+
+		printf("\t%-10s", getTimingPhaseName(phase));
+
+		for (size_t i = 0; i < kPerfCounterMax; i++)
+		{
+			if (counters->isCounterAvailable[i])
+			{
+				printf(" %14.3lf", (double)counters->counts[phase][i] / (double)numberOfSamples);
+			}
+			else
+			{
+				printf(" %14s", "n/a");
+			}
+		}
+
+		printf(" %8.3lf\n", calculateInstructionsPerCycle(counters, phase));
+	}
+
+	return;
+}
+
+void
+printPerfCountersJSON(FILE *  fp, const PerfCounters *  counters, size_t numberOfSamples)
+{
+	if (!counters->isAvailable)
+	{
+		return;
+	}
+
+	fprintf(fp, ", \"perfCounters\": {\"numberOfSamples\": %zu, \"phases\": {", numberOfSamples);
+
+	for (size_t p = 0; p < sizeof(kPerfCountersReportedPhases) / sizeof(kPerfCountersReportedPhases[0]); p++)
+	{
+		TimingPhase	phase = kPerfCountersReportedPhases[p];
+
+		fprintf(fp, "%s\"%s\": {", (p == 0) ? "" : ", ", getTimingPhaseName(phase));
+
+		for (size_t i = 0; i < kPerfCounterMax; i++)
+		{
+			if (counters->isCounterAvailable[i])
+			{
+				fprintf(fp, "\"%sPerIteration\": %.3lf, ", kPerfCounterNames[i], (double)counters->counts[phase][i] / (double)numberOfSamples);
+			}
+			else
+			{
+				fprintf(fp, "\"%sPerIteration\": null, ", kPerfCounterNames[i]);
+			}
+		}
+
+		fprintf(fp, "\"instructionsPerCycle\": %.3lf}", calculateInstructionsPerCycle(counters, phase));
+	}
+
+	fprintf(fp, "}}");
+
+	return;
+}
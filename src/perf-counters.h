@@ -0,0 +1,112 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "timing.h"
+
+/*
+ *	Hardware events counted by the performance counters:
+ *		kPerfCounterCycles		: CPU cycles.
+ *		kPerfCounterInstructions	: Retired instructions.
+ *		kPerfCounterCacheMisses		: Last-level cache misses.
+ *		kPerfCounterBranchMisses	: Mispredicted branches.
+ */
+typedef enum
+{
+	kPerfCounterCycles						= 0,
+	kPerfCounterInstructions					= 1,
+	kPerfCounterCacheMisses						= 2,
+	kPerfCounterBranchMisses					= 3,
+	kPerfCounterMax,
+} PerfCounter;
+
+/*
+ *	A group of hardware performance counters (Linux `perf_event_open()`), with
+ *	the counts accumulated per timing phase, in the same lap-based way as
+ *	`PhaseTimer`.
+ */
+typedef struct
+{
+	bool		isAvailable;
+	int		fileDescriptors[kPerfCounterMax];
+	bool		isCounterAvailable[kPerfCounterMax];
+	uint64_t	lapCounts[kPerfCounterMax];
+	uint64_t	counts[kTimingPhaseMax][kPerfCounterMax];
+} PerfCounters;
+
+/**
+ *	@brief	Opens and enables the performance counters of the calling thread and starts the
+ *		first lap. If the counters are unavailable (e.g., not Linux, no kernel support,
+ *		or not permitted in a container), prints a warning and marks them unavailable,
+ *		which makes the other functions no-ops.
+ *
+ *	@param	counters	: Pointer to the counters.
+ *	@return			: `true` if the counters are available, else `false`.
+ */
+bool	openPerfCounters(PerfCounters *  counters);
+
+/**
+ *	@brief	Adds the counts since the start of the current lap to `phase` and starts a new lap.
+ *
+ *	@param	counters	: Pointer to the counters.
+ *	@param	phase		: The phase that the ending lap belongs to.
+ */
+void	lapPerfCounters(PerfCounters *  counters, TimingPhase phase);
+
+/**
+ *	@brief	Restarts the current lap without accounting the counts since it started to any phase.
+ *
+ *	@param	counters	: Pointer to the counters.
+ */
+void	restartPerfCountersLap(PerfCounters *  counters);
+
+/**
+ *	@brief	Disables and closes the performance counters.
+ *
+ *	@param	counters	: Pointer to the counters.
+ */
+void	closePerfCounters(PerfCounters *  counters);
+
+/**
+ *	@brief	Prints the counts of the sampling and kernel phases, normalized per iteration,
+ *		along with the instructions per cycle, in a human-readable form.
+ *
+ *	@param	counters		: Pointer to the counters.
+ *	@param	numberOfSamples		: The number of samples (Monte Carlo iterations) of the run.
+ */
+void	printPerfCounters(const PerfCounters *  counters, size_t numberOfSamples);
+
+/**
+ *	@brief	Prints the same information as `printPerfCounters()` as a `"perfCounters"` member
+ *		of an open JSON object, after its other members (that is, preceded by a comma).
+ *
+ *	@param	fp			: The file.
+ *	@param	counters		: Pointer to the counters.
+ *	@param	numberOfSamples		: The number of samples (Monte Carlo iterations) of the run.
+ */
+void	printPerfCountersJSON(FILE *  fp, const PerfCounters *  counters, size_t numberOfSamples);
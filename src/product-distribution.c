@@ -0,0 +1,520 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "product-distribution.h"
+#include "distribution-table.h"
+#include "run-arena.h"
+#include "samplers.h"
+#include "sensor-calibration.h"
+#include "timing.h"
+
+static int
+compareDoubles(const void *  a, const void *  b)
+{
+	double	x = *(const double *)a;
+	double	y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+/*
+ *	Number of the sorted values that are at most (or, if `isStrict`, less
+ *	than) a threshold.
+ */
+static size_t
+countSortedAtMost(const double *  sortedValues, size_t numberOfValues, double threshold, bool isStrict)
+{
+	size_t	low = 0;
+	size_t	high = numberOfValues;
+
+	while (low < high)
+	{
+		size_t	middle = low + (high - low) / 2;
+
+		if (isStrict ? (sortedValues[middle] < threshold) : (sortedValues[middle] <= threshold))
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	return low;
+}
+
+void
+initializeProductDistribution(
+	ProductDistribution *	distribution,
+	const double *		samplesA,
+	size_t			numberOfSamplesA,
+	double *		samplesB,
+	size_t			numberOfSamplesB)
+{
+	qsort(samplesB, numberOfSamplesB, sizeof(double), compareDoubles);
+
+	*distribution = (ProductDistribution)
+	{
+		.samplesA		= samplesA,
+		.numberOfSamplesA	= numberOfSamplesA,
+		.sortedSamplesB		= samplesB,
+		.numberOfSamplesB	= numberOfSamplesB,
+	};
+
+	return;
+}
+
+uint64_t
+countProductDistributionAtMost(const ProductDistribution *  distribution, double threshold)
+{
+	uint64_t	count = 0;
+
+	for (size_t i = 0; i < distribution->numberOfSamplesA; i++)
+	{
+		double	a = distribution->samplesA[i];
+
+		/*
+		 *	a * b <= threshold is b <= threshold / a for positive a, and
+		 *	b >= threshold / a for negative a.
+		 */
+		if (a > 0.0)
+		{
+			count += countSortedAtMost(distribution->sortedSamplesB, distribution->numberOfSamplesB, threshold / a, false);
+		}
+		else if (a < 0.0)
+		{
+			count += distribution->numberOfSamplesB -
+					countSortedAtMost(distribution->sortedSamplesB, distribution->numberOfSamplesB, threshold / a, true);
+		}
+		else
+		{
+			count += (threshold >= 0.0) ? distribution->numberOfSamplesB : 0;
+		}
+	}
+
+	return count;
+}
+
+double
+getProductDistributionProbabilityGT(const ProductDistribution *  distribution, double threshold)
+{
+	double	numberOfProducts = (double)distribution->numberOfSamplesA * (double)distribution->numberOfSamplesB;
+
+	return 1.0 - (double)countProductDistributionAtMost(distribution, threshold) / numberOfProducts;
+}
+
+/*
+ *	Means of the samples and of their squares.
+ */
+static void
+getSampleMoments(const double *  samples, size_t numberOfSamples, double *  mean, double *  meanOfSquares)
+{
+	double	sum = 0.0;
+	double	sumOfSquares = 0.0;
+
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		sum += samples[i];
+		sumOfSquares += samples[i] * samples[i];
+	}
+
+	*mean = sum / (double)numberOfSamples;
+	*meanOfSquares = sumOfSquares / (double)numberOfSamples;
+
+	return;
+}
+
+MeanAndVariance
+getProductDistributionMeanAndVariance(const ProductDistribution *  distribution)
+{
+	double	meanA;
+	double	meanOfSquaresA;
+	double	meanB;
+	double	meanOfSquaresB;
+
+	getSampleMoments(distribution->samplesA, distribution->numberOfSamplesA, &meanA, &meanOfSquaresA);
+	getSampleMoments(distribution->sortedSamplesB, distribution->numberOfSamplesB, &meanB, &meanOfSquaresB);
+
+	/*
+	 *	For independent a and b, E[ab] = E[a]E[b] and E[(ab)^2] = E[a^2]E[b^2].
+	 */
+	return (MeanAndVariance)
+	{
+		.mean		= meanA * meanB,
+		.variance	= fmax(meanOfSquaresA * meanOfSquaresB - (meanA * meanB) * (meanA * meanB), 0.0),
+	};
+}
+
+double
+getProductDistributionQuantile(const ProductDistribution *  distribution, double level)
+{
+	double		low = INFINITY;
+	double		high = -INFINITY;
+	uint64_t	numberOfProducts = (uint64_t)distribution->numberOfSamplesA * distribution->numberOfSamplesB;
+	uint64_t	targetCount = (uint64_t)ceil(level * (double)numberOfProducts);
+
+	/*
+	 *	The extreme products are products of extreme samples.
+	 */
+	for (size_t i = 0; i < distribution->numberOfSamplesA; i++)
+	{
+		double	a = distribution->samplesA[i];
+
+		low = fmin(low, fmin(a * distribution->sortedSamplesB[0], a * distribution->sortedSamplesB[distribution->numberOfSamplesB - 1]));
+		high = fmax(high, fmax(a * distribution->sortedSamplesB[0], a * distribution->sortedSamplesB[distribution->numberOfSamplesB - 1]));
+	}
+
+	targetCount = (targetCount > 0) ? targetCount : 1;
+
+	for (size_t step = 0; (step < kProductDistributionQuantileBisectionSteps) && (low < high); step++)
+	{
+		double	middle = low + (high - low) / 2;
+
+		if ((middle <= low) || (middle >= high))
+		{
+			break;
+		}
+
+		if (countProductDistributionAtMost(distribution, middle) >= targetCount)
+		{
+			high = middle;
+		}
+		else
+		{
+			low = middle;
+		}
+	}
+
+	return high;
+}
+
+static double
+getProductDistributionProbabilityGTOfPointer(const void *  distribution, double threshold)
+{
+	return getProductDistributionProbabilityGT((const ProductDistribution *) distribution, threshold);
+}
+
+static double
+getSortedSamplesProbabilityGT(const double *  sortedSamples, size_t numberOfSamples, double threshold)
+{
+	return 1.0 - (double)countSortedAtMost(sortedSamples, numberOfSamples, threshold, false) / (double)numberOfSamples;
+}
+
+/*
+ *	The mass flow samples, as a `DistributionProbabilityGTFunction`.
+ */
+typedef struct
+{
+	const double *	sortedSamples;
+	size_t		numberOfSamples;
+} SortedSamples;
+
+static double
+getSortedSamplesProbabilityGTOfPointer(const void *  distribution, double threshold)
+{
+	const SortedSamples *	samples = (const SortedSamples *) distribution;
+
+	return getSortedSamplesProbabilityGT(samples->sortedSamples, samples->numberOfSamples, threshold);
+}
+
+/*
+ *	Distribution table of the outputs. The counts of the bins of the
+ *	differential pressure are differences of the numbers of products at most
+ *	their edges.
+ */
+static CommonConstantReturnType
+writeProductDistributionTable(
+	const CommandLineArguments *	arguments,
+	const SortedSamples *		massFlow,
+	const ProductDistribution *	differentialPressure,
+	const char **			outputVariableDescriptions)
+{
+	DistributionTable	table = {0};
+	double			lows[kOutputDistributionIndexMax];
+	double			highs[kOutputDistributionIndexMax];
+	bool			calculateAllOutputs = (arguments->common.outputSelect == kOutputDistributionIndexMax);
+
+	if (arguments->distributionTableBounds == kDistributionTableBoundsAnalytic)
+	{
+		calculateSensorOutputBounds(lows, highs);
+
+		for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+		{
+			double	margin = kDistributionTableAnalyticBoundsMargin * (highs[j] - lows[j]);
+
+			lows[j] -= margin;
+			highs[j] += margin;
+		}
+	}
+	else
+	{
+		/*
+		 *	There is no first block: the bins span the samples (for the
+		 *	differential pressure, the products), widened as for a first block.
+		 */
+		lows[kOutputDistributionIndexCalibratedMassFlowOutput] = massFlow->sortedSamples[0];
+		highs[kOutputDistributionIndexCalibratedMassFlowOutput] = massFlow->sortedSamples[massFlow->numberOfSamples - 1];
+		lows[kOutputDistributionIndexCalibratedDifferentialPressureOutput] = getProductDistributionQuantile(differentialPressure, 0.0);
+		highs[kOutputDistributionIndexCalibratedDifferentialPressureOutput] = getProductDistributionQuantile(differentialPressure, 1.0);
+
+		for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+		{
+			double	width = highs[j] - lows[j];
+
+			width = (width > 0.0) ? width : fmax(fabs(highs[j]), 1.0);
+			lows[j] -= kOutputHistogramPilotRangeMargin * width;
+			highs[j] += kOutputHistogramPilotRangeMargin * width;
+		}
+	}
+
+	/*
+	 *	The table holds counts of a single number of samples, so the mass flow
+	 *	counts are scaled to the number of products.
+	 */
+	table.numberOfSamples = (uint64_t)differentialPressure->numberOfSamplesA * differentialPressure->numberOfSamplesB;
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		OutputHistogram *	histogram = &table.histograms[j];
+		double			binWidth = (highs[j] - lows[j]) / kOutputHistogramNumberOfBins;
+		uint64_t		previousCount;
+
+		if (!calculateAllOutputs && (j != arguments->common.outputSelect))
+		{
+			continue;
+		}
+
+		table.isOutputCalculated[j] = true;
+		histogram->low = lows[j];
+		histogram->high = highs[j];
+
+		for (size_t b = 0; b <= kOutputHistogramNumberOfBins; b++)
+		{
+			double		edge = (b == kOutputHistogramNumberOfBins) ? highs[j] : lows[j] + b * binWidth;
+			uint64_t	count = (j == kOutputDistributionIndexCalibratedMassFlowOutput) ?
+						countSortedAtMost(massFlow->sortedSamples, massFlow->numberOfSamples, edge, true) * differentialPressure->numberOfSamplesB :
+						countProductDistributionAtMost(differentialPressure, edge);
+
+			if (b == 0)
+			{
+				histogram->underflowCount = count;
+			}
+			else
+			{
+				histogram->counts[b - 1] = count - previousCount;
+			}
+
+			previousCount = count;
+		}
+
+		histogram->overflowCount = table.numberOfSamples - previousCount;
+	}
+
+	return writeDistributionTable(&table, arguments->distributionTableFormat, outputVariableDescriptions);
+}
+
+CommonConstantReturnType
+runProductDistributionEngine(
+	const CommandLineArguments *	arguments,
+	const char **			outputVariableDescriptions,
+	const char **			unitsOfMeasurement)
+{
+	RunArenaMark			arenaMark = getRunArenaMark();
+	size_t				numberOfMassFlowSamples = arguments->numberOfProductMassFlowSamples;
+	size_t				numberOfCorrectionFactorSamples = arguments->numberOfProductCorrectionFactorSamples;
+	size_t				numberOfInputSamples = (numberOfMassFlowSamples > numberOfCorrectionFactorSamples) ?
+								numberOfMassFlowSamples :
+								numberOfCorrectionFactorSamples;
+	double *			inputSamples[kInputDistributionIndexMax];
+	double *			massFlowSamples;
+	double *			correctionFactorSamples;
+	SortedSamples			massFlow;
+	ProductDistribution		differentialPressure;
+	MeanAndVariance			massFlowMeanAndVariance;
+	double				massFlowMeanOfSquares;
+	MeanAndVariance			differentialPressureMeanAndVariance;
+	size_t				outputSelect = arguments->common.outputSelect;
+	bool				calculateAllOutputs = (outputSelect == kOutputDistributionIndexMax);
+	PhaseTimer			phaseTimer;
+	uint64_t			cpuTimeUsedInMicroSeconds;
+	CommonConstantReturnType	result = kCommonConstantReturnTypeSuccess;
+	bool				isOutOfMemory = false;
+
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		inputSamples[k] = (double *) allocateFromRunArena(numberOfInputSamples * sizeof(double), kRunArenaDefaultAlignment);
+		isOutOfMemory = isOutOfMemory || (inputSamples[k] == NULL);
+	}
+
+	massFlowSamples = (double *) allocateFromRunArena(numberOfMassFlowSamples * sizeof(double), kRunArenaDefaultAlignment);
+	correctionFactorSamples = (double *) allocateFromRunArena(numberOfCorrectionFactorSamples * sizeof(double), kRunArenaDefaultAlignment);
+
+	if (isOutOfMemory || (massFlowSamples == NULL) || (correctionFactorSamples == NULL))
+	{
+		fprintf(stderr, "Error: Out of memory for the samples of the product distribution.\n");
+		releaseRunArenaToMark(arenaMark);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	startPhaseTimer(&phaseTimer);
+
+	/*
+	 *	The mass flow and the correction factor each get their own
+	 *	stratified samples of the inputs they depend on.
+	 */
+	sampleInputDistributionsStratified(kCounterBasedSamplerDefaultSeed, inputSamples, numberOfMassFlowSamples);
+
+	for (size_t i = 0; i < numberOfMassFlowSamples; i++)
+	{
+		massFlowSamples[i] = inputSamples[kInputDistributionIndexHxfer][i];
+	}
+
+	sampleInputDistributionsStratified(kCounterBasedSamplerDefaultSeed + 1, inputSamples, numberOfCorrectionFactorSamples);
+	lapPhaseTimer(&phaseTimer, kTimingPhaseSampling);
+
+	for (size_t i = 0; i < numberOfMassFlowSamples; i++)
+	{
+		double	inputs[kInputDistributionIndexMax] = {[kInputDistributionIndexHxfer] = massFlowSamples[i]};
+		double	outputs[kOutputDistributionIndexMax];
+
+		massFlowSamples[i] = getSensorOutputKernel(kOutputDistributionIndexCalibratedMassFlowOutput)(inputs, outputs);
+	}
+
+	for (size_t i = 0; i < numberOfCorrectionFactorSamples; i++)
+	{
+		double	inputs[kInputDistributionIndexMax];
+
+		for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+		{
+			inputs[k] = inputSamples[k][i];
+		}
+
+		correctionFactorSamples[i] = calculateDifferentialPressureCorrectionFactor(inputs);
+	}
+
+	lapPhaseTimer(&phaseTimer, kTimingPhaseKernel);
+
+	initializeProductDistribution(
+		&differentialPressure,
+		massFlowSamples,
+		numberOfMassFlowSamples,
+		correctionFactorSamples,
+		numberOfCorrectionFactorSamples);
+	differentialPressureMeanAndVariance = getProductDistributionMeanAndVariance(&differentialPressure);
+
+	/*
+	 *	The mass flow samples are sorted after the differential pressure
+	 *	distribution is set up, as it does not need them in order.
+	 */
+	qsort(massFlowSamples, numberOfMassFlowSamples, sizeof(double), compareDoubles);
+	massFlow = (SortedSamples){.sortedSamples = massFlowSamples, .numberOfSamples = numberOfMassFlowSamples};
+	getSampleMoments(massFlowSamples, numberOfMassFlowSamples, &massFlowMeanAndVariance.mean, &massFlowMeanOfSquares);
+	massFlowMeanAndVariance.variance = fmax(massFlowMeanOfSquares - massFlowMeanAndVariance.mean * massFlowMeanAndVariance.mean, 0.0);
+
+	lapPhaseTimer(&phaseTimer, kTimingPhaseReduction);
+	cpuTimeUsedInMicroSeconds = getPhaseTimerComputationCpuNanoseconds(&phaseTimer) / 1000;
+
+	if (arguments->common.isBenchmarkingMode)
+	{
+		printf(
+			"%lf %" PRIu64 "\n",
+			(outputSelect == kOutputDistributionIndexCalibratedMassFlowOutput) ?
+				massFlowMeanAndVariance.mean :
+				differentialPressureMeanAndVariance.mean,
+			cpuTimeUsedInMicroSeconds);
+	}
+	else
+	{
+		if (calculateAllOutputs || (outputSelect == kOutputDistributionIndexCalibratedMassFlowOutput))
+		{
+			printDistributionValueAndProbabilities(
+				&massFlow,
+				getSortedSamplesProbabilityGTOfPointer,
+				massFlowMeanAndVariance.mean,
+				outputVariableDescriptions[kOutputDistributionIndexCalibratedMassFlowOutput],
+				unitsOfMeasurement[kOutputDistributionIndexCalibratedMassFlowOutput]);
+		}
+
+		if (calculateAllOutputs || (outputSelect == kOutputDistributionIndexCalibratedDifferentialPressureOutput))
+		{
+			printDistributionValueAndProbabilities(
+				&differentialPressure,
+				getProductDistributionProbabilityGTOfPointer,
+				differentialPressureMeanAndVariance.mean,
+				outputVariableDescriptions[kOutputDistributionIndexCalibratedDifferentialPressureOutput],
+				unitsOfMeasurement[kOutputDistributionIndexCalibratedDifferentialPressureOutput]);
+		}
+
+		if (calculateAllOutputs)
+		{
+			/*
+			 *	Over all pairs, Cov(m, m * r) = E[r] Var(m), as m and r are independent.
+			 */
+			JointOutputStatistics	jointOutputStatistics = {0};
+			double			meanOfCorrectionFactor = differentialPressureMeanAndVariance.mean / massFlowMeanAndVariance.mean;
+			double			covariance = meanOfCorrectionFactor * massFlowMeanAndVariance.variance;
+			double			normalization = sqrt(massFlowMeanAndVariance.variance * differentialPressureMeanAndVariance.variance);
+
+			jointOutputStatistics.meanAndVariance[kOutputDistributionIndexCalibratedMassFlowOutput] = massFlowMeanAndVariance;
+			jointOutputStatistics.meanAndVariance[kOutputDistributionIndexCalibratedDifferentialPressureOutput] = differentialPressureMeanAndVariance;
+			jointOutputStatistics.covariance[0][0] = massFlowMeanAndVariance.variance;
+			jointOutputStatistics.covariance[1][1] = differentialPressureMeanAndVariance.variance;
+			jointOutputStatistics.covariance[0][1] = covariance;
+			jointOutputStatistics.covariance[1][0] = covariance;
+			jointOutputStatistics.correlation[0][0] = 1.0;
+			jointOutputStatistics.correlation[1][1] = 1.0;
+			jointOutputStatistics.correlation[0][1] = (normalization > 0.0) ? covariance / normalization : 0.0;
+			jointOutputStatistics.correlation[1][0] = jointOutputStatistics.correlation[0][1];
+
+			printJointOutputStatistics(&jointOutputStatistics, outputVariableDescriptions);
+		}
+
+		printf(
+			"\nProduct distribution engine: %zu mass flow samples and %zu correction factor samples, %" PRIu64 " products.\n",
+			numberOfMassFlowSamples,
+			numberOfCorrectionFactorSamples,
+			(uint64_t)numberOfMassFlowSamples * numberOfCorrectionFactorSamples);
+	}
+
+	if (arguments->isDistributionTableMode)
+	{
+		result = writeProductDistributionTable(arguments, &massFlow, &differentialPressure, outputVariableDescriptions);
+	}
+
+	lapPhaseTimer(&phaseTimer, kTimingPhaseOutput);
+
+	if (arguments->common.isTimingEnabled && !arguments->common.isBenchmarkingMode)
+	{
+		printPhaseTimings(&phaseTimer, numberOfMassFlowSamples + numberOfCorrectionFactorSamples);
+	}
+
+	releaseRunArenaToMark(arenaMark);
+
+	return result;
+}
@@ -0,0 +1,114 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "common.h"
+#include "utilities.h"
+#include "utilities-config.h"
+
+/*
+ *	Distribution of the product `a * b` of two independent random variables,
+ *	each represented by a set of samples. The distribution is that of all
+ *	`numberOfSamplesA * numberOfSamplesB` products of a sample of `a` and a
+ *	sample of `b`, but none of these products is formed: with the samples of
+ *	`b` sorted, the number of products at most a threshold is a sum of one
+ *	binary search per sample of `a`.
+ */
+typedef struct
+{
+	const double *	samplesA;
+	size_t		numberOfSamplesA;
+	double *	sortedSamplesB;
+	size_t		numberOfSamplesB;
+} ProductDistribution;
+
+/**
+ *	@brief	Sets up the distribution of a product. Sorts the samples of `b` in place.
+ *
+ *	@param	distribution		: Output. The distribution.
+ *	@param	samplesA		: The samples of `a`.
+ *	@param	numberOfSamplesA	: The number of samples of `a`.
+ *	@param	samplesB		: The samples of `b`, which the distribution keeps, sorted.
+ *	@param	numberOfSamplesB	: The number of samples of `b`.
+ */
+void		initializeProductDistribution(
+			ProductDistribution *	distribution,
+			const double *		samplesA,
+			size_t			numberOfSamplesA,
+			double *		samplesB,
+			size_t			numberOfSamplesB);
+
+/**
+ *	@brief	Number of products of a sample of `a` and a sample of `b` that are at most a threshold.
+ *
+ *	@param	distribution	: The distribution.
+ *	@param	threshold	: The threshold.
+ *	@return			: The number of products.
+ */
+uint64_t	countProductDistributionAtMost(const ProductDistribution *  distribution, double threshold);
+
+/**
+ *	@brief	Probability that the product is greater than a threshold.
+ *
+ *	@param	distribution	: The distribution.
+ *	@param	threshold	: The threshold.
+ *	@return			: The fraction of the products that are greater than the threshold.
+ */
+double		getProductDistributionProbabilityGT(const ProductDistribution *  distribution, double threshold);
+
+/**
+ *	@brief	Mean and variance of the product, from the moments of `a` and `b`.
+ *
+ *	@param	distribution	: The distribution.
+ *	@return			: The mean and (population) variance of all products.
+ */
+MeanAndVariance	getProductDistributionMeanAndVariance(const ProductDistribution *  distribution);
+
+/**
+ *	@brief	Quantile of the product.
+ *
+ *	@param	distribution	: The distribution.
+ *	@param	level		: The quantile level, in `[0, 1]`.
+ *	@return			: The smallest product such that a fraction `level` of the products are at most it.
+ */
+double		getProductDistributionQuantile(const ProductDistribution *  distribution, double level);
+
+/**
+ *	@brief	Product distribution engine (-E option): calculates the mass flow on a set of samples
+ *		of the heat power transfer and the differential pressure correction factor on a
+ *		separate set of samples of the temperatures and pressures, and gets the distribution
+ *		of the differential pressure from all their products. Prints the outputs as a Monte
+ *		Carlo run would, and, with the -D option, writes their distribution table.
+ *
+ *	@param	arguments			: Pointer to the command-line arguments struct.
+ *	@param	outputVariableDescriptions	: The output variable descriptions.
+ *	@param	unitsOfMeasurement		: The units of measurement of the outputs.
+ *	@return					: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runProductDistributionEngine(
+					const CommandLineArguments *	arguments,
+					const char **			outputVariableDescriptions,
+					const char **			unitsOfMeasurement);
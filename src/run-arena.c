@@ -0,0 +1,294 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include "run-arena.h"
+#include "utilities-config.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+typedef enum
+{
+	kRunArenaChunkBackingHeap					= 0,
+	kRunArenaChunkBackingPages					= 1,
+	kRunArenaChunkBackingTransparentHugePages			= 2,
+	kRunArenaChunkBackingHugeTLB					= 3,
+} RunArenaChunkBacking;
+
+typedef struct
+{
+	char *			base;
+	size_t			size;
+	size_t			usedBytes;
+	RunArenaChunkBacking	backing;
+} RunArenaChunk;
+
+typedef struct
+{
+	RunArenaChunk	chunks[kRunArenaMaximumNumberOfChunks];
+	size_t		numberOfChunks;
+	size_t		bytesInUse;
+	size_t		highWaterBytes;
+	size_t		reservedBytes;
+	size_t		peakReservedBytes;
+} RunArena;
+
+static RunArena	runArena;
+
+/*
+ *	Maps a chunk: from the explicit huge page pool if it has enough pages,
+ *	else from normal pages with transparent huge pages requested, else
+ *	(not on Linux) from the heap. Without `isHugePagesAllowed`, from normal
+ *	pages with transparent huge pages refused.
+ */
+static bool
+mapRunArenaChunk(RunArenaChunk *  chunk, size_t size, bool isHugePagesAllowed)
+{
+	chunk->size = size;
+	chunk->usedBytes = 0;
+
+#if defined(__linux__)
+	chunk->base = isHugePagesAllowed ?
+			mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0) :
+			MAP_FAILED;
+	chunk->backing = kRunArenaChunkBackingHugeTLB;
+
+	if (chunk->base == MAP_FAILED)
+	{
+		chunk->base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		if (chunk->base == MAP_FAILED)
+		{
+			return false;
+		}
+
+		chunk->backing = (isHugePagesAllowed && (madvise(chunk->base, size, MADV_HUGEPAGE) == 0)) ?
+					kRunArenaChunkBackingTransparentHugePages :
+					kRunArenaChunkBackingPages;
+
+		if (!isHugePagesAllowed)
+		{
+			madvise(chunk->base, size, MADV_NOHUGEPAGE);
+		}
+	}
+
+	return true;
+#else
+	chunk->backing = kRunArenaChunkBackingHeap;
+
+	return posix_memalign((void **)&chunk->base, kRunArenaMinimumChunkBytes, size) == 0;
+#endif
+}
+
+static void
+unmapRunArenaChunk(RunArenaChunk *  chunk)
+{
+#if defined(__linux__)
+	munmap(chunk->base, chunk->size);
+#else
+	free(chunk->base);
+#endif
+
+	return;
+}
+
+static void *
+allocateFromRunArenaChunk(size_t size, size_t alignment, bool isHugePagesAllowed)
+{
+	RunArenaChunk *	chunk = (runArena.numberOfChunks > 0) ? &runArena.chunks[runArena.numberOfChunks - 1] : NULL;
+	size_t		offset = 0;
+
+	if (chunk != NULL)
+	{
+		offset = (size_t)(((uintptr_t)chunk->base + chunk->usedBytes + alignment - 1) & ~(uintptr_t)(alignment - 1)) - (uintptr_t)chunk->base;
+	}
+
+	/*
+	 *	Start a new chunk if the allocation does not fit in the last one,
+	 *	or if it must not be on huge pages. Chunks are a multiple of the
+	 *	minimum chunk size, and therefore of the huge page size.
+	 */
+	if ((chunk == NULL) || (offset + size > chunk->size) || !isHugePagesAllowed)
+	{
+		size_t	chunkSize = ((size + alignment + kRunArenaMinimumChunkBytes - 1) / kRunArenaMinimumChunkBytes) * kRunArenaMinimumChunkBytes;
+
+		if (runArena.numberOfChunks == kRunArenaMaximumNumberOfChunks)
+		{
+			return NULL;
+		}
+
+		chunk = &runArena.chunks[runArena.numberOfChunks];
+
+		if (!mapRunArenaChunk(chunk, chunkSize, isHugePagesAllowed))
+		{
+			return NULL;
+		}
+
+		runArena.numberOfChunks++;
+		runArena.reservedBytes += chunkSize;
+		runArena.peakReservedBytes = (runArena.reservedBytes > runArena.peakReservedBytes) ? runArena.reservedBytes : runArena.peakReservedBytes;
+		offset = 0;
+	}
+
+	runArena.bytesInUse += offset + size - chunk->usedBytes;
+	runArena.highWaterBytes = (runArena.bytesInUse > runArena.highWaterBytes) ? runArena.bytesInUse : runArena.highWaterBytes;
+	chunk->usedBytes = offset + size;
+
+	return chunk->base + offset;
+}
+
+void *
+allocateFromRunArena(size_t size, size_t alignment)
+{
+	return allocateFromRunArenaChunk(size, alignment, true);
+}
+
+void *
+allocateFromRunArenaWithBasePages(size_t size)
+{
+	return allocateFromRunArenaChunk(size, 1, false);
+}
+
+RunArenaMark
+getRunArenaMark(void)
+{
+	return (RunArenaMark)
+	{
+		.numberOfChunks		= runArena.numberOfChunks,
+		.usedBytesOfLastChunk	= (runArena.numberOfChunks > 0) ? runArena.chunks[runArena.numberOfChunks - 1].usedBytes : 0,
+	};
+}
+
+void
+releaseRunArenaToMark(RunArenaMark mark)
+{
+	while (runArena.numberOfChunks > mark.numberOfChunks)
+	{
+		RunArenaChunk *	chunk = &runArena.chunks[--runArena.numberOfChunks];
+
+		runArena.bytesInUse -= chunk->usedBytes;
+		runArena.reservedBytes -= chunk->size;
+		unmapRunArenaChunk(chunk);
+	}
+
+	if (runArena.numberOfChunks > 0)
+	{
+		RunArenaChunk *	chunk = &runArena.chunks[runArena.numberOfChunks - 1];
+
+		runArena.bytesInUse -= chunk->usedBytes - mark.usedBytesOfLastChunk;
+		chunk->usedBytes = mark.usedBytesOfLastChunk;
+	}
+
+	return;
+}
+
+void
+destroyRunArena(void)
+{
+	releaseRunArenaToMark((RunArenaMark) {0});
+
+	return;
+}
+
+RunArenaStatistics
+getRunArenaStatistics(void)
+{
+	RunArenaStatistics	statistics =
+	{
+		.bytesInUse		= runArena.bytesInUse,
+		.highWaterBytes		= runArena.highWaterBytes,
+		.reservedBytes		= runArena.reservedBytes,
+		.peakReservedBytes	= runArena.peakReservedBytes,
+		.numberOfChunks		= runArena.numberOfChunks,
+	};
+
+	for (size_t c = 0; c < runArena.numberOfChunks; c++)
+	{
+		statistics.numberOfHugeTLBChunks += (runArena.chunks[c].backing == kRunArenaChunkBackingHugeTLB);
+		statistics.numberOfTransparentHugePageChunks += (runArena.chunks[c].backing == kRunArenaChunkBackingTransparentHugePages);
+	}
+
+	return statistics;
+}
+
+/*
+ *	Peak resident set size of the process, in kilobytes (`ru_maxrss` is in
+ *	kilobytes on Linux and in bytes on macOS).
+ */
+static long
+getPeakResidentSetSizeKilobytes(void)
+{
+	struct rusage	resourceUsage;
+
+	if (getrusage(RUSAGE_SELF, &resourceUsage) != 0)
+	{
+		return -1;
+	}
+
+#if defined(__APPLE__)
+	return resourceUsage.ru_maxrss / 1024;
+#else
+	return resourceUsage.ru_maxrss;
+#endif
+}
+
+void
+printMemoryUsage(void)
+{
+	RunArenaStatistics	statistics = getRunArenaStatistics();
+
+	printf("\nPeak resident set size: %ld kB\n", getPeakResidentSetSizeKilobytes());
+	printf(
+		"Run arena: high-water mark %.3lf MB, peak reserved %.3lf MB (%zu chunk(s) now, %zu on explicit huge pages, %zu on transparent huge pages)\n",
+		(double)statistics.highWaterBytes / 1e6,
+		(double)statistics.peakReservedBytes / 1e6,
+		statistics.numberOfChunks,
+		statistics.numberOfHugeTLBChunks,
+		statistics.numberOfTransparentHugePageChunks);
+
+	return;
+}
+
+void
+printMemoryUsageJSON(FILE *  fp)
+{
+	RunArenaStatistics	statistics = getRunArenaStatistics();
+
+	fprintf(
+		fp,
+		", \"memory\": {\"peakResidentSetSizeKilobytes\": %ld, \"runArenaHighWaterBytes\": %zu, \"runArenaPeakReservedBytes\": %zu, "
+		"\"runArenaChunks\": %zu, \"runArenaHugeTLBChunks\": %zu, \"runArenaTransparentHugePageChunks\": %zu}",
+		getPeakResidentSetSizeKilobytes(),
+		statistics.highWaterBytes,
+		statistics.peakReservedBytes,
+		statistics.numberOfChunks,
+		statistics.numberOfHugeTLBChunks,
+		statistics.numberOfTransparentHugePageChunks);
+
+	return;
+}
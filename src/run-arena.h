@@ -0,0 +1,119 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+ *	Run-scoped arena: the buffers of a run (sample arrays, input blocks,
+ *	summaries, scratch space) are carved out of a few large chunks, backed by
+ *	huge pages where available, and all released at once at the end of the
+ *	run. Chunks are mapped but not touched, so their pages are placed on the
+ *	NUMA node of the thread that first writes them. The arena is not
+ *	thread-safe: allocate before starting threads.
+ */
+
+/*
+ *	A position in the arena, to release everything allocated after it
+ *	(e.g., scratch space of a function that may be called many times).
+ */
+typedef struct
+{
+	size_t	numberOfChunks;
+	size_t	usedBytesOfLastChunk;
+} RunArenaMark;
+
+typedef struct
+{
+	size_t	bytesInUse;
+	size_t	highWaterBytes;
+	size_t	reservedBytes;
+	size_t	peakReservedBytes;
+	size_t	numberOfChunks;
+	size_t	numberOfHugeTLBChunks;
+	size_t	numberOfTransparentHugePageChunks;
+} RunArenaStatistics;
+
+/**
+ *	@brief	Allocates from the run arena.
+ *
+ *	@param	size		: The number of bytes.
+ *	@param	alignment	: The alignment, a power of two.
+ *	@return			: The allocated memory, which is freed by `releaseRunArenaToMark()` or `destroyRunArena()`,
+ *				  or `NULL` if the arena has no chunks left or the memory could not be mapped.
+ */
+void *		allocateFromRunArena(size_t size, size_t alignment);
+
+/**
+ *	@brief	Allocates from a new chunk of the run arena that is backed by pages of the base size
+ *		(never huge pages), starting at a page boundary. Memory that threads should own
+ *		page by page (e.g., for first-touch NUMA placement) must not share a 2 MiB huge page
+ *		with the memory of other threads.
+ *	@param	size		: The number of bytes.
+ *	@return			: The allocated memory, which is freed by `releaseRunArenaToMark()` or `destroyRunArena()`,
+ *				  or `NULL` if the arena has no chunks left or the memory could not be mapped.
+ */
+void *		allocateFromRunArenaWithBasePages(size_t size);
+
+/**
+ *	@brief	The current position in the run arena.
+ *
+ *	@return		: The mark.
+ */
+RunArenaMark	getRunArenaMark(void);
+
+/**
+ *	@brief	Releases everything allocated from the run arena after a mark.
+ *
+ *	@param	mark	: The mark.
+ */
+void		releaseRunArenaToMark(RunArenaMark mark);
+
+/**
+ *	@brief	Releases all memory of the run arena.
+ */
+void		destroyRunArena(void);
+
+/**
+ *	@brief	Statistics of the run arena.
+ *
+ *	@return		: The statistics.
+ */
+RunArenaStatistics	getRunArenaStatistics(void);
+
+/**
+ *	@brief	Prints the peak resident set size of the process and the high-water mark and
+ *		reserved size of the run arena.
+ */
+void		printMemoryUsage(void);
+
+/**
+ *	@brief	Prints the same information as `printMemoryUsage()` as a `"memory"` member of an
+ *		open JSON object, after its other members (that is, preceded by a comma).
+ *
+ *	@param	fp	: The file.
+ */
+void		printMemoryUsageJSON(FILE *  fp);
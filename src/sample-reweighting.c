@@ -0,0 +1,523 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "sample-reweighting.h"
+#include "input-distributions.h"
+#include "run-arena.h"
+#include "samplers.h"
+#include "sensor-calibration.h"
+#include "timing.h"
+
+static const char	kSampleReweightingStoreMagic[8] = "FLSRWT02";
+
+/*
+ *	Input and output samples of a run, with the input distributions they were
+ *	drawn from.
+ */
+typedef struct
+{
+	uint64_t			numberOfSamples;
+	InputDistributionSpecification	specifications[kInputDistributionIndexMax];
+	double				(*inputSamples)[kInputDistributionIndexMax];
+	double *			outputSamples[kOutputDistributionIndexMax];
+} StoredSampleSet;
+
+/*
+ *	Samples of an output with their weights, as a `DistributionProbabilityGTFunction`
+ *	distribution. `weights` is `NULL` if all weights are one.
+ */
+typedef struct
+{
+	const double *	samples;
+	const double *	weights;
+	size_t		numberOfSamples;
+	double		totalWeight;
+} WeightedSamples;
+
+/*
+ *	Allocates the samples of a set from the run arena. `false` if it has no
+ *	memory left.
+ */
+static bool
+allocateStoredSampleSet(StoredSampleSet *  set, uint64_t numberOfSamples)
+{
+	bool	isAllocated;
+
+	set->numberOfSamples = numberOfSamples;
+	set->inputSamples = allocateFromRunArena(numberOfSamples * sizeof(*set->inputSamples), kRunArenaDefaultAlignment);
+	isAllocated = (set->inputSamples != NULL);
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		set->outputSamples[j] = (double *) allocateFromRunArena(numberOfSamples * sizeof(double), kRunArenaDefaultAlignment);
+		isAllocated = isAllocated && (set->outputSamples[j] != NULL);
+	}
+
+	return isAllocated;
+}
+
+/*
+ *	Native-endian binary layout: the magic, the number of samples (`uint64_t`),
+ *	the distribution of every input, then the inputs of every sample and the
+ *	samples of every output (`double`). A distribution is its family
+ *	(`uint32_t`), its bounds, mean, standard deviation and mode (`double`), and
+ *	its number of histogram bins (`uint32_t`) followed by their weights (`double`).
+ */
+static bool
+readStoredInputDistributionSpecification(FILE *  fp, InputDistributionSpecification *  specification)
+{
+	uint32_t	family;
+	uint32_t	numberOfHistogramBins;
+
+	*specification = (InputDistributionSpecification) {0};
+
+	if ((fread(&family, sizeof(family), 1, fp) != 1) ||
+		(family >= kInputDistributionFamilyMax) ||
+		(fread(&specification->low, sizeof(double), 1, fp) != 1) ||
+		(fread(&specification->high, sizeof(double), 1, fp) != 1) ||
+		(fread(&specification->mean, sizeof(double), 1, fp) != 1) ||
+		(fread(&specification->standardDeviation, sizeof(double), 1, fp) != 1) ||
+		(fread(&specification->mode, sizeof(double), 1, fp) != 1) ||
+		(fread(&numberOfHistogramBins, sizeof(numberOfHistogramBins), 1, fp) != 1) ||
+		(numberOfHistogramBins > kInputDistributionHistogramMaximumNumberOfBins) ||
+		(fread(specification->histogramWeights, sizeof(double), numberOfHistogramBins, fp) != numberOfHistogramBins))
+	{
+		return false;
+	}
+
+	specification->family = (InputDistributionFamily)family;
+	specification->numberOfHistogramBins = numberOfHistogramBins;
+
+	return (prepareInputDistributionSpecification(specification) == kCommonConstantReturnTypeSuccess);
+}
+
+static bool
+writeStoredInputDistributionSpecification(FILE *  fp, const InputDistributionSpecification *  specification)
+{
+	uint32_t	family = (uint32_t)specification->family;
+	uint32_t	numberOfHistogramBins = (uint32_t)specification->numberOfHistogramBins;
+
+	return (fwrite(&family, sizeof(family), 1, fp) == 1) &&
+		(fwrite(&specification->low, sizeof(double), 1, fp) == 1) &&
+		(fwrite(&specification->high, sizeof(double), 1, fp) == 1) &&
+		(fwrite(&specification->mean, sizeof(double), 1, fp) == 1) &&
+		(fwrite(&specification->standardDeviation, sizeof(double), 1, fp) == 1) &&
+		(fwrite(&specification->mode, sizeof(double), 1, fp) == 1) &&
+		(fwrite(&numberOfHistogramBins, sizeof(numberOfHistogramBins), 1, fp) == 1) &&
+		(fwrite(specification->histogramWeights, sizeof(double), numberOfHistogramBins, fp) == numberOfHistogramBins);
+}
+
+static bool
+readStoredSampleSet(const char *  path, StoredSampleSet *  set, const char **  reason)
+{
+	FILE *		fp = fopen(path, "rb");
+	char		magic[sizeof(kSampleReweightingStoreMagic)];
+	uint64_t	numberOfSamples;
+	bool		isReadSuccessful;
+
+	if (fp == NULL)
+	{
+		*reason = "there was no stored sample set";
+
+		return false;
+	}
+
+	isReadSuccessful = (fread(magic, sizeof(magic), 1, fp) == 1) &&
+				(memcmp(magic, kSampleReweightingStoreMagic, sizeof(magic)) == 0) &&
+				(fread(&numberOfSamples, sizeof(numberOfSamples), 1, fp) == 1) &&
+				(numberOfSamples > 0);
+
+	for (size_t k = 0; isReadSuccessful && (k < kInputDistributionIndexMax); k++)
+	{
+		isReadSuccessful = readStoredInputDistributionSpecification(fp, &set->specifications[k]);
+	}
+
+	if (isReadSuccessful && !allocateStoredSampleSet(set, numberOfSamples))
+	{
+		fclose(fp);
+		*reason = "there was no memory left for the stored sample set";
+
+		return false;
+	}
+
+	if (isReadSuccessful)
+	{
+		isReadSuccessful = (fread(set->inputSamples, sizeof(*set->inputSamples), numberOfSamples, fp) == numberOfSamples);
+	}
+
+	for (size_t j = 0; isReadSuccessful && (j < kOutputDistributionIndexMax); j++)
+	{
+		isReadSuccessful = (fread(set->outputSamples[j], sizeof(double), numberOfSamples, fp) == numberOfSamples);
+	}
+
+	fclose(fp);
+
+	if (!isReadSuccessful)
+	{
+		*reason = "the stored sample set could not be read";
+	}
+
+	return isReadSuccessful;
+}
+
+static bool
+writeStoredSampleSet(const char *  path, const StoredSampleSet *  set)
+{
+	FILE *	fp = fopen(path, "wb");
+	bool	isWriteSuccessful;
+
+	if (fp == NULL)
+	{
+		fprintf(stderr, "Error: Could not open %s for writing.\n", path);
+
+		return false;
+	}
+
+	isWriteSuccessful = (fwrite(kSampleReweightingStoreMagic, sizeof(kSampleReweightingStoreMagic), 1, fp) == 1) &&
+				(fwrite(&set->numberOfSamples, sizeof(set->numberOfSamples), 1, fp) == 1);
+
+	for (size_t k = 0; isWriteSuccessful && (k < kInputDistributionIndexMax); k++)
+	{
+		isWriteSuccessful = writeStoredInputDistributionSpecification(fp, &set->specifications[k]);
+	}
+
+	isWriteSuccessful = isWriteSuccessful &&
+				(fwrite(set->inputSamples, sizeof(*set->inputSamples), set->numberOfSamples, fp) == set->numberOfSamples);
+
+	for (size_t j = 0; isWriteSuccessful && (j < kOutputDistributionIndexMax); j++)
+	{
+		isWriteSuccessful = (fwrite(set->outputSamples[j], sizeof(double), set->numberOfSamples, fp) == set->numberOfSamples);
+	}
+
+	isWriteSuccessful = (fclose(fp) == 0) && isWriteSuccessful;
+
+	if (!isWriteSuccessful)
+	{
+		fprintf(stderr, "Error: Could not write the stored sample set to %s.\n", path);
+	}
+
+	return isWriteSuccessful;
+}
+
+/*
+ *	Weights of the stored samples for the current input distributions, and
+ *	their effective sample size, (sum of weights)^2 / (sum of squared weights).
+ *	The weights are only valid if the current distributions are zero wherever
+ *	the stored ones are, which the caller checks.
+ */
+static double
+calculateReweightingWeights(
+	const StoredSampleSet *			set,
+	const InputDistributionSpecification	specifications[kInputDistributionIndexMax],
+	double *				weights)
+{
+	double	sumOfWeights = 0.0;
+	double	sumOfSquaredWeights = 0.0;
+
+	for (size_t i = 0; i < set->numberOfSamples; i++)
+	{
+		double	weight = 1.0;
+
+		for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+		{
+			weight *= getInputDistributionDensity(&specifications[k], set->inputSamples[i][k]) /
+					getInputDistributionDensity(&set->specifications[k], set->inputSamples[i][k]);
+		}
+
+		weights[i] = weight;
+		sumOfWeights += weight;
+		sumOfSquaredWeights += weight * weight;
+	}
+
+	return (sumOfSquaredWeights > 0.0) ? (sumOfWeights * sumOfWeights) / sumOfSquaredWeights : 0.0;
+}
+
+/*
+ *	Whether the support of every current input distribution lies inside that
+ *	of the stored one. A stored histogram with an empty bin has a gap in its
+ *	support, so it is taken to cover nothing.
+ */
+static bool
+doStoredDistributionsCover(
+	const InputDistributionSpecification	stored[kInputDistributionIndexMax],
+	const InputDistributionSpecification	current[kInputDistributionIndexMax])
+{
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		if ((current[k].low < stored[k].low) || (current[k].high > stored[k].high))
+		{
+			return false;
+		}
+
+		for (size_t b = 0; (stored[k].family == kInputDistributionFamilyHistogram) && (b < stored[k].numberOfHistogramBins); b++)
+		{
+			if (stored[k].histogramWeights[b] == 0.0)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static double
+getWeightedSamplesProbabilityGT(const void *  distribution, double threshold)
+{
+	const WeightedSamples *	samples = (const WeightedSamples *) distribution;
+	double			exceedingWeight = 0.0;
+
+	for (size_t i = 0; i < samples->numberOfSamples; i++)
+	{
+		if (samples->samples[i] > threshold)
+		{
+			exceedingWeight += (samples->weights != NULL) ? samples->weights[i] : 1.0;
+		}
+	}
+
+	return exceedingWeight / samples->totalWeight;
+}
+
+/*
+ *	Weighted means, variances and covariances of the outputs.
+ */
+static JointOutputStatistics
+calculateWeightedJointOutputStatistics(const StoredSampleSet *  set, const double *  weights, double totalWeight)
+{
+	JointOutputStatistics	statistics = {0};
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		double	sum = 0.0;
+
+		for (size_t i = 0; i < set->numberOfSamples; i++)
+		{
+			sum += ((weights != NULL) ? weights[i] : 1.0) * set->outputSamples[j][i];
+		}
+
+		statistics.meanAndVariance[j].mean = sum / totalWeight;
+	}
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		for (size_t l = j; l < kOutputDistributionIndexMax; l++)
+		{
+			double	sum = 0.0;
+
+			for (size_t i = 0; i < set->numberOfSamples; i++)
+			{
+				sum += ((weights != NULL) ? weights[i] : 1.0) *
+					(set->outputSamples[j][i] - statistics.meanAndVariance[j].mean) *
+					(set->outputSamples[l][i] - statistics.meanAndVariance[l].mean);
+			}
+
+			statistics.covariance[j][l] = sum / totalWeight;
+			statistics.covariance[l][j] = statistics.covariance[j][l];
+		}
+
+		statistics.meanAndVariance[j].variance = statistics.covariance[j][j];
+	}
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		for (size_t l = 0; l < kOutputDistributionIndexMax; l++)
+		{
+			double	normalization = sqrt(statistics.covariance[j][j] * statistics.covariance[l][l]);
+
+			statistics.correlation[j][l] = (normalization > 0.0) ? statistics.covariance[j][l] / normalization : 0.0;
+		}
+	}
+
+	return statistics;
+}
+
+CommonConstantReturnType
+runSampleReweighting(
+	const CommandLineArguments *	arguments,
+	const char **			outputVariableDescriptions,
+	const char **			unitsOfMeasurement)
+{
+	RunArenaMark			arenaMark = getRunArenaMark();
+	InputDistributionSpecification	specifications[kInputDistributionIndexMax];
+	StoredSampleSet			set;
+	const char *			reason = NULL;
+	bool				isReweighted = false;
+	double *			weights = NULL;
+	double				totalWeight;
+	double				effectiveSampleSize = 0.0;
+	JointOutputStatistics		statistics;
+	size_t				outputSelect = arguments->common.outputSelect;
+	bool				calculateAllOutputs = (outputSelect == kOutputDistributionIndexMax);
+	PhaseTimer			phaseTimer;
+	uint64_t			cpuTimeUsedInMicroSeconds;
+	CommonConstantReturnType	result = kCommonConstantReturnTypeSuccess;
+	char				reasonBuffer[128];
+
+	getInputDistributionSpecifications(specifications);
+	startPhaseTimer(&phaseTimer);
+
+	if (readStoredSampleSet(arguments->sampleReweightingStorePath, &set, &reason))
+	{
+		lapPhaseTimer(&phaseTimer, kTimingPhaseSampling);
+
+		if (!doStoredDistributionsCover(set.specifications, specifications))
+		{
+			reason = "the input distributions reach outside those of the stored samples";
+		}
+		else
+		{
+			weights = (double *) allocateFromRunArena(set.numberOfSamples * sizeof(double), kRunArenaDefaultAlignment);
+			reason = "there was no memory left for the reweighting weights";
+		}
+
+		if (weights != NULL)
+		{
+			effectiveSampleSize = calculateReweightingWeights(&set, specifications, weights);
+			isReweighted = (effectiveSampleSize >= arguments->minimumEffectiveSampleFraction * (double)set.numberOfSamples);
+
+			snprintf(
+				reasonBuffer,
+				sizeof(reasonBuffer),
+				"the effective sample size of reweighting the stored samples was %.1lf (%.1lf%% of them)",
+				effectiveSampleSize,
+				100.0 * effectiveSampleSize / (double)set.numberOfSamples);
+			reason = reasonBuffer;
+		}
+
+		lapPhaseTimer(&phaseTimer, kTimingPhaseReduction);
+	}
+
+	/*
+	 *	Fall back to fresh samples, which all have weight one.
+	 */
+	if (!isReweighted)
+	{
+		double *	outputSamples[kOutputDistributionIndexMax];
+
+		releaseRunArenaToMark(arenaMark);
+
+		if (!allocateStoredSampleSet(&set, arguments->common.numberOfMonteCarloIterations))
+		{
+			fprintf(stderr, "Error: Out of memory for %zu samples.\n", arguments->common.numberOfMonteCarloIterations);
+			releaseRunArenaToMark(arenaMark);
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		memcpy(set.specifications, specifications, sizeof(specifications));
+		memcpy(outputSamples, set.outputSamples, sizeof(outputSamples));
+		weights = NULL;
+
+		restartPhaseTimerLap(&phaseTimer);
+		sampleInputDistributionsCounterBased(kCounterBasedSamplerDefaultSeed, 0, set.inputSamples, set.numberOfSamples);
+		lapPhaseTimer(&phaseTimer, kTimingPhaseSampling);
+
+		getSensorOutputBlockKernel(kOutputDistributionIndexMax)(
+			(const double (*)[kInputDistributionIndexMax])set.inputSamples,
+			outputSamples,
+			set.numberOfSamples);
+		lapPhaseTimer(&phaseTimer, kTimingPhaseKernel);
+	}
+
+	totalWeight = 0.0;
+
+	for (size_t i = 0; i < set.numberOfSamples; i++)
+	{
+		totalWeight += (weights != NULL) ? weights[i] : 1.0;
+	}
+
+	statistics = calculateWeightedJointOutputStatistics(&set, weights, totalWeight);
+	lapPhaseTimer(&phaseTimer, kTimingPhaseReduction);
+	cpuTimeUsedInMicroSeconds = getPhaseTimerComputationCpuNanoseconds(&phaseTimer) / 1000;
+
+	if (arguments->common.isBenchmarkingMode)
+	{
+		printf("%lf %" PRIu64 "\n", statistics.meanAndVariance[outputSelect].mean, cpuTimeUsedInMicroSeconds);
+	}
+	else
+	{
+		for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+		{
+			WeightedSamples	samples =
+			{
+				.samples		= set.outputSamples[j],
+				.weights		= weights,
+				.numberOfSamples	= set.numberOfSamples,
+				.totalWeight		= totalWeight,
+			};
+
+			if (calculateAllOutputs || (j == outputSelect))
+			{
+				printDistributionValueAndProbabilities(
+					&samples,
+					getWeightedSamplesProbabilityGT,
+					statistics.meanAndVariance[j].mean,
+					outputVariableDescriptions[j],
+					unitsOfMeasurement[j]);
+			}
+		}
+
+		if (calculateAllOutputs)
+		{
+			printJointOutputStatistics(&statistics, outputVariableDescriptions);
+		}
+
+		if (isReweighted)
+		{
+			printf(
+				"\nReweighted the %" PRIu64 " samples stored in %s: effective sample size %.1lf (%.1lf%% of the samples).\n",
+				set.numberOfSamples,
+				arguments->sampleReweightingStorePath,
+				effectiveSampleSize,
+				100.0 * effectiveSampleSize / (double)set.numberOfSamples);
+		}
+		else
+		{
+			printf(
+				"\nDrew %" PRIu64 " fresh samples and stored them in %s, as %s.\n",
+				set.numberOfSamples,
+				arguments->sampleReweightingStorePath,
+				reason);
+		}
+	}
+
+	if (!isReweighted && !writeStoredSampleSet(arguments->sampleReweightingStorePath, &set))
+	{
+		result = kCommonConstantReturnTypeError;
+	}
+
+	lapPhaseTimer(&phaseTimer, kTimingPhaseOutput);
+
+	if (arguments->common.isTimingEnabled && !arguments->common.isBenchmarkingMode)
+	{
+		printPhaseTimings(&phaseTimer, set.numberOfSamples);
+	}
+
+	releaseRunArenaToMark(arenaMark);
+
+	return result;
+}
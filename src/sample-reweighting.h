@@ -0,0 +1,46 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "common.h"
+#include "utilities.h"
+#include "utilities-config.h"
+
+/**
+ *	@brief	Sample reweighting (-L option): answers for the current input distributions from the
+ *		input and output samples stored by an earlier run, weighting each sample by the ratio
+ *		of its density under the current input distributions to that under the stored ones.
+ *		If there is no stored sample set, the current distributions reach outside the stored
+ *		ones, or the effective sample size of the weights is below the threshold, it draws
+ *		-M fresh samples instead and stores them for the next run.
+ *
+ *	@param	arguments			: Pointer to the command-line arguments struct.
+ *	@param	outputVariableDescriptions	: The output variable descriptions.
+ *	@param	unitsOfMeasurement		: The units of measurement of the outputs.
+ *	@return					: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runSampleReweighting(
+					const CommandLineArguments *	arguments,
+					const char **			outputVariableDescriptions,
+					const char **			unitsOfMeasurement);
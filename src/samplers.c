@@ -0,0 +1,936 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uxhw.h>
+#include "common.h"
+#include "input-correlations.h"
+#include "input-distributions.h"
+#include "normal-distribution.h"
+#include "samplers.h"
+#include "sensor-calibration.h"
+
+static const char *	kInputSamplerTypeNames[kInputSamplerTypeMax] =
+{
+	[kInputSamplerTypeMonteCarlo]		= "monte-carlo",
+	[kInputSamplerTypeLatinHypercube]	= "latin-hypercube",
+};
+
+const char *
+getInputSamplerTypeName(InputSamplerType samplerType)
+{
+	return kInputSamplerTypeNames[samplerType];
+}
+
+/*
+ *	Maps uniform variates of the correlated inputs of a block of samples, in
+ *	place, to their distributions under the Gaussian copula: their standard
+ *	Gaussian quantiles are correlated by the Cholesky factor and mapped back
+ *	through the quantile of each distribution. `stride` is the distance, in
+ *	doubles, between consecutive samples of an input.
+ */
+static void
+mapCorrelatedUnitUniformsToInputDistributions(
+	double *	columns[kInputDistributionIndexMax],
+	size_t		stride,
+	size_t		numberOfSamples)
+{
+	const InputCorrelationSpecification *	correlations = getInputCorrelationSpecification();
+
+	for (size_t a = 0; a < correlations->numberOfCorrelatedInputs; a++)
+	{
+		double *	column = columns[correlations->correlatedInputs[a]];
+
+		for (size_t i = 0; i < numberOfSamples; i++)
+		{
+			double	variate = getStandardGaussianQuantile(column[i * stride]);
+
+			column[i * stride] = fmin(fmax(variate, -kGaussianCumulativeTableLimit), kGaussianCumulativeTableLimit);
+		}
+	}
+
+	correlateStandardGaussians(columns, stride, numberOfSamples);
+
+	for (size_t a = 0; a < correlations->numberOfCorrelatedInputs; a++)
+	{
+		size_t					k = correlations->correlatedInputs[a];
+		const InputDistributionSpecification *	specification = getInputDistributionSpecification(k);
+		double *				column = columns[k];
+
+		for (size_t i = 0; i < numberOfSamples; i++)
+		{
+			column[i * stride] = getInputDistributionQuantileOfStandardGaussian(specification, column[i * stride]);
+		}
+	}
+
+	return;
+}
+
+static void
+sampleInputDistributionsLatinHypercube(
+	double	(*inputDistributionBlock)[kInputDistributionIndexMax],
+	size_t	numberOfSamples)
+{
+	const InputCorrelationSpecification *	correlations = getInputCorrelationSpecification();
+	double *				columns[kInputDistributionIndexMax];
+
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		const InputDistributionSpecification *	specification = getInputDistributionSpecification(k);
+
+		columns[k] = &inputDistributionBlock[0][k];
+
+		/*
+		 *	Random permutation of the strata (Fisher-Yates shuffle), in the
+		 *	column itself (stratum indices are exact as doubles).
+		 */
+		for (size_t i = 0; i < numberOfSamples; i++)
+		{
+			inputDistributionBlock[i][k] = (double)i;
+		}
+
+		for (size_t i = numberOfSamples - 1; i > 0; i--)
+		{
+			size_t	j = (size_t)(UxHwDoubleUniformDist(0.0, 1.0) * (double)(i + 1));
+			double	swap;
+
+			j = (j > i) ? i : j;
+			swap = inputDistributionBlock[i][k];
+			inputDistributionBlock[i][k] = inputDistributionBlock[j][k];
+			inputDistributionBlock[j][k] = swap;
+		}
+
+		for (size_t i = 0; i < numberOfSamples; i++)
+		{
+			double	u = (inputDistributionBlock[i][k] + UxHwDoubleUniformDist(0.0, 1.0)) / (double)numberOfSamples;
+
+			inputDistributionBlock[i][k] = correlations->isCorrelated[k] ? u : getInputDistributionQuantile(specification, u);
+		}
+	}
+
+	mapCorrelatedUnitUniformsToInputDistributions(columns, kInputDistributionIndexMax, numberOfSamples);
+
+	return;
+}
+
+void
+sampleInputDistributions(
+	InputSamplerType	samplerType,
+	double			(*inputDistributionBlock)[kInputDistributionIndexMax],
+	size_t			numberOfSamples)
+{
+	if (numberOfSamples == 0)
+	{
+		return;
+	}
+
+	switch (samplerType)
+	{
+		case kInputSamplerTypeLatinHypercube:
+		{
+			sampleInputDistributionsLatinHypercube(inputDistributionBlock, numberOfSamples);
+			break;
+		}
+
+		case kInputSamplerTypeMonteCarlo:
+		default:
+		{
+			for (size_t i = 0; i < numberOfSamples; i++)
+			{
+				setInputDistributionsViaUxHwCall(inputDistributionBlock[i]);
+			}
+			break;
+		}
+	}
+
+	return;
+}
+
+/*
+ *	Finalizer of the SplitMix64 generator (Steele, Lea and Flood, 2014).
+ */
+static uint64_t
+mixSplitMix64(uint64_t z)
+{
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+	return z ^ (z >> 31);
+}
+
+/*
+ *	Random word of input `k` of the sample whose first counter is `counter`.
+ */
+static inline uint64_t
+getCounterBasedWord(uint64_t seed, uint64_t counter, size_t k)
+{
+	return mixSplitMix64(seed + (counter + k + 1) * 0x9E3779B97F4A7C15ULL);
+}
+
+/*
+ *	Next word of the stream of extra words of an input of a sample, for
+ *	samplers that need more than one word.
+ */
+static inline uint64_t
+getNextCounterBasedWord(uint64_t word)
+{
+	return mixSplitMix64(word + 0xD1B54A32D192ED03ULL);
+}
+
+/*
+ *	Uniform variate in [0, 1) of a word.
+ */
+static inline double
+getUniformOfWord(uint64_t word)
+{
+	return (double)(word >> 11) * 0x1.0p-53;
+}
+
+/*
+ *	Uniform variate in [0, 1) of input `k` of the sample whose first counter is `counter`.
+ */
+static inline double
+getCounterBasedUniform(uint64_t seed, uint64_t counter, size_t k)
+{
+	return getUniformOfWord(getCounterBasedWord(seed, counter, k));
+}
+
+/*
+ *	Layers of the Ziggurat: the right edge of every layer (of the base layer,
+ *	its area divided by the height of its top) and the fraction of every layer
+ *	that lies entirely under the density.
+ */
+static double		zigguratEdges[kZigguratNumberOfLayers + 1];
+static double		zigguratRatios[kZigguratNumberOfLayers];
+static pthread_once_t	zigguratTablesOnce = PTHREAD_ONCE_INIT;
+
+static void
+initializeZigguratTables(void)
+{
+	double	density = exp(-0.5 * kZigguratTailStart * kZigguratTailStart);
+
+	zigguratEdges[0] = kZigguratLayerArea / density;
+	zigguratEdges[1] = kZigguratTailStart;
+	zigguratEdges[kZigguratNumberOfLayers] = 0.0;
+
+	for (size_t i = 2; i < kZigguratNumberOfLayers; i++)
+	{
+		zigguratEdges[i] = sqrt(-2.0 * log(kZigguratLayerArea / zigguratEdges[i - 1] + density));
+		density = exp(-0.5 * zigguratEdges[i] * zigguratEdges[i]);
+	}
+
+	for (size_t i = 0; i < kZigguratNumberOfLayers; i++)
+	{
+		zigguratRatios[i] = zigguratEdges[i + 1] / zigguratEdges[i];
+	}
+
+	return;
+}
+
+/*
+ *	Rejection steps of the Ziggurat, rarely reached (about 1.5% of draws):
+ *	the wedges of the layers, the tail beyond `kZigguratTailStart`
+ *	(Marsaglia, 1964) and further draws. `word` is the rejected word. It is
+ *	kept out of line so that it does not weigh on the loops of the fast path.
+ */
+static __attribute__((noinline)) double
+getZigguratStandardGaussianAfterRejection(uint64_t word, size_t layer, double u)
+{
+	for (;;)
+	{
+		if (layer == 0)
+		{
+			double	tailOffset;
+			double	y;
+
+			do
+			{
+				word = getNextCounterBasedWord(word);
+				tailOffset = -log(1.0 - getUniformOfWord(word)) / kZigguratTailStart;
+				word = getNextCounterBasedWord(word);
+				y = -log(1.0 - getUniformOfWord(word));
+			} while (2.0 * y < tailOffset * tailOffset);
+
+			return (u < 0.0) ? -(kZigguratTailStart + tailOffset) : (kZigguratTailStart + tailOffset);
+		}
+		else
+		{
+			double	x = u * zigguratEdges[layer];
+			double	densityAtEdge = exp(-0.5 * (zigguratEdges[layer] * zigguratEdges[layer] - x * x));
+			double	densityAtNextEdge = exp(-0.5 * (zigguratEdges[layer + 1] * zigguratEdges[layer + 1] - x * x));
+
+			word = getNextCounterBasedWord(word);
+
+			if (densityAtNextEdge + getUniformOfWord(word) * (densityAtEdge - densityAtNextEdge) < 1.0)
+			{
+				return x;
+			}
+		}
+
+		word = getNextCounterBasedWord(word);
+		layer = (size_t)(word & (kZigguratNumberOfLayers - 1));
+		u = (double)((int64_t)word >> 11) * 0x1.0p-52;
+
+		if (fabs(u) < zigguratRatios[layer])
+		{
+			return u * zigguratEdges[layer];
+		}
+	}
+}
+
+/*
+ *	Standard Gaussian variate of input `k` of the sample whose first counter is
+ *	`counter`, by the Ziggurat. The same word as `getCounterBasedUniform()`
+ *	gives the layer (its low bits) and the position in it (its high bits).
+ */
+static inline double
+getCounterBasedStandardGaussian(uint64_t seed, uint64_t counter, size_t k)
+{
+	uint64_t	word = getCounterBasedWord(seed, counter, k);
+	size_t		layer = (size_t)(word & (kZigguratNumberOfLayers - 1));
+	double		u = (double)((int64_t)word >> 11) * 0x1.0p-52;
+
+	if (fabs(u) < zigguratRatios[layer])
+	{
+		return u * zigguratEdges[layer];
+	}
+
+	return getZigguratStandardGaussianAfterRejection(word, layer, u);
+}
+
+/*
+ *	Taylor polynomials of the standard Gaussian cumulative distribution
+ *	function about the midpoints of the intervals of the table. The
+ *	derivatives of order n + 1 are (-1)^n He_n(x) times the density, with He_n
+ *	the probabilists' Hermite polynomials, so the relative error stays small
+ *	in the tails, where the derivatives shrink with the function itself.
+ */
+#define kGaussianCumulativeTableNumberOfIntervals	(2 * kGaussianCumulativeTableLimit * kGaussianCumulativeTableIntervalsPerUnit)
+#define kGaussianCumulativeTableNumberOfCoefficients	(8)
+
+static double		gaussianCumulativeTable[kGaussianCumulativeTableNumberOfIntervals][kGaussianCumulativeTableNumberOfCoefficients];
+static pthread_once_t	gaussianCumulativeTableOnce = PTHREAD_ONCE_INIT;
+
+static void
+initializeGaussianCumulativeTable(void)
+{
+	for (size_t j = 0; j < kGaussianCumulativeTableNumberOfIntervals; j++)
+	{
+		double	midpoint = -kGaussianCumulativeTableLimit + ((double)j + 0.5) / kGaussianCumulativeTableIntervalsPerUnit;
+		double	density = getStandardGaussianDensity(midpoint);
+		double	hermite = 1.0;
+		double	previousHermite = 0.0;
+		double	factorial = 1.0;
+		double	sign = 1.0;
+
+		gaussianCumulativeTable[j][0] = getStandardGaussianCumulativeProbability(midpoint);
+
+		for (size_t n = 1; n < kGaussianCumulativeTableNumberOfCoefficients; n++)
+		{
+			double	nextHermite = midpoint * hermite - (double)(n - 1) * previousHermite;
+
+			factorial *= (double)n;
+			gaussianCumulativeTable[j][n] = sign * hermite * density / factorial;
+			previousHermite = hermite;
+			hermite = nextHermite;
+			sign = -sign;
+		}
+	}
+
+	return;
+}
+
+/*
+ *	Standard Gaussian cumulative probability of a variate, from the table, at
+ *	a fraction of the cost of `erfc()`. The polynomial is evaluated by
+ *	Estrin's scheme, whose dependency chains are half as long as those of
+ *	Horner's.
+ */
+static inline double
+getTabulatedStandardGaussianCumulativeProbability(double x)
+{
+	double		clamped = (x < -kGaussianCumulativeTableLimit) ? -kGaussianCumulativeTableLimit : x;
+	double		position;
+	size_t		interval;
+	double		offset;
+	double		offsetSquared;
+	const double *	c;
+
+	clamped = (clamped > kGaussianCumulativeTableLimit) ? kGaussianCumulativeTableLimit : clamped;
+	position = (clamped + kGaussianCumulativeTableLimit) * kGaussianCumulativeTableIntervalsPerUnit;
+	interval = (size_t)(int64_t)position;
+	interval = (interval > kGaussianCumulativeTableNumberOfIntervals - 1) ? kGaussianCumulativeTableNumberOfIntervals - 1 : interval;
+	offset = (position - (double)interval - 0.5) * (1.0 / kGaussianCumulativeTableIntervalsPerUnit);
+	offsetSquared = offset * offset;
+	c = gaussianCumulativeTable[interval];
+
+	return ((c[0] + c[1] * offset) + offsetSquared * (c[2] + c[3] * offset)) +
+		(offsetSquared * offsetSquared) * ((c[4] + c[5] * offset) + offsetSquared * (c[6] + c[7] * offset));
+}
+
+/*
+ *	Nonzero entries of the row of an input in the Cholesky factor of the
+ *	correlation matrix, with the inputs of their columns.
+ */
+typedef struct
+{
+	size_t	numberOfTerms;
+	size_t	inputs[kInputDistributionIndexMax];
+	double	coefficients[kInputDistributionIndexMax];
+} CholeskyFactorRow;
+
+static CholeskyFactorRow
+getCholeskyFactorRow(const InputCorrelationSpecification *  correlations, size_t k)
+{
+	CholeskyFactorRow	row = {.numberOfTerms = 0};
+
+	for (size_t m = 0; m <= k; m++)
+	{
+		if (correlations->choleskyFactor[k][m] != 0.0)
+		{
+			row.inputs[row.numberOfTerms] = m;
+			row.coefficients[row.numberOfTerms] = correlations->choleskyFactor[k][m];
+			row.numberOfTerms++;
+		}
+	}
+
+	return row;
+}
+
+/*
+ *	Correlated standard Gaussian variate of an input of a sample, from the
+ *	independent variates of the inputs up to it.
+ */
+static inline double
+getCorrelatedStandardGaussian(const double *  sample, const CholeskyFactorRow *  row)
+{
+	double	variate = 0.0;
+
+	for (size_t t = 0; t < row->numberOfTerms; t++)
+	{
+		variate += row->coefficients[t] * sample[row->inputs[t]];
+	}
+
+	return variate;
+}
+
+/*
+ *	Independent standard Gaussian variates of the correlated inputs of a
+ *	chunk of samples, by the Ziggurat from the words of the inputs, in their
+ *	columns of the chunk. The Cholesky factor then combines them from the
+ *	last correlated input to the first, so that every row still reads the
+ *	independent variates of the inputs before it, and the combination is
+ *	fused with the mapping of each input to its distribution.
+ */
+static void
+sampleCopulaStandardGaussiansCounterBased(
+	const InputCorrelationSpecification *	correlations,
+	uint64_t				seed,
+	uint64_t				firstSampleIndex,
+	double					(*chunk)[kInputDistributionIndexMax],
+	size_t					numberOfSamples)
+{
+	for (size_t a = 0; a < correlations->numberOfCorrelatedInputs; a++)
+	{
+		size_t	k = correlations->correlatedInputs[a];
+
+		for (size_t i = 0; i < numberOfSamples; i++)
+		{
+			uint64_t	counter = (firstSampleIndex + i) * kInputDistributionIndexMax;
+
+			chunk[i][k] = getCounterBasedStandardGaussian(seed, counter, k);
+		}
+	}
+
+	return;
+}
+
+/*
+ *	Maps the uniform variates of input `k` of a block of samples, in place, to
+ *	its distribution. Every family has its own loop, so the loops over the
+ *	uniform and Gaussian inputs stay free of branches on the family.
+ */
+static void
+mapUnitUniformsToInputDistribution(
+	const InputDistributionSpecification *	specification,
+	double					(*block)[kInputDistributionIndexMax],
+	size_t					k,
+	size_t					numberOfSamples)
+{
+	switch (specification->family)
+	{
+		case kInputDistributionFamilyUniform:
+		{
+			double	low = specification->low;
+			double	width = specification->high - specification->low;
+
+			for (size_t i = 0; i < numberOfSamples; i++)
+			{
+				block[i][k] = low + block[i][k] * width;
+			}
+			break;
+		}
+
+		default:
+		{
+			for (size_t i = 0; i < numberOfSamples; i++)
+			{
+				block[i][k] = getInputDistributionQuantile(specification, block[i][k]);
+			}
+			break;
+		}
+	}
+
+	return;
+}
+
+/*
+ *	Triangular input `k` of a chunk of samples, as the mix of the smaller and
+ *	the larger of two uniform variates with the weights of the relative
+ *	position of the mode (Stein and Keblis, 2009): no square root, and no
+ *	branch on the side of the mode, which would be mispredicted for every
+ *	other sample.
+ */
+static void
+sampleTriangularCounterBased(
+	const InputDistributionSpecification *	specification,
+	uint64_t				seed,
+	uint64_t				firstSampleIndex,
+	double					(*chunk)[kInputDistributionIndexMax],
+	size_t					k,
+	size_t					numberOfSamples)
+{
+	double	low = specification->low;
+	double	width = specification->high - specification->low;
+	double	modePosition = (specification->mode - specification->low) / width;
+
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		uint64_t	counter = (firstSampleIndex + i) * kInputDistributionIndexMax;
+		uint64_t	word = getCounterBasedWord(seed, counter, k);
+		double		u = getUniformOfWord(word);
+		double		v = getUniformOfWord(getNextCounterBasedWord(word));
+		double		smaller = (u < v) ? u : v;
+		double		larger = (u > v) ? u : v;
+
+		chunk[i][k] = low + width * ((1.0 - modePosition) * smaller + modePosition * larger);
+	}
+
+	return;
+}
+
+/*
+ *	Histogram input `k` of a chunk of samples, by the alias method (Walker,
+ *	1977, with the table construction of Vose, 1991) on a single uniform
+ *	variate: its integer part picks a column of the table, and its fractional
+ *	part both picks the bin of the column and places the sample in the bin.
+ *	Neither step branches.
+ */
+static void
+sampleHistogramCounterBased(
+	const InputDistributionSpecification *	specification,
+	uint64_t				seed,
+	uint64_t				firstSampleIndex,
+	double					(*chunk)[kInputDistributionIndexMax],
+	size_t					k,
+	size_t					numberOfSamples)
+{
+	size_t	numberOfBins = specification->numberOfHistogramBins;
+	double	binWidth = (specification->high - specification->low) / (double)numberOfBins;
+	double	scaledProbabilities[kInputDistributionHistogramMaximumNumberOfBins];
+	double	thresholds[kInputDistributionHistogramMaximumNumberOfBins];
+	double	offsets[2 * kInputDistributionHistogramMaximumNumberOfBins];
+	double	scales[2 * kInputDistributionHistogramMaximumNumberOfBins];
+	size_t	aliases[kInputDistributionHistogramMaximumNumberOfBins];
+	size_t	smallBins[kInputDistributionHistogramMaximumNumberOfBins];
+	size_t	largeBins[kInputDistributionHistogramMaximumNumberOfBins];
+	size_t	numberOfSmallBins = 0;
+	size_t	numberOfLargeBins = 0;
+
+	for (size_t b = 0; b < numberOfBins; b++)
+	{
+		scaledProbabilities[b] = (specification->histogramCumulativeProbabilities[b + 1] - specification->histogramCumulativeProbabilities[b]) *
+						(double)numberOfBins;
+		aliases[b] = b;
+
+		if (scaledProbabilities[b] < 1.0)
+		{
+			smallBins[numberOfSmallBins++] = b;
+		}
+		else
+		{
+			largeBins[numberOfLargeBins++] = b;
+		}
+	}
+
+	while ((numberOfSmallBins > 0) && (numberOfLargeBins > 0))
+	{
+		size_t	smallBin = smallBins[--numberOfSmallBins];
+		size_t	largeBin = largeBins[--numberOfLargeBins];
+
+		thresholds[smallBin] = scaledProbabilities[smallBin];
+		aliases[smallBin] = largeBin;
+		scaledProbabilities[largeBin] -= 1.0 - scaledProbabilities[smallBin];
+
+		if (scaledProbabilities[largeBin] < 1.0)
+		{
+			smallBins[numberOfSmallBins++] = largeBin;
+		}
+		else
+		{
+			largeBins[numberOfLargeBins++] = largeBin;
+		}
+	}
+
+	/*
+	 *	What is left holds the whole of its column, up to rounding.
+	 */
+	while (numberOfSmallBins > 0)
+	{
+		thresholds[smallBins[--numberOfSmallBins]] = 1.0;
+	}
+
+	while (numberOfLargeBins > 0)
+	{
+		thresholds[largeBins[--numberOfLargeBins]] = 1.0;
+	}
+
+	/*
+	 *	A fractional part below the threshold of column `b` falls in bin `b`,
+	 *	mapped into it by entry `2 * b` of `offsets` and `scales`, and one at or
+	 *	above it in the alias bin, mapped by entry `2 * b + 1`.
+	 */
+	for (size_t b = 0; b < numberOfBins; b++)
+	{
+		scales[2 * b] = (thresholds[b] > 0.0) ? binWidth / thresholds[b] : 0.0;
+		scales[2 * b + 1] = (thresholds[b] < 1.0) ? binWidth / (1.0 - thresholds[b]) : 0.0;
+		offsets[2 * b] = specification->low + (double)b * binWidth;
+		offsets[2 * b + 1] = specification->low + (double)aliases[b] * binWidth - thresholds[b] * scales[2 * b + 1];
+	}
+
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		uint64_t	counter = (firstSampleIndex + i) * kInputDistributionIndexMax;
+		double		scaledU = getCounterBasedUniform(seed, counter, k) * (double)numberOfBins;
+		size_t		column = (size_t)scaledU;
+		double		fraction = scaledU - (double)column;
+		size_t		entry = 2 * column + (size_t)(fraction >= thresholds[column]);
+
+		chunk[i][k] = offsets[entry] + fraction * scales[entry];
+	}
+
+	return;
+}
+
+void
+sampleInputDistributionsCounterBased(
+	uint64_t	seed,
+	uint64_t	firstSampleIndex,
+	double		(*inputDistributionBlock)[kInputDistributionIndexMax],
+	size_t		numberOfSamples)
+{
+	const InputDistributionSpecification *	specifications[kInputDistributionIndexMax];
+
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		specifications[k] = getInputDistributionSpecification(k);
+	}
+
+	sampleGivenInputDistributionsCounterBased(
+		specifications,
+		getInputCorrelationSpecification(),
+		seed,
+		firstSampleIndex,
+		inputDistributionBlock,
+		numberOfSamples);
+
+	return;
+}
+
+void
+sampleGivenInputDistributionsCounterBased(
+	const InputDistributionSpecification * const	specifications[kInputDistributionIndexMax],
+	const InputCorrelationSpecification *		correlations,
+	uint64_t					seed,
+	uint64_t					firstSampleIndex,
+	double						(*inputDistributionBlock)[kInputDistributionIndexMax],
+	size_t						numberOfSamples)
+{
+	pthread_once(&zigguratTablesOnce, initializeZigguratTables);
+	pthread_once(&gaussianCumulativeTableOnce, initializeGaussianCumulativeTable);
+
+	/*
+	 *	One input at a time over chunks of at most `kMonteCarloBlockSize`
+	 *	samples, so that the loops are specialized to the family and the chunk
+	 *	stays in cache across the inputs.
+	 */
+	for (size_t chunkStart = 0; chunkStart < numberOfSamples; chunkStart += kMonteCarloBlockSize)
+	{
+		size_t	chunkLength = ((numberOfSamples - chunkStart) < kMonteCarloBlockSize) ? (numberOfSamples - chunkStart) : kMonteCarloBlockSize;
+		double	(*chunk)[kInputDistributionIndexMax] = &inputDistributionBlock[chunkStart];
+
+		for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+		{
+			const InputDistributionSpecification *	specification = specifications[k];
+
+			if (correlations->isCorrelated[k])
+			{
+				continue;
+			}
+
+			switch (specification->family)
+			{
+				case kInputDistributionFamilyUniform:
+				{
+					double	low = specification->low;
+					double	width = specification->high - specification->low;
+
+					for (size_t i = 0; i < chunkLength; i++)
+					{
+						uint64_t	counter = (firstSampleIndex + chunkStart + i) * kInputDistributionIndexMax;
+
+						chunk[i][k] = low + getCounterBasedUniform(seed, counter, k) * width;
+					}
+					break;
+				}
+
+				case kInputDistributionFamilyGaussian:
+				{
+					double	mean = specification->mean;
+					double	standardDeviation = specification->standardDeviation;
+
+					for (size_t i = 0; i < chunkLength; i++)
+					{
+						uint64_t	counter = (firstSampleIndex + chunkStart + i) * kInputDistributionIndexMax;
+
+						chunk[i][k] = mean + standardDeviation * getCounterBasedStandardGaussian(seed, counter, k);
+					}
+					break;
+				}
+
+				case kInputDistributionFamilyTriangular:
+				{
+					sampleTriangularCounterBased(specification, seed, firstSampleIndex + chunkStart, chunk, k, chunkLength);
+					break;
+				}
+
+				case kInputDistributionFamilyHistogram:
+				{
+					sampleHistogramCounterBased(specification, seed, firstSampleIndex + chunkStart, chunk, k, chunkLength);
+					break;
+				}
+
+				default:
+				{
+					for (size_t i = 0; i < chunkLength; i++)
+					{
+						uint64_t	counter = (firstSampleIndex + chunkStart + i) * kInputDistributionIndexMax;
+
+						chunk[i][k] = getInputDistributionQuantile(specification, getCounterBasedUniform(seed, counter, k));
+					}
+					break;
+				}
+			}
+		}
+
+		if (correlations->numberOfCorrelatedInputs == 0)
+		{
+			continue;
+		}
+
+		/*
+		 *	The correlated inputs, through their Gaussian copula: Gaussian
+		 *	inputs take the correlated variates directly, uniform ones their
+		 *	tabulated cumulative probabilities, and the others the quantile of
+		 *	those.
+		 */
+		sampleCopulaStandardGaussiansCounterBased(correlations, seed, firstSampleIndex + chunkStart, chunk, chunkLength);
+
+		for (size_t a = correlations->numberOfCorrelatedInputs; a-- > 0;)
+		{
+			size_t					k = correlations->correlatedInputs[a];
+			const InputDistributionSpecification *	specification = specifications[k];
+			CholeskyFactorRow			row = getCholeskyFactorRow(correlations, k);
+
+			switch (specification->family)
+			{
+				case kInputDistributionFamilyGaussian:
+				{
+					double	mean = specification->mean;
+					double	standardDeviation = specification->standardDeviation;
+
+					for (size_t i = 0; i < chunkLength; i++)
+					{
+						chunk[i][k] = mean + standardDeviation * getCorrelatedStandardGaussian(chunk[i], &row);
+					}
+					break;
+				}
+
+				case kInputDistributionFamilyUniform:
+				{
+					double	low = specification->low;
+					double	width = specification->high - specification->low;
+
+					for (size_t i = 0; i < chunkLength; i++)
+					{
+						chunk[i][k] = low + getTabulatedStandardGaussianCumulativeProbability(getCorrelatedStandardGaussian(chunk[i], &row)) * width;
+					}
+					break;
+				}
+
+				default:
+				{
+					for (size_t i = 0; i < chunkLength; i++)
+					{
+						chunk[i][k] = getInputDistributionQuantile(
+									specification,
+									getTabulatedStandardGaussianCumulativeProbability(getCorrelatedStandardGaussian(chunk[i], &row)));
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	return;
+}
+
+void
+mapUnitUniformsToInputDistributions(
+	const InputDistributionSpecification	specifications[kInputDistributionIndexMax],
+	const double				(*uniformBlock)[kInputDistributionIndexMax],
+	double					(*inputDistributionBlock)[kInputDistributionIndexMax],
+	size_t					numberOfSamples)
+{
+	if ((const double (*)[kInputDistributionIndexMax])inputDistributionBlock != uniformBlock)
+	{
+		memcpy(inputDistributionBlock, uniformBlock, numberOfSamples * sizeof(*inputDistributionBlock));
+	}
+
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		mapUnitUniformsToInputDistribution(&specifications[k], inputDistributionBlock, k, numberOfSamples);
+	}
+
+	return;
+}
+
+void
+sampleUnitUniformsCounterBased(
+	uint64_t	seed,
+	uint64_t	firstSampleIndex,
+	double		(*uniformBlock)[kInputDistributionIndexMax],
+	size_t		numberOfSamples)
+{
+	const InputCorrelationSpecification *	correlations = getInputCorrelationSpecification();
+
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		uint64_t	counter = (firstSampleIndex + i) * kInputDistributionIndexMax;
+
+		for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+		{
+			uniformBlock[i][k] = getCounterBasedUniform(seed, counter, k);
+		}
+	}
+
+	if (correlations->numberOfCorrelatedInputs == 0)
+	{
+		return;
+	}
+
+	/*
+	 *	The uniforms of the correlated inputs are the cumulative probabilities
+	 *	of their correlated Gaussian variates, so that every scenario maps them
+	 *	through the same copula.
+	 */
+	pthread_once(&zigguratTablesOnce, initializeZigguratTables);
+	pthread_once(&gaussianCumulativeTableOnce, initializeGaussianCumulativeTable);
+	sampleCopulaStandardGaussiansCounterBased(correlations, seed, firstSampleIndex, uniformBlock, numberOfSamples);
+
+	for (size_t a = correlations->numberOfCorrelatedInputs; a-- > 0;)
+	{
+		size_t			k = correlations->correlatedInputs[a];
+		CholeskyFactorRow	row = getCholeskyFactorRow(correlations, k);
+
+		for (size_t i = 0; i < numberOfSamples; i++)
+		{
+			uniformBlock[i][k] = getTabulatedStandardGaussianCumulativeProbability(getCorrelatedStandardGaussian(uniformBlock[i], &row));
+		}
+	}
+
+	return;
+}
+
+void
+sampleInputDistributionsStratified(
+	uint64_t	seed,
+	double *	inputSamples[kInputDistributionIndexMax],
+	size_t		numberOfSamples)
+{
+	const InputCorrelationSpecification *	correlations = getInputCorrelationSpecification();
+
+	if (numberOfSamples == 0)
+	{
+		return;
+	}
+
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		const InputDistributionSpecification *	specification = getInputDistributionSpecification(k);
+
+		for (size_t i = 0; i < numberOfSamples; i++)
+		{
+			double	p = ((double)i + 0.5) / (double)numberOfSamples;
+
+			inputSamples[k][i] = correlations->isCorrelated[k] ? p : getInputDistributionQuantile(specification, p);
+		}
+
+		/*
+		 *	Random permutation of the strata (Fisher-Yates shuffle), with a
+		 *	different stream of the generator for every input.
+		 */
+		for (size_t i = numberOfSamples - 1; i > 0; i--)
+		{
+			uint64_t	counter = (uint64_t)k * numberOfSamples + i;
+			size_t		j = (size_t)((double)(mixSplitMix64(seed + (counter + 1) * 0x9E3779B97F4A7C15ULL) >> 11) * 0x1.0p-53 * (double)(i + 1));
+			double		swap;
+
+			j = (j > i) ? i : j;
+			swap = inputSamples[k][i];
+			inputSamples[k][i] = inputSamples[k][j];
+			inputSamples[k][j] = swap;
+		}
+	}
+
+	/*
+	 *	The correlated inputs keep their shuffled strata as probabilities
+	 *	until now, for the copula to correlate their Gaussian quantiles.
+	 */
+	mapCorrelatedUnitUniformsToInputDistributions(inputSamples, 1, numberOfSamples);
+
+	return;
+}
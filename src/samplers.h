@@ -0,0 +1,149 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "input-correlations.h"
+#include "input-distributions.h"
+#include "utilities-config.h"
+
+/*
+ *	Ways of drawing a set of samples of the input distributions:
+ *		kInputSamplerTypeMonteCarlo	: Independent samples, via the UxHw Parametric functions.
+ *		kInputSamplerTypeLatinHypercube	: Latin hypercube samples: the range of every input is split into as many
+ *						  equiprobable strata as there are samples, each stratum holds exactly one
+ *						  sample, and the strata of the different inputs are paired at random.
+ */
+typedef enum
+{
+	kInputSamplerTypeMonteCarlo					= 0,
+	kInputSamplerTypeLatinHypercube					= 1,
+	kInputSamplerTypeMax,
+} InputSamplerType;
+
+/**
+ *	@brief	Name of an input sampler type, as used in reports.
+ *
+ *	@param	samplerType	: The sampler type.
+ *	@return			: The name.
+ */
+const char *	getInputSamplerTypeName(InputSamplerType samplerType);
+
+/**
+ *	@brief	Draws a set of samples of the input distributions.
+ *
+ *	@param	samplerType		: The sampler type.
+ *	@param	inputDistributionBlock	: Output. The input distributions of each sample.
+ *	@param	numberOfSamples		: The number of samples to draw.
+ */
+void		sampleInputDistributions(
+			InputSamplerType	samplerType,
+			double			(*inputDistributionBlock)[kInputDistributionIndexMax],
+			size_t			numberOfSamples);
+
+/**
+ *	@brief	Draws a set of independent samples of the input distributions with a counter-based
+ *		generator (SplitMix64): the inputs of the sample with a given index are a function of
+ *		the seed and that index only. Disjoint ranges of indices therefore give disjoint
+ *		slices of the same random stream, whichever process or thread computes them.
+ *		Gaussian inputs are drawn by the Ziggurat, and the other families by their
+ *		quantile functions, one input at a time over the whole set.
+ *
+ *	@param	seed			: The seed of the generator.
+ *	@param	firstSampleIndex	: The index of the first sample.
+ *	@param	inputDistributionBlock	: Output. The input distributions of each sample.
+ *	@param	numberOfSamples		: The number of samples to draw.
+ */
+void		sampleInputDistributionsCounterBased(
+			uint64_t	seed,
+			uint64_t	firstSampleIndex,
+			double		(*inputDistributionBlock)[kInputDistributionIndexMax],
+			size_t		numberOfSamples);
+
+/**
+ *	@brief	Draws samples as `sampleInputDistributionsCounterBased()` does, from given input
+ *		distributions and correlations instead of the current ones, so that callers
+ *		with distributions of their own do not share them through the current ones.
+ *
+ *	@param	specifications		: The prepared distributions, indexed by `InputDistributionIndex`.
+ *	@param	correlations		: The prepared correlations.
+ *	@param	seed			: The seed of the generator.
+ *	@param	firstSampleIndex	: The index of the first sample.
+ *	@param	inputDistributionBlock	: Output. The input distributions of each sample.
+ *	@param	numberOfSamples		: The number of samples to draw.
+ */
+void		sampleGivenInputDistributionsCounterBased(
+			const InputDistributionSpecification * const	specifications[kInputDistributionIndexMax],
+			const InputCorrelationSpecification *		correlations,
+			uint64_t					seed,
+			uint64_t					firstSampleIndex,
+			double						(*inputDistributionBlock)[kInputDistributionIndexMax],
+			size_t						numberOfSamples);
+
+/**
+ *	@brief	Draws the uniform variates in [0, 1) from which `sampleInputDistributionsCounterBased()`
+ *		draws the same samples, before they are mapped to the bounds of the inputs.
+ *
+ *	@param	seed			: The seed of the generator.
+ *	@param	firstSampleIndex	: The index of the first sample.
+ *	@param	uniformBlock		: Output. The uniform variates of each input of each sample.
+ *	@param	numberOfSamples		: The number of samples to draw.
+ */
+void		sampleUnitUniformsCounterBased(
+			uint64_t	seed,
+			uint64_t	firstSampleIndex,
+			double		(*uniformBlock)[kInputDistributionIndexMax],
+			size_t		numberOfSamples);
+
+/**
+ *	@brief	Maps uniform variates in [0, 1) to samples of the given input distributions, by
+ *		their quantile functions.
+ *
+ *	@param	specifications		: The input distributions, indexed by `InputDistributionIndex`.
+ *	@param	uniformBlock		: The uniform variates of each input of each sample.
+ *	@param	inputDistributionBlock	: Output. The input distributions of each sample. May be `uniformBlock`.
+ *	@param	numberOfSamples		: The number of samples.
+ */
+void		mapUnitUniformsToInputDistributions(
+			const InputDistributionSpecification	specifications[kInputDistributionIndexMax],
+			const double				(*uniformBlock)[kInputDistributionIndexMax],
+			double					(*inputDistributionBlock)[kInputDistributionIndexMax],
+			size_t					numberOfSamples);
+
+/**
+ *	@brief	Sets deterministic Latin hypercube samples of the input distributions: the range of
+ *		every input is split into as many equiprobable strata as there are samples, each
+ *		sample is the quantile of the middle probability of one stratum, and the strata of the different inputs are
+ *		paired by permutations drawn with the counter-based generator. The same seed
+ *		therefore always gives the same samples.
+ *
+ *	@param	seed			: The seed of the generator.
+ *	@param	inputSamples		: Output. The per-input arrays of samples.
+ *	@param	numberOfSamples		: The number of samples.
+ */
+void		sampleInputDistributionsStratified(
+			uint64_t	seed,
+			double *	inputSamples[kInputDistributionIndexMax],
+			size_t		numberOfSamples);
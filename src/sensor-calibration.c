@@ -0,0 +1,542 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdbool.h>
+#include <uxhw.h>
+#include "input-correlations.h"
+#include "input-distributions.h"
+#include "run-arena.h"
+#include "sensor-calibration.h"
+
+/**
+ *	@brief  Sensor calibration routines taken from the screenshot on page 6 of
+ *		FL-000986-TN-7, 2022-01-30.
+ *
+ *		This is the common body of the output-specialized kernels below. The
+ *		`calculateMassFlow` and `calculateDifferentialPressure` flags are
+ *		compile-time constants at every call site, so the compiler removes the
+ *		untaken branches (and the loads of their inputs) from each variant.
+ *
+ *	@param  inputDistributions		: The array of input distributions used in the calculation.
+ * 	@param  outputDistributions		: An array of of output distributions. Writes the results to the selected entries.
+ *	@param  calculateMassFlow		: Whether to write `outputDistributions[kOutputDistributionIndexCalibratedMassFlowOutput]`.
+ *	@param  calculateDifferentialPressure	: Whether to write `outputDistributions[kOutputDistributionIndexCalibratedDifferentialPressureOutput]`.
+ *
+ *	@return	double				: Returns the distributional value calculated last.
+ */
+static inline double
+calculateSensorOutput(
+	const double *  inputDistributions,
+	double *  	outputDistributions,
+	const bool	calculateMassFlow,
+	const bool	calculateDifferentialPressure)
+{
+	double	calibratedValue = 0.0;
+	double	m;
+	double	h;
+
+	h = inputDistributions[kInputDistributionIndexHxfer];
+
+	/*
+	 *	The calculation of mass flow is common in the two output calculations.
+	 */
+	m = kSensorCalibrationConstant3 * pow(h, 3) + kSensorCalibrationConstant2 * pow(h, 2) + kSensorCalibrationConstant1;
+
+	if (calculateMassFlow)
+	{
+		calibratedValue = m;
+
+		outputDistributions[kOutputDistributionIndexCalibratedMassFlowOutput] = calibratedValue;
+	}
+
+	if (calculateDifferentialPressure)
+	{
+		double	Tflow;
+		double	T0;
+		double	Pflow;
+		double	P0;
+
+		Tflow = inputDistributions[kInputDistributionIndexTflow];
+		T0 = inputDistributions[kInputDistributionIndexT0];
+		Pflow = inputDistributions[kInputDistributionIndexPflow];
+		P0 = inputDistributions[kInputDistributionIndexP0];
+
+		calibratedValue = m * (Tflow/T0) * (P0/Pflow);
+		outputDistributions[kOutputDistributionIndexCalibratedDifferentialPressureOutput] = calibratedValue;
+	}
+
+	return	calibratedValue;
+}
+
+/*
+ *	Output-specialized variants of `calculateSensorOutput()`, for a single
+ *	set of inputs and for a block of inputs. The block variants write each
+ *	selected output straight into its own array of samples.
+ */
+#define defineSensorOutputKernels(name, calculateMassFlow, calculateDifferentialPressure)\
+	static double\
+	name(const double *  inputDistributions, double *  outputDistributions)\
+	{\
+		return calculateSensorOutput(\
+				inputDistributions,\
+				outputDistributions,\
+				(calculateMassFlow),\
+				(calculateDifferentialPressure));\
+	}\
+\
+	static void\
+	name##Block(\
+		const double	(*inputDistributionBlock)[kInputDistributionIndexMax],\
+		double *	outputSamples[kOutputDistributionIndexMax],\
+		size_t		numberOfSamples)\
+	{\
+		double	outputDistributions[kOutputDistributionIndexMax];\
+\
+		for (size_t i = 0; i < numberOfSamples; i++)\
+		{\
+			calculateSensorOutput(\
+				inputDistributionBlock[i],\
+				outputDistributions,\
+				(calculateMassFlow),\
+				(calculateDifferentialPressure));\
+\
+			if (calculateMassFlow)\
+			{\
+				outputSamples[kOutputDistributionIndexCalibratedMassFlowOutput][i] =\
+					outputDistributions[kOutputDistributionIndexCalibratedMassFlowOutput];\
+			}\
+\
+			if (calculateDifferentialPressure)\
+			{\
+				outputSamples[kOutputDistributionIndexCalibratedDifferentialPressureOutput][i] =\
+					outputDistributions[kOutputDistributionIndexCalibratedDifferentialPressureOutput];\
+			}\
+		}\
+	}
+
+defineSensorOutputKernels(calculateSensorOutputMassFlow,		true,	false)
+defineSensorOutputKernels(calculateSensorOutputDifferentialPressure,	false,	true)
+defineSensorOutputKernels(calculateSensorOutputAll,			true,	true)
+
+#undef defineSensorOutputKernels
+
+/*
+ *	Kernel lookup tables, indexed by the output select value (`-S` option).
+ */
+static const SensorOutputKernel	kSensorOutputKernels[kOutputDistributionIndexMax + 1] =
+{
+	[kOutputDistributionIndexCalibratedMassFlowOutput]		= calculateSensorOutputMassFlow,
+	[kOutputDistributionIndexCalibratedDifferentialPressureOutput]	= calculateSensorOutputDifferentialPressure,
+	[kOutputDistributionIndexMax]					= calculateSensorOutputAll,
+};
+
+static const SensorOutputBlockKernel	kSensorOutputBlockKernels[kOutputDistributionIndexMax + 1] =
+{
+	[kOutputDistributionIndexCalibratedMassFlowOutput]		= calculateSensorOutputMassFlowBlock,
+	[kOutputDistributionIndexCalibratedDifferentialPressureOutput]	= calculateSensorOutputDifferentialPressureBlock,
+	[kOutputDistributionIndexMax]					= calculateSensorOutputAllBlock,
+};
+
+SensorOutputKernel
+getSensorOutputKernel(size_t outputSelect)
+{
+	return kSensorOutputKernels[outputSelect];
+}
+
+SensorOutputBlockKernel
+getSensorOutputBlockKernel(size_t outputSelect)
+{
+	return kSensorOutputBlockKernels[outputSelect];
+}
+
+/*
+ *	Draws an input from its current distribution, via the UxHw Parametric functions.
+ *	The families without a UxHw Parametric function are the quantile function of a
+ *	uniform distribution.
+ */
+static inline double
+getInputDistributionViaUxHwCall(size_t inputIndex)
+{
+	const InputDistributionSpecification *	specification = getInputDistributionSpecification(inputIndex);
+
+	switch (specification->family)
+	{
+		case kInputDistributionFamilyUniform:
+		{
+			return UxHwDoubleUniformDist(specification->low, specification->high);
+		}
+
+		case kInputDistributionFamilyGaussian:
+		{
+			return UxHwDoubleGaussDist(specification->mean, specification->standardDeviation);
+		}
+
+		default:
+		{
+			return getInputDistributionQuantile(specification, UxHwDoubleUniformDist(0.0, 1.0));
+		}
+	}
+}
+
+/*
+ *	Draws the inputs from `firstInputIndex` on. The correlated inputs are drawn
+ *	as independent standard Gaussians, correlated by the Cholesky factor of
+ *	their correlation matrix and mapped to their distributions (the Gaussian
+ *	copula); the others are drawn on their own, in input order.
+ */
+static void
+setInputDistributionsFromIndexViaUxHwCall(double *  inputDistributions, size_t firstInputIndex)
+{
+	const InputCorrelationSpecification *	correlations = getInputCorrelationSpecification();
+	double *				variates[kInputDistributionIndexMax];
+
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		variates[k] = &inputDistributions[k];
+
+		if (k < firstInputIndex)
+		{
+			continue;
+		}
+
+		inputDistributions[k] = correlations->isCorrelated[k] ?
+						UxHwDoubleGaussDist(0.0, 1.0) :
+						getInputDistributionViaUxHwCall(k);
+	}
+
+	if (correlations->numberOfCorrelatedInputs == 0)
+	{
+		return;
+	}
+
+	correlateStandardGaussians(variates, 1, 1);
+
+	for (size_t a = 0; a < correlations->numberOfCorrelatedInputs; a++)
+	{
+		size_t	k = correlations->correlatedInputs[a];
+
+		inputDistributions[k] = getInputDistributionQuantileOfStandardGaussian(getInputDistributionSpecification(k), inputDistributions[k]);
+	}
+
+	return;
+}
+
+void
+setTemperatureAndPressureInputDistributionsViaUxHwCall(double *  inputDistributions)
+{
+	setInputDistributionsFromIndexViaUxHwCall(inputDistributions, kInputDistributionIndexTflow);
+
+	return;
+}
+
+void
+setInputDistributionsViaUxHwCall(double *  inputDistributions)
+{
+	setInputDistributionsFromIndexViaUxHwCall(inputDistributions, kInputDistributionIndexHxfer);
+
+	return;
+}
+
+double
+setInputDistributionsForImportanceSampling(double *  inputDistributions, const ExponentialTilt *  tilt)
+{
+	double	weight;
+
+	inputDistributions[kInputDistributionIndexHxfer] = sampleExponentialTilt(
+								tilt,
+								UxHwDoubleUniformDist(0.0, 1.0),
+								&weight);
+
+	setTemperatureAndPressureInputDistributionsViaUxHwCall(inputDistributions);
+
+	return weight;
+}
+
+double
+calculateDefaultImportanceSamplingTilt(size_t outputSelect, double tailThreshold)
+{
+	double	midpointInputs[kInputDistributionIndexMax];
+	double	outputs[kOutputDistributionIndexMax];
+	double	heatPowerTransferLow;
+	double	heatPowerTransferHigh;
+	double	low;
+	double	high;
+
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		midpointInputs[k] = getInputDistributionQuantile(getInputDistributionSpecification(k), 0.5);
+	}
+
+	getInputDistributionBounds(kInputDistributionIndexHxfer, &heatPowerTransferLow, &heatPowerTransferHigh);
+	low = heatPowerTransferLow;
+	high = heatPowerTransferHigh;
+
+	/*
+	 *	The outputs increase monotonically with the heat power transfer over its range.
+	 */
+	for (int i = 0; i < 100; i++)
+	{
+		midpointInputs[kInputDistributionIndexHxfer] = (low + high) / 2;
+
+		if (kSensorOutputKernels[outputSelect](midpointInputs, outputs) < tailThreshold)
+		{
+			low = midpointInputs[kInputDistributionIndexHxfer];
+		}
+		else
+		{
+			high = midpointInputs[kInputDistributionIndexHxfer];
+		}
+	}
+
+	return calculateExponentialTiltForMean(
+			heatPowerTransferLow,
+			heatPowerTransferHigh,
+			(low + high) / 2);
+}
+
+/*
+ *	The mass flow polynomial of `calculateSensorOutput()`.
+ */
+static double
+calculateMassFlowPolynomial(double h)
+{
+	return kSensorCalibrationConstant3 * pow(h, 3) + kSensorCalibrationConstant2 * pow(h, 2) + kSensorCalibrationConstant1;
+}
+
+/*
+ *	Product and quotient of intervals `[aLow, aHigh]` and `[bLow, bHigh]`. The
+ *	quotient is unbounded if the divisor interval contains zero.
+ */
+static void
+multiplyIntervals(double aLow, double aHigh, double bLow, double bHigh, double *  low, double *  high)
+{
+	double	products[4] = {aLow * bLow, aLow * bHigh, aHigh * bLow, aHigh * bHigh};
+
+	*low = fmin(fmin(products[0], products[1]), fmin(products[2], products[3]));
+	*high = fmax(fmax(products[0], products[1]), fmax(products[2], products[3]));
+
+	return;
+}
+
+static void
+divideIntervals(double aLow, double aHigh, double bLow, double bHigh, double *  low, double *  high)
+{
+	if ((bLow <= 0.0) && (bHigh >= 0.0))
+	{
+		*low = -INFINITY;
+		*high = INFINITY;
+
+		return;
+	}
+
+	multiplyIntervals(aLow, aHigh, 1.0 / bHigh, 1.0 / bLow, low, high);
+
+	return;
+}
+
+void
+calculateSensorOutputInterval(
+	const double	inputLows[kInputDistributionIndexMax],
+	const double	inputHighs[kInputDistributionIndexMax],
+	double		outputLows[kOutputDistributionIndexMax],
+	double		outputHighs[kOutputDistributionIndexMax])
+{
+	double	hLow = inputLows[kInputDistributionIndexHxfer];
+	double	hHigh = inputHighs[kInputDistributionIndexHxfer];
+
+	/*
+	 *	Stationary points of the mass flow polynomial, where
+	 *	3 * C3 * h^2 + 2 * C2 * h = 0, and the ends of the range of h.
+	 */
+	double	candidates[] =
+		{
+			hLow,
+			hHigh,
+			0.0,
+			-2.0 * kSensorCalibrationConstant2 / (3.0 * kSensorCalibrationConstant3),
+		};
+	double	massFlowLow = INFINITY;
+	double	massFlowHigh = -INFINITY;
+	double	temperatureRatioLow;
+	double	temperatureRatioHigh;
+	double	pressureRatioLow;
+	double	pressureRatioHigh;
+	double	factorLow;
+	double	factorHigh;
+	double	differentialPressureLow;
+	double	differentialPressureHigh;
+
+	for (size_t i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++)
+	{
+		if ((candidates[i] >= hLow) && (candidates[i] <= hHigh))
+		{
+			massFlowLow = fmin(massFlowLow, calculateMassFlowPolynomial(candidates[i]));
+			massFlowHigh = fmax(massFlowHigh, calculateMassFlowPolynomial(candidates[i]));
+		}
+	}
+
+	divideIntervals(
+		inputLows[kInputDistributionIndexTflow],
+		inputHighs[kInputDistributionIndexTflow],
+		inputLows[kInputDistributionIndexT0],
+		inputHighs[kInputDistributionIndexT0],
+		&temperatureRatioLow,
+		&temperatureRatioHigh);
+	divideIntervals(
+		inputLows[kInputDistributionIndexP0],
+		inputHighs[kInputDistributionIndexP0],
+		inputLows[kInputDistributionIndexPflow],
+		inputHighs[kInputDistributionIndexPflow],
+		&pressureRatioLow,
+		&pressureRatioHigh);
+	multiplyIntervals(temperatureRatioLow, temperatureRatioHigh, pressureRatioLow, pressureRatioHigh, &factorLow, &factorHigh);
+	multiplyIntervals(massFlowLow, massFlowHigh, factorLow, factorHigh, &differentialPressureLow, &differentialPressureHigh);
+
+	outputLows[kOutputDistributionIndexCalibratedMassFlowOutput] = massFlowLow;
+	outputHighs[kOutputDistributionIndexCalibratedMassFlowOutput] = massFlowHigh;
+	outputLows[kOutputDistributionIndexCalibratedDifferentialPressureOutput] = differentialPressureLow;
+	outputHighs[kOutputDistributionIndexCalibratedDifferentialPressureOutput] = differentialPressureHigh;
+
+	return;
+}
+
+void
+calculateSensorOutputBounds(double outputLows[kOutputDistributionIndexMax], double outputHighs[kOutputDistributionIndexMax])
+{
+	double	inputLows[kInputDistributionIndexMax];
+	double	inputHighs[kInputDistributionIndexMax];
+
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		getInputDistributionRange(k, &inputLows[k], &inputHighs[k]);
+	}
+
+	calculateSensorOutputInterval(inputLows, inputHighs, outputLows, outputHighs);
+
+	return;
+}
+
+ThresholdIntervalDecision
+decideSensorOutputThresholdByInterval(
+	const double	inputLows[kInputDistributionIndexMax],
+	const double	inputHighs[kInputDistributionIndexMax],
+	size_t		outputSelect,
+	double		threshold,
+	double *	outputLow,
+	double *	outputHigh)
+{
+	double	outputLows[kOutputDistributionIndexMax];
+	double	outputHighs[kOutputDistributionIndexMax];
+	double	margin;
+
+	/*
+	 *	An unbounded input (a Gaussian) leaves every threshold undecided.
+	 */
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		if (!isfinite(inputLows[k]) || !isfinite(inputHighs[k]))
+		{
+			*outputLow = -INFINITY;
+			*outputHigh = INFINITY;
+
+			return kThresholdIntervalDecisionAmbiguous;
+		}
+	}
+
+	calculateSensorOutputInterval(inputLows, inputHighs, outputLows, outputHighs);
+
+	/*
+	 *	The kernel rounds differently from the interval evaluation, so the
+	 *	interval is widened before it is compared with the threshold.
+	 */
+	margin = kSensorOutputIntervalRelativeMargin * fmax(fabs(outputLows[outputSelect]), fabs(outputHighs[outputSelect]));
+	*outputLow = outputLows[outputSelect] - margin;
+	*outputHigh = outputHighs[outputSelect] + margin;
+
+	if (*outputHigh <= threshold)
+	{
+		return kThresholdIntervalDecisionBelow;
+	}
+
+	if (*outputLow > threshold)
+	{
+		return kThresholdIntervalDecisionAbove;
+	}
+
+	return kThresholdIntervalDecisionAmbiguous;
+}
+
+double
+calculateDifferentialPressureCorrectionFactor(const double *  inputDistributions)
+{
+	return (inputDistributions[kInputDistributionIndexTflow] / inputDistributions[kInputDistributionIndexT0]) *
+		(inputDistributions[kInputDistributionIndexP0] / inputDistributions[kInputDistributionIndexPflow]);
+}
+
+bool
+calculateSensorOutputParticleDistributions(
+	const ParticleDistribution	inputDistributions[kInputDistributionIndexMax],
+	ParticleDistribution		outputDistributions[kOutputDistributionIndexMax],
+	size_t				outputSelect)
+{
+	RunArenaMark		arenaMark = getRunArenaMark();
+	ParticleDistribution *	temporaries = (ParticleDistribution *) allocateFromRunArena(3 * sizeof(ParticleDistribution), kRunArenaDefaultAlignment);
+	ParticleDistribution *	m;
+
+	if (temporaries == NULL)
+	{
+		return false;
+	}
+
+	m = (outputSelect == kOutputDistributionIndexCalibratedDifferentialPressureOutput) ?
+		&temporaries[2] :
+		&outputDistributions[kOutputDistributionIndexCalibratedMassFlowOutput];
+
+	/*
+	 *	m = C3 * h^3 + C2 * h^2 + C1
+	 */
+	powParticleDistribution(&temporaries[0], &inputDistributions[kInputDistributionIndexHxfer], 3);
+	multiplyParticleDistributionScalar(&temporaries[0], &temporaries[0], kSensorCalibrationConstant3);
+	powParticleDistribution(&temporaries[1], &inputDistributions[kInputDistributionIndexHxfer], 2);
+	multiplyParticleDistributionScalar(&temporaries[1], &temporaries[1], kSensorCalibrationConstant2);
+	addParticleDistributions(m, &temporaries[0], &temporaries[1]);
+	addParticleDistributionScalar(m, m, kSensorCalibrationConstant1);
+
+	/*
+	 *	DP = m * (Tflow / T0) * (P0 / Pflow)
+	 */
+	if (outputSelect != kOutputDistributionIndexCalibratedMassFlowOutput)
+	{
+		ParticleDistribution *	dp = &outputDistributions[kOutputDistributionIndexCalibratedDifferentialPressureOutput];
+
+		divideParticleDistributions(&temporaries[0], &inputDistributions[kInputDistributionIndexTflow], &inputDistributions[kInputDistributionIndexT0]);
+		divideParticleDistributions(&temporaries[1], &inputDistributions[kInputDistributionIndexP0], &inputDistributions[kInputDistributionIndexPflow]);
+		multiplyParticleDistributions(dp, m, &temporaries[0]);
+		multiplyParticleDistributions(dp, dp, &temporaries[1]);
+	}
+
+	releaseRunArenaToMark(arenaMark);
+
+	return true;
+}
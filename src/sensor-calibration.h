@@ -0,0 +1,185 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stddef.h>
+#include "utilities-config.h"
+#include "importance-sampling.h"
+#include "particle-distribution.h"
+
+/**
+ *	@brief  Signature of the output-specialized sensor calibration kernels. The
+ *		kernel to use is selected once, before the main computation loop,
+ *		based on the output selected via the command line.
+ *
+ *	@param  inputDistributions	: The array of input distributions used in the calculation.
+ * 	@param  outputDistributions	: An array of of output distributions. Writes the selected outputs.
+ *
+ *	@return	double			: Returns the distributional value calculated last.
+ */
+typedef double (*SensorOutputKernel)(const double *  inputDistributions, double *  outputDistributions);
+
+/**
+ *	@brief  Signature of the output-specialized sensor calibration kernels for a block of inputs.
+ *
+ *	@param  inputDistributionBlock	: The input distributions of each element of the block.
+ * 	@param  outputSamples		: Per-output arrays of at least `numberOfSamples` entries. Writes
+ *					  the arrays of the selected outputs; the others may be NULL.
+ *	@param  numberOfSamples		: The number of elements of the block.
+ */
+typedef void (*SensorOutputBlockKernel)(
+		const double	(*inputDistributionBlock)[kInputDistributionIndexMax],
+		double *	outputSamples[kOutputDistributionIndexMax],
+		size_t		numberOfSamples);
+
+/**
+ *	@brief  Returns the kernel that calculates the selected output(s).
+ *
+ *	@param  outputSelect	: The output select value (`-S` option), at most `kOutputDistributionIndexMax`.
+ *	@return			: The kernel.
+ */
+SensorOutputKernel	getSensorOutputKernel(size_t outputSelect);
+
+/**
+ *	@brief  Returns the block kernel that calculates the selected output(s).
+ *
+ *	@param  outputSelect	: The output select value (`-S` option), at most `kOutputDistributionIndexMax`.
+ *	@return			: The block kernel.
+ */
+SensorOutputBlockKernel	getSensorOutputBlockKernel(size_t outputSelect);
+
+/**
+ *	@brief  Sets the temperature and pressure Input Distributions via call to UxHw Parametric function.
+ *		Correlated inputs (-K option) are sampled through their Gaussian copula, which must not
+ *		involve the heat power transfer.
+ *
+ *	@param  inputDistributions	: An array of double values, where the function writes the distributional data.
+ */
+void	setTemperatureAndPressureInputDistributionsViaUxHwCall(double *  inputDistributions);
+
+/**
+ *	@brief  Sets the Input Distributions via call to UxHw Parametric function. Correlated inputs
+ *		(-K option) are sampled through their Gaussian copula.
+ *
+ *	@param  inputDistributions	: An array of double values, where the function writes the distributional data.
+ */
+void	setInputDistributionsViaUxHwCall(double *  inputDistributions);
+
+/**
+ *	@brief  Sets the Input Distributions for importance sampling: the heat power transfer is
+ *		sampled from its exponentially tilted distribution and the other inputs as usual.
+ *
+ *	@param  inputDistributions	: An array of double values, where the function writes the samples.
+ *	@param  tilt			: The exponential tilt of the heat power transfer distribution.
+ *
+ *	@return	double			: The importance weight of the sample.
+ */
+double	setInputDistributionsForImportanceSampling(double *  inputDistributions, const ExponentialTilt *  tilt);
+
+/**
+ *	@brief  Chooses the tilt of the heat power transfer distribution for importance sampling
+ *		of `P(output > tailThreshold)`: the tilted distribution is centered on the heat
+ *		power transfer at which the selected output, with the temperature and pressure
+ *		inputs at the midpoints of their ranges, equals the threshold.
+ *
+ *	@param  outputSelect		: The selected output.
+ *	@param  tailThreshold		: The threshold of the tail probability.
+ *
+ *	@return	double			: The tilt.
+ */
+double	calculateDefaultImportanceSamplingTilt(size_t outputSelect, double tailThreshold);
+
+/**
+ *	@brief  Evaluates `calculateSensorOutput()` in interval arithmetic: the range of each output
+ *		over a box of inputs. The mass flow is a cubic polynomial of the heat power transfer,
+ *		so its extremes are at the ends of the heat power transfer range or at the stationary
+ *		points of the polynomial inside it. The differential pressure is the mass flow times
+ *		the temperature and pressure ratios, whose intervals are products and quotients of the
+ *		input intervals.
+ *
+ *	@param  inputLows	: The lower bound of each input.
+ *	@param  inputHighs	: The upper bound of each input.
+ *	@param  outputLows	: Output. The lower bound of each output.
+ *	@param  outputHighs	: Output. The upper bound of each output.
+ */
+void	calculateSensorOutputInterval(
+		const double	inputLows[kInputDistributionIndexMax],
+		const double	inputHighs[kInputDistributionIndexMax],
+		double		outputLows[kOutputDistributionIndexMax],
+		double		outputHighs[kOutputDistributionIndexMax]);
+
+/**
+ *	@brief  Calculates the range of each output over the finite ranges of the input
+ *		distributions (see `getInputDistributionRange()`).
+ *
+ *	@param  outputLows	: Output. The lower bound of each output.
+ *	@param  outputHighs	: Output. The upper bound of each output.
+ */
+void	calculateSensorOutputBounds(double outputLows[kOutputDistributionIndexMax], double outputHighs[kOutputDistributionIndexMax]);
+
+/**
+ *	@brief  Decides whether an output exceeds a threshold from its interval over a box of
+ *		inputs alone. If the whole interval is on one side of the threshold, the probability
+ *		that the output exceeds it is exactly 0 or 1, and no sampling is needed. A box
+ *		with an infinite bound is always on either side of the threshold.
+ *
+ *	@param  inputLows	: The lower bound of each input.
+ *	@param  inputHighs	: The upper bound of each input.
+ *	@param  outputSelect	: The output.
+ *	@param  threshold	: The threshold.
+ *	@param  outputLow	: Output. The lower bound of the output, widened by `kSensorOutputIntervalRelativeMargin`.
+ *	@param  outputHigh	: Output. The upper bound of the output, widened likewise.
+ *	@return			: Whether the output is always at most, always above, or on either side of the threshold.
+ */
+ThresholdIntervalDecision	decideSensorOutputThresholdByInterval(
+					const double	inputLows[kInputDistributionIndexMax],
+					const double	inputHighs[kInputDistributionIndexMax],
+					size_t		outputSelect,
+					double		threshold,
+					double *	outputLow,
+					double *	outputHigh);
+
+/**
+ *	@brief  The calculation of `calculateSensorOutput()`, run once on particle distributions of
+ *		the inputs instead of once per sample.
+ *
+ *	@param  inputDistributions	: The input distributions, indexed by `InputDistributionIndex`.
+ *	@param  outputDistributions	: Output. The output distributions. Writes the selected entries.
+ *	@param  outputSelect		: The output select value (`-S` option), at most `kOutputDistributionIndexMax`.
+ *	@return				: `true` if successful, `false` if the run arena has no memory left for the temporaries.
+ */
+bool	calculateSensorOutputParticleDistributions(
+		const ParticleDistribution	inputDistributions[kInputDistributionIndexMax],
+		ParticleDistribution		outputDistributions[kOutputDistributionIndexMax],
+		size_t				outputSelect);
+
+/**
+ *	@brief  Calculates the factor by which `calculateSensorOutput()` multiplies the mass flow to
+ *		get the differential pressure, `(Tflow / T0) * (P0 / Pflow)`. It depends on the
+ *		temperature and pressure inputs only, and the mass flow on the heat power transfer only.
+ *
+ *	@param  inputDistributions	: The array of input distributions used in the calculation.
+ *	@return	double			: The correction factor.
+ */
+double	calculateDifferentialPressureCorrectionFactor(const double *  inputDistributions);
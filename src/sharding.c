@@ -0,0 +1,481 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "sharding.h"
+#include "mergeable-statistics.h"
+#include "run-arena.h"
+#include "samplers.h"
+#include "sensor-calibration.h"
+
+#define kPartialResultFileMagic						"fls110-partial-result"
+#define kPartialResultFileVersion					(1)
+
+static const double	kMergedReportQuantileLevels[] = {0.05, 0.25, 0.50, 0.75, 0.95};
+
+/*
+ *	Everything in a partial-result file except the summaries.
+ */
+typedef struct
+{
+	uint64_t	seed;
+	size_t		shardIndex;
+	size_t		numberOfShards;
+	size_t		numberOfIterations;
+	size_t		outputSelect;
+	size_t		numberOfSamples;
+	const char *	path;
+} PartialResultHeader;
+
+static bool
+readPartialResultHeader(FILE *  fp, PartialResultHeader *  header)
+{
+	char	magic[32];
+	int	version;
+
+	return (fscanf(fp, "%31s %d", magic, &version) == 2) &&
+		(strcmp(magic, kPartialResultFileMagic) == 0) &&
+		(version == kPartialResultFileVersion) &&
+		(fscanf(fp, " seed %" SCNu64, &header->seed) == 1) &&
+		(fscanf(fp, " shard %zu %zu", &header->shardIndex, &header->numberOfShards) == 2) &&
+		(fscanf(fp, " iterations %zu", &header->numberOfIterations) == 1) &&
+		(fscanf(fp, " select-output %zu", &header->outputSelect) == 1) &&
+		(fscanf(fp, " samples %zu", &header->numberOfSamples) == 1);
+}
+
+/*
+ *	Samples and runs the kernel on the iterations with indices in `[first, first + numberOfSamples)`.
+ */
+static void
+calculateOutputSamplesCounterBased(
+	const CommandLineArguments *	arguments,
+	uint64_t			firstSampleIndex,
+	double				(*inputDistributionBlock)[kInputDistributionIndexMax],
+	double *			outputSamples[kOutputDistributionIndexMax],
+	size_t				numberOfSamples)
+{
+	sampleInputDistributionsCounterBased(kCounterBasedSamplerDefaultSeed, firstSampleIndex, inputDistributionBlock, numberOfSamples);
+	getSensorOutputBlockKernel(arguments->common.outputSelect)(
+		(const double (*)[kInputDistributionIndexMax])inputDistributionBlock,
+		outputSamples,
+		numberOfSamples);
+
+	return;
+}
+
+CommonConstantReturnType
+runMonteCarloShard(const CommandLineArguments *  arguments)
+{
+	size_t				numberOfIterations = arguments->common.numberOfMonteCarloIterations;
+	size_t				firstIteration = (size_t)((uint64_t)arguments->shardIndex * numberOfIterations / arguments->numberOfShards);
+	size_t				endIteration = (size_t)((uint64_t)(arguments->shardIndex + 1) * numberOfIterations / arguments->numberOfShards);
+	size_t				numberOfPilotSamples = (numberOfIterations < kMonteCarloBlockSize) ? numberOfIterations : kMonteCarloBlockSize;
+	double				(*inputDistributionBlock)[kInputDistributionIndexMax];
+	double *			outputSamples[kOutputDistributionIndexMax] = {NULL};
+	MergeableOutputSummaries *	summaries;
+	RunArenaMark			arenaMark = getRunArenaMark();
+	char				path[64];
+	FILE *				fp;
+	bool				isOutOfMemory;
+
+	inputDistributionBlock = allocateFromRunArena(kMonteCarloBlockSize * sizeof(*inputDistributionBlock), kRunArenaDefaultAlignment);
+	summaries = (MergeableOutputSummaries *) allocateFromRunArena(sizeof(MergeableOutputSummaries), kRunArenaDefaultAlignment);
+	isOutOfMemory = (inputDistributionBlock == NULL) || (summaries == NULL);
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		if ((arguments->common.outputSelect == kOutputDistributionIndexMax) || (j == arguments->common.outputSelect))
+		{
+			outputSamples[j] = (double *) allocateFromRunArena(kMonteCarloBlockSize * sizeof(double), kRunArenaDefaultAlignment);
+			isOutOfMemory = isOutOfMemory || (outputSamples[j] == NULL);
+		}
+	}
+
+	if (isOutOfMemory)
+	{
+		fprintf(stderr, "Error: Out of memory for the shard.\n");
+		releaseRunArenaToMark(arenaMark);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	Every shard computes the same pilot block (the first iterations of the
+	 *	whole run), so that all shards use the same histogram ranges.
+	 */
+	calculateOutputSamplesCounterBased(arguments, 0, inputDistributionBlock, outputSamples, numberOfPilotSamples);
+	initializeMergeableOutputSummaries(summaries, outputSamples, numberOfPilotSamples);
+
+	for (size_t blockStart = firstIteration; blockStart < endIteration; blockStart += kMonteCarloBlockSize)
+	{
+		size_t	blockLength = (endIteration - blockStart < kMonteCarloBlockSize) ? endIteration - blockStart : kMonteCarloBlockSize;
+
+		calculateOutputSamplesCounterBased(arguments, blockStart, inputDistributionBlock, outputSamples, blockLength);
+
+		if (!updateMergeableOutputSummaries(summaries, outputSamples, blockLength))
+		{
+			fprintf(stderr, "Error: Out of memory for the quantile sketches of the shard.\n");
+			releaseRunArenaToMark(arenaMark);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	snprintf(path, sizeof(path), "partial-%zu-of-%zu.out", arguments->shardIndex, arguments->numberOfShards);
+	fp = fopen(path, "w");
+
+	if (fp == NULL)
+	{
+		fprintf(stderr, "Error: Could not open %s for writing.\n", path);
+	}
+	else
+	{
+		fprintf(fp, "%s %d\n", kPartialResultFileMagic, kPartialResultFileVersion);
+		fprintf(fp, "seed %" PRIu64 "\n", (uint64_t)kCounterBasedSamplerDefaultSeed);
+		fprintf(fp, "shard %zu %zu\n", arguments->shardIndex, arguments->numberOfShards);
+		fprintf(fp, "iterations %zu\n", numberOfIterations);
+		fprintf(fp, "select-output %zu\n", arguments->common.outputSelect);
+		fprintf(fp, "samples %zu\n", endIteration - firstIteration);
+		writeMergeableOutputSummaries(fp, summaries);
+		fclose(fp);
+
+		printf(
+			"Shard %zu of %zu: summarized iterations %zu to %zu of %zu in %s.\n",
+			arguments->shardIndex,
+			arguments->numberOfShards,
+			firstIteration,
+			endIteration,
+			numberOfIterations,
+			path);
+	}
+
+	releaseRunArenaToMark(arenaMark);
+
+	return (fp == NULL) ? kCommonConstantReturnTypeError : kCommonConstantReturnTypeSuccess;
+}
+
+static int
+comparePartialResultHeadersByShardIndex(const void *  a, const void *  b)
+{
+	size_t	x = ((const PartialResultHeader *)a)->shardIndex;
+	size_t	y = ((const PartialResultHeader *)b)->shardIndex;
+
+	return (x > y) - (x < y);
+}
+
+static void
+printMergedOutputSummary(
+	const OutputSummary *	summary,
+	const char *		variableDescription,
+	const char *		unitsOfMeasurement)
+{
+	double	variance;
+	double	skewness;
+	double	excessKurtosis;
+	double	binWidth = (summary->histogram.high - summary->histogram.low) / kOutputHistogramNumberOfBins;
+
+	getMomentAccumulatorStatistics(&summary->moments, &variance, &skewness, &excessKurtosis);
+
+	printf("%s: %.2lf %s.\n", variableDescription, summary->moments.mean, unitsOfMeasurement);
+	printf("\n");
+	printf("\tStandard deviation: %.6le %s, skewness: %.6lf, excess kurtosis: %.6lf\n", sqrt(variance), unitsOfMeasurement, skewness, excessKurtosis);
+	printf("\tMinimum: %.6lf %s, maximum: %.6lf %s\n", summary->moments.minimum, unitsOfMeasurement, summary->moments.maximum, unitsOfMeasurement);
+	printf("\tQuantiles (from the merged sketches, within a relative error of %lg%% of the order statistics of the samples):", 100.0 * kQuantileSketchRelativeAccuracy);
+
+	for (size_t q = 0; q < sizeof(kMergedReportQuantileLevels) / sizeof(kMergedReportQuantileLevels[0]); q++)
+	{
+		printf(" %lg%%: %.6lf", 100.0 * kMergedReportQuantileLevels[q], getQuantileSketchQuantile(&summary->sketch, kMergedReportQuantileLevels[q]));
+	}
+
+	printf("\n\tHistogram (%d bins):\n", kOutputHistogramNumberOfBins);
+	printf("\t\t(-inf, %.6lf): %" PRIu64 "\n", summary->histogram.low, summary->histogram.underflowCount);
+
+	for (size_t b = 0; b < kOutputHistogramNumberOfBins; b++)
+	{
+		printf(
+			"\t\t[%.6lf, %.6lf): %" PRIu64 "\n",
+			summary->histogram.low + (double)b * binWidth,
+			summary->histogram.low + (double)(b + 1) * binWidth,
+			summary->histogram.counts[b]);
+	}
+
+	printf("\t\t[%.6lf, inf): %" PRIu64 "\n", summary->histogram.high, summary->histogram.overflowCount);
+
+	return;
+}
+
+static void
+printMergedOutputSummaryJSON(const OutputSummary *  summary, const char *  variableDescription)
+{
+	double	variance;
+	double	skewness;
+	double	excessKurtosis;
+
+	getMomentAccumulatorStatistics(&summary->moments, &variance, &skewness, &excessKurtosis);
+
+	printf(
+		"{\"variableDescription\": \"%s\", \"numberOfSamples\": %" PRIu64 ", \"mean\": %.17lg, \"variance\": %.17lg, "
+		"\"skewness\": %.17lg, \"excessKurtosis\": %.17lg, \"minimum\": %.17lg, \"maximum\": %.17lg, \"quantiles\": {",
+		variableDescription,
+		summary->moments.count,
+		summary->moments.mean,
+		variance,
+		skewness,
+		excessKurtosis,
+		summary->moments.minimum,
+		summary->moments.maximum);
+
+	for (size_t q = 0; q < sizeof(kMergedReportQuantileLevels) / sizeof(kMergedReportQuantileLevels[0]); q++)
+	{
+		printf(
+			"%s\"%lg\": %.17lg",
+			(q == 0) ? "" : ", ",
+			kMergedReportQuantileLevels[q],
+			getQuantileSketchQuantile(&summary->sketch, kMergedReportQuantileLevels[q]));
+	}
+
+	printf(
+		"}, \"histogram\": {\"low\": %.17lg, \"high\": %.17lg, \"underflowCount\": %" PRIu64 ", \"overflowCount\": %" PRIu64 ", \"counts\": [",
+		summary->histogram.low,
+		summary->histogram.high,
+		summary->histogram.underflowCount,
+		summary->histogram.overflowCount);
+
+	for (size_t b = 0; b < kOutputHistogramNumberOfBins; b++)
+	{
+		printf("%s%" PRIu64, (b == 0) ? "" : ", ", summary->histogram.counts[b]);
+	}
+
+	printf("]}}");
+
+	return;
+}
+
+CommonConstantReturnType
+mergeMonteCarloShards(
+	const CommandLineArguments *	arguments,
+	const char **			outputVariableNames,
+	const char **			unitsOfMeasurement)
+{
+	CommonConstantReturnType	result = kCommonConstantReturnTypeSuccess;
+	RunArenaMark			arenaMark = getRunArenaMark();
+	char *				paths = (char *) allocateFromRunArena(strlen(arguments->mergePartialResultPaths) + 1, 1);
+	size_t				numberOfFiles = 1;
+	PartialResultHeader *		headers;
+	MergeableOutputSummaries *	merged;
+	MergeableOutputSummaries *	shardSummaries;
+	size_t				f = 0;
+
+	if (paths == NULL)
+	{
+		fprintf(stderr, "Error: Out of memory for merging the partial results.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	strcpy(paths, arguments->mergePartialResultPaths);
+
+	for (const char *  c = paths; *c != '\0'; c++)
+	{
+		numberOfFiles += (*c == ',');
+	}
+
+	headers = (PartialResultHeader *) allocateFromRunArena(numberOfFiles * sizeof(PartialResultHeader), kRunArenaDefaultAlignment);
+	merged = (MergeableOutputSummaries *) allocateFromRunArena(sizeof(MergeableOutputSummaries), kRunArenaDefaultAlignment);
+	shardSummaries = (MergeableOutputSummaries *) allocateFromRunArena(sizeof(MergeableOutputSummaries), kRunArenaDefaultAlignment);
+
+	if ((headers == NULL) || (merged == NULL) || (shardSummaries == NULL))
+	{
+		fprintf(stderr, "Error: Out of memory for merging the partial results.\n");
+		releaseRunArenaToMark(arenaMark);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	Read the headers, and check that the files are the shards of one run.
+	 */
+	for (char *  path = strtok(paths, ","); (path != NULL) && (result == kCommonConstantReturnTypeSuccess); path = strtok(NULL, ","))
+	{
+		FILE *	fp = fopen(path, "r");
+
+		if ((fp == NULL) || !readPartialResultHeader(fp, &headers[f]))
+		{
+			fprintf(stderr, "Error: \"%s\" is not a readable partial-result file.\n", path);
+			result = kCommonConstantReturnTypeError;
+		}
+		else if ((headers[f].seed != headers[0].seed) ||
+			(headers[f].numberOfShards != headers[0].numberOfShards) ||
+			(headers[f].numberOfIterations != headers[0].numberOfIterations) ||
+			(headers[f].outputSelect != headers[0].outputSelect))
+		{
+			fprintf(stderr, "Error: \"%s\" is a shard of a different run than \"%s\".\n", path, headers[0].path);
+			result = kCommonConstantReturnTypeError;
+		}
+
+		if (fp != NULL)
+		{
+			fclose(fp);
+		}
+
+		headers[f++].path = path;
+	}
+
+	qsort(headers, f, sizeof(PartialResultHeader), comparePartialResultHeadersByShardIndex);
+
+	if ((result == kCommonConstantReturnTypeSuccess) && (f != headers[0].numberOfShards))
+	{
+		fprintf(stderr, "Error: Got %zu partial-result files for a run with %zu shards.\n", f, headers[0].numberOfShards);
+		result = kCommonConstantReturnTypeError;
+	}
+
+	for (size_t i = 0; (i < f) && (result == kCommonConstantReturnTypeSuccess); i++)
+	{
+		if (headers[i].shardIndex != i)
+		{
+			fprintf(stderr, "Error: Shard %zu is missing or duplicated.\n", i);
+			result = kCommonConstantReturnTypeError;
+		}
+	}
+
+	/*
+	 *	Merge the summaries in shard order.
+	 */
+	for (size_t i = 0; (i < f) && (result == kCommonConstantReturnTypeSuccess); i++)
+	{
+		FILE *	fp = fopen(headers[i].path, "r");
+
+		if ((fp == NULL) ||
+			!readPartialResultHeader(fp, &headers[i]) ||
+			!readMergeableOutputSummaries(fp, (i == 0) ? merged : shardSummaries) ||
+			((i > 0) && !mergeMergeableOutputSummaries(merged, shardSummaries)))
+		{
+			fprintf(stderr, "Error: Could not merge the partial-result file \"%s\".\n", headers[i].path);
+			result = kCommonConstantReturnTypeError;
+		}
+
+		if (fp != NULL)
+		{
+			fclose(fp);
+		}
+	}
+
+	if (result == kCommonConstantReturnTypeSuccess)
+	{
+		JointOutputStatistics	jointOutputStatistics = {0};
+		bool			isFirstOutput = true;
+
+		if (headers[0].outputSelect == kOutputDistributionIndexMax)
+		{
+			for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+			{
+				double	skewness;
+				double	excessKurtosis;
+
+				jointOutputStatistics.meanAndVariance[j].mean = merged->outputs[j].moments.mean;
+				getMomentAccumulatorStatistics(
+					&merged->outputs[j].moments,
+					&jointOutputStatistics.meanAndVariance[j].variance,
+					&skewness,
+					&excessKurtosis);
+				jointOutputStatistics.covariance[j][j] = jointOutputStatistics.meanAndVariance[j].variance;
+			}
+
+			for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+			{
+				for (size_t k = j + 1; k < kOutputDistributionIndexMax; k++)
+				{
+					double	normalization = sqrt(jointOutputStatistics.covariance[j][j] * jointOutputStatistics.covariance[k][k]);
+
+					jointOutputStatistics.covariance[j][k] = merged->comoment[j][k] / (double)(headers[0].numberOfIterations - 1);
+					jointOutputStatistics.covariance[k][j] = jointOutputStatistics.covariance[j][k];
+					jointOutputStatistics.correlation[j][k] = (normalization > 0.0) ? jointOutputStatistics.covariance[j][k] / normalization : 0.0;
+					jointOutputStatistics.correlation[k][j] = jointOutputStatistics.correlation[j][k];
+				}
+			}
+		}
+
+		if (arguments->common.isOutputJSONMode)
+		{
+			/*
+			 *	The quantiles come from the merged sketches, so state their bound.
+			 */
+			printf(
+				"{\"numberOfShards\": %zu, \"numberOfIterations\": %zu, \"quantileRelativeAccuracy\": %lg, \"outputs\": [",
+				f,
+				headers[0].numberOfIterations,
+				kQuantileSketchRelativeAccuracy);
+		}
+		else
+		{
+			printf("Merged %zu shards of a Monte Carlo run of %zu iterations.\n\n", f, headers[0].numberOfIterations);
+		}
+
+		for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+		{
+			if (!merged->isOutputCalculated[j])
+			{
+				continue;
+			}
+
+			if (arguments->common.isOutputJSONMode)
+			{
+				printf("%s", isFirstOutput ? "" : ", ");
+				printMergedOutputSummaryJSON(&merged->outputs[j], outputVariableNames[j]);
+			}
+			else
+			{
+				printMergedOutputSummary(&merged->outputs[j], outputVariableNames[j], unitsOfMeasurement[j]);
+			}
+
+			isFirstOutput = false;
+		}
+
+		if (arguments->common.isOutputJSONMode)
+		{
+			printf("]");
+
+			if (headers[0].outputSelect == kOutputDistributionIndexMax)
+			{
+				printf(
+					", \"covariance\": %.17lg, \"correlation\": %.17lg",
+					jointOutputStatistics.covariance[0][1],
+					jointOutputStatistics.correlation[0][1]);
+			}
+
+			printf("}\n");
+		}
+		else if (headers[0].outputSelect == kOutputDistributionIndexMax)
+		{
+			printJointOutputStatistics(&jointOutputStatistics, outputVariableNames);
+		}
+	}
+
+	releaseRunArenaToMark(arenaMark);
+
+	return result;
+}
@@ -0,0 +1,51 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "utilities.h"
+
+/**
+ *	@brief	Runs one shard of a sharded Monte Carlo run: the iterations with indices in
+ *		`[k * M / n, (k + 1) * M / n)` for shard `k` of `n` and `M` iterations, with inputs
+ *		from the counter-based sampler. Writes the mergeable summaries of the calculated
+ *		outputs to the partial-result file `partial-<k>-of-<n>.out`.
+ *
+ *	@param	arguments	: The command-line arguments.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runMonteCarloShard(const CommandLineArguments *  arguments);
+
+/**
+ *	@brief	Merges the partial-result files of all shards of a sharded Monte Carlo run and
+ *		prints the statistics of the complete run.
+ *
+ *	@param	arguments			: The command-line arguments.
+ *	@param	outputVariableNames		: The names of the outputs.
+ *	@param	unitsOfMeasurement		: The units of the outputs.
+ *	@return					: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	mergeMonteCarloShards(
+					const CommandLineArguments *	arguments,
+					const char **			outputVariableNames,
+					const char **			unitsOfMeasurement);
@@ -0,0 +1,409 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "text-output.h"
+#include "double-formatting.h"
+#include "run-arena.h"
+#include "utilities-config.h"
+
+/*
+ *	Rows of a table of doubles, formatted into a buffer of their own.
+ */
+typedef struct
+{
+	const double * const *	columns;
+	size_t			numberOfColumns;
+	size_t			firstRow;
+	size_t			endRow;
+	const char *		columnSeparator;
+	const char *		rowTerminator;
+	const char *		nonFiniteText;
+	char *			buffer;
+	size_t			length;
+} TextOutputChunk;
+
+bool
+initializeTextOutputStream(TextOutputStream *  stream, int fileDescriptor)
+{
+	fflush(stdout);
+
+	*stream = (TextOutputStream)
+	{
+		.fileDescriptor		= fileDescriptor,
+		.isFileDescriptorOwned	= false,
+		.buffer			= (char *) allocateFromRunArena(kTextOutputBufferBytes, kRunArenaDefaultAlignment),
+		.capacity		= kTextOutputBufferBytes,
+		.length			= 0,
+		.hasWriteFailed		= false,
+	};
+
+	if (stream->buffer == NULL)
+	{
+		fprintf(stderr, "Error: Out of memory for the output buffer.\n");
+
+		return false;
+	}
+
+	return true;
+}
+
+bool
+openTextOutputFile(TextOutputStream *  stream, const char *  path)
+{
+	int	fileDescriptor = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	if (fileDescriptor < 0)
+	{
+		fprintf(stderr, "Error: Could not open %s for writing (%s).\n", path, strerror(errno));
+
+		return false;
+	}
+
+	if (!initializeTextOutputStream(stream, fileDescriptor))
+	{
+		close(fileDescriptor);
+
+		return false;
+	}
+
+	stream->isFileDescriptorOwned = true;
+
+	return true;
+}
+
+/*
+ *	Writes all of a buffer, retrying after interruptions and partial writes.
+ */
+static bool
+writeAll(int fileDescriptor, const char *  buffer, size_t length)
+{
+	size_t	written = 0;
+
+	while (written < length)
+	{
+		ssize_t	result = write(fileDescriptor, &buffer[written], length - written);
+
+		if (result >= 0)
+		{
+			written += (size_t)result;
+		}
+		else if (errno != EINTR)
+		{
+			fprintf(stderr, "Error: Could not write the output (%s).\n", strerror(errno));
+
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool
+flushTextOutputStream(TextOutputStream *  stream)
+{
+	if (!stream->hasWriteFailed)
+	{
+		stream->hasWriteFailed = !writeAll(stream->fileDescriptor, stream->buffer, stream->length);
+	}
+
+	stream->length = 0;
+
+	return !stream->hasWriteFailed;
+}
+
+bool
+closeTextOutputStream(TextOutputStream *  stream)
+{
+	flushTextOutputStream(stream);
+
+	if (stream->isFileDescriptorOwned && (close(stream->fileDescriptor) != 0))
+	{
+		fprintf(stderr, "Error: Could not close the output (%s).\n", strerror(errno));
+		stream->hasWriteFailed = true;
+	}
+
+	return !stream->hasWriteFailed;
+}
+
+void
+reserveTextOutput(TextOutputStream *  stream, size_t length)
+{
+	if (stream->capacity - stream->length < length)
+	{
+		flushTextOutputStream(stream);
+	}
+
+	return;
+}
+
+void
+appendTextOutputText(TextOutputStream *  stream, const char *  text)
+{
+	size_t	length = strlen(text);
+
+	while (length > 0)
+	{
+		size_t	chunkLength;
+
+		reserveTextOutput(stream, 1);
+		chunkLength = (length < stream->capacity - stream->length) ? length : stream->capacity - stream->length;
+		memcpy(&stream->buffer[stream->length], text, chunkLength);
+		stream->length += chunkLength;
+		text += chunkLength;
+		length -= chunkLength;
+	}
+
+	return;
+}
+
+void
+appendTextOutputDouble(TextOutputStream *  stream, double value)
+{
+	reserveTextOutput(stream, kDoubleFormattingMaximumLength);
+	stream->length += formatDoubleShortest(value, &stream->buffer[stream->length]);
+
+	return;
+}
+
+void
+appendTextOutputUnsigned(TextOutputStream *  stream, uint64_t value)
+{
+	reserveTextOutput(stream, kDoubleFormattingMaximumLength);
+	stream->length += formatUnsignedDecimal(value, &stream->buffer[stream->length]);
+
+	return;
+}
+
+/*
+ *	Longest text of one row of a table of doubles.
+ */
+static size_t
+getMaximumRowLength(size_t numberOfColumns, const char *  columnSeparator, const char *  rowTerminator, const char *  nonFiniteText)
+{
+	size_t	valueLength = kDoubleFormattingMaximumLength;
+
+	if ((nonFiniteText != NULL) && (strlen(nonFiniteText) > valueLength))
+	{
+		valueLength = strlen(nonFiniteText);
+	}
+
+	return numberOfColumns * (valueLength + strlen(columnSeparator)) + strlen(rowTerminator);
+}
+
+/*
+ *	Formats one row at `buffer` and returns its length.
+ */
+static inline size_t
+formatDoubleRow(
+	char *			buffer,
+	const double * const *	columns,
+	size_t			numberOfColumns,
+	size_t			row,
+	const char *		columnSeparator,
+	size_t			columnSeparatorLength,
+	const char *		rowTerminator,
+	size_t			rowTerminatorLength,
+	const char *		nonFiniteText)
+{
+	size_t	length = 0;
+
+	for (size_t c = 0; c < numberOfColumns; c++)
+	{
+		double	value = columns[c][row];
+
+		if (c > 0)
+		{
+			memcpy(&buffer[length], columnSeparator, columnSeparatorLength);
+			length += columnSeparatorLength;
+		}
+
+		if ((nonFiniteText != NULL) && !isfinite(value))
+		{
+			memcpy(&buffer[length], nonFiniteText, strlen(nonFiniteText));
+			length += strlen(nonFiniteText);
+		}
+		else
+		{
+			length += formatDoubleShortest(value, &buffer[length]);
+		}
+	}
+
+	memcpy(&buffer[length], rowTerminator, rowTerminatorLength);
+
+	return length + rowTerminatorLength;
+}
+
+static void *
+formatTextOutputChunk(void *  chunkArgument)
+{
+	TextOutputChunk *	chunk = (TextOutputChunk *)chunkArgument;
+	size_t			columnSeparatorLength = strlen(chunk->columnSeparator);
+	size_t			rowTerminatorLength = strlen(chunk->rowTerminator);
+
+	chunk->length = 0;
+
+	for (size_t row = chunk->firstRow; row < chunk->endRow; row++)
+	{
+		chunk->length += formatDoubleRow(
+					&chunk->buffer[chunk->length],
+					chunk->columns,
+					chunk->numberOfColumns,
+					row,
+					chunk->columnSeparator,
+					columnSeparatorLength,
+					chunk->rowTerminator,
+					rowTerminatorLength,
+					chunk->nonFiniteText);
+	}
+
+	return NULL;
+}
+
+void
+appendTextOutputDoubleRows(
+	TextOutputStream *		stream,
+	const double * const *		columns,
+	size_t				numberOfColumns,
+	size_t				numberOfRows,
+	const char *			columnSeparator,
+	const char *			rowTerminator,
+	const char *			nonFiniteText,
+	size_t				numberOfThreads)
+{
+	size_t			maximumRowLength = getMaximumRowLength(numberOfColumns, columnSeparator, rowTerminator, nonFiniteText);
+	size_t			columnSeparatorLength = strlen(columnSeparator);
+	size_t			rowTerminatorLength = strlen(rowTerminator);
+	RunArenaMark		arenaMark = getRunArenaMark();
+	pthread_t		threads[kParallelMonteCarloMaximumNumberOfThreads];
+	TextOutputChunk		chunks[kParallelMonteCarloMaximumNumberOfThreads];
+	size_t			numberOfChunkBuffers = 0;
+
+	/*
+	 *	In rounds, each thread formats the next chunk of rows into its own
+	 *	buffer, and the main thread then writes the buffers in order.
+	 */
+	if ((numberOfThreads > 1) && (numberOfRows >= 2 * kTextOutputParallelChunkRows))
+	{
+		numberOfThreads = (numberOfThreads < kParallelMonteCarloMaximumNumberOfThreads) ? numberOfThreads : kParallelMonteCarloMaximumNumberOfThreads;
+
+		for (size_t t = 0; t < numberOfThreads; t++)
+		{
+			chunks[t] = (TextOutputChunk)
+			{
+				.columns		= columns,
+				.numberOfColumns	= numberOfColumns,
+				.columnSeparator	= columnSeparator,
+				.rowTerminator		= rowTerminator,
+				.nonFiniteText		= nonFiniteText,
+				.buffer			= (char *) allocateFromRunArena(
+								kTextOutputParallelChunkRows * maximumRowLength,
+								kRunArenaDefaultAlignment),
+			};
+
+			if (chunks[t].buffer == NULL)
+			{
+				break;
+			}
+
+			numberOfChunkBuffers++;
+		}
+	}
+
+	/*
+	 *	With one thread, few rows, or no memory left for the buffers of the
+	 *	threads, format the rows into the stream's own buffer.
+	 */
+	if (numberOfChunkBuffers < 2)
+	{
+		releaseRunArenaToMark(arenaMark);
+
+		for (size_t row = 0; row < numberOfRows; row++)
+		{
+			reserveTextOutput(stream, maximumRowLength);
+			stream->length += formatDoubleRow(
+						&stream->buffer[stream->length],
+						columns,
+						numberOfColumns,
+						row,
+						columnSeparator,
+						columnSeparatorLength,
+						rowTerminator,
+						rowTerminatorLength,
+						nonFiniteText);
+		}
+
+		return;
+	}
+
+	numberOfThreads = numberOfChunkBuffers;
+	flushTextOutputStream(stream);
+
+	for (size_t roundStart = 0; roundStart < numberOfRows; roundStart += numberOfThreads * kTextOutputParallelChunkRows)
+	{
+		size_t	numberOfChunks = 0;
+		bool	isThreadStarted[kParallelMonteCarloMaximumNumberOfThreads];
+
+		for (size_t t = 0; (t < numberOfThreads) && (roundStart + t * kTextOutputParallelChunkRows < numberOfRows); t++)
+		{
+			size_t	firstRow = roundStart + t * kTextOutputParallelChunkRows;
+
+			chunks[t].firstRow = firstRow;
+			chunks[t].endRow = (numberOfRows - firstRow < kTextOutputParallelChunkRows) ? numberOfRows : firstRow + kTextOutputParallelChunkRows;
+			isThreadStarted[t] = (pthread_create(&threads[t], NULL, formatTextOutputChunk, &chunks[t]) == 0);
+
+			/*
+			 *	If a thread cannot be started, format its chunk here.
+			 */
+			if (!isThreadStarted[t])
+			{
+				formatTextOutputChunk(&chunks[t]);
+			}
+
+			numberOfChunks++;
+		}
+
+		for (size_t t = 0; t < numberOfChunks; t++)
+		{
+			if (isThreadStarted[t])
+			{
+				pthread_join(threads[t], NULL);
+			}
+
+			if (!stream->hasWriteFailed)
+			{
+				stream->hasWriteFailed = !writeAll(stream->fileDescriptor, chunks[t].buffer, chunks[t].length);
+			}
+		}
+	}
+
+	releaseRunArenaToMark(arenaMark);
+
+	return;
+}
@@ -0,0 +1,137 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ *	Buffered text output: text and numbers are formatted (doubles in their
+ *	shortest round-trip form) into a buffer from the run arena, which is
+ *	handed to `write()` whenever it is full. Large tables of doubles can be
+ *	formatted by several threads, one chunk of rows each.
+ */
+typedef struct
+{
+	int	fileDescriptor;
+	bool	isFileDescriptorOwned;
+	char *	buffer;
+	size_t	capacity;
+	size_t	length;
+	bool	hasWriteFailed;
+} TextOutputStream;
+
+/**
+ *	@brief	Initializes a stream that writes to an open file descriptor, with a buffer from the run
+ *		arena (release it with a mark taken before). Flushes `stdout` first, so that text
+ *		printed before stays before the stream's text when both go to standard output.
+ *
+ *	@param	stream		: The stream.
+ *	@param	fileDescriptor	: The file descriptor.
+ *	@return			: `true` if successful, `false` if the run arena has no memory left for the buffer.
+ */
+bool	initializeTextOutputStream(TextOutputStream *  stream, int fileDescriptor);
+
+/**
+ *	@brief	Initializes a stream that writes to a file, which is created or truncated.
+ *
+ *	@param	stream	: The stream.
+ *	@param	path	: The path of the file.
+ *	@return		: `true` if the file was opened and the buffer allocated, else `false`.
+ */
+bool	openTextOutputFile(TextOutputStream *  stream, const char *  path);
+
+/**
+ *	@brief	Makes room in the buffer for at least `length` more characters, writing the buffer if needed.
+ *
+ *	@param	stream	: The stream.
+ *	@param	length	: The number of characters, at most `kTextOutputBufferBytes`.
+ */
+void	reserveTextOutput(TextOutputStream *  stream, size_t length);
+
+/**
+ *	@brief	Appends text.
+ *
+ *	@param	stream	: The stream.
+ *	@param	text	: The text.
+ */
+void	appendTextOutputText(TextOutputStream *  stream, const char *  text);
+
+/**
+ *	@brief	Appends a double in its shortest round-trip form.
+ *
+ *	@param	stream	: The stream.
+ *	@param	value	: The value.
+ */
+void	appendTextOutputDouble(TextOutputStream *  stream, double value);
+
+/**
+ *	@brief	Appends an unsigned integer.
+ *
+ *	@param	stream	: The stream.
+ *	@param	value	: The value.
+ */
+void	appendTextOutputUnsigned(TextOutputStream *  stream, uint64_t value);
+
+/**
+ *	@brief	Appends a table of doubles in their shortest round-trip form: for each row, the values
+ *		of the columns separated by `columnSeparator`, followed by `rowTerminator`. With more
+ *		than one thread, the threads format chunks of `kTextOutputParallelChunkRows` rows
+ *		into buffers of their own, which are written in order.
+ *
+ *	@param	stream			: The stream.
+ *	@param	columns			: The per-column arrays of values.
+ *	@param	numberOfColumns		: The number of columns.
+ *	@param	numberOfRows		: The number of rows.
+ *	@param	columnSeparator		: Text between the values of a row.
+ *	@param	rowTerminator		: Text after each row.
+ *	@param	nonFiniteText		: Text for values that are not finite, or `NULL` for "nan", "inf" and "-inf".
+ *	@param	numberOfThreads		: The number of threads to format with.
+ */
+void	appendTextOutputDoubleRows(
+		TextOutputStream *		stream,
+		const double * const *		columns,
+		size_t				numberOfColumns,
+		size_t				numberOfRows,
+		const char *			columnSeparator,
+		const char *			rowTerminator,
+		const char *			nonFiniteText,
+		size_t				numberOfThreads);
+
+/**
+ *	@brief	Writes the buffered text.
+ *
+ *	@param	stream	: The stream.
+ *	@return		: `true` if all text appended to the stream so far was written, else `false`.
+ */
+bool	flushTextOutputStream(TextOutputStream *  stream);
+
+/**
+ *	@brief	Writes the buffered text and closes the file descriptor if the stream opened it.
+ *
+ *	@param	stream	: The stream.
+ *	@return		: `true` if all text appended to the stream was written, else `false`.
+ */
+bool	closeTextOutputStream(TextOutputStream *  stream);
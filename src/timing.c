@@ -0,0 +1,153 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <time.h>
+#include <inttypes.h>
+#include "timing.h"
+
+static const char *	kTimingPhaseNames[kTimingPhaseMax] =
+{
+	[kTimingPhaseSampling]		= "sampling",
+	[kTimingPhaseKernel]		= "kernel",
+	[kTimingPhaseReduction]		= "reduction",
+	[kTimingPhaseOutput]		= "output",
+};
+
+static uint64_t
+getClockNanoseconds(clockid_t clockIdentifier)
+{
+	struct timespec	now;
+
+	clock_gettime(clockIdentifier, &now);
+
+	return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+uint64_t
+getWallClockNanoseconds(void)
+{
+	return getClockNanoseconds(CLOCK_MONOTONIC);
+}
+
+void
+startPhaseTimer(PhaseTimer *  timer)
+{
+	*timer = (PhaseTimer){0};
+	restartPhaseTimerLap(timer);
+
+	return;
+}
+
+void
+restartPhaseTimerLap(PhaseTimer *  timer)
+{
+	timer->lapWallNanoseconds = getClockNanoseconds(CLOCK_MONOTONIC);
+	timer->lapCpuNanoseconds = getClockNanoseconds(CLOCK_PROCESS_CPUTIME_ID);
+
+	return;
+}
+
+void
+lapPhaseTimer(PhaseTimer *  timer, TimingPhase phase)
+{
+	uint64_t	wallNanoseconds = getClockNanoseconds(CLOCK_MONOTONIC);
+	uint64_t	cpuNanoseconds = getClockNanoseconds(CLOCK_PROCESS_CPUTIME_ID);
+
+	timer->wallNanoseconds[phase] += wallNanoseconds - timer->lapWallNanoseconds;
+	timer->cpuNanoseconds[phase] += cpuNanoseconds - timer->lapCpuNanoseconds;
+	timer->lapWallNanoseconds = wallNanoseconds;
+	timer->lapCpuNanoseconds = cpuNanoseconds;
+
+	return;
+}
+
+const char *
+getTimingPhaseName(TimingPhase phase)
+{
+	return kTimingPhaseNames[phase];
+}
+
+uint64_t
+getPhaseTimerComputationCpuNanoseconds(const PhaseTimer *  timer)
+{
+	return timer->cpuNanoseconds[kTimingPhaseSampling] +
+		timer->cpuNanoseconds[kTimingPhaseKernel] +
+		timer->cpuNanoseconds[kTimingPhaseReduction];
+}
+
+/*
+ *	Sample throughput of the sampling and kernel phases, in samples per second of wall-clock time.
+ */
+static double
+calculateSamplesPerSecond(const PhaseTimer *  timer, size_t numberOfSamples)
+{
+	uint64_t	wallNanoseconds = timer->wallNanoseconds[kTimingPhaseSampling] + timer->wallNanoseconds[kTimingPhaseKernel];
+
+	return (wallNanoseconds > 0) ? (double)numberOfSamples * 1e9 / (double)wallNanoseconds : 0.0;
+}
+
+void
+printPhaseTimings(const PhaseTimer *  timer, size_t numberOfSamples)
+{
+	printf("\nCPU time used: %lf seconds\n", (double)getPhaseTimerComputationCpuNanoseconds(timer) / 1e9);
+	printf("\n");
+	printf("\t%-10s %16s %16s %16s\n", "Phase", "Wall time (s)", "CPU time (s)", "Wall ns/sample");
+
+	for (size_t phase = 0; phase < kTimingPhaseMax; phase++)
+	{
+		printf(
+			"\t%-10s %16.9lf %16.9lf %16.3lf\n",
+			kTimingPhaseNames[phase],
+			(double)timer->wallNanoseconds[phase] / 1e9,
+			(double)timer->cpuNanoseconds[phase] / 1e9,
+			(double)timer->wallNanoseconds[phase] / (double)numberOfSamples);
+	}
+
+	printf("\n");
+	printf("\tThroughput of sampling and kernel: %.1lf samples/s\n", calculateSamplesPerSecond(timer, numberOfSamples));
+
+	return;
+}
+
+void
+printPhaseTimingsJSON(FILE *  fp, const PhaseTimer *  timer, size_t numberOfSamples)
+{
+	fprintf(fp, ", \"timing\": {\"numberOfSamples\": %zu, \"samplesPerSecond\": %.1lf, \"phases\": {", numberOfSamples, calculateSamplesPerSecond(timer, numberOfSamples));
+
+	for (size_t phase = 0; phase < kTimingPhaseMax; phase++)
+	{
+		fprintf(
+			fp,
+			"%s\"%s\": {\"wallNanoseconds\": %" PRIu64 ", \"cpuNanoseconds\": %" PRIu64 ", \"wallNanosecondsPerSample\": %.3lf}",
+			(phase == 0) ? "" : ", ",
+			kTimingPhaseNames[phase],
+			timer->wallNanoseconds[phase],
+			timer->cpuNanoseconds[phase],
+			(double)timer->wallNanoseconds[phase] / (double)numberOfSamples);
+	}
+
+	fprintf(fp, "}}");
+
+	return;
+}
@@ -0,0 +1,120 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ *	Phases of a run that the phase timer distinguishes:
+ *		kTimingPhaseSampling	: Setting the input distributions (random number generation in native Monte Carlo mode).
+ *		kTimingPhaseKernel	: The sensor calibration kernel and storing its outputs.
+ *		kTimingPhaseReduction	: Convergence checks and the post-processing of the Monte Carlo samples.
+ *		kTimingPhaseOutput	: Printing the results and writing the output files.
+ */
+typedef enum
+{
+	kTimingPhaseSampling						= 0,
+	kTimingPhaseKernel						= 1,
+	kTimingPhaseReduction						= 2,
+	kTimingPhaseOutput						= 3,
+	kTimingPhaseMax,
+} TimingPhase;
+
+/*
+ *	Accumulated wall-clock (`CLOCK_MONOTONIC`) and process CPU
+ *	(`CLOCK_PROCESS_CPUTIME_ID`) time per phase, in nanoseconds.
+ */
+typedef struct
+{
+	uint64_t	wallNanoseconds[kTimingPhaseMax];
+	uint64_t	cpuNanoseconds[kTimingPhaseMax];
+	uint64_t	lapWallNanoseconds;
+	uint64_t	lapCpuNanoseconds;
+} PhaseTimer;
+
+/**
+ *	@brief	Reads the monotonic wall clock.
+ *
+ *	@return		: The current value of `CLOCK_MONOTONIC`, in nanoseconds.
+ */
+uint64_t	getWallClockNanoseconds(void);
+
+/**
+ *	@brief	Clears the accumulated times and starts the first lap.
+ *
+ *	@param	timer	: Pointer to the timer.
+ */
+void		startPhaseTimer(PhaseTimer *  timer);
+
+/**
+ *	@brief	Adds the time since the start of the current lap to `phase` and starts a new lap.
+ *
+ *	@param	timer	: Pointer to the timer.
+ *	@param	phase	: The phase that the ending lap belongs to.
+ */
+void		lapPhaseTimer(PhaseTimer *  timer, TimingPhase phase);
+
+/**
+ *	@brief	Restarts the current lap without accounting the time since it started to any phase.
+ *
+ *	@param	timer	: Pointer to the timer.
+ */
+void		restartPhaseTimerLap(PhaseTimer *  timer);
+
+/**
+ *	@brief	Name of a timing phase, as used in the timing reports.
+ *
+ *	@param	phase	: The phase.
+ *	@return		: The name of the phase.
+ */
+const char *	getTimingPhaseName(TimingPhase phase);
+
+/**
+ *	@brief	Total CPU time of the computation phases (sampling, kernel and reduction), in nanoseconds.
+ *
+ *	@param	timer	: Pointer to the timer.
+ *	@return		: The total CPU time.
+ */
+uint64_t	getPhaseTimerComputationCpuNanoseconds(const PhaseTimer *  timer);
+
+/**
+ *	@brief	Prints the per-phase wall-clock and CPU times, the time per sample and the
+ *		sample throughput in a human-readable form.
+ *
+ *	@param	timer			: Pointer to the timer.
+ *	@param	numberOfSamples		: The number of samples (Monte Carlo iterations) of the run.
+ */
+void		printPhaseTimings(const PhaseTimer *  timer, size_t numberOfSamples);
+
+/**
+ *	@brief	Prints the same information as `printPhaseTimings()` as a `"timing"` member of an
+ *		open JSON object, after its other members (that is, preceded by a comma).
+ *
+ *	@param	fp			: The file.
+ *	@param	timer			: Pointer to the timer.
+ *	@param	numberOfSamples		: The number of samples (Monte Carlo iterations) of the run.
+ */
+void		printPhaseTimingsJSON(FILE *  fp, const PhaseTimer *  timer, size_t numberOfSamples);
@@ -20,6 +20,8 @@
  *	SOFTWARE.
  */
 
+#pragma once
+
 /*
  *	These example values of the FLS110's C1, C2, and C3
  *	are taken from the screenshot on page 6 of FL-000986-TN-7, 2022-01-30.
@@ -61,6 +63,96 @@ typedef enum
 	kInputDistributionIndexMax,
 } InputDistributionIndex;
 
+/*
+ *	Families of input distributions, selectable per input at run time (-I,
+ *	-C and -B options), with the parameters of their assignments:
+ *		kInputDistributionFamilyUniform			: Uniform distribution on [low, high] (<low>:<high>).
+ *		kInputDistributionFamilyGaussian		: Gaussian distribution (<mean>:<standard deviation>).
+ *		kInputDistributionFamilyTruncatedGaussian	: Gaussian distribution restricted to [low, high]
+ *								  (<mean>:<standard deviation>:<low>:<high>).
+ *		kInputDistributionFamilyTriangular		: Triangular distribution on [low, high] (<low>:<mode>:<high>).
+ *		kInputDistributionFamilyHistogram		: Empirical histogram of equal-width bins spanning [low, high]
+ *								  (<low>:<high>:<weight>/<weight>/...).
+ */
+typedef enum
+{
+	kInputDistributionFamilyUniform					= 0,
+	kInputDistributionFamilyGaussian				= 1,
+	kInputDistributionFamilyTruncatedGaussian			= 2,
+	kInputDistributionFamilyTriangular				= 3,
+	kInputDistributionFamilyHistogram				= 4,
+	kInputDistributionFamilyMax,
+} InputDistributionFamily;
+
+/*
+ *	Longest line, in bytes, of an input distribution configuration file (-C
+ *	option) or scenario batch file (-B option).
+ */
+#define kInputDistributionAssignmentsMaximumLineBytes			(4096)
+
+/*
+ *	Largest number of bins of an empirical histogram input distribution.
+ */
+#define kInputDistributionHistogramMaximumNumberOfBins			(64)
+
+/*
+ *	Most `:`-separated fields of an input distribution assignment: the family
+ *	and up to four parameters.
+ */
+#define kInputDistributionAssignmentMaximumNumberOfFields		(5)
+
+/*
+ *	Size, in bytes, of the description of an invalid input distribution
+ *	assignment or input correlation, including its terminating null.
+ */
+#define kInputAssignmentErrorMessageBytes				(512)
+
+/*
+ *	Half-width, in standard deviations, of the finite range that stands in
+ *	for the unbounded support of a Gaussian input where the outputs need
+ *	finite bounds (the analytic bounds of the -D distribution table).
+ */
+#define kInputDistributionGaussianRangeStandardDeviations		(8.0)
+
+/*
+ *	Ziggurat sampler of the Gaussian inputs of the counter-based samplers
+ *	(Marsaglia and Tsang, 2000, with the layers of Doornik, 2005): the
+ *	number of layers, the start of the tail and the area of every layer.
+ */
+#define kZigguratNumberOfLayers						(256)
+#define kZigguratTailStart						(3.6541528853610088)
+#define kZigguratLayerArea						(4.92867323399e-3)
+
+/*
+ *	Table of the standard Gaussian cumulative distribution function with which
+ *	the counter-based samplers map correlated Gaussian variates to uniforms
+ *	(-K option): degree-7 Taylor polynomials about the midpoints of intervals
+ *	of width 1 / `kGaussianCumulativeTableIntervalsPerUnit` over
+ *	[-`kGaussianCumulativeTableLimit`, `kGaussianCumulativeTableLimit`], to which
+ *	the variates of the copula are clamped.
+ */
+#define kGaussianCumulativeTableLimit					(9)
+#define kGaussianCumulativeTableIntervalsPerUnit			(16)
+
+/*
+ *	Smallest squared diagonal entry of the Cholesky factor of the input
+ *	correlation matrix (-K option) for which the matrix counts as positive
+ *	definite.
+ */
+#define kInputCorrelationMinimumCholeskyPivot				(1e-9)
+
+/*
+ *	Most scenarios of a common random numbers sweep (-U option).
+ */
+#define kCommonRandomNumbersSweepMaximumNumberOfScenarios		(256)
+
+/*
+ *	A stored sample set (-L option) answers for the current input
+ *	distributions by reweighting only if its effective sample size is at least
+ *	this fraction of its number of samples (unless the -e option sets it).
+ */
+#define kSampleReweightingDefaultMinimumEffectiveSampleFraction		(0.5)
+
 /*
  *	Output Distributions:
  *		kOutputDistributionIndexCalibratedMassFlowOutput		: Mass flow (in sccm)
@@ -72,3 +164,181 @@ typedef enum
 	kOutputDistributionIndexCalibratedDifferentialPressureOutput	= 1,
 	kOutputDistributionIndexMax,
 } OutputDistributionIndex;
+
+/*
+ *	Monte Carlo mode: the main loop runs in blocks of this many iterations. In
+ *	adaptive Monte Carlo mode, convergence is checked at the end of each block,
+ *	but only after at least `kAdaptiveMonteCarloMinimumNumberOfBlocks` blocks, so
+ *	that the batch-means estimates of the standard errors of the quantiles are
+ *	meaningful.
+ */
+#define kMonteCarloBlockSize						(1024)
+#define kAdaptiveMonteCarloMinimumNumberOfBlocks			(8)
+
+/*
+ *	Wasserstein accuracy-versus-cost sweep: the reference distribution of each
+ *	output has this many Latin hypercube samples unless set with `-M`, and the
+ *	sweep evaluates every sampler at `kWassersteinSweepMinimumSize` samples,
+ *	multiplied by `kWassersteinSweepSizeFactor` up to a tenth of the reference
+ *	size, repeating each evaluation `kWassersteinSweepRepetitions` times. The
+ *	cost of every point is timed separately, after the accuracy of all points:
+ *	`kWassersteinSweepTimingWarmupRepetitions` untimed runs, then the median of
+ *	`kWassersteinSweepTimingRepetitions` timings, each of as many runs as take
+ *	at least `kWassersteinSweepTimingMinimumNanoseconds` in all.
+ */
+#define kWassersteinSweepDefaultReferenceSize				(1000000)
+#define kWassersteinSweepMinimumSize					(100)
+#define kWassersteinSweepSizeFactor					(10)
+#define kWassersteinSweepRepetitions					(5)
+#define kWassersteinSweepTimingWarmupRepetitions			(3)
+#define kWassersteinSweepTimingRepetitions				(15)
+#define kWassersteinSweepTimingMinimumNanoseconds			(2000000)
+
+/*
+ *	Mergeable summaries of Monte Carlo outputs (sharded runs): fixed-edge
+ *	histograms whose range is that of a pilot block of samples, widened by
+ *	`kOutputHistogramPilotRangeMargin` times its width on either side, and
+ *	quantile sketches with logarithmic buckets that guarantee a relative error
+ *	of at most `kQuantileSketchRelativeAccuracy` for magnitudes of at least
+ *	`kQuantileSketchMinimumIndexableValue`. Only the buckets that hold samples
+ *	are stored, in hash tables of initially `kQuantileSketchInitialCapacity`
+ *	entries that double when they are half full.
+ */
+#define kOutputHistogramNumberOfBins					(64)
+#define kOutputHistogramPilotRangeMargin				(0.25)
+#define kQuantileSketchRelativeAccuracy					(1e-6)
+#define kQuantileSketchMinimumIndexableValue				(1e-9)
+#define kQuantileSketchInitialCapacity					(1024)
+
+/*
+ *	Seed of the counter-based input sampler, used by sharded runs so that the
+ *	inputs of every iteration are the same whichever shard computes them.
+ */
+#define kCounterBasedSamplerDefaultSeed					(0x5EEDF1511000ULL)
+
+/*
+ *	Parallel Monte Carlo: maximum number of threads. Each thread runs a
+ *	contiguous range of whole blocks of `kMonteCarloBlockSize` iterations, so
+ *	that no page of the sample arrays (which are on base-size pages, not huge
+ *	pages) is shared by two threads.
+ */
+#define kParallelMonteCarloMaximumNumberOfThreads			(256)
+
+/*
+ *	Run arena: per-run buffers come from chunks of at least
+ *	`kRunArenaMinimumChunkBytes` (one 2 MiB huge page on x86-64 and AArch64
+ *	Linux), and the arena has at most `kRunArenaMaximumNumberOfChunks` chunks.
+ */
+#define kRunArenaMinimumChunkBytes					(2 * 1024 * 1024)
+#define kRunArenaMaximumNumberOfChunks					(64)
+#define kRunArenaDefaultAlignment					(64)
+
+/*
+ *	Content of the JSON output of a Monte Carlo run (-J option):
+ *		kJSONOutputContentSamples	: All samples of each output.
+ *		kJSONOutputContentSummary	: Moments, extremes and quantiles of each output.
+ *		kJSONOutputContentHistogram	: Histogram of each output.
+ */
+typedef enum
+{
+	kJSONOutputContentSamples					= 0,
+	kJSONOutputContentSummary					= 1,
+	kJSONOutputContentHistogram					= 2,
+	kJSONOutputContentMax,
+} JSONOutputContent;
+
+/*
+ *	Text output (data.out and JSON) is formatted into a buffer of
+ *	`kTextOutputBufferBytes`, which is handed to `write()` whenever it is
+ *	full. Tables of samples are formatted in parallel in chunks of
+ *	`kTextOutputParallelChunkRows` rows per thread.
+ */
+#define kTextOutputBufferBytes						(1024 * 1024)
+#define kTextOutputParallelChunkRows					(65536)
+
+/*
+ *	Range of the bins of the distribution table output (-D option):
+ *		kDistributionTableBoundsFirstBlock	: The range of the first block of samples, widened by
+ *							  `kOutputHistogramPilotRangeMargin` of its width on each side.
+ *		kDistributionTableBoundsAnalytic	: The range of the output over the ranges of the inputs,
+ *							  so that no sample falls outside the bins.
+ */
+typedef enum
+{
+	kDistributionTableBoundsFirstBlock				= 0,
+	kDistributionTableBoundsAnalytic				= 1,
+	kDistributionTableBoundsMax,
+} DistributionTableBounds;
+
+/*
+ *	Outcome of comparing the interval of an output over the input bounds with
+ *	a threshold (-t option):
+ *		kThresholdIntervalDecisionBelow		: The output is never above the threshold.
+ *		kThresholdIntervalDecisionAbove		: The output is always above the threshold.
+ *		kThresholdIntervalDecisionAmbiguous	: The interval contains the threshold, so the
+ *							  probability has to be sampled.
+ */
+typedef enum
+{
+	kThresholdIntervalDecisionBelow					= 0,
+	kThresholdIntervalDecisionAbove					= 1,
+	kThresholdIntervalDecisionAmbiguous				= 2,
+	kThresholdIntervalDecisionMax,
+} ThresholdIntervalDecision;
+
+/*
+ *	The interval of an output is widened by `kSensorOutputIntervalRelativeMargin`
+ *	times its magnitude before it is compared with a threshold, to cover the
+ *	rounding of the kernel.
+ */
+#define kSensorOutputIntervalRelativeMargin				(1e-12)
+
+/*
+ *	File format of the distribution table output (-F option).
+ */
+typedef enum
+{
+	kDistributionTableFormatText					= 0,
+	kDistributionTableFormatJSON					= 1,
+	kDistributionTableFormatBinary					= 2,
+	kDistributionTableFormatMax,
+} DistributionTableFormat;
+
+/*
+ *	The analytic bounds of the outputs are widened by this fraction of their
+ *	width on each side, so that samples that round past a bound still fall in
+ *	the first or last bin.
+ */
+#define kDistributionTableAnalyticBoundsMargin				(1e-9)
+
+/*
+ *	Compressed sample output (-Z option): the samples are compressed in blocks
+ *	of `kCompressedOutputBlockRows` rows, each of which can be read on its own
+ *	through the index at the end of the file. The compressor finds repeated
+ *	sequences of at least `kCompressedOutputMinimumMatchBytes` bytes, up to
+ *	`kCompressedOutputMaximumMatchOffset` bytes back, through a hash table of
+ *	2^`kCompressedOutputHashBits` entries.
+ */
+#define kCompressedOutputBlockRows					(65536)
+#define kCompressedOutputMinimumMatchBytes				(4)
+#define kCompressedOutputMaximumMatchOffset				(65535)
+#define kCompressedOutputHashBits					(14)
+
+/*
+ *	Particle mode (-Q option): every distribution is represented by
+ *	`kParticleDistributionNumberOfParticles` equally-weighted particles, and
+ *	arithmetic on distributions works on `kParticleDistributionVectorBytes`
+ *	bytes of particles at a time. Integer powers up to
+ *	`kParticleDistributionMaximumIntegerExponent` are computed by repeated
+ *	multiplication.
+ */
+#define kParticleDistributionNumberOfParticles				(4096)
+#define kParticleDistributionVectorBytes				(32)
+#define kParticleDistributionMaximumIntegerExponent			(64)
+
+/*
+ *	Product distribution engine (-E option): quantiles of a product of two
+ *	independent sample sets are found by `kProductDistributionQuantileBisectionSteps`
+ *	bisection steps on its distribution function.
+ */
+#define kProductDistributionQuantileBisectionSteps			(100)
@@ -20,10 +20,19 @@
  *	SOFTWARE.
  */
 
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
 #include <uxhw.h>
 #include "utilities.h"
+#include "distribution-table.h"
+#include "input-correlations.h"
+#include "input-distributions.h"
+#include "json-output.h"
+#include "run-arena.h"
+#include "text-output.h"
 
 void
 printUsage(void)
@@ -35,12 +44,69 @@ printUsage(void)
 		"\t[-o, --output <Path to output CSV file : str>] (Specify the output file.)\n"
 		"\t[-S, --select-output <output : int>] (Compute 0-indexed output. Calculate all possible outputs if equal to %d. Default value: %d.)\n"
 		"\t[-M, --multiple-executions <Number of executions : int (Default: 1)>] (Repeated execute kernel for benchmarking.)\n"
-		"\t[-T, --time] (Timing mode: Times and prints the timing of the kernel execution.)\n"
+		"\t[-T, --time] (Timing mode: Times and prints the wall-clock and CPU time of the sampling, kernel, reduction and output phases,\n"
+		"\t\tand the peak resident set size and run arena high-water mark.)\n"
 		"\t[-b, --benchmarking] (Benchmarking mode: Generate outputs in format for benchmarking.)\n"
 		"\t[-j, --json] (Print output in JSON format.)\n"
+		"\t[-a, --adaptive-tolerance <relative tolerance : double>] (Adaptive Monte Carlo: stop once the standard errors of the mean\n"
+		"\t\tand of the 5%%, 50%% and 95%% quantiles are at most this fraction of the mean. The -M value is the iteration cap.)\n"
+		"\t[-t, --tail-threshold <threshold : double>] (Importance sampling: estimate P(output > threshold) by exponentially tilting\n"
+		"\t\tthe heat power transfer input. Requires -M and -S. With -a, stops at that relative standard error. If the range of\n"
+		"\t\tthe output over the input bounds is entirely on one side of the threshold, answers 0 or 1 without sampling.)\n"
+		"\t[-k, --tilt <tilt : double>] (Importance sampling: tilt on heat power transfer, in 1/W. Default: chosen from the threshold.)\n"
+		"\t[-P, --perf-counters] (Print hardware performance counters per iteration of the sampling and kernel phases. Linux only.)\n"
+		"\t[-W, --wasserstein-sweep] (Accuracy-versus-cost sweep: print the 1-Wasserstein distance to a reference distribution and the\n"
+		"\t\twall-clock cost of each input sampler and number of samples, marking the Pareto-optimal ones. -M sets the reference size.)\n"
+		"\t[-R, --wasserstein-reference <Path to reference data.out file : str>] (Use these samples of the -S output as the -W reference.)\n"
+		"\t[-s, --shard <k/n : str>] (Sharded Monte Carlo: run shard k (0-indexed) of n of the -M iterations and write its mergeable\n"
+		"\t\tpartial result (moments, histogram and quantile sketch) to partial-<k>-of-<n>.out.)\n"
+		"\t[-m, --merge <Comma-separated paths of partial-result files : str>] (Merge the partial results of all shards and print the\n"
+		"\t\tstatistics of the complete run.)\n"
+		"\t[-N, --threads <Number of threads : int>] (Parallel Monte Carlo: run the -M iterations on this many threads, each writing its\n"
+		"\t\town NUMA-local range of the samples. With -T, also prints per-thread timing and the per-thread and per-NUMA-node bandwidth of the first write of the ranges.)\n"
+		"\t[-A, --pin-threads] (Parallel Monte Carlo: pin each thread to its own CPU.)\n"
+		"\t[-J, --json-content <samples|summary|histogram : str>] (Content of the -j output of a Monte Carlo run: all samples\n"
+		"\t\t(default), or only the moments, extremes and quantiles, or only a histogram of each output.)\n"
+		"\t[-D, --distribution-table <first-block|analytic : str>] (Write a table of the probability density and cumulative\n"
+		"\t\tdistribution of each output over %d bins instead of data.out. The bins span the first block of samples, or the\n"
+		"\t\trange of the output over the ranges of the inputs.)\n"
+		"\t[-F, --distribution-table-format <text|json|binary : str>] (Format of the -D table: distribution-table.out (default),\n"
+		"\t\tdistribution-table.json or distribution-table.bin.)\n"
+		"\t[-Z, --compressed-output] (Write the samples to data.cmp, compressed in blocks on a background thread, instead of data.out.)\n"
+		"\t[-X, --decompress <Path to data.cmp file : str>] (Decompress a -Z file into data.out.)\n"
+		"\t[-Q, --particles] (Particle mode: run the kernel once on distributions of %d equally-weighted particles instead of\n"
+		"\t\tMonte Carlo iterations, and answer the probabilities from the particles. The particles are written as samples.)\n"
+		"\t[-E, --product-engine <N_mxN_r : str>] (Product distribution engine: sample the mass flow N_m times and the correction\n"
+		"\t\tfactor (Tflow / T0) * (P0 / Pflow) N_r times, and answer the differential pressure from all N_m * N_r products of the\n"
+		"\t\ttwo. Requires -S %d or -S %d. Writes no data.out; use -D for the distributions.)\n"
+		"\t[-I, --inputs <assignments : str>] (Input distributions, as comma-separated <input>=[<family>:]<parameters>, for\n"
+		"\t\texample Tflow=gaussian:293.5:0.2,P0=400000:410000. The inputs are Hxfer, Tflow, T0, Pflow and P0. The families\n"
+		"\t\tand their parameters are uniform:<low>:<high> (the default family), gaussian:<mean>:<standard deviation>,\n"
+		"\t\ttruncated-gaussian:<mean>:<standard deviation>:<low>:<high>, triangular:<low>:<mode>:<high> and\n"
+		"\t\thistogram:<low>:<high>:<weight>/<weight>/... (up to %d equal-width bins).)\n"
+		"\t[-C, --input-config <Path to configuration file : str>] (Read -I assignments from every line of this file. -I overrides it.)\n"
+		"\t[-K, --correlations <correlations : str>] (Correlations of the inputs, as comma-separated <input>:<input>=<correlation>,\n"
+		"\t\tfor example Tflow:T0=0.8,Pflow:P0=0.6. The inputs are sampled from a Gaussian copula with this correlation\n"
+		"\t\tmatrix, which must be positive definite, and keep their -I distributions. Unlisted pairs are uncorrelated.)\n"
+		"\t[-B, --scenario-batch <Path to scenario file : str>] (Run the iterations once for every line of -I assignments of this\n"
+		"\t\tfile, on top of the -I and -C input distributions, in one process and with the same buffers. Writes no data.out.)\n"
+		"\t[-U, --crn-sweep <Path to scenario file : str>] (Common random numbers sweep: evaluate the -S output for every line of -I\n"
+		"\t\tassignments of this file from the same -M uniform variates of the inputs, mapped to the distributions of each\n"
+		"\t\tscenario, and print the difference of each scenario from the first, with its standard error. Writes no data.out.)\n"
+		"\t[-L, --reweight <Path to sample store : str>] (Answer for the current input distributions by reweighting the input and\n"
+		"\t\toutput samples stored in this file by an earlier run. If there are none, the input distributions reach outside\n"
+		"\t\tthe stored ones, or the effective sample size is too small, draw -M fresh samples and store them. Writes no data.out.)\n"
+		"\t[-e, --min-ess-fraction <fraction in (0, 1] : double>] (Smallest effective sample size of -L reweighting, as a fraction\n"
+		"\t\tof the stored samples, below which it draws fresh samples. Default is %.2lf.)\n"
 		"\t[-h, --help] (Display this help message.)\n",
 		kOutputDistributionIndexMax,
-		kOutputDistributionIndexMax);
+		kOutputDistributionIndexMax,
+		kOutputHistogramNumberOfBins,
+		kParticleDistributionNumberOfParticles,
+		kOutputDistributionIndexCalibratedDifferentialPressureOutput,
+		kOutputDistributionIndexMax,
+		kInputDistributionHistogramMaximumNumberOfBins,
+		kSampleReweightingDefaultMinimumEffectiveSampleFraction);
 	fprintf(stderr, "\n");
 
 	return;
@@ -63,7 +129,8 @@ setDefaultCommandLineArguments(CommandLineArguments *  arguments)
 
 	*arguments = (CommandLineArguments)
 	{
-		.common	= (CommonCommandLineArguments) {0}
+		.common				= (CommonCommandLineArguments) {0},
+		.minimumEffectiveSampleFraction	= kSampleReweightingDefaultMinimumEffectiveSampleFraction,
 	};
 #pragma GCC diagnostic pop
 
@@ -76,7 +143,47 @@ getCommandLineArguments(
 	char *			argv[],
 	CommandLineArguments *	arguments)
 {
-	DemoOption		demoSpecificOptions = {0};
+	char *			adaptiveToleranceArg = NULL;
+	char *			tailThresholdArg = NULL;
+	char *			tiltArg = NULL;
+	char *			shardArg = NULL;
+	char *			threadsArg = NULL;
+	char *			jsonContentArg = NULL;
+	char *			distributionTableArg = NULL;
+	char *			distributionTableFormatArg = NULL;
+	char *			productEngineArg = NULL;
+	char *			inputDistributionAssignmentsArg = NULL;
+	char *			inputDistributionConfigurationArg = NULL;
+	char *			inputCorrelationAssignmentsArg = NULL;
+	char *			minimumEffectiveSampleFractionArg = NULL;
+	DemoOption		demoSpecificOptions[] =
+				{
+					{ .opt = "a", .optAlternative = "adaptive-tolerance", .hasArg = true, .foundArg = &adaptiveToleranceArg, .foundOpt = NULL },
+					{ .opt = "t", .optAlternative = "tail-threshold", .hasArg = true, .foundArg = &tailThresholdArg, .foundOpt = NULL },
+					{ .opt = "k", .optAlternative = "tilt", .hasArg = true, .foundArg = &tiltArg, .foundOpt = NULL },
+					{ .opt = "P", .optAlternative = "perf-counters", .hasArg = false, .foundArg = NULL, .foundOpt = &arguments->isPerfCountersEnabled },
+					{ .opt = "W", .optAlternative = "wasserstein-sweep", .hasArg = false, .foundArg = NULL, .foundOpt = &arguments->isWassersteinSweepMode },
+					{ .opt = "R", .optAlternative = "wasserstein-reference", .hasArg = true, .foundArg = &arguments->wassersteinReferencePath, .foundOpt = NULL },
+					{ .opt = "s", .optAlternative = "shard", .hasArg = true, .foundArg = &shardArg, .foundOpt = NULL },
+					{ .opt = "m", .optAlternative = "merge", .hasArg = true, .foundArg = &arguments->mergePartialResultPaths, .foundOpt = NULL },
+					{ .opt = "N", .optAlternative = "threads", .hasArg = true, .foundArg = &threadsArg, .foundOpt = NULL },
+					{ .opt = "A", .optAlternative = "pin-threads", .hasArg = false, .foundArg = NULL, .foundOpt = &arguments->isThreadPinningEnabled },
+					{ .opt = "J", .optAlternative = "json-content", .hasArg = true, .foundArg = &jsonContentArg, .foundOpt = NULL },
+					{ .opt = "D", .optAlternative = "distribution-table", .hasArg = true, .foundArg = &distributionTableArg, .foundOpt = NULL },
+					{ .opt = "F", .optAlternative = "distribution-table-format", .hasArg = true, .foundArg = &distributionTableFormatArg, .foundOpt = NULL },
+					{ .opt = "Z", .optAlternative = "compressed-output", .hasArg = false, .foundArg = NULL, .foundOpt = &arguments->isCompressedOutputMode },
+					{ .opt = "X", .optAlternative = "decompress", .hasArg = true, .foundArg = &arguments->decompressInputPath, .foundOpt = NULL },
+					{ .opt = "Q", .optAlternative = "particles", .hasArg = false, .foundArg = NULL, .foundOpt = &arguments->isParticleMode },
+					{ .opt = "E", .optAlternative = "product-engine", .hasArg = true, .foundArg = &productEngineArg, .foundOpt = NULL },
+					{ .opt = "I", .optAlternative = "inputs", .hasArg = true, .foundArg = &inputDistributionAssignmentsArg, .foundOpt = NULL },
+					{ .opt = "C", .optAlternative = "input-config", .hasArg = true, .foundArg = &inputDistributionConfigurationArg, .foundOpt = NULL },
+					{ .opt = "K", .optAlternative = "correlations", .hasArg = true, .foundArg = &inputCorrelationAssignmentsArg, .foundOpt = NULL },
+					{ .opt = "B", .optAlternative = "scenario-batch", .hasArg = true, .foundArg = &arguments->scenarioBatchPath, .foundOpt = NULL },
+					{ .opt = "U", .optAlternative = "crn-sweep", .hasArg = true, .foundArg = &arguments->commonRandomNumbersScenarioPath, .foundOpt = NULL },
+					{ .opt = "L", .optAlternative = "reweight", .hasArg = true, .foundArg = &arguments->sampleReweightingStorePath, .foundOpt = NULL },
+					{ .opt = "e", .optAlternative = "min-ess-fraction", .hasArg = true, .foundArg = &minimumEffectiveSampleFractionArg, .foundOpt = NULL },
+					{0},
+				};
 
 	if (arguments == NULL)
 	{
@@ -86,10 +193,7 @@ getCommandLineArguments(
 
 	setDefaultCommandLineArguments(arguments);
 
-	/*
-	 *	This application example has no application specific arguments.
-	 */
-	if (parseArgs(argc, argv, &arguments->common, &demoSpecificOptions) != 0)
+	if (parseArgs(argc, argv, &arguments->common, demoSpecificOptions) != 0)
 	{
 		fprintf(stderr, "Parsing command line arguments failed\n");
 		printUsage();
@@ -124,6 +228,48 @@ getCommandLineArguments(
 		return kCommonConstantReturnTypeError;
 	}
 
+	/*
+	 *	The input distributions of the configuration file apply first, so that
+	 *	the -I option overrides them.
+	 */
+	if ((inputDistributionConfigurationArg != NULL) &&
+		(loadInputDistributionConfigurationFile(inputDistributionConfigurationArg) != kCommonConstantReturnTypeSuccess))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((inputDistributionAssignmentsArg != NULL) &&
+		(parseInputDistributionAssignments(inputDistributionAssignmentsArg) != kCommonConstantReturnTypeSuccess))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((inputCorrelationAssignmentsArg != NULL) &&
+		(parseInputCorrelationAssignments(inputCorrelationAssignmentsArg) != kCommonConstantReturnTypeSuccess))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (adaptiveToleranceArg != NULL)
+	{
+		if ((parseDoubleChecked(adaptiveToleranceArg, &arguments->adaptiveTolerance) != kCommonConstantReturnTypeSuccess) ||
+			!(arguments->adaptiveTolerance > 0.0))
+		{
+			fprintf(stderr, "Error: The adaptive tolerance (-a option) must be a positive real number.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: Adaptive Monte Carlo (-a option) requires Monte Carlo mode (-M option).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isAdaptiveMonteCarloMode = true;
+	}
+
 	if (arguments->common.isVerbose)
 	{
 		fprintf(stderr, "Warning: Verbose mode not supported. Continuing in non-verbose mode.\n");
@@ -147,23 +293,488 @@ getCommandLineArguments(
 			"Output select value (-S option) is greater than the possible number of outputs: Provided %zd. Max: %d\n",
 			arguments->common.outputSelect,
 			kOutputDistributionIndexMax);
+
+		return kCommonConstantReturnTypeError;
 	}
 	/*
-	 *	When all outputs are selected, we cannot be in benchmarking mode or Monte Carlo mode.
+	 *	When all outputs are selected, we cannot be in benchmarking mode. In Monte Carlo
+	 *	mode, all outputs are sampled jointly in a single pass.
 	 */
 	else if (arguments->common.outputSelect == kOutputDistributionIndexMax)
 	{
-		if ((arguments->common.isBenchmarkingMode) || (arguments->common.isMonteCarloMode))
+		if (arguments->common.isBenchmarkingMode)
+		{
+			fprintf(stderr, "Error: Please select a single output when in benchmarking mode.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (tailThresholdArg != NULL)
+	{
+		if (parseDoubleChecked(tailThresholdArg, &arguments->tailThreshold) != kCommonConstantReturnTypeSuccess)
+		{
+			fprintf(stderr, "Error: The tail threshold (-t option) must be a real number.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (!arguments->common.isMonteCarloMode || (arguments->common.outputSelect == kOutputDistributionIndexMax))
+		{
+			fprintf(stderr, "Error: Importance sampling (-t option) requires Monte Carlo mode (-M option) and a single output (-S option).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->common.isOutputJSONMode || arguments->common.isBenchmarkingMode)
+		{
+			fprintf(stderr, "Error: Importance sampling (-t option) does not support JSON output or benchmarking mode.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isImportanceSamplingMode = true;
+	}
+
+	if (tiltArg != NULL)
+	{
+		if (parseDoubleChecked(tiltArg, &arguments->importanceSamplingTilt) != kCommonConstantReturnTypeSuccess)
+		{
+			fprintf(stderr, "Error: The tilt (-k option) must be a real number.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (!arguments->isImportanceSamplingMode)
+		{
+			fprintf(stderr, "Error: The tilt (-k option) requires importance sampling (-t option).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isTiltSpecified = true;
+	}
+
+	if (arguments->isWassersteinSweepMode)
+	{
+		if (arguments->isAdaptiveMonteCarloMode || arguments->isImportanceSamplingMode || arguments->common.isBenchmarkingMode)
+		{
+			fprintf(stderr, "Error: The Wasserstein sweep (-W option) does not support the -a, -t and -b options.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if ((arguments->wassersteinReferencePath != NULL) && (arguments->common.outputSelect == kOutputDistributionIndexMax))
+		{
+			fprintf(stderr, "Error: A Wasserstein reference file (-R option) requires a single output (-S option).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+	else if (arguments->wassersteinReferencePath != NULL)
+	{
+		fprintf(stderr, "Error: The Wasserstein reference file (-R option) requires the Wasserstein sweep (-W option).\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (shardArg != NULL)
+	{
+		char *	separator = strchr(shardArg, '/');
+		int	shardIndex;
+		int	numberOfShards;
+
+		if ((separator == NULL) ||
+			((*separator = '\0'), parseIntChecked(shardArg, &shardIndex) != kCommonConstantReturnTypeSuccess) ||
+			(parseIntChecked(separator + 1, &numberOfShards) != kCommonConstantReturnTypeSuccess) ||
+			(numberOfShards < 1) || (shardIndex < 0) || (shardIndex >= numberOfShards))
+		{
+			fprintf(stderr, "Error: The shard (-s option) must be of the form k/n, with 0 <= k < n.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: Sharded Monte Carlo (-s option) requires Monte Carlo mode (-M option).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isAdaptiveMonteCarloMode || arguments->isImportanceSamplingMode ||
+			arguments->isWassersteinSweepMode || arguments->common.isBenchmarkingMode)
+		{
+			fprintf(stderr, "Error: Sharded Monte Carlo (-s option) does not support the -a, -t, -W and -b options.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isShardMode = true;
+		arguments->shardIndex = (size_t)shardIndex;
+		arguments->numberOfShards = (size_t)numberOfShards;
+	}
+
+	if (productEngineArg != NULL)
+	{
+		char *	separator = strchr(productEngineArg, 'x');
+		int	numberOfMassFlowSamples;
+		int	numberOfCorrectionFactorSamples;
+
+		if ((separator == NULL) ||
+			((*separator = '\0'), parseIntChecked(productEngineArg, &numberOfMassFlowSamples) != kCommonConstantReturnTypeSuccess) ||
+			(parseIntChecked(separator + 1, &numberOfCorrectionFactorSamples) != kCommonConstantReturnTypeSuccess) ||
+			(numberOfMassFlowSamples < 1) || (numberOfCorrectionFactorSamples < 1))
+		{
+			fprintf(stderr, "Error: The product engine sample counts (-E option) must be of the form N_mxN_r, with N_m, N_r >= 1.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->common.isMonteCarloMode || arguments->isWassersteinSweepMode || arguments->isShardMode ||
+			(arguments->mergePartialResultPaths != NULL) || (arguments->decompressInputPath != NULL) ||
+			arguments->isParticleMode || arguments->common.isOutputJSONMode)
+		{
+			fprintf(stderr, "Error: The product engine (-E option) does not support the -M, -W, -s, -m, -X, -Q and -j options.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->common.outputSelect == kOutputDistributionIndexCalibratedMassFlowOutput)
+		{
+			fprintf(stderr, "Error: The product engine (-E option) requires the differential pressure output (-S %d or -S %d).\n",
+				kOutputDistributionIndexCalibratedDifferentialPressureOutput,
+				kOutputDistributionIndexMax);
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isProductEngineMode = true;
+		arguments->numberOfProductMassFlowSamples = (size_t)numberOfMassFlowSamples;
+		arguments->numberOfProductCorrectionFactorSamples = (size_t)numberOfCorrectionFactorSamples;
+	}
+
+	if ((arguments->mergePartialResultPaths != NULL) && (arguments->isShardMode || arguments->isWassersteinSweepMode))
+	{
+		fprintf(stderr, "Error: Merging partial results (-m option) does not support the -s and -W options.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (threadsArg != NULL)
+	{
+		int	numberOfThreads;
+
+		if ((parseIntChecked(threadsArg, &numberOfThreads) != kCommonConstantReturnTypeSuccess) ||
+			(numberOfThreads < 1) || (numberOfThreads > kParallelMonteCarloMaximumNumberOfThreads))
+		{
+			fprintf(stderr, "Error: The number of threads (-N option) must be between 1 and %d.\n", kParallelMonteCarloMaximumNumberOfThreads);
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: Parallel Monte Carlo (-N option) requires Monte Carlo mode (-M option).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isAdaptiveMonteCarloMode || arguments->isImportanceSamplingMode || arguments->isPerfCountersEnabled ||
+			arguments->isWassersteinSweepMode || arguments->isShardMode || (arguments->mergePartialResultPaths != NULL))
+		{
+			fprintf(stderr, "Error: Parallel Monte Carlo (-N option) does not support the -a, -t, -P, -W, -s and -m options.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isParallelMonteCarloMode = true;
+		arguments->numberOfThreads = (size_t)numberOfThreads;
+	}
+	else if (arguments->isThreadPinningEnabled)
+	{
+		fprintf(stderr, "Error: Thread pinning (-A option) requires parallel Monte Carlo (-N option).\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (jsonContentArg != NULL)
+	{
+		arguments->jsonOutputContent = kJSONOutputContentMax;
+
+		for (JSONOutputContent content = 0; content < kJSONOutputContentMax; content++)
+		{
+			if (strcmp(jsonContentArg, getJSONOutputContentName(content)) == 0)
+			{
+				arguments->jsonOutputContent = content;
+			}
+		}
+
+		if (arguments->jsonOutputContent == kJSONOutputContentMax)
+		{
+			fprintf(stderr, "Error: The JSON content (-J option) must be one of samples, summary and histogram.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (!arguments->common.isOutputJSONMode || !arguments->common.isMonteCarloMode)
 		{
-			fprintf(stderr, "Error: Please select a single output when in benchmarking mode or Monte Carlo mode.\n");
+			fprintf(stderr, "Error: The JSON content (-J option) requires JSON output (-j option) and Monte Carlo mode (-M option).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isImportanceSamplingMode || arguments->isWassersteinSweepMode ||
+			arguments->isShardMode || (arguments->mergePartialResultPaths != NULL))
+		{
+			fprintf(stderr, "Error: The JSON content (-J option) does not support the -t, -W, -s and -m options.\n");
 
 			return kCommonConstantReturnTypeError;
 		}
 	}
 
+	if (distributionTableArg != NULL)
+	{
+		arguments->distributionTableBounds = kDistributionTableBoundsMax;
+
+		for (DistributionTableBounds bounds = 0; bounds < kDistributionTableBoundsMax; bounds++)
+		{
+			if (strcmp(distributionTableArg, getDistributionTableBoundsName(bounds)) == 0)
+			{
+				arguments->distributionTableBounds = bounds;
+			}
+		}
+
+		if (arguments->distributionTableBounds == kDistributionTableBoundsMax)
+		{
+			fprintf(stderr, "Error: The distribution table bounds (-D option) must be one of first-block and analytic.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (!arguments->common.isMonteCarloMode && !arguments->isProductEngineMode)
+		{
+			fprintf(stderr, "Error: The distribution table (-D option) requires Monte Carlo mode (-M option) or the product engine (-E option).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isImportanceSamplingMode || arguments->isWassersteinSweepMode ||
+			arguments->isShardMode || (arguments->mergePartialResultPaths != NULL))
+		{
+			fprintf(stderr, "Error: The distribution table (-D option) does not support the -t, -W, -s and -m options.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isDistributionTableMode = true;
+	}
+
+	if (distributionTableFormatArg != NULL)
+	{
+		arguments->distributionTableFormat = kDistributionTableFormatMax;
+
+		for (DistributionTableFormat format = 0; format < kDistributionTableFormatMax; format++)
+		{
+			if (strcmp(distributionTableFormatArg, getDistributionTableFormatName(format)) == 0)
+			{
+				arguments->distributionTableFormat = format;
+			}
+		}
+
+		if (arguments->distributionTableFormat == kDistributionTableFormatMax)
+		{
+			fprintf(stderr, "Error: The distribution table format (-F option) must be one of text, json and binary.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (!arguments->isDistributionTableMode)
+		{
+			fprintf(stderr, "Error: The distribution table format (-F option) requires the distribution table (-D option).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (arguments->isCompressedOutputMode)
+	{
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: The compressed output (-Z option) requires Monte Carlo mode (-M option).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isWassersteinSweepMode || arguments->isShardMode ||
+			(arguments->mergePartialResultPaths != NULL) || arguments->isDistributionTableMode)
+		{
+			fprintf(stderr, "Error: The compressed output (-Z option) does not support the -W, -s, -m and -D options.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if ((arguments->decompressInputPath != NULL) &&
+		(arguments->common.isMonteCarloMode || arguments->isWassersteinSweepMode || (arguments->mergePartialResultPaths != NULL)))
+	{
+		fprintf(stderr, "Error: Decompressing (-X option) does not support the -M, -W and -m options.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (arguments->isParticleMode &&
+		(arguments->common.isMonteCarloMode || arguments->isWassersteinSweepMode || arguments->isShardMode ||
+			(arguments->mergePartialResultPaths != NULL) || (arguments->decompressInputPath != NULL)))
+	{
+		fprintf(stderr, "Error: Particle mode (-Q option) does not support the -M, -W, -s, -m and -X options.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((arguments->scenarioBatchPath != NULL) &&
+		(arguments->isWassersteinSweepMode || arguments->isShardMode || (arguments->mergePartialResultPaths != NULL) ||
+			(arguments->decompressInputPath != NULL) || arguments->isParticleMode || arguments->isProductEngineMode ||
+			arguments->common.isOutputJSONMode || arguments->isDistributionTableMode || arguments->isCompressedOutputMode ||
+			arguments->common.isWriteToFileEnabled))
+	{
+		fprintf(stderr, "Error: The scenario batch (-B option) does not support the -W, -s, -m, -X, -Q, -E, -j, -D, -Z and -o options.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (arguments->commonRandomNumbersScenarioPath != NULL)
+	{
+		if (!arguments->common.isMonteCarloMode || (arguments->common.outputSelect == kOutputDistributionIndexMax))
+		{
+			fprintf(stderr, "Error: The common random numbers sweep (-U option) requires Monte Carlo mode (-M option) and a single output (-S option).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isAdaptiveMonteCarloMode || arguments->isImportanceSamplingMode || arguments->isWassersteinSweepMode ||
+			arguments->isShardMode || (arguments->mergePartialResultPaths != NULL) || arguments->isParallelMonteCarloMode ||
+			arguments->isParticleMode || arguments->isProductEngineMode || (arguments->scenarioBatchPath != NULL) ||
+			arguments->common.isOutputJSONMode || arguments->isDistributionTableMode || arguments->isCompressedOutputMode)
+		{
+			fprintf(stderr, "Error: The common random numbers sweep (-U option) does not support the -a, -t, -W, -s, -m, -N, -Q, -E, -B, -j, -D and -Z options.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (minimumEffectiveSampleFractionArg != NULL)
+	{
+		if ((parseDoubleChecked(minimumEffectiveSampleFractionArg, &arguments->minimumEffectiveSampleFraction) != kCommonConstantReturnTypeSuccess) ||
+			!(arguments->minimumEffectiveSampleFraction > 0.0) || !(arguments->minimumEffectiveSampleFraction <= 1.0))
+		{
+			fprintf(stderr, "Error: The minimum effective sample fraction (-e option) must be a real number in (0, 1].\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->sampleReweightingStorePath == NULL)
+		{
+			fprintf(stderr, "Error: The minimum effective sample fraction (-e option) requires sample reweighting (-L option).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (arguments->sampleReweightingStorePath != NULL)
+	{
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: Sample reweighting (-L option) requires Monte Carlo mode (-M option).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isAdaptiveMonteCarloMode || arguments->isImportanceSamplingMode || arguments->isWassersteinSweepMode ||
+			arguments->isShardMode || (arguments->mergePartialResultPaths != NULL) || arguments->isParallelMonteCarloMode ||
+			arguments->isParticleMode || arguments->isProductEngineMode || (arguments->scenarioBatchPath != NULL) ||
+			(arguments->commonRandomNumbersScenarioPath != NULL) || arguments->common.isOutputJSONMode ||
+			arguments->isDistributionTableMode || arguments->isCompressedOutputMode)
+		{
+			fprintf(stderr, "Error: Sample reweighting (-L option) does not support the -a, -t, -W, -s, -m, -N, -Q, -E, -B, -U, -j, -D and -Z options.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (areInputsCorrelated())
+		{
+			fprintf(stderr, "Error: Sample reweighting (-L option) requires independent inputs (no -K option).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	/*
+	 *	Importance sampling tilts the heat power transfer on its own, and the
+	 *	product engine samples it apart from the other inputs.
+	 */
+	if ((arguments->isImportanceSamplingMode || arguments->isProductEngineMode) &&
+		getInputCorrelationSpecification()->isCorrelated[kInputDistributionIndexHxfer])
+	{
+		fprintf(stderr, "Error: Importance sampling (-t option) and the product engine (-E option) require Hxfer to be uncorrelated with the other inputs (-K option).\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
 	return kCommonConstantReturnTypeSuccess;
 }
 
+void
+printTailProbabilityEstimate(
+	const TailProbabilityEstimator *	estimator,
+	const ExponentialTilt *			tilt,
+	const char *				variableDescription,
+	const char *				unitsOfMeasurement)
+{
+	double	estimate = getTailProbabilityEstimate(estimator);
+	double	standardError = getTailProbabilityStandardError(estimator);
+
+	printf("Importance sampling estimate of the probability that %s is greater than %.2lf %s: %.6le\n",
+		variableDescription,
+		estimator->threshold,
+		unitsOfMeasurement,
+		estimate);
+	printf("\n");
+	printf("\tStandard error: %.6le (relative standard error: %.6lf)\n",
+		standardError,
+		(estimate > 0.0) ? standardError / estimate : INFINITY);
+	printf("\tSamples: %zu, of which %zu exceed the threshold, with an effective sample size of %.1lf\n",
+		estimator->numberOfSamples,
+		estimator->numberOfExceedances,
+		getTailProbabilityEffectiveSampleSize(estimator));
+	printf("\tTilt on heat power transfer: %.6lf 1/W\n", tilt->tilt);
+
+	return;
+}
+
+void
+printThresholdIntervalDecision(
+	ThresholdIntervalDecision	decision,
+	double				threshold,
+	double				outputLow,
+	double				outputHigh,
+	const char *			variableDescription,
+	const char *			unitsOfMeasurement)
+{
+	printf("Probability that %s is greater than %.2lf %s: %.6le\n",
+		variableDescription,
+		threshold,
+		unitsOfMeasurement,
+		(decision == kThresholdIntervalDecisionAbove) ? 1.0 : 0.0);
+	printf("\n");
+	printf("\tDecided without sampling: over the input bounds, the output lies in [%.6lf, %.6lf] %s, entirely %s the threshold.\n",
+		outputLow,
+		outputHigh,
+		unitsOfMeasurement,
+		(decision == kThresholdIntervalDecisionAbove) ? "above" : "at or below");
+
+	return;
+}
+
 void
 printCalibratedValueAndProbabilities(
 	CommandLineArguments *	arguments,
@@ -219,6 +830,43 @@ printCalibratedValueAndProbabilities(
 	return;
 }
 
+void
+printDistributionValueAndProbabilities(
+	const void *				distribution,
+	DistributionProbabilityGTFunction	probabilityGT,
+	double					value,
+	const char *				variableDescription,
+	const char *				unitsOfMeasurement)
+{
+	static const double	relativeDeviations[] = {0.05, 0.50, 1.00, 2.00};
+	size_t			numberOfDeviations = sizeof(relativeDeviations) / sizeof(relativeDeviations[0]);
+
+	printf("%s: %.2lf %s.\n", variableDescription, value, unitsOfMeasurement);
+	printf("\n");
+
+	for (size_t d = 0; d < numberOfDeviations; d++)
+	{
+		printf(
+			"\tProbability that calibrated sensor output is %3.0lf%% or more smaller than %.2lf, is %.6lf\n",
+			100 * relativeDeviations[d],
+			value,
+			1 - probabilityGT(distribution, value * (1 - relativeDeviations[d])));
+	}
+
+	printf("\n");
+
+	for (size_t d = 0; d < numberOfDeviations; d++)
+	{
+		printf(
+			"\tProbability that calibrated sensor output is %3.0lf%% or more greater than %.2lf, is %.6lf\n",
+			100 * relativeDeviations[d],
+			value,
+			probabilityGT(distribution, (1 + relativeDeviations[d]) * value));
+	}
+
+	return;
+}
+
 void
 populateJSONVariableStruct(
 	JSONVariable *		jsonVariable,
@@ -238,12 +886,19 @@ populateJSONVariableStruct(
 
 void
 printJSONFormattedOutput(
-	CommandLineArguments *	arguments,
-	double *		monteCarloOutputSamples,
-	double *		outputDistributions,
-	const char **		outputVariableDescriptions)
+	CommandLineArguments *		arguments,
+	double *			monteCarloOutputSamples[kOutputDistributionIndexMax],
+	const JointOutputStatistics *	jointOutputStatistics,
+	double *			outputDistributions,
+	const char **			outputVariableDescriptions)
 {
-	JSONVariable			jsonVariables[kOutputDistributionIndexMax];
+	/*
+	 *	Two extra entries for the flattened covariance and correlation matrices.
+	 */
+	JSONVariable			jsonVariables[kOutputDistributionIndexMax + 2];
+	double				covariance[kOutputDistributionIndexMax * kOutputDistributionIndexMax];
+	double				correlation[kOutputDistributionIndexMax * kOutputDistributionIndexMax];
+	size_t				numberOfJSONVariables;
 	OutputDistributionIndex		outputSelectLowerBound;
 	OutputDistributionIndex		outputSelectUpperBound;
 
@@ -266,7 +921,7 @@ printJSONFormattedOutput(
 		 *	Else, it points to the entry of the `outputVariables` to be used.
 		 *	In this case, `arguments.common.numberOfMonteCarloIterations` equals 1.
 		 */
-		double *	pointerToOutputVariable = arguments->common.isMonteCarloMode ? monteCarloOutputSamples : &outputDistributions[outputSelect];
+		double *	pointerToOutputVariable = arguments->common.isMonteCarloMode ? monteCarloOutputSamples[outputSelect] : &outputDistributions[outputSelect];
 
 		populateJSONVariableStruct(
 			&jsonVariables[outputSelect],
@@ -276,10 +931,153 @@ printJSONFormattedOutput(
 			arguments->common.numberOfMonteCarloIterations);
 	}
 
+	numberOfJSONVariables = outputSelectUpperBound - outputSelectLowerBound;
+
+	if (jointOutputStatistics != NULL)
+	{
+		for (size_t i = 0; i < kOutputDistributionIndexMax; i++)
+		{
+			for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+			{
+				covariance[i * kOutputDistributionIndexMax + j] = jointOutputStatistics->covariance[i][j];
+				correlation[i * kOutputDistributionIndexMax + j] = jointOutputStatistics->correlation[i][j];
+			}
+		}
+
+		populateJSONVariableStruct(
+			&jsonVariables[outputSelectUpperBound],
+			covariance,
+			"Output covariance matrix (row-major)",
+			0,
+			kOutputDistributionIndexMax * kOutputDistributionIndexMax);
+		snprintf(jsonVariables[outputSelectUpperBound].variableSymbol, kCommonConstantMaxCharsPerJSONVariableSymbol, "outputCovariance");
+
+		populateJSONVariableStruct(
+			&jsonVariables[outputSelectUpperBound + 1],
+			correlation,
+			"Output correlation matrix (row-major)",
+			0,
+			kOutputDistributionIndexMax * kOutputDistributionIndexMax);
+		snprintf(jsonVariables[outputSelectUpperBound + 1].variableSymbol, kCommonConstantMaxCharsPerJSONVariableSymbol, "outputCorrelation");
+
+		numberOfJSONVariables += 2;
+	}
+
 	printJSONVariables(
 		&jsonVariables[outputSelectLowerBound],
-		outputSelectUpperBound - outputSelectLowerBound,
+		numberOfJSONVariables,
 		"Output variables");
 
 	return;
 }
+
+JointOutputStatistics
+calculateJointOutputStatisticsOfDoubleSamples(
+	double *	monteCarloOutputSamples[kOutputDistributionIndexMax],
+	size_t		numberOfSamples)
+{
+	JointOutputStatistics	statistics = {0};
+	double			mean[kOutputDistributionIndexMax] = {0};
+	double			comoment[kOutputDistributionIndexMax][kOutputDistributionIndexMax] = {{0}};
+	double			delta[kOutputDistributionIndexMax];
+
+	/*
+	 *	Single-pass (Welford-style) update of the means and co-moments.
+	 */
+	for (size_t n = 0; n < numberOfSamples; n++)
+	{
+		for (size_t i = 0; i < kOutputDistributionIndexMax; i++)
+		{
+			delta[i] = monteCarloOutputSamples[i][n] - mean[i];
+			mean[i] += delta[i] / (double)(n + 1);
+		}
+
+		for (size_t i = 0; i < kOutputDistributionIndexMax; i++)
+		{
+			for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+			{
+				comoment[i][j] += delta[i] * (monteCarloOutputSamples[j][n] - mean[j]);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < kOutputDistributionIndexMax; i++)
+	{
+		for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+		{
+			statistics.covariance[i][j] = (numberOfSamples > 1) ? comoment[i][j] / (double)(numberOfSamples - 1) : 0.0;
+		}
+
+		statistics.meanAndVariance[i].mean = mean[i];
+		statistics.meanAndVariance[i].variance = statistics.covariance[i][i];
+	}
+
+	for (size_t i = 0; i < kOutputDistributionIndexMax; i++)
+	{
+		for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+		{
+			double	normalization = sqrt(statistics.covariance[i][i] * statistics.covariance[j][j]);
+
+			statistics.correlation[i][j] = (normalization > 0.0) ? statistics.covariance[i][j] / normalization : 0.0;
+		}
+	}
+
+	return statistics;
+}
+
+void
+printJointOutputStatistics(
+	const JointOutputStatistics *	jointOutputStatistics,
+	const char **			outputVariableDescriptions)
+{
+	printf("Joint output statistics:\n");
+	printf("\n");
+
+	for (size_t i = 0; i < kOutputDistributionIndexMax; i++)
+	{
+		for (size_t j = i + 1; j < kOutputDistributionIndexMax; j++)
+		{
+			printf(
+				"\tCovariance of %s and %s is %.6le, correlation coefficient is %.6lf\n",
+				outputVariableDescriptions[i],
+				outputVariableDescriptions[j],
+				jointOutputStatistics->covariance[i][j],
+				jointOutputStatistics->correlation[i][j]);
+		}
+	}
+
+	return;
+}
+
+void
+saveJointMonteCarloDoubleDataToDataDotOutFile(
+	double **	monteCarloOutputSamples,
+	size_t		numberOfOutputs,
+	uint64_t	cpuTimeUsedInMicroSeconds,
+	size_t		numberOfSamples,
+	size_t		numberOfThreads)
+{
+	RunArenaMark		arenaMark = getRunArenaMark();
+	TextOutputStream	stream;
+
+	if (!openTextOutputFile(&stream, "data.out"))
+	{
+		return;
+	}
+
+	appendTextOutputUnsigned(&stream, cpuTimeUsedInMicroSeconds);
+	appendTextOutputText(&stream, "\n");
+	appendTextOutputDoubleRows(
+		&stream,
+		(const double * const *)monteCarloOutputSamples,
+		numberOfOutputs,
+		numberOfSamples,
+		" ",
+		"\n",
+		NULL,
+		numberOfThreads);
+	closeTextOutputStream(&stream);
+	releaseRunArenaToMark(arenaMark);
+
+	return;
+}
@@ -24,12 +24,54 @@
 
 #include "common.h"
 #include "utilities-config.h"
+#include "importance-sampling.h"
 
 typedef struct
 {
 	CommonCommandLineArguments	common;
+	bool				isAdaptiveMonteCarloMode;
+	double				adaptiveTolerance;
+	bool				isImportanceSamplingMode;
+	double				tailThreshold;
+	bool				isTiltSpecified;
+	double				importanceSamplingTilt;
+	bool				isPerfCountersEnabled;
+	bool				isWassersteinSweepMode;
+	char *				wassersteinReferencePath;
+	bool				isShardMode;
+	size_t				shardIndex;
+	size_t				numberOfShards;
+	char *				mergePartialResultPaths;
+	bool				isParallelMonteCarloMode;
+	size_t				numberOfThreads;
+	bool				isThreadPinningEnabled;
+	JSONOutputContent		jsonOutputContent;
+	bool				isDistributionTableMode;
+	DistributionTableBounds		distributionTableBounds;
+	DistributionTableFormat		distributionTableFormat;
+	bool				isCompressedOutputMode;
+	char *				decompressInputPath;
+	bool				isParticleMode;
+	bool				isProductEngineMode;
+	size_t				numberOfProductMassFlowSamples;
+	size_t				numberOfProductCorrectionFactorSamples;
+	char *				scenarioBatchPath;
+	char *				commonRandomNumbersScenarioPath;
+	char *				sampleReweightingStorePath;
+	double				minimumEffectiveSampleFraction;
 } CommandLineArguments;
 
+/*
+ *	Joint statistics of the outputs of a Monte Carlo run in which all
+ *	outputs are calculated in the same pass.
+ */
+typedef struct
+{
+	MeanAndVariance	meanAndVariance[kOutputDistributionIndexMax];
+	double		covariance[kOutputDistributionIndexMax][kOutputDistributionIndexMax];
+	double		correlation[kOutputDistributionIndexMax][kOutputDistributionIndexMax];
+} JointOutputStatistics;
+
 /**
  *	@brief	Print out command line usage.
  */
@@ -60,6 +102,62 @@ void	printCalibratedValueAndProbabilities(
 		const char *  		variableDescription,
 		const char *		unitsOfMeasurement);
 
+/*
+ *	Probability that a distribution held in some representation other than a
+ *	distributional double is greater than a threshold.
+ */
+typedef double	(*DistributionProbabilityGTFunction)(const void *  distribution, double threshold);
+
+/**
+ *	@brief  Prints a distribution in the form of `printCalibratedValueAndProbabilities()`, with
+ *		the probabilities answered by a function of the representation of the distribution
+ *		instead of `UxHwDoubleProbabilityGT()`.
+ *
+ *	@param  distribution		: The distribution.
+ *	@param  probabilityGT		: The probability that the distribution is greater than a threshold.
+ *	@param  value			: The value (mean) of the distribution.
+ *	@param  variableDescription	: A string that describes the output.
+ *	@param  unitsOfMeasurement	: A string that describes the units of measurement of the printed value.
+ */
+void	printDistributionValueAndProbabilities(
+		const void *				distribution,
+		DistributionProbabilityGTFunction	probabilityGT,
+		double					value,
+		const char *				variableDescription,
+		const char *				unitsOfMeasurement);
+
+/**
+ *	@brief  Prints the importance sampling estimate of a tail probability in a human-readable form.
+ *
+ *	@param  estimator		: The tail probability estimator.
+ *	@param  tilt			: The exponential tilt applied to the heat power transfer input.
+ *	@param  variableDescription	: A string that describes the output.
+ *	@param  unitsOfMeasurement	: A string that describes the units of measurement of the output.
+ */
+void	printTailProbabilityEstimate(
+		const TailProbabilityEstimator *	estimator,
+		const ExponentialTilt *			tilt,
+		const char *				variableDescription,
+		const char *				unitsOfMeasurement);
+
+/**
+ *	@brief  Prints a tail probability that the interval pre-filter decided without sampling.
+ *
+ *	@param  decision		: `kThresholdIntervalDecisionBelow` or `kThresholdIntervalDecisionAbove`.
+ *	@param  threshold		: The threshold.
+ *	@param  outputLow		: The lower bound of the output over the input bounds.
+ *	@param  outputHigh		: The upper bound of the output over the input bounds.
+ *	@param  variableDescription	: A string that describes the output.
+ *	@param  unitsOfMeasurement	: A string that describes the units of measurement of the output.
+ */
+void	printThresholdIntervalDecision(
+		ThresholdIntervalDecision	decision,
+		double				threshold,
+		double				outputLow,
+		double				outputHigh,
+		const char *			variableDescription,
+		const char *			unitsOfMeasurement);
+
 /**
  * 	@brief  Populates a JSONVariable struct
  *
@@ -81,12 +179,55 @@ void	populateJSONVariableStruct(
  *		a single value or all values stored in `outputDistributions`.
  * 
  *	@param  arguments				: The command-line arguments, specifying which outputs will be printed.
- *	@param  monteCarloOutputSamples			: The array of data samples of Monte Carlo.
+ *	@param  monteCarloOutputSamples			: The per-output arrays of data samples of Monte Carlo.
+ *	@param  jointOutputStatistics			: Joint statistics to print along with the samples, or NULL.
  *	@param  outputDistributions 			: The array that stores the distributions to be printed.
  *	@param  outputVariableDescriptions		: An array of strings containing the descriptions of the variables to be printed.
  */
 void	printJSONFormattedOutput(
-		CommandLineArguments *	arguments,
-		double *		monteCarloOutputSamples,
-		double *		outputDistributions,
-		const char **		outputVariableDescriptions);
+		CommandLineArguments *		arguments,
+		double *			monteCarloOutputSamples[kOutputDistributionIndexMax],
+		const JointOutputStatistics *	jointOutputStatistics,
+		double *			outputDistributions,
+		const char **			outputVariableDescriptions);
+
+/**
+ *	@brief  Calculates the means, variances, covariances and correlation coefficients of
+ *		the per-output Monte Carlo sample arrays in a single pass.
+ *
+ *	@param  monteCarloOutputSamples		: The per-output arrays of data samples of Monte Carlo.
+ *	@param  numberOfSamples			: The number of samples in each array.
+ *
+ *	@return	JointOutputStatistics		: The joint statistics of the outputs.
+ */
+JointOutputStatistics	calculateJointOutputStatisticsOfDoubleSamples(
+				double *	monteCarloOutputSamples[kOutputDistributionIndexMax],
+				size_t		numberOfSamples);
+
+/**
+ *	@brief  Prints the covariance and correlation coefficients of the outputs in a human-readable form.
+ *
+ *	@param  jointOutputStatistics		: The joint statistics to print.
+ *	@param  outputVariableDescriptions	: An array of strings containing the descriptions of the outputs.
+ */
+void	printJointOutputStatistics(
+		const JointOutputStatistics *	jointOutputStatistics,
+		const char **			outputVariableDescriptions);
+
+/**
+ *	@brief  Saves joint Monte Carlo outputs to `data.out`. The first line contains the execution time
+ *		in microseconds and each next line contains one sample of every output, separated by spaces,
+ *		in the shortest form that reads back as the same double.
+ *
+ *	@param  monteCarloOutputSamples		: The per-output arrays of data samples of Monte Carlo.
+ *	@param  numberOfOutputs			: The number of arrays in `monteCarloOutputSamples`.
+ *	@param  cpuTimeUsedInMicroSeconds	: The execution time to write on the first line.
+ *	@param  numberOfSamples			: The number of samples in each array.
+ *	@param  numberOfThreads			: The number of threads to format the samples with.
+ */
+void	saveJointMonteCarloDoubleDataToDataDotOutFile(
+		double **	monteCarloOutputSamples,
+		size_t		numberOfOutputs,
+		uint64_t	cpuTimeUsedInMicroSeconds,
+		size_t		numberOfSamples,
+		size_t		numberOfThreads);
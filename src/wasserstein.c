@@ -0,0 +1,523 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "wasserstein.h"
+#include "run-arena.h"
+#include "samplers.h"
+#include "sensor-calibration.h"
+#include "timing.h"
+
+/*
+ *	One point of the sweep, for one output.
+ */
+typedef struct
+{
+	InputSamplerType	samplerType;
+	size_t			numberOfSamples;
+	double			meanWassersteinDistance;
+	double			standardDeviationOfWassersteinDistance;
+	double			medianWallNanoseconds;
+} WassersteinSweepPoint;
+
+static int
+compareDoubles(const void *  a, const void *  b)
+{
+	double	x = *(const double *)a;
+	double	y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+void
+sortDoubleSamples(double *  samples, size_t numberOfSamples)
+{
+	qsort(samples, numberOfSamples, sizeof(double), compareDoubles);
+
+	return;
+}
+
+double
+calculateWassersteinDistanceOfSortedSamples(
+	const double *	samples,
+	size_t		numberOfSamples,
+	const double *	referenceSamples,
+	size_t		numberOfReferenceSamples)
+{
+	double	distance = 0.0;
+	double	u = 0.0;
+	size_t	i = 0;
+	size_t	j = 0;
+
+	/*
+	 *	Walk the breakpoints `(i + 1) / n` and `(j + 1) / m` of the two quantile
+	 *	functions in order. Comparing `(i + 1) * m` with `(j + 1) * n` avoids
+	 *	rounding errors in deciding which breakpoint comes first.
+	 */
+	while ((i < numberOfSamples) && (j < numberOfReferenceSamples))
+	{
+		size_t	sampleBreakpoint = (i + 1) * numberOfReferenceSamples;
+		size_t	referenceBreakpoint = (j + 1) * numberOfSamples;
+		double	nextU = (sampleBreakpoint <= referenceBreakpoint) ?
+					(double)(i + 1) / (double)numberOfSamples :
+					(double)(j + 1) / (double)numberOfReferenceSamples;
+
+		distance += (nextU - u) * fabs(samples[i] - referenceSamples[j]);
+		u = nextU;
+
+		if (sampleBreakpoint <= referenceBreakpoint)
+		{
+			i++;
+		}
+
+		if (referenceBreakpoint <= sampleBreakpoint)
+		{
+			j++;
+		}
+	}
+
+	return distance;
+}
+
+/*
+ *	Loads samples from a file in the format of `data.out`: the first line
+ *	holds the execution time and each next line one sample. The file is read
+ *	twice, first to count the samples, so that the samples can be read into
+ *	one allocation from the run arena.
+ */
+static double *
+loadReferenceSamples(const char *  path, size_t *  numberOfSamples)
+{
+	FILE *		fp = fopen(path, "r");
+	double *	samples;
+	double		executionTime;
+	double		sample;
+
+	*numberOfSamples = 0;
+
+	if (fp == NULL)
+	{
+		fprintf(stderr, "Error: Could not open the Wasserstein reference file \"%s\".\n", path);
+
+		return NULL;
+	}
+
+	if (fscanf(fp, "%lf", &executionTime) != 1)
+	{
+		fprintf(stderr, "Error: The Wasserstein reference file \"%s\" is empty.\n", path);
+		fclose(fp);
+
+		return NULL;
+	}
+
+	while (fscanf(fp, "%lf", &sample) == 1)
+	{
+		(*numberOfSamples)++;
+	}
+
+	if (*numberOfSamples == 0)
+	{
+		fprintf(stderr, "Error: The Wasserstein reference file \"%s\" holds no samples.\n", path);
+		fclose(fp);
+
+		return NULL;
+	}
+
+	samples = (double *) allocateFromRunArena(*numberOfSamples * sizeof(double), kRunArenaDefaultAlignment);
+
+	if (samples == NULL)
+	{
+		fprintf(stderr, "Error: Out of memory for the samples of the Wasserstein reference file \"%s\".\n", path);
+		fclose(fp);
+
+		return NULL;
+	}
+
+	rewind(fp);
+
+	if (fscanf(fp, "%lf", &executionTime) != 1)
+	{
+		fclose(fp);
+
+		return NULL;
+	}
+
+	for (size_t i = 0; i < *numberOfSamples; i++)
+	{
+		if (fscanf(fp, "%lf", &samples[i]) != 1)
+		{
+			fprintf(stderr, "Error: The Wasserstein reference file \"%s\" changed while reading it.\n", path);
+			fclose(fp);
+
+			return NULL;
+		}
+	}
+
+	fclose(fp);
+
+	return samples;
+}
+
+/*
+ *	Samples the inputs and runs the kernel of the selected output(s).
+ */
+static void
+sampleOutputs(
+	const CommandLineArguments *	arguments,
+	InputSamplerType		samplerType,
+	double				(*inputDistributionBlock)[kInputDistributionIndexMax],
+	double *			outputSamples[kOutputDistributionIndexMax],
+	size_t				numberOfSamples)
+{
+	sampleInputDistributions(samplerType, inputDistributionBlock, numberOfSamples);
+	getSensorOutputBlockKernel(arguments->common.outputSelect)(
+		(const double (*)[kInputDistributionIndexMax])inputDistributionBlock,
+		outputSamples,
+		numberOfSamples);
+
+	return;
+}
+
+/*
+ *	Wall-clock time of one run of `sampleOutputs()`, as the median of
+ *	`kWassersteinSweepTimingRepetitions` timings after warmup runs. The
+ *	warmup runs also set how many runs each timing takes, so that it lasts
+ *	well beyond the resolution of the clock and short scheduler interruptions.
+ */
+static double
+timeSampleOutputs(
+	const CommandLineArguments *	arguments,
+	InputSamplerType		samplerType,
+	double				(*inputDistributionBlock)[kInputDistributionIndexMax],
+	double *			outputSamples[kOutputDistributionIndexMax],
+	size_t				numberOfSamples)
+{
+	double		timings[kWassersteinSweepTimingRepetitions];
+	uint64_t	warmupNanoseconds = 0;
+	uint64_t	runsPerTiming;
+
+	for (int r = 0; r < kWassersteinSweepTimingWarmupRepetitions; r++)
+	{
+		uint64_t	start = getWallClockNanoseconds();
+
+		sampleOutputs(arguments, samplerType, inputDistributionBlock, outputSamples, numberOfSamples);
+		warmupNanoseconds = getWallClockNanoseconds() - start;
+	}
+
+	runsPerTiming = (warmupNanoseconds >= kWassersteinSweepTimingMinimumNanoseconds) ?
+				1 :
+				kWassersteinSweepTimingMinimumNanoseconds / ((warmupNanoseconds > 0) ? warmupNanoseconds : 1) + 1;
+
+	for (int r = 0; r < kWassersteinSweepTimingRepetitions; r++)
+	{
+		uint64_t	start = getWallClockNanoseconds();
+
+		for (uint64_t run = 0; run < runsPerTiming; run++)
+		{
+			sampleOutputs(arguments, samplerType, inputDistributionBlock, outputSamples, numberOfSamples);
+		}
+
+		timings[r] = (double)(getWallClockNanoseconds() - start) / (double)runsPerTiming;
+	}
+
+	sortDoubleSamples(timings, kWassersteinSweepTimingRepetitions);
+
+	return timings[kWassersteinSweepTimingRepetitions / 2];
+}
+
+static bool
+isWassersteinSweepPointParetoOptimal(const WassersteinSweepPoint *  points, size_t numberOfPoints, size_t index)
+{
+	for (size_t k = 0; k < numberOfPoints; k++)
+	{
+		bool	isNoWorse = (points[k].medianWallNanoseconds <= points[index].medianWallNanoseconds) &&
+				(points[k].meanWassersteinDistance <= points[index].meanWassersteinDistance);
+		bool	isBetter = (points[k].medianWallNanoseconds < points[index].medianWallNanoseconds) ||
+				(points[k].meanWassersteinDistance < points[index].meanWassersteinDistance);
+
+		if ((k != index) && isNoWorse && isBetter)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+CommonConstantReturnType
+runWassersteinSweep(const CommandLineArguments *  arguments, const char **  outputVariableNames)
+{
+	bool				calculateAllOutputs = (arguments->common.outputSelect == kOutputDistributionIndexMax);
+	size_t				numberOfReferenceSamples = arguments->common.isMonteCarloMode ?
+								arguments->common.numberOfMonteCarloIterations :
+								kWassersteinSweepDefaultReferenceSize;
+	size_t				maximumSweepSize = 0;
+	size_t				numberOfSizes = 0;
+	size_t				numberOfPoints;
+	double *			referenceSamples[kOutputDistributionIndexMax] = {NULL};
+	double *			outputSamples[kOutputDistributionIndexMax] = {NULL};
+	double				(*inputDistributionBlock)[kInputDistributionIndexMax] = NULL;
+	WassersteinSweepPoint *		points[kOutputDistributionIndexMax] = {NULL};
+	bool				isFirstRow = true;
+	bool				isOutOfMemory = false;
+	RunArenaMark			arenaMark = getRunArenaMark();
+
+	/*
+	 *	Reference distribution(s): loaded, or generated with Latin hypercube sampling.
+	 */
+	if (arguments->wassersteinReferencePath != NULL)
+	{
+		referenceSamples[arguments->common.outputSelect] = loadReferenceSamples(
+									arguments->wassersteinReferencePath,
+									&numberOfReferenceSamples);
+
+		if (referenceSamples[arguments->common.outputSelect] == NULL)
+		{
+			releaseRunArenaToMark(arenaMark);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+	else
+	{
+		inputDistributionBlock = allocateFromRunArena(numberOfReferenceSamples * sizeof(*inputDistributionBlock), kRunArenaDefaultAlignment);
+		isOutOfMemory = (inputDistributionBlock == NULL);
+
+		for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+		{
+			if (calculateAllOutputs || (j == arguments->common.outputSelect))
+			{
+				referenceSamples[j] = (double *) allocateFromRunArena(numberOfReferenceSamples * sizeof(double), kRunArenaDefaultAlignment);
+				isOutOfMemory = isOutOfMemory || (referenceSamples[j] == NULL);
+			}
+		}
+
+		if (isOutOfMemory)
+		{
+			fprintf(stderr, "Error: Out of memory for the Wasserstein reference samples.\n");
+			releaseRunArenaToMark(arenaMark);
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		sampleOutputs(arguments, kInputSamplerTypeLatinHypercube, inputDistributionBlock, referenceSamples, numberOfReferenceSamples);
+	}
+
+	for (size_t size = kWassersteinSweepMinimumSize; size <= numberOfReferenceSamples / 10; size *= kWassersteinSweepSizeFactor)
+	{
+		maximumSweepSize = size;
+		numberOfSizes++;
+	}
+
+	if (numberOfSizes == 0)
+	{
+		fprintf(
+			stderr,
+			"Error: The Wasserstein reference needs at least %d samples.\n",
+			10 * kWassersteinSweepMinimumSize);
+
+		releaseRunArenaToMark(arenaMark);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (inputDistributionBlock == NULL)
+	{
+		inputDistributionBlock = allocateFromRunArena(maximumSweepSize * sizeof(*inputDistributionBlock), kRunArenaDefaultAlignment);
+		isOutOfMemory = (inputDistributionBlock == NULL);
+	}
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		if (referenceSamples[j] != NULL)
+		{
+			sortDoubleSamples(referenceSamples[j], numberOfReferenceSamples);
+			outputSamples[j] = (double *) allocateFromRunArena(maximumSweepSize * sizeof(double), kRunArenaDefaultAlignment);
+			points[j] = (WassersteinSweepPoint *) allocateFromRunArena(
+								kInputSamplerTypeMax * numberOfSizes * sizeof(WassersteinSweepPoint),
+								kRunArenaDefaultAlignment);
+
+			isOutOfMemory = isOutOfMemory || (outputSamples[j] == NULL) || (points[j] == NULL);
+		}
+	}
+
+	if (isOutOfMemory)
+	{
+		fprintf(stderr, "Error: Out of memory for the Wasserstein sweep.\n");
+		releaseRunArenaToMark(arenaMark);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	The sweep.
+	 */
+	numberOfPoints = 0;
+
+	for (size_t s = 0; s < kInputSamplerTypeMax; s++)
+	{
+		for (size_t size = kWassersteinSweepMinimumSize; size <= maximumSweepSize; size *= kWassersteinSweepSizeFactor)
+		{
+			double	sumOfDistances[kOutputDistributionIndexMax] = {0};
+			double	sumOfSquaredDistances[kOutputDistributionIndexMax] = {0};
+
+			for (int r = 0; r < kWassersteinSweepRepetitions; r++)
+			{
+				sampleOutputs(arguments, (InputSamplerType)s, inputDistributionBlock, outputSamples, size);
+
+				for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+				{
+					if (referenceSamples[j] != NULL)
+					{
+						double	distance;
+
+						sortDoubleSamples(outputSamples[j], size);
+						distance = calculateWassersteinDistanceOfSortedSamples(
+								outputSamples[j],
+								size,
+								referenceSamples[j],
+								numberOfReferenceSamples);
+						sumOfDistances[j] += distance;
+						sumOfSquaredDistances[j] += distance * distance;
+					}
+				}
+			}
+
+			for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+			{
+				if (referenceSamples[j] != NULL)
+				{
+					double	mean = sumOfDistances[j] / kWassersteinSweepRepetitions;
+					double	variance = (sumOfSquaredDistances[j] - kWassersteinSweepRepetitions * mean * mean) / (kWassersteinSweepRepetitions - 1);
+
+					points[j][numberOfPoints] = (WassersteinSweepPoint)
+					{
+						.samplerType				= (InputSamplerType)s,
+						.numberOfSamples			= size,
+						.meanWassersteinDistance		= mean,
+						.standardDeviationOfWassersteinDistance	= sqrt(fmax(variance, 0.0)),
+					};
+				}
+			}
+
+			numberOfPoints++;
+		}
+	}
+
+	/*
+	 *	The costs, after all the accuracies, so that the number of timed runs
+	 *	(which depends on the speed of the machine) does not change the random
+	 *	numbers, and hence the distances, of the points that follow.
+	 */
+	numberOfPoints = 0;
+
+	for (size_t s = 0; s < kInputSamplerTypeMax; s++)
+	{
+		for (size_t size = kWassersteinSweepMinimumSize; size <= maximumSweepSize; size *= kWassersteinSweepSizeFactor)
+		{
+			double	medianWallNanoseconds = timeSampleOutputs(arguments, (InputSamplerType)s, inputDistributionBlock, outputSamples, size);
+
+			for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+			{
+				if (referenceSamples[j] != NULL)
+				{
+					points[j][numberOfPoints].medianWallNanoseconds = medianWallNanoseconds;
+				}
+			}
+
+			numberOfPoints++;
+		}
+	}
+
+	/*
+	 *	Report.
+	 */
+	if (arguments->common.isOutputJSONMode)
+	{
+		printf(
+			"{\"referenceSize\": %zu, \"repetitions\": %d, \"timingRepetitions\": %d, \"points\": [",
+			numberOfReferenceSamples,
+			kWassersteinSweepRepetitions,
+			kWassersteinSweepTimingRepetitions);
+	}
+	else
+	{
+		printf("output,sampler,numberOfSamples,wassersteinDistanceMean,wassersteinDistanceStandardDeviation,wallNanosecondsMedian,isParetoOptimal\n");
+	}
+
+	for (size_t j = 0; j < kOutputDistributionIndexMax; j++)
+	{
+		if (referenceSamples[j] == NULL)
+		{
+			continue;
+		}
+
+		for (size_t p = 0; p < numberOfPoints; p++)
+		{
+			const WassersteinSweepPoint *	point = &points[j][p];
+			bool				isParetoOptimal = isWassersteinSweepPointParetoOptimal(points[j], numberOfPoints, p);
+
+			if (arguments->common.isOutputJSONMode)
+			{
+				printf(
+					"%s{\"output\": \"%s\", \"sampler\": \"%s\", \"numberOfSamples\": %zu, "
+					"\"wassersteinDistanceMean\": %.9le, \"wassersteinDistanceStandardDeviation\": %.9le, "
+					"\"wallNanosecondsMedian\": %.1lf, \"isParetoOptimal\": %s}",
+					isFirstRow ? "" : ", ",
+					outputVariableNames[j],
+					getInputSamplerTypeName(point->samplerType),
+					point->numberOfSamples,
+					point->meanWassersteinDistance,
+					point->standardDeviationOfWassersteinDistance,
+					point->medianWallNanoseconds,
+					isParetoOptimal ? "true" : "false");
+			}
+			else
+			{
+				printf(
+					"\"%s\",%s,%zu,%.9le,%.9le,%.1lf,%d\n",
+					outputVariableNames[j],
+					getInputSamplerTypeName(point->samplerType),
+					point->numberOfSamples,
+					point->meanWassersteinDistance,
+					point->standardDeviationOfWassersteinDistance,
+					point->medianWallNanoseconds,
+					isParetoOptimal);
+			}
+
+			isFirstRow = false;
+		}
+	}
+
+	if (arguments->common.isOutputJSONMode)
+	{
+		printf("]}\n");
+	}
+
+	releaseRunArenaToMark(arenaMark);
+
+	return kCommonConstantReturnTypeSuccess;
+}
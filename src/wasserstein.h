@@ -0,0 +1,66 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stddef.h>
+#include "utilities.h"
+
+/**
+ *	@brief	1-Wasserstein distance between the empirical distributions of two sorted sets of
+ *		samples, i.e., the integral over `u` in `[0, 1]` of the absolute difference of
+ *		their quantile functions. Runs in `O(n + m)` time.
+ *
+ *	@param	samples			: The first set of samples, sorted in ascending order.
+ *	@param	numberOfSamples		: The number of samples in the first set.
+ *	@param	referenceSamples	: The second set of samples, sorted in ascending order.
+ *	@param	numberOfReferenceSamples: The number of samples in the second set.
+ *	@return				: The 1-Wasserstein distance.
+ */
+double	calculateWassersteinDistanceOfSortedSamples(
+		const double *	samples,
+		size_t		numberOfSamples,
+		const double *	referenceSamples,
+		size_t		numberOfReferenceSamples);
+
+/**
+ *	@brief	Sorts samples in ascending order.
+ *
+ *	@param	samples		: The samples.
+ *	@param	numberOfSamples	: The number of samples.
+ */
+void	sortDoubleSamples(double *  samples, size_t numberOfSamples);
+
+/**
+ *	@brief	Runs the Wasserstein accuracy-versus-cost sweep: for every input sampler and number
+ *		of samples, measures the wall-clock time of sampling and running the kernel, and the
+ *		1-Wasserstein distance of the selected output(s) to a reference distribution, which
+ *		is either loaded from a file or generated with Latin hypercube sampling. Prints one
+ *		CSV row (or, in JSON mode, one JSON object) per output, sampler and number of samples,
+ *		marking the Pareto-optimal ones.
+ *
+ *	@param	arguments		: The command-line arguments.
+ *	@param	outputVariableNames	: The names of the outputs.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runWassersteinSweep(const CommandLineArguments *  arguments, const char **  outputVariableNames);